@@ -5,6 +5,7 @@
 #include <imgui.h>
 
 #include "core/Scene.hpp"
+#include "graphics/DescriptorResource.hpp"
 #include "graphics/Window.hpp"
 #include <ImGuizmo/ImGuizmo.h>
 
@@ -210,6 +211,8 @@ AstuteApplication::interface() -> void
         case GizmoState::Scale:
           transform.scale = scale;
       }
+      // Edited in place, so tell the scene its entity tree is stale.
+      scene->get_registry().patch<TransformComponent>(*selected_entity);
     },
     {
       .expandable = false,
@@ -286,6 +289,82 @@ AstuteApplication::interface() -> void
   renderer->expose_settings_to_ui();
   UI::end();
 
+  UI::scope("Culling", [&r = renderer]() {
+    auto gpu_driven = r->get_technique() == RendererTechnique::GPUDriven;
+    if (ImGui::Checkbox("GPU-driven", &gpu_driven)) {
+      r->set_technique(gpu_driven ? RendererTechnique::GPUDriven
+                                  : RendererTechnique::Deferred);
+    }
+    const auto& statistics = r->get_culling_statistics();
+    UI::text("Tested: {}", statistics.tested);
+    UI::coloured_text(
+      { 0.1F, 0.9F, 0.6F, 1.0F }, "Visible: {}", statistics.visible);
+    UI::coloured_text(
+      { 0.9F, 0.3F, 0.2F, 1.0F }, "Culled: {}", statistics.culled());
+    for (auto i = 0ULL; i < statistics.cascade_visible.size(); i++) {
+      UI::text("Cascade {}: {}", i, statistics.cascade_visible.at(i));
+    }
+  });
+
+  UI::scope("Draw state", [this]() {
+    for (const auto* name : { "MainGeometry", "Shadow" }) {
+      const auto statistics =
+        renderer->get_render_pass(name).get_command_statistics();
+      UI::text("{}: {} emitted, {} skipped",
+               name,
+               statistics.emitted,
+               statistics.skipped);
+    }
+  });
+
+  UI::scope("Descriptors", []() {
+    const auto statistics = DescriptorResource::the().get_statistics();
+    UI::text("Allocated sets: {}", statistics.allocated_sets);
+    UI::text("Descriptor writes: {}", statistics.descriptor_writes);
+    UI::text("Frame pools: {} (peak {})",
+             statistics.frame_pools,
+             statistics.peak_frame_pools);
+    UI::text("Peak sets per frame: {}", statistics.peak_frame_sets);
+    UI::text("Persistent pools: {}", statistics.persistent_pools);
+  });
+
+  UI::scope("Render graph", [this]() {
+    const auto& statistics = renderer->get_render_graph_statistics();
+    constexpr auto mebibyte = 1024.0 * 1024.0;
+    UI::text("Passes: {} ({} culled)", statistics.passes, statistics.culled);
+    UI::text("Hazards: {}, covered by render passes: {}, between queues: {}",
+             statistics.hazards,
+             statistics.covered,
+             statistics.cross_queue);
+    UI::text("Barriers: {}", statistics.barriers);
+    UI::text("Transients: {:.1f} MiB, aliased: {:.1f} MiB",
+             static_cast<f64>(statistics.transient_bytes) / mebibyte,
+             static_cast<f64>(statistics.aliased_bytes) / mebibyte);
+  });
+
+  UI::scope("Frame timing", [this]() {
+    const auto& statistics = get_statistics();
+    const auto cpu_time = statistics.frame_time - statistics.frame_wait_time;
+    const auto gpu_time = renderer->get_gpu_frame_time();
+    UI::text("Frame: {:.2f} ms", statistics.frame_time);
+    UI::text("CPU: {:.2f} ms, waiting for the GPU: {:.2f} ms",
+             cpu_time,
+             statistics.frame_wait_time);
+    UI::text("GPU: {:.2f} ms", gpu_time);
+    // Busy time beyond the frame time is time both worked at once.
+    UI::text("CPU/GPU overlap: {:.2f} ms",
+             std::max(0.0, cpu_time + gpu_time - statistics.frame_time));
+
+    const auto graphics_time =
+      renderer->get_gpu_queue_time(QueueType::Graphics);
+    const auto compute_time = renderer->get_gpu_queue_time(QueueType::Compute);
+    UI::text("Graphics queue: {:.2f} ms, compute queue: {:.2f} ms",
+             graphics_time,
+             compute_time);
+    UI::text("Queue overlap: {:.2f} ms",
+             std::max(0.0, graphics_time + compute_time - gpu_time));
+  });
+
   ImGui::PopStyleVar();
 
   for_each_in_tuple(widgets, [](auto& widget) { widget->interface(); });
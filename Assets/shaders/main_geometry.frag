@@ -2,6 +2,12 @@
 
 #extension GL_EXT_debug_printf : enable
 
+#pragma variant USE_NORMAL_MAP
+
+#ifndef USE_NORMAL_MAP
+#define USE_NORMAL_MAP 0
+#endif
+
 #include "buffers.glsl"
 #include "util.glsl"
 
@@ -30,8 +36,6 @@ layout(push_constant) uniform Material
   float transparency;
   float roughness;
   float emission;
-
-  uint use_normal_map;
 }
 mat_pc;
 
@@ -45,11 +49,11 @@ main()
   vec3 T = normalize(fragment_tangents);
   vec3 B = normalize(fragment_bitangents);
   mat3 TBN = mat3(T, B, N);
-  if (mat_pc.use_normal_map == 1) {
-    fragment_normals = compute_normal_from_map(TBN);
-  } else {
-    fragment_normals = vec4(N, 0.0);
-  }
+#if USE_NORMAL_MAP
+  fragment_normals = compute_normal_from_map(TBN);
+#else
+  fragment_normals = vec4(N, 0.0);
+#endif
 
   vec4 sampled_albedo = texture(albedo_map, fragment_uvs);
   vec3 albedo_color = sampled_albedo.rgb * mat_pc.albedo_colour;
@@ -0,0 +1,152 @@
+#include <graphics/PersistentDescriptorSet.hpp>
+
+#include <array>
+#include <bit>
+#include <gtest/gtest.h>
+
+using namespace Engine::Graphics;
+using Engine::Core::u32;
+using Engine::Core::u64;
+
+namespace {
+auto
+image_write(u32 binding, const VkDescriptorImageInfo& info)
+  -> VkWriteDescriptorSet
+{
+  VkWriteDescriptorSet write{};
+  write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  write.dstBinding = binding;
+  write.descriptorCount = 1;
+  write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  write.pImageInfo = &info;
+  return write;
+}
+
+auto
+buffer_write(u32 binding, const VkDescriptorBufferInfo& info)
+  -> VkWriteDescriptorSet
+{
+  VkWriteDescriptorSet write{};
+  write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  write.dstBinding = binding;
+  write.descriptorCount = 1;
+  write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  write.pBufferInfo = &info;
+  return write;
+}
+
+template<class Handle>
+auto
+fake_handle(std::uintptr_t value) -> Handle
+{
+  return std::bit_cast<Handle>(value);
+}
+} // namespace
+
+TEST(DescriptorBindingTrackerTest, WritesEveryBindingOnceThenNothing)
+{
+  const VkDescriptorImageInfo albedo{
+    .imageView = fake_handle<VkImageView>(0x10),
+    .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+  };
+  const VkDescriptorBufferInfo camera{
+    .buffer = fake_handle<VkBuffer>(0x20),
+    .range = 256,
+  };
+  const std::array writes{ image_write(3, albedo), buffer_write(0, camera) };
+
+  DescriptorBindingTracker tracker;
+  EXPECT_EQ(tracker.track(writes),
+            DescriptorBindingTracker::binding_bit(0) |
+              DescriptorBindingTracker::binding_bit(3));
+  EXPECT_EQ(tracker.track(writes), 0U);
+  EXPECT_EQ(tracker.track(writes), 0U);
+}
+
+TEST(DescriptorBindingTrackerTest, ChangesBehindTheSamePointerAreDirty)
+{
+  // Framebuffer attachments are recreated in place on resize: the pointer a
+  // material holds stays, the view it points at does not.
+  VkDescriptorImageInfo attachment{
+    .imageView = fake_handle<VkImageView>(0x10),
+    .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+  };
+  VkDescriptorBufferInfo lights{
+    .buffer = fake_handle<VkBuffer>(0x20),
+    .range = 64,
+  };
+  const std::array writes{ image_write(1, attachment),
+                          buffer_write(2, lights) };
+
+  DescriptorBindingTracker tracker;
+  tracker.track(writes);
+
+  attachment.imageView = fake_handle<VkImageView>(0x11);
+  EXPECT_EQ(tracker.track(writes), DescriptorBindingTracker::binding_bit(1));
+
+  lights.range = 128;
+  EXPECT_EQ(tracker.track(writes), DescriptorBindingTracker::binding_bit(2));
+  EXPECT_EQ(tracker.track(writes), 0U);
+}
+
+TEST(DescriptorBindingTrackerTest, MarkedAndResetBindingsAreDirty)
+{
+  const VkDescriptorImageInfo image{
+    .imageView = fake_handle<VkImageView>(0x10),
+  };
+  const std::array writes{ image_write(4, image), image_write(70, image) };
+
+  DescriptorBindingTracker tracker;
+  tracker.track(writes);
+
+  // A mark only reports the binding once it is among the writes.
+  tracker.mark_dirty(9);
+  EXPECT_EQ(tracker.track(writes), 0U);
+  tracker.mark_dirty(4);
+  EXPECT_EQ(tracker.track(writes), DescriptorBindingTracker::binding_bit(4));
+
+  // Bindings from 63 up share the top bit.
+  EXPECT_EQ(DescriptorBindingTracker::binding_bit(70), u64{ 1 } << 63);
+  tracker.mark_dirty(100);
+  EXPECT_EQ(tracker.track(writes), DescriptorBindingTracker::binding_bit(70));
+
+  tracker.reset();
+  EXPECT_EQ(tracker.track(writes),
+            DescriptorBindingTracker::binding_bit(4) |
+              DescriptorBindingTracker::binding_bit(70));
+}
+
+TEST(DescriptorBindingTrackerTest, SeparateCallsCoverSeparateBindings)
+{
+  // The renderer writes its buffers and a pass material its images into the
+  // same set, in two calls.
+  const VkDescriptorBufferInfo camera{
+    .buffer = fake_handle<VkBuffer>(0x20),
+    .range = 256,
+  };
+  const VkDescriptorImageInfo shadow_map{
+    .imageView = fake_handle<VkImageView>(0x30),
+  };
+  const std::array renderer_writes{ buffer_write(0, camera) };
+  const std::array material_writes{ image_write(8, shadow_map) };
+
+  DescriptorBindingTracker tracker;
+  EXPECT_EQ(tracker.track(renderer_writes),
+            DescriptorBindingTracker::binding_bit(0));
+  EXPECT_EQ(tracker.track(material_writes),
+            DescriptorBindingTracker::binding_bit(8));
+  EXPECT_EQ(tracker.track(renderer_writes), 0U);
+  EXPECT_EQ(tracker.track(material_writes), 0U);
+}
+
+TEST(DescriptorBindingTrackerTest, ArraysAreAlwaysWritten)
+{
+  const std::array<VkDescriptorImageInfo, 2> cascades{};
+  VkWriteDescriptorSet write = image_write(5, cascades[0]);
+  write.descriptorCount = static_cast<u32>(cascades.size());
+
+  DescriptorBindingTracker tracker;
+  const std::array writes{ write };
+  EXPECT_EQ(tracker.track(writes), DescriptorBindingTracker::binding_bit(5));
+  EXPECT_EQ(tracker.track(writes), DescriptorBindingTracker::binding_bit(5));
+}
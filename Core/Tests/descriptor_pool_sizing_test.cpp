@@ -0,0 +1,85 @@
+#include <graphics/DescriptorPoolSizing.hpp>
+
+#include <array>
+#include <gtest/gtest.h>
+
+using namespace Engine::Graphics;
+using Engine::Core::u32;
+
+namespace {
+auto
+binding(u32 index, VkDescriptorType type, u32 count = 1)
+  -> VkDescriptorSetLayoutBinding
+{
+  VkDescriptorSetLayoutBinding result{};
+  result.binding = index;
+  result.descriptorType = type;
+  result.descriptorCount = count;
+  return result;
+}
+
+auto
+count_of(const DescriptorPoolUsage& usage, VkDescriptorType type) -> u32
+{
+  for (const auto& size : usage.to_pool_sizes()) {
+    if (size.type == type) {
+      return size.descriptorCount;
+    }
+  }
+  return 0;
+}
+} // namespace
+
+TEST(DescriptorPoolSizingTest, CountsBindingsByType)
+{
+  const std::array bindings{
+    binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER),
+    binding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER),
+    binding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4),
+  };
+  const auto usage = DescriptorPoolUsage::from_bindings(bindings);
+
+  EXPECT_EQ(usage.sets, 1U);
+  EXPECT_EQ(count_of(usage, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER), 2U);
+  EXPECT_EQ(count_of(usage, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER), 4U);
+  // Only the types in use become pool sizes.
+  EXPECT_EQ(usage.to_pool_sizes().size(), 2U);
+}
+
+TEST(DescriptorPoolSizingTest, ChainedPoolsDoubleAndFitTheRequest)
+{
+  auto exhausted = DescriptorPoolUsage::uniform(0);
+  exhausted.sets = 8;
+  exhausted.descriptors[0] = 8;
+
+  const std::array bindings{
+    binding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 40),
+  };
+  const auto request = DescriptorPoolUsage::from_bindings(bindings);
+  const auto chained = size_chained_pool(exhausted, request);
+
+  EXPECT_EQ(chained.sets, 16U);
+  EXPECT_EQ(count_of(chained, DescriptorPoolUsage::types[0]), 16U);
+  EXPECT_EQ(count_of(chained, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER), 40U);
+}
+
+TEST(DescriptorPoolSizingTest, FramePoolsHoldThePeakWithHeadroom)
+{
+  auto peak = DescriptorPoolUsage::uniform(0);
+  peak.sets = 400;
+  peak.descriptors[1] = 1000;
+  const auto minimum = DescriptorPoolUsage::uniform(64);
+  const auto sized = size_frame_pool(peak, minimum);
+
+  EXPECT_EQ(sized.sets, 500U);
+  EXPECT_EQ(sized.descriptors[1], 1250U);
+  EXPECT_EQ(sized.descriptors[0], 64U);
+  EXPECT_EQ(size_frame_pool({}, minimum), minimum);
+
+  // Summing what a frame allocated gives the next peak.
+  DescriptorPoolUsage frame;
+  frame += peak;
+  frame += peak;
+  EXPECT_EQ(frame.sets, 800U);
+  EXPECT_EQ(DescriptorPoolUsage::max(frame, peak), frame);
+}
@@ -0,0 +1,247 @@
+#include <graphics/DrawListBuilder.hpp>
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+using namespace Engine::Graphics;
+using Engine::Core::u32;
+
+namespace {
+// Only the addresses matter to the builder, so stand-ins are enough.
+struct FakeResources
+{
+  std::array<char, 4> vertex_buffers{};
+  std::array<char, 8> materials{};
+
+  auto key(u32 vertex_buffer, u32 material, u32 submesh) const -> CommandKey
+  {
+    return CommandKey{
+      reinterpret_cast<const VertexBuffer*>(&vertex_buffers.at(vertex_buffer)),
+      nullptr,
+      reinterpret_cast<const Material*>(&materials.at(material)),
+      submesh,
+    };
+  }
+};
+
+auto
+translation(float x) -> glm::mat4
+{
+  glm::mat4 matrix{ 1.0F };
+  matrix[3][0] = x;
+  return matrix;
+}
+}
+
+TEST(DrawListBuilderTest, BatchesEqualKeysIntoContiguousRanges)
+{
+  FakeResources resources;
+  DrawListBuilder builder{ DrawListBuilder::ListType::Geometry };
+
+  std::mt19937 engine{ 1234 };
+  static constexpr u32 submission_count = 10000;
+  for (u32 i = 0; i < submission_count; i++) {
+    builder.submit(
+      resources.key(engine() % 4, engine() % 8, engine() % 3),
+      nullptr,
+      translation(static_cast<float>(i)),
+      i);
+  }
+
+  static constexpr u32 base_instance = 16;
+  std::vector<TransformVertexData> transforms(submission_count);
+  builder.build(transforms, base_instance);
+
+  const auto batches = builder.get_batches();
+  ASSERT_EQ(batches.size(), 4U * 8U * 3U);
+
+  auto expected_first = base_instance;
+  for (const auto& batch : batches) {
+    ASSERT_EQ(batch.first_instance, expected_first);
+    expected_first += batch.instance_count;
+  }
+  ASSERT_EQ(expected_first - base_instance, submission_count);
+
+  const auto user_data = builder.get_user_data();
+  for (const auto& batch : batches) {
+    const auto begin = batch.first_instance - base_instance;
+    for (u32 i = 0; i < batch.instance_count; i++) {
+      // The translation survives the 3x4 packing as the fourth column.
+      ASSERT_EQ(transforms[begin + i].transform_rows[0].w,
+                static_cast<float>(user_data[begin + i]));
+      // Within a batch, instances keep their submission order.
+      if (i > 0) {
+        ASSERT_LT(user_data[begin + i - 1], user_data[begin + i]);
+      }
+    }
+  }
+
+  builder.clear();
+  builder.build({});
+  ASSERT_TRUE(builder.empty());
+  ASSERT_EQ(builder.get_submission_count(), 0U);
+}
+
+TEST(DrawListBuilderTest, LayersAreContiguousAndOrdered)
+{
+  FakeResources resources;
+  DrawListBuilder builder{ DrawListBuilder::ListType::Shadow };
+
+  // Submitted from the last layer to the first, each with two keys.
+  static constexpr u32 layers = 10;
+  const std::array<TransformVertexData, 1> transform{};
+  for (u32 layer = layers; layer-- > 0;) {
+    for (u32 i = 0; i <= layer; i++) {
+      builder.submit(resources.key(0, i % 2, 0), nullptr, transform, 0, layer);
+    }
+  }
+
+  std::vector<TransformVertexData> transforms(builder.get_submission_count());
+  builder.build(transforms);
+
+  u32 expected_first = 0;
+  for (u32 layer = 0; layer < DrawListBuilder::layer_count; layer++) {
+    const auto batches = builder.get_batches(layer);
+    if (layer >= layers) {
+      ASSERT_TRUE(batches.empty());
+      continue;
+    }
+    ASSERT_EQ(batches.size(), layer == 0 ? 1U : 2U);
+    u32 instances = 0;
+    for (const auto& batch : batches) {
+      ASSERT_EQ(batch.first_instance, expected_first + instances);
+      instances += batch.instance_count;
+    }
+    ASSERT_EQ(instances, layer + 1);
+    expected_first += instances;
+  }
+}
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+TEST(DrawListBuilderBenchmark, SponzaInstances)
+{
+  // Shape of the glTF Sponza the editor scene loads: 103 submeshes sharing
+  // 25 materials and a single vertex buffer.
+  static constexpr u32 sponza_submesh_count = 103;
+  static constexpr u32 sponza_material_count = 25;
+  static constexpr u32 instance_count = 100000;
+  static constexpr u32 frame_count = 20;
+
+  std::array<char, sponza_material_count> materials{};
+  char vertex_buffer{};
+  std::vector<CommandKey> keys;
+  for (u32 i = 0; i < sponza_submesh_count; i++) {
+    keys.push_back(CommandKey{
+      reinterpret_cast<const VertexBuffer*>(&vertex_buffer),
+      nullptr,
+      reinterpret_cast<const Material*>(&materials.at(i % materials.size())),
+      i,
+    });
+  }
+  const auto transform = translation(1.0F);
+
+  using clock = std::chrono::high_resolution_clock;
+  const auto nanos = [](auto duration) {
+    return std::chrono::duration<double, std::nano>(duration).count();
+  };
+
+  DrawListBuilder builder{ DrawListBuilder::ListType::Geometry };
+  std::vector<TransformVertexData> transforms(instance_count);
+  double submit_ns = 0.0;
+  double flush_ns = 0.0;
+  for (u32 frame = 0; frame < frame_count; frame++) {
+    const auto submit_start = clock::now();
+    for (u32 i = 0; i < instance_count; i++) {
+      builder.submit(keys[i % keys.size()], nullptr, transform);
+    }
+    const auto flush_start = clock::now();
+    builder.build(transforms);
+    ASSERT_EQ(builder.get_batches().size(), sponza_submesh_count);
+    builder.clear();
+    const auto flush_end = clock::now();
+
+    submit_ns += nanos(flush_start - submit_start);
+    flush_ns += nanos(flush_end - flush_start);
+  }
+
+  // The path this replaced: three hash map updates per submit (draw, shadow
+  // and transforms), then a walk of the transform map at flush.
+  struct MapCommand
+  {
+    u32 submesh_index{ 0 };
+    u32 instance_count{ 0 };
+  };
+  struct MapTransforms
+  {
+    std::vector<TransformVertexData> transforms;
+    u32 offset{ 0 };
+  };
+  std::unordered_map<CommandKey, MapCommand> draw_commands;
+  std::unordered_map<CommandKey, MapCommand> shadow_draw_commands;
+  std::unordered_map<CommandKey, MapTransforms> mesh_transform_map;
+  std::vector<TransformVertexData> flattened(instance_count);
+  double map_submit_ns = 0.0;
+  double map_flush_ns = 0.0;
+  for (u32 frame = 0; frame < frame_count; frame++) {
+    const auto submit_start = clock::now();
+    for (u32 i = 0; i < instance_count; i++) {
+      const auto& key = keys[i % keys.size()];
+      auto& packed = mesh_transform_map[key].transforms.emplace_back();
+      for (u32 row = 0; row < 3; row++) {
+        packed.transform_rows[row] = {
+          transform[0][row],
+          transform[1][row],
+          transform[2][row],
+          transform[3][row],
+        };
+      }
+      auto& command = draw_commands[key];
+      command.submesh_index = key.submesh_index;
+      command.instance_count++;
+      auto& shadow_command = shadow_draw_commands[key];
+      shadow_command.submesh_index = key.submesh_index;
+      shadow_command.instance_count++;
+    }
+    const auto flush_start = clock::now();
+    u32 offset = 0;
+    for (auto& [key, transform_data] : mesh_transform_map) {
+      transform_data.offset = offset;
+      for (const auto& packed : transform_data.transforms) {
+        flattened[offset++] = packed;
+      }
+    }
+    draw_commands.clear();
+    shadow_draw_commands.clear();
+    mesh_transform_map.clear();
+    const auto flush_end = clock::now();
+
+    map_submit_ns += nanos(flush_start - submit_start);
+    map_flush_ns += nanos(flush_end - flush_start);
+  }
+
+  std::stringstream csv_output;
+  csv_output << "Path,Submit(ns/submit),Flush(ns/flush)\n";
+  csv_output << "DrawListBuilder,"
+             << submit_ns / (frame_count * double{ instance_count }) << ","
+             << flush_ns / frame_count << "\n";
+  csv_output << "UnorderedMap,"
+             << map_submit_ns / (frame_count * double{ instance_count }) << ","
+             << map_flush_ns / frame_count << "\n";
+  std::cout << csv_output.str();
+
+  std::ofstream csv_file("draw_list_benchmark_results.csv");
+  if (csv_file.is_open()) {
+    csv_file << csv_output.str();
+    csv_file.close();
+  } else {
+    std::cerr << "Failed to open file for writing CSV results." << std::endl;
+  }
+}
+#endif
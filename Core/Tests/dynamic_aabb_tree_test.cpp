@@ -0,0 +1,303 @@
+#include <core/DynamicAABBTree.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace Engine::Core;
+
+namespace {
+auto
+random_boxes(u32 count, f32 extent, u32 seed) -> std::vector<AABB>
+{
+  std::mt19937 engine{ seed };
+  std::uniform_real_distribution<f32> position{ -extent, extent };
+  std::uniform_real_distribution<f32> size{ 0.1F, 2.0F };
+  std::vector<AABB> boxes(count);
+  for (auto& box : boxes) {
+    const glm::vec3 centre{ position(engine),
+                            position(engine),
+                            position(engine) };
+    const glm::vec3 half{ size(engine), size(engine), size(engine) };
+    box = { centre - half, centre + half };
+  }
+  return boxes;
+}
+
+auto
+overlaps(const AABB& first, const AABB& second) -> bool
+{
+  return first.min.x <= second.max.x && first.max.x >= second.min.x &&
+         first.min.y <= second.max.y && first.max.y >= second.min.y &&
+         first.min.z <= second.max.z && first.max.z >= second.min.z;
+}
+
+auto
+build_tree(DynamicAABBTree& tree, const std::vector<AABB>& boxes)
+  -> std::vector<i32>
+{
+  std::vector<i32> proxies(boxes.size());
+  for (u32 i = 0; i < boxes.size(); i++) {
+    proxies[i] = tree.create_proxy(boxes[i], i);
+  }
+  return proxies;
+}
+
+// The tree reports candidates by fat bounds, so re-test exact bounds the way
+// callers do and compare against a linear scan.
+template<class Query, class Exact>
+auto
+expect_matches_linear(const std::vector<AABB>& boxes,
+                      const std::vector<bool>& alive,
+                      Query&& query,
+                      Exact&& exact) -> void
+{
+  std::vector<u32> found;
+  query([&](u32 index) {
+    if (exact(boxes[index])) {
+      found.push_back(index);
+    }
+  });
+  std::ranges::sort(found);
+
+  std::vector<u32> expected;
+  for (u32 i = 0; i < boxes.size(); i++) {
+    if (alive[i] && exact(boxes[i])) {
+      expected.push_back(i);
+    }
+  }
+  EXPECT_EQ(found, expected);
+}
+}
+
+TEST(DynamicAABBTreeTest, BoxQueryMatchesLinearScan)
+{
+  const auto boxes = random_boxes(2000, 50.0F, 1);
+  DynamicAABBTree tree;
+  build_tree(tree, boxes);
+  const std::vector<bool> alive(boxes.size(), true);
+
+  EXPECT_EQ(tree.get_proxy_count(), 2000U);
+  // Balanced, so far from the 2000 a degenerate insertion order could give.
+  EXPECT_LT(tree.get_height(), 32);
+
+  for (const auto& region : random_boxes(20, 50.0F, 2)) {
+    const AABB query_box{ region.min - glm::vec3{ 5.0F },
+                          region.max + glm::vec3{ 5.0F } };
+    expect_matches_linear(
+      boxes,
+      alive,
+      [&](auto callback) { tree.query(query_box, callback); },
+      [&](const AABB& box) { return overlaps(box, query_box); });
+  }
+}
+
+TEST(DynamicAABBTreeTest, SphereAndRayQueriesMatchLinearScan)
+{
+  const auto boxes = random_boxes(1000, 30.0F, 3);
+  DynamicAABBTree tree;
+  build_tree(tree, boxes);
+  const std::vector<bool> alive(boxes.size(), true);
+
+  const glm::vec3 centre{ 3.0F, -2.0F, 5.0F };
+  const auto radius = 8.0F;
+  expect_matches_linear(
+    boxes,
+    alive,
+    [&](auto callback) { tree.query_sphere(centre, radius, callback); },
+    [&](const AABB& box) {
+      const auto offset = glm::clamp(centre, box.min, box.max) - centre;
+      return glm::dot(offset, offset) <= radius * radius;
+    });
+
+  const glm::vec3 origin{ -40.0F, 1.0F, 0.5F };
+  const auto direction = glm::normalize(glm::vec3{ 1.0F, 0.05F, 0.02F });
+  const auto hits_ray = [&](const AABB& box) {
+    const auto t0 = (box.min - origin) / direction;
+    const auto t1 = (box.max - origin) / direction;
+    const auto enter = glm::min(t0, t1);
+    const auto exit = glm::max(t0, t1);
+    const auto t_enter = std::max(std::max(enter.x, enter.y), enter.z);
+    const auto t_exit = std::min(std::min(exit.x, exit.y), exit.z);
+    return t_exit >= std::max(t_enter, 0.0F);
+  };
+  expect_matches_linear(
+    boxes,
+    alive,
+    [&](auto callback) { tree.ray_cast(origin, direction, callback); },
+    hits_ray);
+}
+
+TEST(DynamicAABBTreeTest, FrustumQueryMatchesLinearScan)
+{
+  const auto boxes = random_boxes(1000, 30.0F, 4);
+  DynamicAABBTree tree;
+  build_tree(tree, boxes);
+  const std::vector<bool> alive(boxes.size(), true);
+
+  const Frustum frustum{ glm::ortho(-10.0F, 10.0F, -5.0F, 5.0F, 0.0F, 20.0F) };
+  expect_matches_linear(
+    boxes,
+    alive,
+    [&](auto callback) { tree.query(frustum, callback); },
+    [&](const AABB& box) { return frustum.intersects(box); });
+}
+
+TEST(DynamicAABBTreeTest, MovesAndRemovalsKeepQueriesExact)
+{
+  auto boxes = random_boxes(1000, 40.0F, 5);
+  DynamicAABBTree tree{ { .margin = 0.5F } };
+  auto proxies = build_tree(tree, boxes);
+  std::vector<bool> alive(boxes.size(), true);
+
+  std::mt19937 engine{ 6 };
+  std::uniform_real_distribution<f32> jitter{ -0.2F, 0.2F };
+  std::uniform_real_distribution<f32> jump{ -40.0F, 40.0F };
+  u32 reinserted = 0;
+  for (u32 i = 0; i < boxes.size(); i++) {
+    // Small moves should mostly stay inside the fat bounds.
+    const auto offset = i % 10 == 0
+                          ? glm::vec3{ jump(engine), jump(engine), 0.0F }
+                          : glm::vec3{ jitter(engine), 0.0F, 0.0F };
+    boxes[i] = { boxes[i].min + offset, boxes[i].max + offset };
+    reinserted += tree.move_proxy(proxies[i], boxes[i]) ? 1U : 0U;
+  }
+  EXPECT_LT(reinserted, boxes.size() / 2);
+
+  for (u32 i = 0; i < boxes.size(); i += 3) {
+    tree.destroy_proxy(proxies[i]);
+    alive[i] = false;
+  }
+  EXPECT_EQ(tree.get_proxy_count(), 666U);
+
+  for (const auto& region : random_boxes(20, 40.0F, 7)) {
+    const AABB query_box{ region.min - glm::vec3{ 6.0F },
+                          region.max + glm::vec3{ 6.0F } };
+    expect_matches_linear(
+      boxes,
+      alive,
+      [&](auto callback) { tree.query(query_box, callback); },
+      [&](const AABB& box) { return overlaps(box, query_box); });
+  }
+
+  // Freed nodes are reused before the node array grows again.
+  for (u32 i = 0; i < boxes.size(); i += 3) {
+    proxies[i] = tree.create_proxy(boxes[i], i);
+    alive[i] = true;
+  }
+  EXPECT_EQ(tree.get_proxy_count(), 1000U);
+  expect_matches_linear(
+    boxes,
+    alive,
+    [&](auto callback) {
+      tree.query(AABB{ glm::vec3{ -100.0F }, glm::vec3{ 100.0F } }, callback);
+    },
+    [](const AABB&) { return true; });
+}
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+TEST(DynamicAABBTreeBenchmark, QueriesAgainstLinearScan)
+{
+  static constexpr std::array<u32, 3> entity_counts{ 10000, 100000, 1000000 };
+  static constexpr u32 query_count = 100;
+
+  using clock = std::chrono::high_resolution_clock;
+  const auto millis = [](auto duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  };
+
+  std::stringstream csv_output;
+  csv_output << "Entities,Build(ms),Move(ms),Reinserted,Height,"
+                "TreeQuery(us/query),LinearQuery(us/query),"
+                "TreeRay(us/query),LinearRay(us/query)\n";
+  for (const auto entity_count : entity_counts) {
+    // Constant density, so each query returns a similar number of hits.
+    const auto extent = 10.0F * std::cbrt(static_cast<f32>(entity_count));
+    auto boxes = random_boxes(entity_count, extent, entity_count);
+    const auto regions = random_boxes(query_count, extent, 11);
+
+    DynamicAABBTree tree{ { .margin = 0.5F } };
+    const auto build_start = clock::now();
+    const auto proxies = build_tree(tree, boxes);
+    const auto build_ms = millis(clock::now() - build_start);
+
+    // Every entity moves a little, as in a frame of animation.
+    std::mt19937 engine{ 12 };
+    std::uniform_real_distribution<f32> jitter{ -0.5F, 0.5F };
+    u32 reinserted = 0;
+    const auto move_start = clock::now();
+    for (u32 i = 0; i < entity_count; i++) {
+      const glm::vec3 offset{ jitter(engine), jitter(engine), jitter(engine) };
+      boxes[i] = { boxes[i].min + offset, boxes[i].max + offset };
+      reinserted += tree.move_proxy(proxies[i], boxes[i]) ? 1U : 0U;
+    }
+    const auto move_ms = millis(clock::now() - move_start);
+
+    u64 tree_hits = 0;
+    const auto tree_start = clock::now();
+    for (const auto& region : regions) {
+      tree.query(region, [&](u32) { tree_hits++; });
+    }
+    const auto tree_ms = millis(clock::now() - tree_start);
+
+    u64 linear_hits = 0;
+    const auto linear_start = clock::now();
+    for (const auto& region : regions) {
+      for (const auto& box : boxes) {
+        linear_hits += overlaps(box, region) ? 1U : 0U;
+      }
+    }
+    const auto linear_ms = millis(clock::now() - linear_start);
+    EXPECT_GE(tree_hits, linear_hits);
+
+    const glm::vec3 direction = glm::normalize(glm::vec3{ 1.0F, 0.1F, 0.2F });
+    u64 ray_hits = 0;
+    const auto tree_ray_start = clock::now();
+    for (const auto& region : regions) {
+      tree.ray_cast(region.min, direction, [&](u32) { ray_hits++; });
+    }
+    const auto tree_ray_ms = millis(clock::now() - tree_ray_start);
+
+    const auto linear_ray_start = clock::now();
+    for (const auto& region : regions) {
+      const auto inverse_direction = 1.0F / direction;
+      for (const auto& box : boxes) {
+        const auto t0 = (box.min - region.min) * inverse_direction;
+        const auto t1 = (box.max - region.min) * inverse_direction;
+        const auto enter = glm::min(t0, t1);
+        const auto exit = glm::max(t0, t1);
+        const auto t_enter = std::max(std::max(enter.x, enter.y), enter.z);
+        const auto t_exit = std::min(std::min(exit.x, exit.y), exit.z);
+        ray_hits += t_exit >= std::max(t_enter, 0.0F) ? 1U : 0U;
+      }
+    }
+    const auto linear_ray_ms = millis(clock::now() - linear_ray_start);
+
+    const auto per_query_us = 1000.0 / query_count;
+    csv_output << entity_count << "," << build_ms << "," << move_ms << ","
+               << reinserted << "," << tree.get_height() << ","
+               << tree_ms * per_query_us << "," << linear_ms * per_query_us
+               << "," << tree_ray_ms * per_query_us << ","
+               << linear_ray_ms * per_query_us << "\n";
+    EXPECT_GT(ray_hits, 0U);
+  }
+  std::cout << csv_output.str();
+
+  std::ofstream csv_file("dynamic_aabb_tree_benchmark_results.csv");
+  if (csv_file.is_open()) {
+    csv_file << csv_output.str();
+    csv_file.close();
+  } else {
+    std::cerr << "Failed to open file for writing CSV results." << std::endl;
+  }
+}
+#endif
@@ -0,0 +1,59 @@
+#include <graphics/FrameRangeTracker.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace Engine::Graphics;
+using Range = FrameRangeTracker::Range;
+
+TEST(FrameRangeTrackerTest, ChangesReachEveryFrameOnce)
+{
+  FrameRangeTracker tracker{ 3 };
+
+  const auto written = tracker.update(0, { 16, 8 });
+  EXPECT_EQ(written.offset, 16U);
+  EXPECT_EQ(written.size, 8U);
+  EXPECT_TRUE(tracker.get_stale(0).empty());
+
+  // The other frames catch up when they come around, and only then.
+  const auto missed = tracker.refresh(1);
+  EXPECT_EQ(missed.offset, 16U);
+  EXPECT_EQ(missed.size, 8U);
+  EXPECT_TRUE(tracker.refresh(1).empty());
+  EXPECT_FALSE(tracker.get_stale(2).empty());
+}
+
+TEST(FrameRangeTrackerTest, WritesWhatTheFrameMissedWithItsOwnChange)
+{
+  FrameRangeTracker tracker{ 2 };
+
+  tracker.update(0, { 0, 4 });
+  const auto written = tracker.update(1, { 64, 16 });
+  EXPECT_EQ(written.offset, 0U);
+  EXPECT_EQ(written.size, 80U);
+
+  // Frame 0 wrote its own change already and only misses frame 1's.
+  const auto missed = tracker.refresh(0);
+  EXPECT_EQ(missed.offset, 64U);
+  EXPECT_EQ(missed.size, 16U);
+}
+
+TEST(FrameRangeTrackerTest, ResetLeavesNothingStale)
+{
+  FrameRangeTracker tracker{ 3 };
+  tracker.update(2, { 8, 8 });
+  tracker.reset();
+  for (auto frame = 0U; frame < 3; frame++) {
+    EXPECT_TRUE(tracker.refresh(frame).empty());
+  }
+}
+
+TEST(FrameRangeTrackerTest, MergesToTheCoveringRange)
+{
+  const Range a{ 32, 8 };
+  const Range b{ 4, 4 };
+  const auto merged = a.merged(b);
+  EXPECT_EQ(merged.offset, 4U);
+  EXPECT_EQ(merged.size, 36U);
+  EXPECT_EQ(a.merged({}).size, 8U);
+  EXPECT_EQ(Range{}.merged(b).offset, 4U);
+}
@@ -0,0 +1,32 @@
+#include <core/Frustum.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+
+using Engine::Core::AABB;
+using Engine::Core::Frustum;
+
+TEST(FrustumTest, OrthographicBoxCullsOutsideAABBs)
+{
+  // A 2x2x10 box looking down -Z from the origin.
+  const Frustum frustum{ glm::ortho(-1.0F, 1.0F, -1.0F, 1.0F, 0.0F, 10.0F) };
+
+  ASSERT_TRUE(frustum.intersects(AABB{ { -0.5F, -0.5F, -5.5F },
+                                       { 0.5F, 0.5F, -4.5F } }));
+  // Between the near plane and the midpoint, which a [-1, 1] depth range
+  // would put in front of the near plane.
+  ASSERT_TRUE(frustum.intersects(AABB{ { -0.5F, -0.5F, -2.0F },
+                                       { 0.5F, 0.5F, -1.0F } }));
+  // Straddling the right plane.
+  ASSERT_TRUE(frustum.intersects(AABB{ { 0.5F, -0.5F, -5.5F },
+                                       { 1.5F, 0.5F, -4.5F } }));
+  // Entirely to the right, above, behind and beyond the far plane.
+  ASSERT_FALSE(frustum.intersects(AABB{ { 1.5F, -0.5F, -5.5F },
+                                        { 2.5F, 0.5F, -4.5F } }));
+  ASSERT_FALSE(frustum.intersects(AABB{ { -0.5F, 1.5F, -5.5F },
+                                        { 0.5F, 2.5F, -4.5F } }));
+  ASSERT_FALSE(frustum.intersects(AABB{ { -0.5F, -0.5F, 0.5F },
+                                        { 0.5F, 0.5F, 1.5F } }));
+  ASSERT_FALSE(frustum.intersects(AABB{ { -0.5F, -0.5F, -11.5F },
+                                        { 0.5F, 0.5F, -10.5F } }));
+}
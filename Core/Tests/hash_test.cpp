@@ -0,0 +1,166 @@
+#include <core/DataBuffer.hpp>
+#include <core/Hash.hpp>
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+#include <algorithm>
+#include <execution>
+#endif
+
+using namespace Engine::Core;
+
+namespace {
+auto
+counting_bytes(usize count) -> std::vector<u8>
+{
+  std::vector<u8> bytes(count);
+  std::iota(bytes.begin(), bytes.end(), u8{ 0 });
+  return bytes;
+}
+} // namespace
+
+TEST(HashTest, MatchesReferenceValues)
+{
+  EXPECT_EQ(hash_bytes(std::string_view{}), 0xEF46DB3751D8E999ULL);
+  EXPECT_EQ(hash_bytes(std::string_view{ "abc" }), 0x44BC2CF5AD770999ULL);
+
+  // Long enough for the striped loop and every tail step.
+  const auto bytes = counting_bytes(100);
+  EXPECT_EQ(hash_bytes(std::span<const u8>{ bytes }), 0x6AC1E58032166597ULL);
+  EXPECT_EQ(hash_bytes(std::span<const u8>{ bytes }, 0x9E3779B97F4A7C15ULL),
+            0x3B97D91EBA03E785ULL);
+}
+
+TEST(HashTest, DependsOnContentOnly)
+{
+  const std::vector<u32> first{ 0x07230203, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  const std::vector<u32> second{ first };
+  ASSERT_NE(first.data(), second.data());
+  EXPECT_EQ(hash_bytes(std::span{ first }), hash_bytes(std::span{ second }));
+
+  // Every length up to a few stripes, and every single bit flip.
+  const auto bytes = counting_bytes(129);
+  for (usize size = 0; size < bytes.size(); size++) {
+    const std::span<const u8> all{ bytes };
+    EXPECT_NE(hash_bytes(all.first(size)), hash_bytes(all.first(size + 1)))
+      << size;
+  }
+  const auto original = hash_bytes(std::span<const u8>{ bytes });
+  for (usize bit = 0; bit < bytes.size() * 8; bit++) {
+    auto changed = bytes;
+    changed[bit / 8] ^= static_cast<u8>(1U << (bit % 8));
+    EXPECT_NE(hash_bytes(std::span<const u8>{ changed }), original) << bit;
+  }
+}
+
+TEST(HashTest, ValuesHashInOrder)
+{
+  int first = 0;
+  int second = 0;
+  EXPECT_EQ(hash_values(&first, 1U), hash_values(&first, 1U));
+  EXPECT_NE(hash_values(&first, 1U), hash_values(&second, 1U));
+  EXPECT_NE(hash_values(1U, 2U), hash_values(2U, 1U));
+  EXPECT_NE(hash_values(1U), hash_values(1U, 0U));
+  EXPECT_NE(hash_values(0.0F), hash_values(-0.0F));
+}
+
+TEST(HashTest, DataBuffersWithEqualBytesHashEqual)
+{
+  const std::array<u8, 5> bytes{ 1, 2, 3, 4, 5 };
+  const DataBuffer first{ bytes.data(), bytes.size() };
+  const auto second = DataBuffer::copy(first);
+  EXPECT_EQ(first.hash(), second.hash());
+
+  const DataBuffer shorter{ bytes.data(), bytes.size() - 1 };
+  EXPECT_NE(first.hash(), shorter.hash());
+}
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+namespace {
+// The SPIR-V hash Shader used before: a parallel for_each over 16-word
+// chunks, then a serial fold of the chunk hashes.
+auto
+legacy_hash(const std::vector<u32>& words) -> usize
+{
+  static constexpr usize chunk_size = 16;
+  std::vector<usize> chunk_hashes((words.size() + chunk_size - 1) / chunk_size,
+                                  0);
+  std::for_each(std::execution::par,
+                chunk_hashes.begin(),
+                chunk_hashes.end(),
+                [&](usize& chunk_hash) {
+                  const auto start = (&chunk_hash - chunk_hashes.data()) *
+                                     static_cast<std::ptrdiff_t>(chunk_size);
+                  const auto end =
+                    std::min(static_cast<usize>(start) + chunk_size,
+                             words.size());
+                  for (auto i = static_cast<usize>(start); i < end; ++i) {
+                    chunk_hash ^= std::hash<u32>{}(words[i]) + 0x9e3779b9 +
+                                  (chunk_hash << 6) + (chunk_hash >> 2);
+                  }
+                });
+  return std::accumulate(
+    chunk_hashes.begin(), chunk_hashes.end(), usize{ 0 }, [](auto acc, auto h) {
+      return acc ^ (h + 0x9e3779b9 + (acc << 6) + (acc >> 2));
+    });
+}
+} // namespace
+
+TEST(HashBenchmark, SpirvAgainstParallelChunks)
+{
+  // Typical SPIR-V sizes, from a small post-process stage to a large uber
+  // shader.
+  static constexpr std::array<usize, 4> word_counts{ 512, 2048, 8192, 65536 };
+  static constexpr u32 iterations = 200;
+
+  using clock = std::chrono::high_resolution_clock;
+  const auto micros = [](auto duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+  };
+
+  std::stringstream csv_output;
+  csv_output << "Words,Legacy(us),Hash(us),Speedup\n";
+  for (const auto word_count : word_counts) {
+    std::mt19937 engine{ static_cast<u32>(word_count) };
+    std::vector<u32> words(word_count);
+    std::ranges::generate(words, engine);
+
+    // Sinks keep either loop from being optimised away.
+    usize legacy_sink = 0;
+    const auto legacy_start = clock::now();
+    for (u32 i = 0; i < iterations; i++) {
+      legacy_sink += legacy_hash(words);
+    }
+    const auto legacy_us = micros(clock::now() - legacy_start) / iterations;
+
+    u64 hash_sink = 0;
+    const auto hash_start = clock::now();
+    for (u32 i = 0; i < iterations; i++) {
+      hash_sink += hash_bytes(std::span<const u32>{ words });
+    }
+    const auto hash_us = micros(clock::now() - hash_start) / iterations;
+    EXPECT_NE(legacy_sink + hash_sink, 0U);
+
+    csv_output << word_count << "," << legacy_us << "," << hash_us << ","
+               << legacy_us / hash_us << "\n";
+  }
+  std::cout << csv_output.str();
+
+  std::ofstream csv_file("hash_benchmark_results.csv");
+  if (csv_file.is_open()) {
+    csv_file << csv_output.str();
+    csv_file.close();
+  } else {
+    std::cerr << "Failed to open file for writing CSV results." << std::endl;
+  }
+}
+#endif
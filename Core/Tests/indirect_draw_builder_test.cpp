@@ -0,0 +1,129 @@
+#include <graphics/IndirectDrawBuilder.hpp>
+
+#include <array>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace Engine::Graphics;
+using Engine::Core::u32;
+
+namespace {
+// Only the addresses matter to the builder, so stand-ins are enough.
+struct FakeResources
+{
+  std::array<char, 4> vertex_buffers{};
+  std::array<char, 4> materials{};
+
+  auto key(u32 vertex_buffer, u32 material, u32 submesh) const -> CommandKey
+  {
+    return CommandKey{
+      reinterpret_cast<const VertexBuffer*>(&vertex_buffers.at(vertex_buffer)),
+      nullptr,
+      reinterpret_cast<const Material*>(&materials.at(material)),
+      submesh,
+    };
+  }
+};
+
+auto
+command(u32 index_count, u32 first_index) -> VkDrawIndexedIndirectCommand
+{
+  VkDrawIndexedIndirectCommand result{};
+  result.indexCount = index_count;
+  result.instanceCount = 1;
+  result.firstIndex = first_index;
+  return result;
+}
+
+auto
+instances(u32 count) -> std::vector<TransformVertexData>
+{
+  return std::vector<TransformVertexData>(count);
+}
+} // namespace
+
+TEST(IndirectDrawBuilderTest, GroupsCommandsSharingBindings)
+{
+  FakeResources resources;
+  IndirectDrawBuilder builder;
+  const Engine::Core::AABB bounds{ glm::vec3{ -1.0F }, glm::vec3{ 1.0F } };
+
+  // Mesh 0 with two submeshes of material 0, mesh 1 in between.
+  builder.submit(
+    resources.key(0, 0, 0), nullptr, bounds, command(6, 0), instances(3));
+  builder.submit(
+    resources.key(1, 1, 0), nullptr, bounds, command(9, 0), instances(2));
+  builder.submit(
+    resources.key(0, 0, 1), nullptr, bounds, command(12, 6), instances(4));
+  builder.build();
+
+  ASSERT_EQ(builder.get_draw_count(), 3U);
+  ASSERT_EQ(builder.get_instance_count(), 9U);
+  ASSERT_EQ(builder.get_group_count(), 2U);
+
+  const auto draws = builder.get_draws();
+  // Both submeshes of mesh 0 share a group and its commands are adjacent.
+  EXPECT_EQ(draws[0].group, draws[2].group);
+  EXPECT_NE(draws[0].group, draws[1].group);
+  const auto& group = builder.get_groups()[draws[0].group];
+  EXPECT_EQ(group.command_count, 2U);
+  EXPECT_EQ(draws[0].group_first_command, group.first_command);
+  EXPECT_EQ(draws[2].group_first_command, group.first_command);
+  EXPECT_EQ(std::max(draws[0].command, draws[2].command),
+            group.first_command + 1);
+
+  // Instances keep their submission order and know their draw.
+  const auto instance_data = builder.get_instances();
+  EXPECT_EQ(instance_data[0].draw, 0U);
+  EXPECT_EQ(instance_data[3].draw, 1U);
+  EXPECT_EQ(instance_data[5].draw, 2U);
+  EXPECT_EQ(draws[2].instance_offset, 5U);
+}
+
+TEST(IndirectDrawBuilderTest, CommandsStartEmptyAtTheirOutputRange)
+{
+  FakeResources resources;
+  IndirectDrawBuilder builder;
+  const Engine::Core::AABB bounds{ glm::vec3{ -1.0F }, glm::vec3{ 1.0F } };
+
+  builder.submit(
+    resources.key(0, 0, 0), nullptr, bounds, command(6, 0), instances(3));
+  builder.submit(
+    resources.key(1, 0, 0), nullptr, bounds, command(9, 3), instances(2));
+  builder.build();
+
+  const auto draw_count = builder.get_draw_count();
+  std::vector<VkDrawIndexedIndirectCommand> commands(
+    IndirectDrawBuilder::view_count * draw_count);
+  builder.write_commands(commands);
+
+  for (u32 view = 0; view < IndirectDrawBuilder::view_count; view++) {
+    for (u32 draw = 0; draw < draw_count; draw++) {
+      const auto& data = builder.get_draws()[draw];
+      const auto& written = commands[view * draw_count + data.command];
+      EXPECT_EQ(written.instanceCount, 0U);
+      EXPECT_EQ(written.firstInstance,
+                view * builder.get_instance_count() + data.instance_offset);
+    }
+  }
+  const auto& first = commands[builder.get_draws()[1].command];
+  EXPECT_EQ(first.indexCount, 9U);
+  EXPECT_EQ(first.firstIndex, 3U);
+}
+
+TEST(IndirectDrawBuilderTest, CountsVisibleInstancesPerView)
+{
+  static constexpr u32 draw_count = 2;
+  std::vector<VkDrawIndexedIndirectCommand> commands(
+    IndirectDrawBuilder::view_count * draw_count);
+  commands[0].instanceCount = 3;
+  commands[1].instanceCount = 1;
+  commands[draw_count * 4 + 1].instanceCount = 7;
+
+  const auto visible =
+    IndirectDrawBuilder::count_visible(commands, draw_count);
+  EXPECT_EQ(visible[0], 4U);
+  EXPECT_EQ(visible[4], 7U);
+  EXPECT_EQ(visible[1], 0U);
+  EXPECT_EQ(IndirectDrawBuilder::count_visible({}, 0)[0], 0U);
+}
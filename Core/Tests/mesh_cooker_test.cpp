@@ -0,0 +1,311 @@
+#include <graphics/MeshCooker.hpp>
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+#include <graphics/MeshImporter.hpp>
+#endif
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace Engine::Graphics;
+using Engine::Core::u32;
+using Engine::Core::u64;
+
+namespace {
+struct TestMesh
+{
+  std::vector<Vertex> vertices;
+  std::vector<Index> indices;
+  MeshData data;
+};
+
+auto
+make_test_mesh() -> TestMesh
+{
+  TestMesh mesh;
+  for (u32 i = 0; i < 8; i++) {
+    auto& vertex = mesh.vertices.emplace_back();
+    const auto value = static_cast<float>(i);
+    vertex.position = { value, value * 2.0F, value * 3.0F };
+    vertex.uvs = { value * 0.1F, value * 0.2F };
+    vertex.normals = { 0.0F, 1.0F, 0.0F };
+    vertex.tangent = { 1.0F, 0.0F, 0.0F };
+    vertex.bitangent = { 0.0F, 0.0F, 1.0F };
+  }
+  mesh.indices = { { 0, 1, 2 }, { 2, 3, 0 }, { 0, 1, 2 }, { 1, 2, 3 } };
+
+  auto& first = mesh.data.submeshes.emplace_back();
+  first.base_vertex = 0;
+  first.base_index = 0;
+  first.material_index = 0;
+  first.index_count = 6;
+  first.vertex_count = 4;
+  first.transform[3][1] = 5.0F;
+  first.bounding_box = { glm::vec3{ 0.0F }, glm::vec3{ 3.0F, 6.0F, 9.0F } };
+  first.node_name = "Root";
+  first.mesh_name = "First";
+
+  auto& second = mesh.data.submeshes.emplace_back();
+  second.base_vertex = 4;
+  second.base_index = 6;
+  second.material_index = 1;
+  second.index_count = 6;
+  second.vertex_count = 4;
+  second.local_transform[0][0] = 2.0F;
+  second.node_name = "Child";
+  second.mesh_name = "Second";
+
+  auto& material = mesh.data.materials.emplace_back();
+  material.shininess = 12.0F;
+  material.reflectivity = 0.5F;
+  material.texture_paths.at(0) = "textures/albedo.png";
+  material.texture_paths.at(3) = "textures/roughness_metallic.png";
+  mesh.data.materials.emplace_back();
+
+  mesh.data.vertices = mesh.vertices;
+  mesh.data.indices = mesh.indices;
+  mesh.data.bounding_box = { glm::vec3{ -1.0F }, glm::vec3{ 7.0F } };
+  return mesh;
+}
+
+auto
+temporary_path(const char* name) -> std::filesystem::path
+{
+  return std::filesystem::temp_directory_path() / name;
+}
+}
+
+TEST(MeshCookerTest, RoundTripsEverySection)
+{
+  const auto mesh = make_test_mesh();
+  const auto path = temporary_path("mesh_cooker_round_trip.astmesh");
+  ASSERT_TRUE(MeshCooker::write(path, 42, mesh.data));
+
+  const auto cooked = MeshCooker::load(path, 42);
+  ASSERT_NE(cooked, nullptr);
+  const auto& data = cooked->get_data();
+
+  ASSERT_EQ(data.vertices.size(), mesh.vertices.size());
+  EXPECT_EQ(std::memcmp(data.vertices.data(),
+                        mesh.vertices.data(),
+                        data.vertices.size_bytes()),
+            0);
+  ASSERT_EQ(data.indices.size(), mesh.indices.size());
+  EXPECT_EQ(std::memcmp(data.indices.data(),
+                        mesh.indices.data(),
+                        data.indices.size_bytes()),
+            0);
+
+  ASSERT_EQ(data.submeshes.size(), 2U);
+  for (u32 i = 0; i < data.submeshes.size(); i++) {
+    const auto& expected = mesh.data.submeshes[i];
+    const auto& actual = data.submeshes[i];
+    EXPECT_EQ(actual.base_vertex, expected.base_vertex);
+    EXPECT_EQ(actual.base_index, expected.base_index);
+    EXPECT_EQ(actual.material_index, expected.material_index);
+    EXPECT_EQ(actual.index_count, expected.index_count);
+    EXPECT_EQ(actual.vertex_count, expected.vertex_count);
+    EXPECT_EQ(actual.node_name, expected.node_name);
+    EXPECT_EQ(actual.mesh_name, expected.mesh_name);
+    EXPECT_EQ(std::memcmp(&actual.transform,
+                          &expected.transform,
+                          sizeof(expected.transform)),
+              0);
+    EXPECT_EQ(std::memcmp(&actual.local_transform,
+                          &expected.local_transform,
+                          sizeof(expected.local_transform)),
+              0);
+    EXPECT_EQ(std::memcmp(&actual.bounding_box,
+                          &expected.bounding_box,
+                          sizeof(expected.bounding_box)),
+              0);
+  }
+
+  ASSERT_EQ(data.materials.size(), 2U);
+  EXPECT_EQ(data.materials[0].shininess, 12.0F);
+  EXPECT_EQ(data.materials[0].reflectivity, 0.5F);
+  for (u32 i = 0; i < data.materials.size(); i++) {
+    EXPECT_EQ(data.materials[i].texture_paths,
+              mesh.data.materials[i].texture_paths);
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST(MeshCookerTest, RejectsStaleAndDamagedFiles)
+{
+  const auto mesh = make_test_mesh();
+  const auto path = temporary_path("mesh_cooker_stale.astmesh");
+  ASSERT_TRUE(MeshCooker::write(path, 1, mesh.data));
+
+  // Cooked from other source contents.
+  EXPECT_EQ(MeshCooker::load(path, 2), nullptr);
+  const auto missing = temporary_path("mesh_cooker_missing.astmesh");
+  EXPECT_EQ(MeshCooker::load(missing, 1), nullptr);
+
+  // Truncated, as if the writer had been interrupted.
+  const auto size = std::filesystem::file_size(path);
+  std::filesystem::resize_file(path, size / 2);
+  EXPECT_EQ(MeshCooker::load(path, 1), nullptr);
+
+  // Written by another format version.
+  ASSERT_TRUE(MeshCooker::write(path, 1, mesh.data));
+  {
+    std::fstream file{ path, std::ios::binary | std::ios::in | std::ios::out };
+    const u32 version = MeshCooker::format_version + 1;
+    file.seekp(sizeof(u32));
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  }
+  EXPECT_EQ(MeshCooker::load(path, 1), nullptr);
+
+  // A submesh using a material the file does not have.
+  auto bad_material = make_test_mesh();
+  bad_material.data.submeshes.back().material_index =
+    static_cast<u32>(bad_material.data.materials.size());
+  ASSERT_TRUE(MeshCooker::write(path, 1, bad_material.data));
+  EXPECT_EQ(MeshCooker::load(path, 1), nullptr);
+
+  std::filesystem::remove(path);
+}
+
+TEST(MeshCookerTest, RejectsChangedDependencies)
+{
+  const auto mesh = make_test_mesh();
+  const auto path = temporary_path("mesh_cooker_dependencies.astmesh");
+  const auto buffer = temporary_path("mesh_cooker_dependencies.bin");
+  const auto write_buffer = [&buffer](const char* contents) {
+    std::ofstream file{ buffer, std::ios::binary | std::ios::trunc };
+    file << contents;
+  };
+  write_buffer("geometry");
+  const std::vector dependencies{ buffer };
+  ASSERT_TRUE(MeshCooker::write(path, 1, mesh.data, dependencies));
+  EXPECT_NE(MeshCooker::load(path, 1), nullptr);
+
+  // The model file is unchanged, only the buffer it references is edited.
+  write_buffer("edited geometry");
+  EXPECT_EQ(MeshCooker::load(path, 1), nullptr);
+
+  ASSERT_TRUE(MeshCooker::write(path, 1, mesh.data, dependencies));
+  EXPECT_NE(MeshCooker::load(path, 1), nullptr);
+  std::filesystem::remove(buffer);
+  EXPECT_EQ(MeshCooker::load(path, 1), nullptr);
+
+  // A dependency that cannot be read is not cooked.
+  EXPECT_FALSE(MeshCooker::write(path, 1, mesh.data, dependencies));
+
+  std::filesystem::remove(path);
+}
+
+TEST(MeshCookerTest, HashDependsOnContentOnly)
+{
+  std::vector<std::byte> bytes(1001);
+  for (u32 i = 0; i < bytes.size(); i++) {
+    bytes[i] = static_cast<std::byte>(i * 31);
+  }
+  const auto original = MeshCooker::hash(bytes);
+  EXPECT_EQ(MeshCooker::hash(std::vector<std::byte>{ bytes }), original);
+
+  // Any single byte, in the word loop or in the tail, changes the hash.
+  for (const auto index : { 0U, 517U, 1000U }) {
+    auto changed = bytes;
+    changed[index] ^= std::byte{ 1 };
+    EXPECT_NE(MeshCooker::hash(changed), original) << index;
+  }
+  EXPECT_NE(MeshCooker::hash(std::span{ bytes }.first(1000)), original);
+
+  const auto path = temporary_path("mesh_cooker_hash.bin");
+  {
+    std::ofstream file{ path, std::ios::binary };
+    file.write(reinterpret_cast<const char*>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+  }
+  EXPECT_EQ(MeshCooker::hash_file(path), original);
+  std::filesystem::remove(path);
+  EXPECT_FALSE(MeshCooker::hash_file(path).has_value());
+}
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+TEST(MeshCookerBenchmark, CookedAgainstAssimp)
+{
+  const auto assets =
+    std::filesystem::path{ __FILE__ }.parent_path() / "../../Assets/meshes";
+  static constexpr u32 iterations = 10;
+
+  using clock = std::chrono::high_resolution_clock;
+  const auto millis = [](auto duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  };
+
+  std::stringstream csv_output;
+  csv_output << "Mesh,Vertices,Assimp(ms),Cooked(ms),CookedWithHash(ms)\n";
+  for (const auto* name : { "cube/cube.gltf", "sponza_new/sponza.gltf" }) {
+    const auto source = assets / name;
+    if (!std::filesystem::exists(source)) {
+      continue;
+    }
+
+    std::size_t vertex_count = 0;
+    const auto assimp_start = clock::now();
+    for (u32 iteration = 0; iteration < iterations; iteration++) {
+      const auto imported = MeshImporter::import(source.string());
+      ASSERT_NE(imported, nullptr);
+      vertex_count = imported->vertices.size();
+    }
+    const auto assimp_ms = millis(clock::now() - assimp_start) / iterations;
+
+    const auto source_hash = MeshCooker::hash_file(source);
+    ASSERT_TRUE(source_hash.has_value());
+    const auto cooked_path = temporary_path("mesh_cooker_benchmark.astmesh");
+    const auto imported = MeshImporter::import(source.string());
+    ASSERT_TRUE(MeshCooker::write(
+      cooked_path, *source_hash, imported->data, imported->dependencies));
+
+    // Touches every vertex, as the upload would.
+    const auto consume = [](const MeshData& data) {
+      float sum = 0.0F;
+      for (const auto& vertex : data.vertices) {
+        sum += vertex.position.x;
+      }
+      return sum;
+    };
+    float checksum = 0.0F;
+    const auto cooked_start = clock::now();
+    for (u32 iteration = 0; iteration < iterations; iteration++) {
+      const auto cooked = MeshCooker::load(cooked_path, *source_hash);
+      ASSERT_NE(cooked, nullptr);
+      checksum += consume(cooked->get_data());
+    }
+    const auto cooked_ms = millis(clock::now() - cooked_start) / iterations;
+
+    const auto hashed_start = clock::now();
+    for (u32 iteration = 0; iteration < iterations; iteration++) {
+      const auto cooked =
+        MeshCooker::load(cooked_path, *MeshCooker::hash_file(source));
+      ASSERT_NE(cooked, nullptr);
+      checksum += consume(cooked->get_data());
+    }
+    const auto hashed_ms = millis(clock::now() - hashed_start) / iterations;
+    std::filesystem::remove(cooked_path);
+
+    csv_output << name << "," << vertex_count << "," << assimp_ms << ","
+               << cooked_ms << "," << hashed_ms << "\n";
+    EXPECT_NE(checksum, -1.0F);
+  }
+  std::cout << csv_output.str();
+
+  std::ofstream csv_file("mesh_cooker_benchmark_results.csv");
+  if (csv_file.is_open()) {
+    csv_file << csv_output.str();
+    csv_file.close();
+  } else {
+    std::cerr << "Failed to open file for writing CSV results." << std::endl;
+  }
+}
+#endif
@@ -0,0 +1,112 @@
+#include <graphics/PipelineCacheFile.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace Engine::Graphics;
+using Engine::Core::u32;
+
+namespace {
+auto
+make_identity() -> PipelineCacheFile::DeviceIdentity
+{
+  PipelineCacheFile::DeviceIdentity identity{
+    .vendor_id = 0x10DE,
+    .device_id = 0x2684,
+  };
+  for (u32 i = 0; i < identity.cache_uuid.size(); i++) {
+    identity.cache_uuid.at(i) = static_cast<Engine::Core::u8>(i * 7);
+  }
+  return identity;
+}
+
+/// A version one header followed by some driver data.
+auto
+make_cache_data(const PipelineCacheFile::DeviceIdentity& identity)
+  -> std::vector<std::byte>
+{
+  std::vector<std::byte> data(32 + 64, std::byte{ 0xAB });
+  const std::array<u32, 4> fields{
+    32,
+    VK_PIPELINE_CACHE_HEADER_VERSION_ONE,
+    identity.vendor_id,
+    identity.device_id,
+  };
+  std::memcpy(data.data(), fields.data(), sizeof(fields));
+  std::memcpy(data.data() + sizeof(fields),
+              identity.cache_uuid.data(),
+              identity.cache_uuid.size());
+  return data;
+}
+
+auto
+temporary_path(const char* name) -> std::filesystem::path
+{
+  return std::filesystem::temp_directory_path() / name;
+}
+}
+
+TEST(PipelineCacheFileTest, AcceptsDataWrittenByTheSameDevice)
+{
+  const auto identity = make_identity();
+  EXPECT_TRUE(
+    PipelineCacheFile::is_compatible(make_cache_data(identity), identity));
+}
+
+TEST(PipelineCacheFileTest, RejectsDataOfAnotherDeviceOrDriver)
+{
+  const auto identity = make_identity();
+  const auto data = make_cache_data(identity);
+
+  auto other_vendor = identity;
+  other_vendor.vendor_id = 0x1002;
+  EXPECT_FALSE(PipelineCacheFile::is_compatible(data, other_vendor));
+
+  auto other_device = identity;
+  other_device.device_id++;
+  EXPECT_FALSE(PipelineCacheFile::is_compatible(data, other_device));
+
+  // A driver update changes the UUID.
+  auto other_driver = identity;
+  other_driver.cache_uuid.back()++;
+  EXPECT_FALSE(PipelineCacheFile::is_compatible(data, other_driver));
+}
+
+TEST(PipelineCacheFileTest, RejectsMalformedHeaders)
+{
+  const auto identity = make_identity();
+  const auto data = make_cache_data(identity);
+
+  EXPECT_FALSE(PipelineCacheFile::is_compatible({}, identity));
+  EXPECT_FALSE(PipelineCacheFile::is_compatible(
+    std::span{ data }.first(31), identity));
+
+  auto wrong_version = data;
+  wrong_version.at(4) = std::byte{ 2 };
+  EXPECT_FALSE(PipelineCacheFile::is_compatible(wrong_version, identity));
+
+  auto short_header = data;
+  short_header.at(0) = std::byte{ 16 };
+  EXPECT_FALSE(PipelineCacheFile::is_compatible(short_header, identity));
+}
+
+TEST(PipelineCacheFileTest, RoundTripsCompatibleDataOnly)
+{
+  const auto identity = make_identity();
+  const auto data = make_cache_data(identity);
+  const auto path = temporary_path("astute_pipeline_cache_test.bin");
+  ASSERT_TRUE(PipelineCacheFile::write(path, data));
+  EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+  EXPECT_EQ(PipelineCacheFile::read(path, identity), data);
+
+  auto other_device = identity;
+  other_device.device_id++;
+  EXPECT_TRUE(PipelineCacheFile::read(path, other_device).empty());
+
+  std::filesystem::remove(path);
+  EXPECT_TRUE(PipelineCacheFile::read(path, identity).empty());
+}
@@ -0,0 +1,141 @@
+#include <graphics/QueueSchedule.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+using namespace Engine::Graphics;
+
+namespace {
+
+constexpr VkPipelineStageFlags fragment = 0x80;
+constexpr VkPipelineStageFlags compute = 0x800;
+constexpr VkPipelineStageFlags tests = 0x100;
+
+} // namespace
+
+TEST(QueueScheduleTest, SameQueueDependenciesNeedNoSemaphores)
+{
+  QueueSchedule schedule;
+  const auto first = schedule.add_stage("First", QueueType::Graphics, {});
+  const auto second = schedule.add_stage("Second", QueueType::Graphics, {});
+  schedule.add_dependency(first, second, fragment);
+  schedule.compile();
+
+  EXPECT_EQ(schedule.get_semaphore_count(), 0U);
+  for (const auto& stage : schedule.get_stages()) {
+    EXPECT_TRUE(stage.waits.empty());
+    EXPECT_TRUE(stage.signals.empty());
+  }
+}
+
+TEST(QueueScheduleTest, CrossQueueDependencyIsASemaphore)
+{
+  QueueSchedule schedule;
+  const auto depth =
+    schedule.add_stage("Depth", QueueType::Graphics, { "Predepth" });
+  const auto culling =
+    schedule.add_stage("Culling", QueueType::Compute, { "LightCulling" });
+  schedule.add_dependency(depth, culling, compute);
+  schedule.compile();
+
+  ASSERT_EQ(schedule.get_semaphore_count(), 1U);
+  const auto& stages = schedule.get_stages();
+  ASSERT_EQ(stages.at(depth).signals.size(), 1U);
+  ASSERT_EQ(stages.at(culling).waits.size(), 1U);
+  EXPECT_EQ(stages.at(culling).waits.front().semaphore,
+            stages.at(depth).signals.front());
+  EXPECT_EQ(stages.at(culling).waits.front().stages, compute);
+}
+
+TEST(QueueScheduleTest, WaitsOnlyForTheLatestStageOfAQueue)
+{
+  QueueSchedule schedule;
+  const auto depth = schedule.add_stage("Depth", QueueType::Graphics, {});
+  const auto shadows = schedule.add_stage("Shadows", QueueType::Graphics, {});
+  const auto culling = schedule.add_stage("Culling", QueueType::Compute, {});
+  schedule.add_dependency(depth, culling, compute);
+  schedule.add_dependency(shadows, culling, fragment);
+  schedule.compile();
+
+  // Shadows is submitted after depth, so its signal covers both.
+  ASSERT_EQ(schedule.get_semaphore_count(), 1U);
+  const auto& stages = schedule.get_stages();
+  EXPECT_TRUE(stages.at(depth).signals.empty());
+  ASSERT_EQ(stages.at(shadows).signals.size(), 1U);
+  ASSERT_EQ(stages.at(culling).waits.size(), 1U);
+  EXPECT_EQ(stages.at(culling).waits.front().stages, compute | fragment);
+}
+
+TEST(QueueScheduleTest, EveryWaiterHasItsOwnSemaphore)
+{
+  QueueSchedule schedule;
+  const auto culling = schedule.add_stage("Culling", QueueType::Compute, {});
+  const auto lighting = schedule.add_stage("Lighting", QueueType::Graphics, {});
+  const auto bloom = schedule.add_stage("Bloom", QueueType::Compute, {});
+  const auto compose = schedule.add_stage("Compose", QueueType::Graphics, {});
+  schedule.add_dependency(culling, lighting, fragment);
+  schedule.add_dependency(lighting, bloom, compute);
+  schedule.add_dependency(culling, compose, fragment);
+  schedule.add_dependency(bloom, compose, fragment);
+  schedule.compile();
+
+  // Binary semaphores are waited once per signal, so compose does not share
+  // the one lighting waits for.
+  EXPECT_EQ(schedule.get_semaphore_count(), 3U);
+  const auto& stages = schedule.get_stages();
+  ASSERT_EQ(stages.at(compose).waits.size(), 1U);
+  EXPECT_EQ(stages.at(compose).waits.front().semaphore,
+            stages.at(bloom).signals.front());
+  EXPECT_EQ(stages.at(culling).signals.size(), 1U);
+}
+
+TEST(QueueScheduleTest, HandoffsAcrossQueuesTransferOwnership)
+{
+  QueueSchedule schedule;
+  const auto depth = schedule.add_stage("Depth", QueueType::Graphics, {});
+  const auto culling = schedule.add_stage("Culling", QueueType::Compute, {});
+  const auto lighting = schedule.add_stage("Lighting", QueueType::Graphics, {});
+  schedule.add_handoff({ 0, depth, culling, tests, compute });
+  schedule.add_handoff({ 0, culling, lighting, compute, tests });
+  schedule.add_handoff({ 1, depth, lighting, tests, fragment });
+  schedule.compile();
+
+  const auto& stages = schedule.get_stages();
+  ASSERT_EQ(stages.at(depth).releases.size(), 1U);
+  EXPECT_EQ(stages.at(depth).releases.front().to, culling);
+  ASSERT_EQ(stages.at(culling).acquires.size(), 1U);
+  ASSERT_EQ(stages.at(culling).releases.size(), 1U);
+  // Resource 1 stays on the graphics queue.
+  ASSERT_EQ(stages.at(lighting).acquires.size(), 1U);
+  EXPECT_EQ(stages.at(lighting).acquires.front().resource, 0U);
+
+  ASSERT_EQ(stages.at(lighting).waits.size(), 1U);
+  EXPECT_EQ(stages.at(lighting).waits.front().stages, tests);
+}
+
+TEST(QueueScheduleTest, DependenciesOnLaterStagesThrow)
+{
+  QueueSchedule schedule;
+  const auto first = schedule.add_stage("First", QueueType::Graphics, {});
+  const auto second = schedule.add_stage("Second", QueueType::Compute, {});
+  EXPECT_THROW(schedule.add_dependency(second, first, compute),
+               std::runtime_error);
+  EXPECT_THROW(schedule.add_dependency(first, first, compute),
+               std::runtime_error);
+  EXPECT_THROW(schedule.add_dependency(first, 7, compute), std::runtime_error);
+}
+
+TEST(QueueScheduleTest, CompilingAgainGivesTheSameSchedule)
+{
+  QueueSchedule schedule;
+  const auto depth = schedule.add_stage("Depth", QueueType::Graphics, {});
+  const auto culling = schedule.add_stage("Culling", QueueType::Compute, {});
+  schedule.add_handoff({ 0, depth, culling, tests, compute });
+  schedule.compile();
+  schedule.compile();
+
+  EXPECT_EQ(schedule.get_semaphore_count(), 1U);
+  EXPECT_EQ(schedule.get_stages().at(culling).acquires.size(), 1U);
+  EXPECT_EQ(schedule.get_stages().at(culling).waits.size(), 1U);
+}
@@ -0,0 +1,269 @@
+#include <graphics/RenderGraph.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+using namespace Engine::Graphics;
+
+namespace {
+
+constexpr auto fragment = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+constexpr auto read_only = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+auto
+names(const RenderGraph& graph) -> std::vector<std::string>
+{
+  std::vector<std::string> result;
+  for (const auto pass : graph.get_order()) {
+    result.push_back(graph.get_passes().at(pass).name);
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(RenderGraphTest, PassesNothingDependsOnAreCulled)
+{
+  RenderGraph graph;
+  const auto lighting = graph.add_pass("Lighting", QueueType::Graphics);
+  const auto debug = graph.add_pass("Debug", QueueType::Graphics);
+  const auto colour = graph.add_image("Colour", nullptr, read_only);
+  const auto overlay = graph.add_image("Overlay", nullptr, read_only);
+  graph.write(lighting, colour, RenderGraph::colour_attachment);
+  graph.write(debug, overlay, RenderGraph::colour_attachment);
+  graph.set_output(colour);
+  graph.compile();
+
+  EXPECT_FALSE(graph.is_culled(lighting));
+  EXPECT_TRUE(graph.is_culled(debug));
+  EXPECT_EQ(names(graph), std::vector<std::string>{ "Lighting" });
+  EXPECT_EQ(graph.get_statistics().culled, 1U);
+}
+
+TEST(RenderGraphTest, ComputePassesRunAsSoonAsTheyAreReady)
+{
+  RenderGraph graph;
+  const auto depth = graph.add_pass("Depth", QueueType::Graphics);
+  const auto shadows = graph.add_pass("Shadows", QueueType::Graphics);
+  const auto culling = graph.add_pass("Culling", QueueType::Compute);
+  const auto lighting = graph.add_pass("Lighting", QueueType::Graphics);
+  const auto depth_image = graph.add_image("Depth", nullptr, read_only);
+  const auto shadow_map = graph.add_image("ShadowMap", nullptr, read_only);
+  const auto lights = graph.add_buffer("Lights");
+  const auto colour = graph.add_image("Colour", nullptr, read_only);
+  graph.write(depth, depth_image, RenderGraph::depth_attachment);
+  graph.write(shadows, shadow_map, RenderGraph::depth_attachment);
+  graph.read(culling, depth_image, RenderGraph::compute_read);
+  graph.write(culling, lights, RenderGraph::compute_write);
+  graph.read(lighting, depth_image, RenderGraph::depth_test);
+  graph.read(lighting, shadow_map, RenderGraph::sampled_in_fragment);
+  graph.read(lighting, lights, RenderGraph::sampled_in_fragment);
+  graph.write(lighting, colour, RenderGraph::colour_attachment);
+  graph.set_output(colour);
+  graph.compile();
+
+  const std::vector<std::string> expected{
+    "Depth", "Culling", "Shadows", "Lighting"
+  };
+  EXPECT_EQ(names(graph), expected);
+}
+
+TEST(RenderGraphTest, RenderPassDependenciesCoverHazards)
+{
+  RenderGraph graph;
+  const auto geometry =
+    graph.add_pass("Geometry", QueueType::Graphics, fragment, fragment);
+  const auto shading =
+    graph.add_pass("Shading", QueueType::Graphics, fragment, fragment);
+  const auto gbuffer = graph.add_image("GBuffer", nullptr, read_only);
+  const auto colour = graph.add_image("Colour", nullptr, read_only);
+  graph.write(geometry, gbuffer, RenderGraph::colour_attachment);
+  graph.read(shading, gbuffer, RenderGraph::sampled_in_fragment);
+  graph.write(shading, colour, RenderGraph::colour_attachment);
+  graph.set_output(colour);
+  graph.compile();
+
+  EXPECT_EQ(graph.get_statistics().hazards, 1U);
+  EXPECT_EQ(graph.get_statistics().covered, 1U);
+  EXPECT_EQ(graph.get_statistics().barriers, 0U);
+  EXPECT_TRUE(graph.get_barrier(shading).empty());
+}
+
+TEST(RenderGraphTest, UncoveredHazardsShareOneBarrierPerPass)
+{
+  RenderGraph graph;
+  const auto producer = graph.add_pass("Producer", QueueType::Graphics);
+  const auto consumer = graph.add_pass("Consumer", QueueType::Graphics);
+  const auto first = graph.add_buffer("First");
+  const auto second = graph.add_image("Second", nullptr, read_only);
+  const auto colour = graph.add_image("Colour", nullptr, read_only);
+  graph.write(producer, first, RenderGraph::compute_write);
+  graph.write(producer, second, RenderGraph::colour_attachment);
+  graph.read(consumer, first, RenderGraph::indirect_arguments);
+  graph.read(consumer, second, RenderGraph::sampled_in_fragment);
+  graph.write(consumer, colour, RenderGraph::colour_attachment);
+  graph.set_output(colour);
+  graph.compile();
+
+  EXPECT_EQ(graph.get_statistics().hazards, 2U);
+  EXPECT_EQ(graph.get_statistics().barriers, 1U);
+  const auto& barrier = graph.get_barrier(consumer);
+  EXPECT_EQ(barrier.src_stages,
+            RenderGraph::compute_write.stages |
+              RenderGraph::colour_attachment.stages);
+  EXPECT_EQ(barrier.dst_stages,
+            RenderGraph::indirect_arguments.stages |
+              RenderGraph::sampled_in_fragment.stages);
+}
+
+TEST(RenderGraphTest, ImagesChangeQueueOnceTheOwningQueueIsDone)
+{
+  RenderGraph graph;
+  const auto lighting = graph.add_pass("Lighting", QueueType::Graphics);
+  const auto aberration = graph.add_pass("Aberration", QueueType::Graphics);
+  const auto bloom = graph.add_pass("Bloom", QueueType::Compute);
+  const auto compose = graph.add_pass("Compose", QueueType::Graphics);
+  const auto hdr = graph.add_image("HDR", nullptr, read_only);
+  const auto bloomed = graph.add_image("Bloomed", nullptr, read_only);
+  const auto shifted = graph.add_image("Shifted", nullptr, read_only);
+  const auto output = graph.add_image("Output", nullptr, read_only);
+  graph.write(lighting, hdr, RenderGraph::colour_attachment);
+  graph.read(aberration, hdr, RenderGraph::sampled_in_fragment);
+  graph.write(aberration, shifted, RenderGraph::colour_attachment);
+  graph.read(bloom, hdr, RenderGraph::compute_read);
+  graph.write(bloom, bloomed, RenderGraph::compute_write);
+  graph.read(compose, bloomed, RenderGraph::sampled_in_fragment);
+  graph.read(compose, shifted, RenderGraph::sampled_in_fragment);
+  graph.write(compose, output, RenderGraph::colour_attachment);
+  graph.set_output(output);
+  graph.compile();
+
+  // Bloom is ready as soon as lighting is done, but waits for the image.
+  const std::vector<std::string> expected{
+    "Lighting", "Aberration", "Bloom", "Compose"
+  };
+  EXPECT_EQ(names(graph), expected);
+
+  QueueSchedule schedule;
+  graph.build_schedule(schedule);
+  const auto& stages = schedule.get_stages();
+  ASSERT_EQ(stages.size(), 3U);
+  EXPECT_EQ(stages.at(0).passes,
+            (std::vector<std::string>{ "Lighting", "Aberration" }));
+  EXPECT_EQ(stages.at(1).queue, QueueType::Compute);
+  ASSERT_EQ(stages.at(1).acquires.size(), 1U);
+  EXPECT_EQ(stages.at(1).acquires.front().resource, hdr);
+  ASSERT_EQ(stages.at(2).acquires.size(), 1U);
+  EXPECT_EQ(stages.at(2).acquires.front().resource, bloomed);
+}
+
+TEST(RenderGraphTest, StagesSplitWhereTheOtherQueueWaits)
+{
+  RenderGraph graph;
+  const auto depth = graph.add_pass("Depth", QueueType::Graphics);
+  const auto culling = graph.add_pass("Culling", QueueType::Compute);
+  const auto shadows = graph.add_pass("Shadows", QueueType::Graphics);
+  const auto lighting = graph.add_pass("Lighting", QueueType::Graphics);
+  const auto depth_image = graph.add_image("Depth", nullptr, read_only);
+  const auto shadow_map = graph.add_image("ShadowMap", nullptr, read_only);
+  const auto lights = graph.add_buffer("Lights");
+  const auto colour = graph.add_image("Colour", nullptr, read_only);
+  graph.write(depth, depth_image, RenderGraph::depth_attachment);
+  graph.read(culling, depth_image, RenderGraph::compute_read);
+  graph.write(culling, lights, RenderGraph::compute_write);
+  graph.write(shadows, shadow_map, RenderGraph::depth_attachment);
+  graph.read(lighting, depth_image, RenderGraph::depth_test);
+  graph.read(lighting, shadow_map, RenderGraph::sampled_in_fragment);
+  graph.read(lighting, lights, RenderGraph::sampled_in_fragment);
+  graph.write(lighting, colour, RenderGraph::colour_attachment);
+  graph.set_output(colour);
+  graph.compile();
+
+  QueueSchedule schedule;
+  graph.build_schedule(schedule);
+  const auto& stages = schedule.get_stages();
+  ASSERT_EQ(stages.size(), 4U);
+  // Culling waits for the depth alone, and shadows do not wait for culling.
+  EXPECT_EQ(stages.at(0).passes, std::vector<std::string>{ "Depth" });
+  EXPECT_EQ(stages.at(2).passes, std::vector<std::string>{ "Shadows" });
+  EXPECT_TRUE(stages.at(2).waits.empty());
+  ASSERT_EQ(stages.at(3).waits.size(), 1U);
+  // The depth goes to culling and comes back for lighting.
+  EXPECT_EQ(stages.at(0).releases.size(), 1U);
+  EXPECT_EQ(stages.at(1).acquires.size(), 1U);
+  EXPECT_EQ(stages.at(1).releases.size(), 1U);
+  EXPECT_EQ(stages.at(3).acquires.size(), 1U);
+}
+
+TEST(RenderGraphTest, TransientsAliveAtDifferentTimesShareMemory)
+{
+  RenderGraph graph;
+  const auto geometry =
+    graph.add_pass("Geometry", QueueType::Graphics, fragment, fragment);
+  const auto shading =
+    graph.add_pass("Shading", QueueType::Graphics, fragment, fragment);
+  const auto aberration =
+    graph.add_pass("Aberration", QueueType::Graphics, fragment, fragment);
+  const auto compose =
+    graph.add_pass("Compose", QueueType::Graphics, fragment, fragment);
+  const auto gbuffer = graph.add_image("GBuffer", nullptr, read_only);
+  const auto hdr = graph.add_image("HDR", nullptr, read_only);
+  const auto shifted = graph.add_image("Shifted", nullptr, read_only);
+  const auto output = graph.add_image("Output", nullptr, read_only);
+  graph.write(geometry, gbuffer, RenderGraph::colour_attachment);
+  graph.read(shading, gbuffer, RenderGraph::sampled_in_fragment);
+  graph.write(shading, hdr, RenderGraph::colour_attachment);
+  graph.read(aberration, hdr, RenderGraph::sampled_in_fragment);
+  graph.write(aberration, shifted, RenderGraph::colour_attachment);
+  graph.read(compose, shifted, RenderGraph::sampled_in_fragment);
+  graph.write(compose, output, RenderGraph::colour_attachment);
+  graph.set_output(output);
+  graph.set_transient(gbuffer, 1024, 256);
+  graph.set_transient(shifted, 1024, 256);
+  graph.set_transient(hdr, 512, 256);
+  graph.compile();
+
+  const auto& placements = graph.get_placements();
+  ASSERT_EQ(placements.size(), 3U);
+  const auto offset_of = [&](RenderGraph::ResourceIndex resource) {
+    return std::ranges::find(
+             placements, resource, &RenderGraph::Placement::resource)
+      ->offset;
+  };
+  EXPECT_EQ(offset_of(gbuffer), offset_of(shifted));
+  EXPECT_EQ(offset_of(hdr), 1024U);
+
+  const auto& statistics = graph.get_statistics();
+  EXPECT_EQ(statistics.transient_bytes, 2560U);
+  EXPECT_EQ(statistics.aliased_bytes, 1536U);
+  // Within a frame and into the next, both covered by the render passes.
+  const auto aliasing = std::ranges::count_if(
+    graph.get_hazards(), [](const auto& hazard) { return hazard.aliasing; });
+  EXPECT_EQ(aliasing, 2);
+  EXPECT_EQ(statistics.barriers, 0U);
+}
+
+TEST(RenderGraphTest, TransientsOnDifferentQueuesNeverShareMemory)
+{
+  RenderGraph graph;
+  const auto geometry = graph.add_pass("Geometry", QueueType::Graphics);
+  const auto bloom = graph.add_pass("Bloom", QueueType::Compute);
+  const auto compose = graph.add_pass("Compose", QueueType::Graphics);
+  const auto gbuffer = graph.add_image("GBuffer", nullptr, read_only);
+  const auto scratch = graph.add_image("Scratch", nullptr, read_only);
+  const auto bloomed = graph.add_buffer("Bloomed");
+  const auto output = graph.add_image("Output", nullptr, read_only);
+  graph.write(geometry, gbuffer, RenderGraph::colour_attachment);
+  graph.write(bloom, scratch, RenderGraph::compute_write);
+  graph.write(bloom, bloomed, RenderGraph::compute_write);
+  graph.read(compose, bloomed, RenderGraph::sampled_in_fragment);
+  graph.read(compose, gbuffer, RenderGraph::sampled_in_fragment);
+  graph.write(compose, output, RenderGraph::colour_attachment);
+  graph.set_output(output);
+  graph.set_transient(gbuffer, 256, 1);
+  graph.set_transient(scratch, 256, 1);
+  graph.compile();
+
+  EXPECT_EQ(graph.get_statistics().aliased_bytes, 512U);
+}
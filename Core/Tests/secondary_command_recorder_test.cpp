@@ -0,0 +1,184 @@
+#include <graphics/SecondaryCommandRecorder.hpp>
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+#include <graphics/Allocator.hpp>
+#include <graphics/CommandBuffer.hpp>
+#include <graphics/Device.hpp>
+#include <graphics/Framebuffer.hpp>
+#include <graphics/Instance.hpp>
+#include <thread_pool/ThreadPool.hpp>
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#endif
+
+#include <gtest/gtest.h>
+
+using namespace Engine::Graphics;
+using Engine::Core::usize;
+
+namespace {
+auto
+expect_covers(const std::vector<DrawChunk>& chunks, usize draw_count) -> void
+{
+  usize next = 0;
+  for (const auto& chunk : chunks) {
+    EXPECT_EQ(chunk.begin, next);
+    EXPECT_GT(chunk.size(), 0U);
+    next = chunk.end;
+  }
+  EXPECT_EQ(next, draw_count);
+}
+} // namespace
+
+TEST(SecondaryCommandRecorderTest, NoDrawsNoChunks)
+{
+  EXPECT_TRUE(SecondaryCommandRecorder::split(0, 4).empty());
+}
+
+TEST(SecondaryCommandRecorderTest, SmallListsStayInOneChunk)
+{
+  const auto chunks = SecondaryCommandRecorder::split(
+    SecondaryCommandRecorder::minimum_chunk_size + 1, 4);
+  ASSERT_EQ(chunks.size(), 1U);
+  expect_covers(chunks, SecondaryCommandRecorder::minimum_chunk_size + 1);
+}
+
+TEST(SecondaryCommandRecorderTest, LargeListsSplitEvenlyAcrossWorkers)
+{
+  const auto chunks = SecondaryCommandRecorder::split(10003, 4);
+  ASSERT_EQ(chunks.size(), 4U);
+  expect_covers(chunks, 10003);
+  for (const auto& chunk : chunks) {
+    EXPECT_GE(chunk.size(), 2500U);
+    EXPECT_LE(chunk.size(), 2501U);
+  }
+
+  // Never more chunks than minimum-sized ones fit.
+  const auto partial = SecondaryCommandRecorder::split(
+    3 * SecondaryCommandRecorder::minimum_chunk_size, 8);
+  EXPECT_EQ(partial.size(), 3U);
+  expect_covers(partial, 3 * SecondaryCommandRecorder::minimum_chunk_size);
+}
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+namespace {
+struct DeviceProvider
+{
+  [[nodiscard]] static auto get_device() -> VkDevice
+  {
+    return Engine::Graphics::Device::the().device();
+  }
+  [[nodiscard]] static auto get_queue_type() -> QueueType
+  {
+    return QueueType::Graphics;
+  }
+};
+} // namespace
+
+TEST(SecondaryCommandRecorderBenchmark, TenThousandDrawsPerWorkerCount)
+{
+  using Engine::Core::u32;
+  static constexpr usize draw_count = 10000;
+  static constexpr u32 iterations = 50;
+  // The size of the per-draw push constants of the geometry pass.
+  static constexpr u32 push_constant_size = 128;
+
+  Device::the();
+  Allocator::construct();
+  {
+    Framebuffer framebuffer{ FramebufferSpecification{
+      .width = 256,
+      .height = 256,
+      .attachments = { { .format = VK_FORMAT_R8G8B8A8_UNORM } },
+      .debug_name = "SecondaryCommandRecorderBenchmark",
+    } };
+
+    // Every draw records its push constants and scissor, the state commands
+    // the geometry pass records per draw. No pipeline is bound, so there is
+    // no vkCmdDraw, which would be invalid without one.
+    const VkPushConstantRange range{
+      .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+      .offset = 0,
+      .size = push_constant_size,
+    };
+    VkPipelineLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layout_info.pushConstantRangeCount = 1;
+    layout_info.pPushConstantRanges = &range;
+    VkPipelineLayout layout{};
+    ASSERT_EQ(vkCreatePipelineLayout(
+                Device::the().device(), &layout_info, nullptr, &layout),
+              VK_SUCCESS);
+
+    const std::array<std::byte, push_constant_size> push_constants{};
+    const VkRect2D scissor{ .offset = {}, .extent = { 256, 256 } };
+    const auto record_draws = [&](CommandBuffer& buffer, DrawChunk chunk) {
+      const auto command_buffer = buffer.get_command_buffer();
+      for (auto draw = chunk.begin; draw < chunk.end; draw++) {
+        vkCmdPushConstants(command_buffer,
+                           layout,
+                           VK_SHADER_STAGE_VERTEX_BIT,
+                           0,
+                           push_constant_size,
+                           push_constants.data());
+        vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+      }
+    };
+
+    using clock = std::chrono::high_resolution_clock;
+    const auto millis = [](auto duration) {
+      return std::chrono::duration<double, std::milli>(duration).count();
+    };
+
+    std::stringstream csv_output;
+    csv_output << "Threads,Chunks,Draws,Record(ms),Speedup\n";
+    double single_thread_ms = 0.0;
+    const auto hardware_threads =
+      std::max(std::thread::hardware_concurrency(), 1U);
+    for (const auto thread_count : { 1U, 2U, 4U, hardware_threads }) {
+      ED::ThreadPool thread_pool{ DeviceProvider{}, thread_count };
+      SecondaryCommandRecorder recorder{ thread_pool, 1 };
+
+      // The first recording creates the secondaries and their pools.
+      recorder.record(framebuffer, draw_count, record_draws);
+      recorder.reset();
+
+      const auto start = clock::now();
+      for (u32 iteration = 0; iteration < iterations; iteration++) {
+        recorder.record(framebuffer, draw_count, record_draws);
+        // Waits for every chunk.
+        recorder.reset();
+      }
+      const auto record_ms = millis(clock::now() - start) / iterations;
+      if (thread_count == 1) {
+        single_thread_ms = record_ms;
+      }
+
+      csv_output << thread_count << ","
+                 << SecondaryCommandRecorder::split(draw_count, thread_count)
+                      .size()
+                 << "," << draw_count << "," << record_ms << ","
+                 << single_thread_ms / record_ms << "\n";
+    }
+    std::cout << csv_output.str();
+
+    std::ofstream csv_file("secondary_command_recorder_benchmark_results.csv");
+    if (csv_file.is_open()) {
+      csv_file << csv_output.str();
+      csv_file.close();
+    } else {
+      std::cerr << "Failed to open file for writing CSV results." << std::endl;
+    }
+
+    vkDestroyPipelineLayout(Device::the().device(), layout, nullptr);
+  }
+  Allocator::destroy();
+  Device::destroy();
+  Instance::destroy();
+}
+#endif
@@ -0,0 +1,89 @@
+#include <graphics/StateTrackingRecorder.hpp>
+
+#include <array>
+#include <bit>
+#include <gtest/gtest.h>
+
+using namespace Engine::Graphics;
+using Engine::Core::u32;
+using Engine::Core::u8;
+
+namespace {
+template<class Handle>
+auto
+fake_handle(std::uintptr_t value) -> Handle
+{
+  return std::bit_cast<Handle>(value);
+}
+
+auto
+bytes_of(const u32& value) -> std::span<const u8>
+{
+  return { reinterpret_cast<const u8*>(&value), sizeof(value) };
+}
+} // namespace
+
+TEST(BoundStateCacheTest, RepeatedBindsAreSkipped)
+{
+  BoundStateCache cache;
+  const auto pipeline = fake_handle<VkPipeline>(0x10);
+  const auto mesh = fake_handle<VkBuffer>(0x20);
+
+  EXPECT_TRUE(cache.pipeline(pipeline));
+  EXPECT_FALSE(cache.pipeline(pipeline));
+  EXPECT_TRUE(cache.vertex_buffer(0, mesh, 0));
+  EXPECT_FALSE(cache.vertex_buffer(0, mesh, 0));
+  EXPECT_TRUE(cache.vertex_buffer(0, mesh, 64));
+  // Another binding point is its own state.
+  EXPECT_TRUE(cache.vertex_buffer(1, mesh, 64));
+  EXPECT_TRUE(cache.index_buffer(mesh, 0, VK_INDEX_TYPE_UINT32));
+  EXPECT_FALSE(cache.index_buffer(mesh, 0, VK_INDEX_TYPE_UINT32));
+  EXPECT_TRUE(cache.index_buffer(mesh, 0, VK_INDEX_TYPE_UINT16));
+
+  EXPECT_EQ(cache.get_statistics().emitted, 6U);
+  EXPECT_EQ(cache.get_statistics().skipped, 3U);
+}
+
+TEST(BoundStateCacheTest, DescriptorSetsAreKeptPerLayout)
+{
+  BoundStateCache cache;
+  const auto layout = fake_handle<VkPipelineLayout>(0x10);
+  const auto other_layout = fake_handle<VkPipelineLayout>(0x11);
+  const std::array renderer_and_material{
+    fake_handle<VkDescriptorSet>(0x20),
+    fake_handle<VkDescriptorSet>(0x30),
+  };
+  const std::array other_material{ fake_handle<VkDescriptorSet>(0x31) };
+
+  EXPECT_TRUE(cache.descriptor_sets(layout, 0, renderer_and_material));
+  EXPECT_FALSE(cache.descriptor_sets(layout, 0, renderer_and_material));
+  EXPECT_FALSE(cache.descriptor_sets(
+    layout, 1, std::span{ renderer_and_material }.subspan(1)));
+  EXPECT_TRUE(cache.descriptor_sets(layout, 1, other_material));
+
+  // A different layout may not see the same sets.
+  EXPECT_TRUE(cache.descriptor_sets(other_layout, 1, other_material));
+  EXPECT_FALSE(cache.descriptor_sets(other_layout, 1, other_material));
+}
+
+TEST(BoundStateCacheTest, PushConstantsCompareContents)
+{
+  BoundStateCache cache;
+  const auto layout = fake_handle<VkPipelineLayout>(0x10);
+  u32 cascade = 3;
+
+  EXPECT_TRUE(
+    cache.push_constants(layout, VK_SHADER_STAGE_ALL, 0, bytes_of(cascade)));
+  EXPECT_FALSE(
+    cache.push_constants(layout, VK_SHADER_STAGE_ALL, 0, bytes_of(cascade)));
+  cascade = 4;
+  EXPECT_TRUE(
+    cache.push_constants(layout, VK_SHADER_STAGE_ALL, 0, bytes_of(cascade)));
+
+  cache.reset();
+  EXPECT_TRUE(
+    cache.push_constants(layout, VK_SHADER_STAGE_ALL, 0, bytes_of(cascade)));
+  // Statistics outlive a reset.
+  EXPECT_EQ(cache.get_statistics().emitted, 3U);
+  EXPECT_EQ(cache.get_statistics().skipped, 1U);
+}
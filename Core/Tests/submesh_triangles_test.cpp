@@ -0,0 +1,171 @@
+#include <graphics/MeshData.hpp>
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+#include <graphics/MeshImporter.hpp>
+#endif
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace Engine::Graphics;
+using Engine::Core::u32;
+using Engine::Core::usize;
+
+namespace {
+auto
+make_vertex(float x, float y, float z) -> Vertex
+{
+  Vertex vertex{};
+  vertex.position = { x, y, z };
+  return vertex;
+}
+
+auto
+make_submesh(u32 base_vertex, u32 base_index, u32 index_count) -> Submesh
+{
+  Submesh submesh{};
+  submesh.base_vertex = base_vertex;
+  submesh.base_index = base_index;
+  submesh.index_count = index_count;
+  return submesh;
+}
+
+auto
+same_position(const glm::vec3& first, const glm::vec3& second) -> bool
+{
+  return first.x == second.x && first.y == second.y && first.z == second.z;
+}
+}
+
+TEST(SubmeshTrianglesTest, ReadsTrianglesOfEachSubmesh)
+{
+  // Two quads, each indexed relative to its own base vertex.
+  const std::vector<Vertex> vertices{
+    make_vertex(0, 0, 0), make_vertex(1, 0, 0), make_vertex(1, 1, 0),
+    make_vertex(0, 1, 0), make_vertex(0, 0, 5), make_vertex(2, 0, 5),
+    make_vertex(2, 2, 5), make_vertex(0, 2, 5),
+  };
+  const std::vector<Index> indices{
+    { 0, 1, 2 },
+    { 2, 3, 0 },
+    { 0, 1, 2 },
+    { 2, 3, 0 },
+  };
+
+  const SubmeshTriangles first{ vertices, indices, make_submesh(0, 0, 6) };
+  const SubmeshTriangles second{ vertices, indices, make_submesh(4, 6, 6) };
+  ASSERT_EQ(first.size(), 2U);
+  ASSERT_EQ(second.size(), 2U);
+
+  EXPECT_TRUE(same_position(first[1].V0, glm::vec3{ 1, 1, 0 }));
+  EXPECT_TRUE(same_position(first[1].V1, glm::vec3{ 0, 1, 0 }));
+  EXPECT_TRUE(same_position(first[1].V2, glm::vec3{ 0, 0, 0 }));
+
+  usize visited = 0;
+  for (const auto& triangle : second) {
+    EXPECT_EQ(triangle.V0.z, 5.0F);
+    EXPECT_EQ(triangle.V1.z, 5.0F);
+    EXPECT_EQ(triangle.V2.z, 5.0F);
+    visited++;
+  }
+  EXPECT_EQ(visited, second.size());
+  EXPECT_TRUE(same_position(second[0].V2, glm::vec3{ 2, 2, 5 }));
+}
+
+TEST(SubmeshTrianglesTest, EmptySubmeshHasNoTriangles)
+{
+  const std::vector<Vertex> vertices{ make_vertex(0, 0, 0) };
+  const std::vector<Index> indices{ { 0, 0, 0 } };
+  const SubmeshTriangles triangles{ vertices, indices, make_submesh(0, 3, 0) };
+  EXPECT_TRUE(triangles.empty());
+  EXPECT_EQ(triangles.begin(), triangles.end());
+}
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+TEST(SubmeshTrianglesBenchmark, ViewAgainstCopiedTriangles)
+{
+  const auto assets =
+    std::filesystem::path{ __FILE__ }.parent_path() / "../../Assets/meshes";
+
+  // What MeshAsset used to build for every submesh at load.
+  struct CopiedTriangle
+  {
+    Vertex V0;
+    Vertex V1;
+    Vertex V2;
+  };
+
+  using clock = std::chrono::high_resolution_clock;
+  const auto millis = [](auto duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  };
+
+  std::stringstream csv_output;
+  csv_output << "Mesh,Triangles,VertexBytes,CopiedBytes,CopyBuild(ms),"
+                "CopiedScan(ms),ViewScan(ms)\n";
+  // The meshes bundled in Assets/meshes.
+  for (const auto* name : { "cube/cube.gltf", "cube.glb" }) {
+    const auto source = assets / name;
+    ASSERT_TRUE(std::filesystem::exists(source)) << source;
+    const auto imported = MeshImporter::import(source.string());
+    ASSERT_NE(imported, nullptr);
+    const auto& data = imported->data;
+
+    const auto build_start = clock::now();
+    std::vector<std::vector<CopiedTriangle>> copied(data.submeshes.size());
+    usize triangle_count = 0;
+    for (usize m = 0; m < data.submeshes.size(); m++) {
+      const auto& submesh = data.submeshes[m];
+      for (const auto& index : data.indices.subspan(
+             submesh.base_index / 3, submesh.index_count / 3)) {
+        copied[m].push_back({ data.vertices[index.V1 + submesh.base_vertex],
+                              data.vertices[index.V2 + submesh.base_vertex],
+                              data.vertices[index.V3 + submesh.base_vertex] });
+      }
+      triangle_count += copied[m].size();
+    }
+    const auto build_ms = millis(clock::now() - build_start);
+
+    // A stand in for a CPU side query touching every triangle.
+    glm::vec3 copied_sum{ 0.0F };
+    const auto copied_start = clock::now();
+    for (const auto& triangles : copied) {
+      for (const auto& triangle : triangles) {
+        copied_sum += triangle.V0.position + triangle.V1.position +
+                      triangle.V2.position;
+      }
+    }
+    const auto copied_ms = millis(clock::now() - copied_start);
+
+    glm::vec3 view_sum{ 0.0F };
+    const auto view_start = clock::now();
+    for (const auto& submesh : data.submeshes) {
+      for (const auto& triangle :
+           SubmeshTriangles{ data.vertices, data.indices, submesh }) {
+        view_sum += triangle.V0 + triangle.V1 + triangle.V2;
+      }
+    }
+    const auto view_ms = millis(clock::now() - view_start);
+    EXPECT_TRUE(same_position(copied_sum, view_sum));
+
+    csv_output << name << "," << triangle_count << ","
+               << data.vertices.size_bytes() << ","
+               << triangle_count * sizeof(CopiedTriangle) << "," << build_ms
+               << "," << copied_ms << "," << view_ms << "\n";
+  }
+  std::cout << csv_output.str();
+
+  std::ofstream csv_file("submesh_triangles_benchmark_results.csv");
+  if (csv_file.is_open()) {
+    csv_file << csv_output.str();
+    csv_file.close();
+  } else {
+    std::cerr << "Failed to open file for writing CSV results." << std::endl;
+  }
+}
+#endif
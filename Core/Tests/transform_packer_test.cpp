@@ -0,0 +1,262 @@
+#include <graphics/TransformPacker.hpp>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace Engine::Graphics;
+using Engine::Core::u32;
+using InstructionSet = TransformPacker::InstructionSet;
+
+namespace {
+auto
+random_matrices(u32 count, u32 seed) -> std::vector<glm::mat4>
+{
+  std::mt19937 engine{ seed };
+  std::uniform_real_distribution<float> distribution{ -10.0F, 10.0F };
+  std::vector<glm::mat4> matrices(count);
+  for (auto& matrix : matrices) {
+    for (auto column = 0; column < 4; column++) {
+      for (auto row = 0; row < 4; row++) {
+        matrix[column][row] = distribution(engine);
+      }
+    }
+  }
+  return matrices;
+}
+
+// What both submit paths did before: one glm product, then twelve stores.
+auto
+pack_with_glm(const glm::mat4& instance, const glm::mat4& local)
+  -> TransformVertexData
+{
+  const auto transform = instance * local;
+  TransformVertexData output;
+  for (auto row = 0; row < 3; row++) {
+    output.transform_rows[row] = {
+      transform[0][row],
+      transform[1][row],
+      transform[2][row],
+      transform[3][row],
+    };
+  }
+  return output;
+}
+
+struct Components
+{
+  std::vector<glm::vec3> translations;
+  std::vector<glm::quat> rotations;
+  std::vector<glm::vec3> scales;
+};
+
+auto
+random_components(u32 count, u32 seed) -> Components
+{
+  std::mt19937 engine{ seed };
+  std::uniform_real_distribution<float> distribution{ -2.0F, 2.0F };
+  const auto next = [&]() { return distribution(engine); };
+  Components components;
+  for (u32 i = 0; i < count; i++) {
+    components.translations.emplace_back(next(), next(), next());
+    components.rotations.push_back(
+      glm::normalize(glm::quat{ next(), next(), next(), next() }));
+    components.scales.emplace_back(next(), next(), next());
+  }
+  return components;
+}
+
+auto
+supported_instruction_sets() -> std::vector<InstructionSet>
+{
+  std::vector<InstructionSet> supported;
+  for (const auto instruction_set :
+       { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2 }) {
+    if (instruction_set <= TransformPacker::get_instruction_set()) {
+      supported.push_back(instruction_set);
+    }
+  }
+  return supported;
+}
+}
+
+TEST(TransformPackerTest, MatchesGlmForEveryInstructionSet)
+{
+  static constexpr u32 instance_count = 1001;
+  const auto instances = random_matrices(instance_count, 1234);
+  const auto local = random_matrices(1, 4321).front();
+
+  for (const auto instruction_set : supported_instruction_sets()) {
+    std::vector<TransformVertexData> packed(instance_count);
+    TransformPacker::pack(instruction_set, instances, local, packed);
+
+    for (u32 i = 0; i < instance_count; i++) {
+      const auto expected = pack_with_glm(instances[i], local);
+      for (auto row = 0; row < 3; row++) {
+        for (auto column = 0; column < 4; column++) {
+          const auto value = expected.transform_rows[row][column];
+          // FMA rounds once per multiply-add, so allow a little slack.
+          ASSERT_NEAR(packed[i].transform_rows[row][column],
+                      value,
+                      1e-4F * std::max(1.0F, std::abs(value)))
+            << TransformPacker::to_string(instruction_set) << " instance "
+            << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(TransformPackerTest, ComposeMatchesMatrixProducts)
+{
+  std::mt19937 engine{ 42 };
+  std::uniform_real_distribution<float> distribution{ -2.0F, 2.0F };
+  for (u32 i = 0; i < 100; i++) {
+    const glm::vec3 translation{
+      distribution(engine),
+      distribution(engine),
+      distribution(engine),
+    };
+    const auto rotation = glm::normalize(glm::quat{
+      distribution(engine),
+      distribution(engine),
+      distribution(engine),
+      distribution(engine),
+    });
+    const glm::vec3 scale{
+      distribution(engine),
+      distribution(engine),
+      distribution(engine),
+    };
+
+    const glm::mat4 identity{ 1.0F };
+    const auto expected = glm::translate(identity, translation) *
+                          glm::mat4_cast(rotation) *
+                          glm::scale(identity, scale);
+    const auto composed =
+      TransformPacker::compose(translation, rotation, scale);
+    for (auto column = 0; column < 4; column++) {
+      for (auto row = 0; row < 4; row++) {
+        ASSERT_NEAR(composed[column][row], expected[column][row], 1e-5F);
+      }
+    }
+  }
+}
+
+TEST(TransformPackerTest, BatchedComposeMatchesComposeForEveryInstructionSet)
+{
+  // Not a multiple of four, so the scalar tail runs too.
+  static constexpr u32 instance_count = 1003;
+  const auto components = random_components(instance_count, 99);
+
+  for (const auto instruction_set : supported_instruction_sets()) {
+    std::vector<glm::mat4> composed(instance_count);
+    TransformPacker::compose(instruction_set,
+                             components.translations,
+                             components.rotations,
+                             components.scales,
+                             composed);
+
+    for (u32 i = 0; i < instance_count; i++) {
+      const auto expected =
+        TransformPacker::compose(components.translations[i],
+                                 components.rotations[i],
+                                 components.scales[i]);
+      for (auto column = 0; column < 4; column++) {
+        for (auto row = 0; row < 4; row++) {
+          ASSERT_NEAR(composed[i][column][row], expected[column][row], 1e-5F)
+            << TransformPacker::to_string(instruction_set) << " instance "
+            << i;
+        }
+      }
+    }
+  }
+}
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+TEST(TransformPackerBenchmark, BatchedAgainstGlm)
+{
+  static constexpr std::array<u32, 3> instance_counts{ 1000, 10000, 100000 };
+  static constexpr u32 iterations = 50;
+
+  using clock = std::chrono::high_resolution_clock;
+  const auto nanos = [](auto duration) {
+    return std::chrono::duration<double, std::nano>(duration).count();
+  };
+
+  std::stringstream csv_output;
+  csv_output << "Path,Instances,Time(ns/transform)\n";
+  for (const auto instance_count : instance_counts) {
+    const auto instances = random_matrices(instance_count, instance_count);
+    const auto local = random_matrices(1, 7).front();
+    std::vector<TransformVertexData> packed(instance_count);
+
+    const auto glm_start = clock::now();
+    for (u32 iteration = 0; iteration < iterations; iteration++) {
+      for (u32 i = 0; i < instance_count; i++) {
+        packed[i] = pack_with_glm(instances[i], local);
+      }
+    }
+    const auto glm_ns = nanos(clock::now() - glm_start);
+    const auto per_transform = iterations * static_cast<double>(instance_count);
+    csv_output << "glm," << instance_count << "," << glm_ns / per_transform
+               << "\n";
+
+    for (const auto instruction_set : supported_instruction_sets()) {
+      const auto start = clock::now();
+      for (u32 iteration = 0; iteration < iterations; iteration++) {
+        TransformPacker::pack(instruction_set, instances, local, packed);
+      }
+      const auto elapsed_ns = nanos(clock::now() - start);
+      csv_output << TransformPacker::to_string(instruction_set) << ","
+                 << instance_count << "," << elapsed_ns / per_transform << "\n";
+    }
+
+    // TransformComponent::compute() one entity at a time, against one batch
+    // for the whole view.
+    const auto components = random_components(instance_count, instance_count);
+    std::vector<glm::mat4> composed(instance_count);
+    const auto per_entity_start = clock::now();
+    for (u32 iteration = 0; iteration < iterations; iteration++) {
+      for (u32 i = 0; i < instance_count; i++) {
+        composed[i] = TransformPacker::compose(components.translations[i],
+                                               components.rotations[i],
+                                               components.scales[i]);
+      }
+    }
+    const auto per_entity_ns = nanos(clock::now() - per_entity_start);
+    csv_output << "ComposePerEntity," << instance_count << ","
+               << per_entity_ns / per_transform << "\n";
+
+    for (const auto instruction_set : supported_instruction_sets()) {
+      const auto start = clock::now();
+      for (u32 iteration = 0; iteration < iterations; iteration++) {
+        TransformPacker::compose(instruction_set,
+                                 components.translations,
+                                 components.rotations,
+                                 components.scales,
+                                 composed);
+      }
+      const auto elapsed_ns = nanos(clock::now() - start);
+      csv_output << "Compose" << TransformPacker::to_string(instruction_set)
+                 << "," << instance_count << ","
+                 << elapsed_ns / per_transform << "\n";
+    }
+  }
+  std::cout << csv_output.str();
+
+  std::ofstream csv_file("transform_packer_benchmark_results.csv");
+  if (csv_file.is_open()) {
+    csv_file << csv_output.str();
+    csv_file.close();
+  } else {
+    std::cerr << "Failed to open file for writing CSV results." << std::endl;
+  }
+}
+#endif
@@ -29,6 +29,9 @@ public:
   {
     f64 frame_time{ 0.0 };
     f64 frames_per_seconds{ 0.0 };
+    /// Milliseconds of the frame spent waiting for the GPU to release the
+    /// frame in flight. Near zero while the CPU and GPU overlap.
+    f64 frame_wait_time{ 0.0 };
   };
 
   explicit Application(const Configuration&);
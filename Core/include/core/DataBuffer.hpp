@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "core/Exceptions.hpp"
+#include "core/Hash.hpp"
 #include "core/Types.hpp"
 
 namespace Engine::Core {
@@ -254,8 +255,9 @@ public:
   }
   [[nodiscard]] auto hash() const noexcept -> usize
   {
-    return std::hash<usize>{}(buffer_size) ^
-           std::hash<std::unique_ptr<u8[]>>{}(data);
+    const auto size = data != nullptr ? buffer_size : 0;
+    return static_cast<usize>(
+      hash_bytes(std::span<const u8>{ data.get(), size }));
   }
   [[nodiscard]] auto valid() const noexcept -> bool
   {
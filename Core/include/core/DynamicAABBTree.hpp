@@ -0,0 +1,191 @@
+#pragma once
+
+#include "core/AABB.hpp"
+#include "core/Frustum.hpp"
+#include "core/Types.hpp"
+
+#include <array>
+#include <glm/glm.hpp>
+#include <limits>
+#include <vector>
+
+namespace Engine::Core {
+
+/// A bounding volume hierarchy over proxies that move, in the style of the
+/// Box2D dynamic tree.
+///
+/// Leaves store "fat" bounds, the proxy bounds grown by a margin, so a proxy
+/// that moves a little stays where it is and only proxies that leave their fat
+/// bounds are re-inserted. Insertion picks the sibling with the smallest
+/// surface area cost and AVL rotations keep the tree balanced, so queries stay
+/// logarithmic in the proxy count.
+class DynamicAABBTree
+{
+public:
+  static constexpr i32 null_node = -1;
+
+  struct Configuration
+  {
+    const f32 margin{ 0.1F };
+  };
+  DynamicAABBTree();
+  explicit DynamicAABBTree(const Configuration&);
+
+  /// Returns the proxy id, stable until the proxy is destroyed.
+  auto create_proxy(const AABB&, u32 user_data) -> i32;
+  auto destroy_proxy(i32 proxy) -> void;
+  /// Returns true if the proxy had to be re-inserted.
+  auto move_proxy(i32 proxy, const AABB&) -> bool;
+  auto clear() -> void;
+
+  [[nodiscard]] auto get_user_data(i32 proxy) const -> u32
+  {
+    return nodes[static_cast<usize>(proxy)].user_data;
+  }
+  [[nodiscard]] auto get_fat_bounds(i32 proxy) const -> const AABB&
+  {
+    return nodes[static_cast<usize>(proxy)].bounds;
+  }
+  [[nodiscard]] auto get_proxy_count() const -> u32 { return proxy_count; }
+  [[nodiscard]] auto get_height() const -> i32
+  {
+    return root == null_node ? 0 : nodes[static_cast<usize>(root)].height;
+  }
+
+  /// Every query calls `callback(user_data)` for each proxy whose fat bounds
+  /// pass the test, so callers re-test exact bounds where that matters.
+  template<class F>
+  auto query(const AABB& box, F&& callback) const -> void
+  {
+    traverse(
+      [&box](const AABB& bounds) {
+        return bounds.min.x <= box.max.x && bounds.max.x >= box.min.x &&
+               bounds.min.y <= box.max.y && bounds.max.y >= box.min.y &&
+               bounds.min.z <= box.max.z && bounds.max.z >= box.min.z;
+      },
+      std::forward<F>(callback));
+  }
+
+  template<class F>
+  auto query(const Frustum& frustum, F&& callback) const -> void
+  {
+    traverse(
+      [&frustum](const AABB& bounds) { return frustum.intersects(bounds); },
+      std::forward<F>(callback));
+  }
+
+  template<class F>
+  auto query_sphere(const glm::vec3& centre, f32 radius, F&& callback) const
+    -> void
+  {
+    traverse(
+      [&centre, radius](const AABB& bounds) {
+        const auto closest = glm::clamp(centre, bounds.min, bounds.max);
+        const auto offset = closest - centre;
+        return glm::dot(offset, offset) <= radius * radius;
+      },
+      std::forward<F>(callback));
+  }
+
+  template<class F>
+  auto ray_cast(const glm::vec3& origin,
+                const glm::vec3& direction,
+                F&& callback,
+                f32 max_distance = std::numeric_limits<f32>::max()) const
+    -> void
+  {
+    const auto inverse_direction = 1.0F / direction;
+    traverse(
+      [&](const AABB& bounds) {
+        const auto t0 = (bounds.min - origin) * inverse_direction;
+        const auto t1 = (bounds.max - origin) * inverse_direction;
+        const auto slab_enter = glm::min(t0, t1);
+        const auto slab_exit = glm::max(t0, t1);
+        const auto t_enter =
+          std::max(std::max(slab_enter.x, slab_enter.y), slab_enter.z);
+        const auto t_exit =
+          std::min(std::min(slab_exit.x, slab_exit.y), slab_exit.z);
+        return t_exit >= std::max(t_enter, 0.0F) && t_enter <= max_distance;
+      },
+      std::forward<F>(callback));
+  }
+
+private:
+  struct Node
+  {
+    AABB bounds{};
+    i32 parent{ null_node };
+    i32 left{ null_node };
+    i32 right{ null_node };
+    // Leaves are at height 0, free nodes at -1.
+    i32 height{ -1 };
+    // Free list link while the node is unused.
+    i32 next{ null_node };
+    u32 user_data{ 0 };
+
+    [[nodiscard]] auto is_leaf() const -> bool { return left == null_node; }
+  };
+
+  f32 margin;
+  std::vector<Node> nodes;
+  i32 root{ null_node };
+  i32 free_list{ null_node };
+  u32 proxy_count{ 0 };
+
+  auto allocate_node() -> i32;
+  auto free_node(i32) -> void;
+  auto insert_leaf(i32) -> void;
+  auto remove_leaf(i32) -> void;
+  auto refit_upwards(i32) -> void;
+  auto balance(i32) -> i32;
+  auto node(i32 index) -> Node& { return nodes[static_cast<usize>(index)]; }
+  [[nodiscard]] auto node(i32 index) const -> const Node&
+  {
+    return nodes[static_cast<usize>(index)];
+  }
+
+  template<class Overlaps, class F>
+  auto traverse(Overlaps&& overlaps, F&& callback) const -> void
+  {
+    if (root == null_node) {
+      return;
+    }
+
+    // The tree is balanced, so the stack is never deeper than its height.
+    // The overflow vector only exists for pathological trees.
+    std::array<i32, 128> stack{};
+    std::vector<i32> overflow;
+    usize size = 0;
+    const auto push = [&](i32 index) {
+      if (size < stack.size()) {
+        stack[size++] = index;
+      } else {
+        overflow.push_back(index);
+      }
+    };
+
+    push(root);
+    while (size > 0) {
+      i32 index = null_node;
+      if (!overflow.empty()) {
+        index = overflow.back();
+        overflow.pop_back();
+      } else {
+        index = stack[--size];
+      }
+
+      const auto& current = node(index);
+      if (!overlaps(current.bounds)) {
+        continue;
+      }
+      if (current.is_leaf()) {
+        callback(current.user_data);
+      } else {
+        push(current.left);
+        push(current.right);
+      }
+    }
+  }
+};
+
+} // namespace Engine::Core
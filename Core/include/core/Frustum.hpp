@@ -0,0 +1,54 @@
+#pragma once
+
+#include "core/AABB.hpp"
+#include "core/Types.hpp"
+
+#include <array>
+#include <glm/glm.hpp>
+
+namespace Engine::Core {
+
+/// The six planes of a view projection, pointing inwards. Assumes the [0, 1]
+/// clip depth range the renderer is built with.
+struct Frustum
+{
+  std::array<glm::vec4, 6> planes{};
+
+  constexpr Frustum() = default;
+
+  explicit Frustum(const glm::mat4& view_projection)
+  {
+    const auto row = [&](Core::i32 index) {
+      return glm::vec4{
+        view_projection[0][index],
+        view_projection[1][index],
+        view_projection[2][index],
+        view_projection[3][index],
+      };
+    };
+    const auto x = row(0);
+    const auto y = row(1);
+    const auto z = row(2);
+    const auto w = row(3);
+    planes = { w + x, w - x, w + y, w - y, z, w - z };
+  }
+
+  /// Conservative: an AABB outside the frustum but across the extension of
+  /// two of its planes still counts as intersecting.
+  [[nodiscard]] auto intersects(const AABB& aabb) const -> bool
+  {
+    const auto centre = (aabb.min + aabb.max) * 0.5F;
+    const auto extents = (aabb.max - aabb.min) * 0.5F;
+    for (const auto& plane : planes) {
+      const glm::vec3 normal{ plane };
+      const auto distance = glm::dot(normal, centre) + plane.w;
+      const auto radius = glm::dot(glm::abs(normal), extents);
+      if (distance + radius < 0.0F) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+} // namespace Engine::Core
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "core/Types.hpp"
+
+#include <bit>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace Engine::Core {
+
+namespace Detail {
+constexpr u64 hash_prime_1 = 0x9E3779B185EBCA87ULL;
+constexpr u64 hash_prime_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr u64 hash_prime_3 = 0x165667B19E3779F9ULL;
+constexpr u64 hash_prime_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr u64 hash_prime_5 = 0x27D4EB2F165667C5ULL;
+
+constexpr auto
+hash_round(u64 accumulator, u64 word) -> u64
+{
+  accumulator += word * hash_prime_2;
+  return std::rotl(accumulator, 31) * hash_prime_1;
+}
+
+constexpr auto
+hash_avalanche(u64 value) -> u64
+{
+  value ^= value >> 33U;
+  value *= hash_prime_2;
+  value ^= value >> 29U;
+  value *= hash_prime_3;
+  value ^= value >> 32U;
+  return value;
+}
+
+template<class T>
+constexpr auto
+to_hash_word(const T& value) -> u64
+{
+  if constexpr (std::is_pointer_v<T>) {
+    return static_cast<u64>(std::bit_cast<std::uintptr_t>(value));
+  } else if constexpr (std::is_enum_v<T>) {
+    return static_cast<u64>(static_cast<std::underlying_type_t<T>>(value));
+  } else if constexpr (std::is_same_v<T, f32>) {
+    return std::bit_cast<u32>(value);
+  } else if constexpr (std::is_same_v<T, f64>) {
+    return std::bit_cast<u64>(value);
+  } else {
+    static_assert(std::is_integral_v<T>, "Hash words are numbers or pointers");
+    return static_cast<u64>(value);
+  }
+}
+} // namespace Detail
+
+/// XXH64 of a byte range. The result depends only on the bytes and the seed,
+/// never on addresses, so it is stable between runs and may be stored.
+auto
+hash_bytes(std::span<const byte>, u64 seed = 0) -> u64;
+
+template<class T>
+  requires std::is_trivially_copyable_v<T>
+auto
+hash_bytes(std::span<const T> values, u64 seed = 0) -> u64
+{
+  return hash_bytes(std::as_bytes(values), seed);
+}
+
+inline auto
+hash_bytes(std::string_view text, u64 seed = 0) -> u64
+{
+  return hash_bytes(std::as_bytes(std::span{ text }), seed);
+}
+
+/// Mixes one word into a running hash. Unlike the boost-style xor-shift
+/// combine, the result is fully avalanched, so it can seed a hash map or a
+/// sort key directly.
+constexpr auto
+hash_combine(u64 seed, u64 value) -> u64
+{
+  seed ^= Detail::hash_round(0, value);
+  seed = std::rotl(seed, 27) * Detail::hash_prime_1 + Detail::hash_prime_4;
+  return Detail::hash_avalanche(seed);
+}
+
+/// Hashes a fixed set of numbers, enums or pointers without building a
+/// buffer for them. Pointers hash by address, so this suits identity keys.
+template<class... T>
+constexpr auto
+hash_values(const T&... values) -> u64
+{
+  u64 seed = Detail::hash_prime_5 + sizeof...(T) * sizeof(u64);
+  ((seed = hash_combine(seed, Detail::to_hash_word(values))), ...);
+  return seed;
+}
+
+} // namespace Engine::Core
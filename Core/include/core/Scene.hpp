@@ -3,11 +3,13 @@
 #include "graphics/Forward.hpp"
 
 #include "core/Camera.hpp"
+#include "core/DynamicAABBTree.hpp"
 #include "core/Random.hpp"
 #include "core/Types.hpp"
 #include "graphics/Material.hpp"
 #include "graphics/Mesh.hpp"
 #include "graphics/ShaderBuffers.hpp"
+#include "graphics/TransformPacker.hpp"
 
 #include "thread_pool/ResultContainer.hpp"
 
@@ -47,19 +49,14 @@ struct TransformComponent
 
   [[nodiscard]] auto compute() const -> glm::mat4
   {
-    static constexpr auto identity = glm::mat4(1);
-    return glm::translate(identity, translation) * glm::mat4_cast(rotation) *
-           glm::scale(identity, scale);
+    return Graphics::TransformPacker::compose(translation, rotation, scale);
   }
 
   [[nodiscard]] auto intersects(const glm::vec3& ray,
                                 const glm::vec3& origin) const -> bool
   {
     // Transform the ray and origin to local space
-    glm::mat4 model_matrix = glm::translate(glm::mat4(1.0F), translation) *
-                             glm::mat4_cast(rotation) *
-                             glm::scale(glm::mat4(1.0F), scale);
-    glm::mat4 inv_model_matrix = glm::inverse(model_matrix);
+    glm::mat4 inv_model_matrix = glm::inverse(compute());
 
     glm::vec3 local_ray =
       glm::normalize(glm::vec3(inv_model_matrix * glm::vec4(ray, 0.0F)));
@@ -165,8 +162,13 @@ struct LightEnvironment
   glm::mat4 shadow_projection{ 1 };
   bool is_perspective{ false };
 
+  // Indexed by light slot. A light keeps its slot while it exists, so only
+  // the slots listed as dirty differ from what was uploaded last.
   std::vector<Graphics::PointLight> point_lights;
   std::vector<Graphics::SpotLight> spot_lights;
+  // Sorted and unique. The renderer clears them once uploaded.
+  std::vector<u32> dirty_point_lights;
+  std::vector<u32> dirty_spot_lights;
 };
 
 class Scene
@@ -205,6 +207,16 @@ public:
   auto find_intersected_entity(const glm::vec3&, const glm::vec3&)
     -> entt::entity;
 
+  /// Brings the entity tree up to date with every transform or mesh change
+  /// since the last call.
+  auto update_entity_tree() -> void;
+  /// World bounds of every entity with a TransformComponent. User data is the
+  /// entity id, see entt::to_integral.
+  [[nodiscard]] auto get_entity_tree() const -> const DynamicAABBTree&
+  {
+    return entity_tree;
+  }
+
 private:
   std::mutex registry_mutex;
   entt::registry registry;
@@ -213,6 +225,45 @@ private:
 
   LightEnvironment light_environment;
   std::queue<std::future<void>> scene_tasks;
+
+  // Reused every frame when submitting instances grouped by mesh.
+  std::vector<glm::mat4> instance_transforms;
+  std::vector<glm::vec4> instance_colours;
+  // Entities found by the camera and cascade queries of the entity tree,
+  // their transform components, and the transforms composed from them.
+  std::vector<entt::entity> visible_entities;
+  std::vector<glm::vec3> visible_translations;
+  std::vector<glm::quat> visible_rotations;
+  std::vector<glm::vec3> visible_scales;
+  std::vector<glm::mat4> visible_transforms;
+
+  // Kept in sync through registry signals, see update_entity_tree().
+  DynamicAABBTree entity_tree;
+  std::unordered_map<entt::entity, i32> entity_proxies;
+  std::vector<entt::entity> dirty_entities;
+
+  // The entity in every slot of one light array, and the slots whose light
+  // has to be mapped again from its components.
+  struct LightSlots
+  {
+    std::vector<entt::entity> entities;
+    std::unordered_map<entt::entity, u32> slots;
+    std::vector<u32> pending;
+  };
+  LightSlots point_light_slots;
+  LightSlots spot_light_slots;
+
+  auto mark_dirty(entt::registry&, entt::entity) -> void;
+  auto remove_from_tree(entt::registry&, entt::entity) -> void;
+
+  template<class Component>
+  auto get_light_storage();
+  template<class Component>
+  auto on_light_changed(entt::registry&, entt::entity) -> void;
+  template<class Component>
+  auto on_light_removed(entt::registry&, entt::entity) -> void;
+  template<class Component>
+  auto update_lights() -> void;
 };
 
 }
@@ -122,8 +122,15 @@ public:
                       VkImageCreateInfo&,
                       const AllocationProperties&) -> VmaAllocation;
 
+  /// Memory that images are bound into afterwards, at offsets of the
+  /// caller's choosing.
+  auto allocate_memory(const VkMemoryRequirements&,
+                       const AllocationProperties&) -> VmaAllocation;
+  void bind_image(VmaAllocation, VkDeviceSize offset, VkImage);
+
   void deallocate_buffer(VmaAllocation, VkBuffer&);
   void deallocate_image(VmaAllocation, VkImage&);
+  void deallocate_memory(VmaAllocation);
 
   static auto get_allocator() -> VmaAllocator { return allocator; }
 
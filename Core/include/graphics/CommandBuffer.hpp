@@ -4,6 +4,7 @@
 #include "graphics/Device.hpp"
 
 #include <optional>
+#include <span>
 
 #include <vulkan/vulkan.h>
 
@@ -20,12 +21,30 @@ public:
     const std::optional<Core::u32> image_count{ std::nullopt };
   };
 
+  struct SemaphoreWait
+  {
+    VkSemaphore semaphore{ nullptr };
+    VkPipelineStageFlags stages{ 0 };
+  };
+  /// Semaphores a pipelined submission waits for and signals.
+  struct Dependencies
+  {
+    std::span<const SemaphoreWait> waits{};
+    std::span<const VkSemaphore> signals{};
+  };
+
   explicit CommandBuffer(const Properties&);
   ~CommandBuffer();
 
+  /// Waits for the previous submission of this frame in flight, then starts
+  /// recording into its command buffer.
   auto begin(const VkCommandBufferBeginInfo* = nullptr) -> void;
   auto end() -> void;
+  /// Submits and waits until the GPU has executed the commands.
   auto submit() -> void;
+  /// Submits without waiting. The next begin() on this frame in flight waits
+  /// for it instead, so the resources it uses must be per frame as well.
+  auto submit_pipelined(const Dependencies&) -> void;
 
   [[nodiscard]] auto get_command_buffer() const -> VkCommandBuffer
   {
@@ -49,6 +68,7 @@ private:
   auto create_command_pool() -> void;
   auto create_command_buffers() -> void;
   auto create_fences() -> void;
+  auto queue_submit(const Dependencies&) -> void;
 
   auto destroy() -> void;
 
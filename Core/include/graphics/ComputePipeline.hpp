@@ -17,7 +17,11 @@ public:
   explicit ComputePipeline(const Configuration&);
   ~ComputePipeline() override;
 
-  auto on_resize(const Core::Extent&) -> void override;
+  [[nodiscard]] auto needs_recreation() const -> bool override
+  {
+    return false;
+  }
+  auto recreate() -> void override;
 
   auto get_pipeline() const -> VkPipeline override { return pipeline; }
   auto get_layout() const -> VkPipelineLayout override { return layout; }
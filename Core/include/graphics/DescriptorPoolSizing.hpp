@@ -0,0 +1,64 @@
+#pragma once
+
+#include "core/Types.hpp"
+
+#include <array>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Engine::Graphics {
+
+/// Descriptors of each type, and sets, that a descriptor pool was created
+/// for or that allocations took from one.
+struct DescriptorPoolUsage
+{
+  static constexpr std::array types{
+    VK_DESCRIPTOR_TYPE_SAMPLER,
+    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+    VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+    VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,
+    VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,
+    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+    VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
+  };
+
+  std::array<Core::u32, types.size()> descriptors{};
+  Core::u32 sets{ 0 };
+
+  /// One set of a layout with these bindings. Types outside `types` are
+  /// not counted.
+  static auto from_bindings(std::span<const VkDescriptorSetLayoutBinding>)
+    -> DescriptorPoolUsage;
+  /// The same count of every type, and of sets.
+  static auto uniform(Core::u32 count) -> DescriptorPoolUsage;
+
+  auto operator+=(const DescriptorPoolUsage&) -> DescriptorPoolUsage&;
+  auto operator==(const DescriptorPoolUsage&) const -> bool = default;
+  /// The larger of the two counts, type by type.
+  [[nodiscard]] static auto max(const DescriptorPoolUsage&,
+                                const DescriptorPoolUsage&)
+    -> DescriptorPoolUsage;
+
+  /// The non-zero counts, as VkDescriptorPoolCreateInfo wants them.
+  [[nodiscard]] auto to_pool_sizes() const
+    -> std::vector<VkDescriptorPoolSize>;
+};
+
+/// The pool chained behind one that could not serve `request`: twice its
+/// size, and at least large enough for the request.
+auto
+size_chained_pool(const DescriptorPoolUsage& exhausted,
+                  const DescriptorPoolUsage& request) -> DescriptorPoolUsage;
+
+/// The single pool a frame starts with: the most the frame has been seen to
+/// use plus a quarter, and never less than `minimum`.
+auto
+size_frame_pool(const DescriptorPoolUsage& peak,
+                const DescriptorPoolUsage& minimum) -> DescriptorPoolUsage;
+
+} // namespace Engine::Graphics
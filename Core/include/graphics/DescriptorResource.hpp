@@ -3,11 +3,34 @@
 #include <vulkan/vulkan.h>
 
 #include "core/Types.hpp"
+#include "graphics/DescriptorPoolSizing.hpp"
+
+#include <atomic>
 #include <mutex>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
 namespace Engine::Graphics {
 
+/// Descriptor work of one frame.
+struct DescriptorStatistics
+{
+  Core::u32 allocated_sets{ 0 };
+  Core::u32 descriptor_writes{ 0 };
+  /// Pools the frame's chain had grown to by the end of the frame.
+  Core::u32 frame_pools{ 0 };
+  /// The most pools, and sets, any frame has needed so far.
+  Core::u32 peak_frame_pools{ 0 };
+  Core::u32 peak_frame_sets{ 0 };
+  Core::u32 persistent_pools{ 0 };
+};
+
+/// Hands out descriptor sets from chains of pools: one chain per frame in
+/// flight, reset when the frame begins, and one for persistent sets. A chain
+/// grows by another pool when its pools run out, and a frame chain that had
+/// to grow is replaced by one pool sized from what the frames have used.
+/// Allocation is safe from several recording threads at once.
 class DescriptorResource
 {
 public:
@@ -17,11 +40,27 @@ public:
   DescriptorResource& operator=(const DescriptorResource&) = delete;
 
   [[nodiscard]] auto allocate_descriptor_set(
-    const VkDescriptorSetAllocateInfo& alloc_info) const -> VkDescriptorSet;
+    const VkDescriptorSetAllocateInfo& alloc_info) -> VkDescriptorSet;
   [[nodiscard]] auto allocate_many_descriptor_sets(
-    const VkDescriptorSetAllocateInfo& alloc_info) const
+    const VkDescriptorSetAllocateInfo& alloc_info)
     -> std::vector<VkDescriptorSet>;
 
+  /// Allocates from a pool that begin_frame() never resets, for sets that
+  /// are kept and rewritten across frames.
+  [[nodiscard]] auto allocate_persistent_descriptor_set(
+    const VkDescriptorSetAllocateInfo& alloc_info) -> VkDescriptorSet;
+  /// Frees a persistent set once the frame that may still use it has come
+  /// around again.
+  auto free_persistent_descriptor_set(VkDescriptorSet) -> void;
+  /// vkUpdateDescriptorSets, counted in the frame statistics.
+  auto update_descriptor_sets(std::span<const VkWriteDescriptorSet>) const
+    -> void;
+  /// The counts of the last finished frame.
+  [[nodiscard]] auto get_statistics() const -> DescriptorStatistics
+  {
+    return last_frame_statistics;
+  }
+
   void begin_frame();
   void end_frame();
 
@@ -29,26 +68,46 @@ public:
 
   static auto the() -> DescriptorResource&
   {
-    if (!instance) {
-      std::scoped_lock lock{ mutex };
-      instance = Core::Scope<DescriptorResource>{ new DescriptorResource() };
-    }
-    std::scoped_lock lock{ mutex };
-    return *instance;
+    static DescriptorResource instance;
+    return instance;
   }
 
 private:
   DescriptorResource() { create_pool(); }
 
+  struct PoolChain
+  {
+    std::mutex mutex;
+    std::vector<VkDescriptorPool> pools;
+    std::vector<DescriptorPoolUsage> capacities;
+    // Frame chains fill their pools in order and never look back.
+    Core::usize active{ 0 };
+    DescriptorPoolUsage used{};
+  };
+
   void create_pool();
-  void handle_fragmentation() const;
-  void handle_out_of_memory() const;
+  /// Appends a pool with room for `capacity` to the chain.
+  static auto create_chained_pool(PoolChain&,
+                                  const DescriptorPoolUsage& capacity,
+                                  VkDescriptorPoolCreateFlags) -> void;
+  /// Allocates the sets from the chain, growing it when its pools are out of
+  /// memory or fragmented. Returns the pool they came from, or null.
+  auto allocate_from(PoolChain&,
+                     const VkDescriptorSetAllocateInfo&,
+                     VkDescriptorSet*,
+                     bool persistent) -> VkDescriptorPool;
 
   Core::u32 current_frame{ 0 };
-  std::vector<VkDescriptorPool> descriptor_pools;
-  std::array<VkDescriptorPoolSize, 11> pool_sizes;
-  static inline std::mutex mutex{};
-  static inline Core::Scope<DescriptorResource> instance{};
+  std::vector<Core::Scope<PoolChain>> frame_chains;
+  PoolChain persistent_chain;
+  // Which persistent pool each live persistent set came from.
+  std::unordered_map<VkDescriptorSet, VkDescriptorPool> persistent_owners;
+  std::vector<std::vector<VkDescriptorSet>> pending_frees;
+  DescriptorPoolUsage peak_frame_usage{};
+  Core::u32 peak_frame_pools{ 0 };
+  mutable std::atomic<Core::u32> allocated_sets{ 0 };
+  mutable std::atomic<Core::u32> descriptor_writes{ 0 };
+  DescriptorStatistics last_frame_statistics{};
 };
 
 } // namespace Engine::Graphics
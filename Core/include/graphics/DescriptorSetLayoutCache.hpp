@@ -0,0 +1,68 @@
+#pragma once
+
+#include "core/Types.hpp"
+#include "graphics/DescriptorPoolSizing.hpp"
+
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vulkan/vulkan.h>
+
+namespace Engine::Graphics {
+
+struct DescriptorSetLayoutCacheStatistics
+{
+  Core::u32 created{ 0 };
+  Core::u32 reused{ 0 };
+  Core::u32 alive{ 0 };
+};
+
+/// Descriptor set layouts shared between shaders, keyed by their binding
+/// signature. Shaders that declare the same set get the same layout, which
+/// also makes their descriptor sets interchangeable.
+class DescriptorSetLayoutCache
+{
+public:
+  /// A layout with exactly these bindings, created on first request. Every
+  /// acquire must be matched by a release; the layout is destroyed with the
+  /// last one.
+  auto acquire(std::span<const VkDescriptorSetLayoutBinding>)
+    -> VkDescriptorSetLayout;
+  auto release(VkDescriptorSetLayout) -> void;
+
+  /// What one set of the layout takes from a descriptor pool, or nothing for
+  /// a layout the cache does not own.
+  [[nodiscard]] auto get_pool_usage(VkDescriptorSetLayout) const
+    -> DescriptorPoolUsage;
+
+  [[nodiscard]] auto get_statistics() const
+    -> DescriptorSetLayoutCacheStatistics;
+
+  static auto the() -> DescriptorSetLayoutCache&
+  {
+    static DescriptorSetLayoutCache instance;
+    return instance;
+  }
+
+private:
+  DescriptorSetLayoutCache() = default;
+
+  struct Entry
+  {
+    VkDescriptorSetLayout layout{ VK_NULL_HANDLE };
+    Core::u32 users{ 0 };
+  };
+
+  // Shared for the lookups every descriptor set allocation makes.
+  mutable std::shared_mutex mutex;
+  // Keyed by the bytes of the sorted bindings.
+  std::unordered_map<std::string, Entry> entries;
+  std::unordered_map<VkDescriptorSetLayout, std::string> signatures;
+  std::unordered_map<VkDescriptorSetLayout, DescriptorPoolUsage> pool_usages;
+  Core::u32 created{ 0 };
+  Core::u32 reused{ 0 };
+};
+
+} // namespace Engine::Graphics
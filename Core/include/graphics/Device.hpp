@@ -72,12 +72,27 @@ public:
   }
 
   auto create_secondary_command_buffer() -> VkCommandBuffer;
+  /// Shared by every pipeline created. Loaded from disk with the device and
+  /// saved when it is destroyed, so later runs skip most driver compilation.
+  auto get_pipeline_cache() const -> VkPipelineCache { return pipeline_cache; }
   auto reset_command_pools() -> void;
 
   auto supports(std::string_view extension) const -> bool
   {
     return extension_support.contains(extension.data());
   }
+  /// Whether indirect draws can take their count from a buffer, draw many
+  /// commands at once and start at any instance, as GPU-driven drawing does.
+  auto supports_gpu_driven_draws() const -> bool
+  {
+    return gpu_driven_draw_support;
+  }
+  /// Whether compute work runs on a queue family of its own, next to the
+  /// graphics queue. Images then change owner when passed between them.
+  auto has_async_compute() const -> bool
+  {
+    return get_family(QueueType::Compute) != get_family(QueueType::Graphics);
+  }
 
 private:
   auto deinitialise() -> void;
@@ -88,6 +103,8 @@ private:
 
   auto create_device(VkSurfaceKHR) -> void;
   auto is_device_suitable(VkPhysicalDevice, VkSurfaceKHR) -> bool;
+  auto create_pipeline_cache() -> void;
+  auto save_pipeline_cache() const -> void;
 
   static inline Core::Scope<Device> impl;
   static inline bool is_initialised{ false };
@@ -97,8 +114,10 @@ private:
   VkCommandPool graphics_command_pool;
   VkCommandPool transfer_command_pool;
   VkCommandPool compute_command_pool;
+  VkPipelineCache pipeline_cache{ nullptr };
 
   std::unordered_set<std::string> extension_support;
+  bool gpu_driven_draw_support{ false };
   std::unordered_map<QueueType, QueueInformation> queue_support;
 };
 
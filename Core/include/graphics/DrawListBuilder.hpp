@@ -0,0 +1,182 @@
+#pragma once
+
+#include "core/Hash.hpp"
+#include "core/Types.hpp"
+#include "graphics/Forward.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace ED {
+class ThreadPool;
+}
+
+namespace Engine::Graphics {
+struct CommandKey;
+}
+
+template<>
+struct std::hash<Engine::Graphics::CommandKey>
+{
+  auto operator()(const Engine::Graphics::CommandKey& key) const noexcept
+    -> Engine::Core::usize;
+}; // namespace std
+
+namespace Engine::Graphics {
+
+class StaticMesh;
+
+struct TransformVertexData
+{
+  std::array<glm::vec4, 3> transform_rows{};
+};
+
+struct CommandKey
+{
+  const VertexBuffer* vertex_buffer{ nullptr };
+  const IndexBuffer* index_buffer{ nullptr };
+  const Material* material{ nullptr };
+  Core::u32 submesh_index{ 0 };
+
+  auto operator<=>(const CommandKey&) const = default;
+};
+
+/// One instanced draw, produced by DrawListBuilder::build. The instances of a
+/// batch are contiguous in the transform destination given to build(),
+/// starting at first_instance.
+struct DrawBatch
+{
+  CommandKey key{};
+  const StaticMesh* static_mesh{ nullptr };
+  Core::u32 submesh_index{ 0 };
+  Core::u32 instance_count{ 0 };
+  Core::u32 first_instance{ 0 };
+};
+
+/// Collects draw submissions into flat per-thread arrays and turns them into
+/// instanced batches once per frame.
+///
+/// Submitting only appends to the bucket of the calling thread (the main
+/// thread, or a worker of the renderer thread pool), so no hashing or locking
+/// happens per submit. build() radix-sorts all submissions on a 64-bit key
+/// derived from the CommandKey, groups equal keys into DrawBatches and moves
+/// the transforms so every batch owns a contiguous range.
+class DrawListBuilder
+{
+public:
+  /// Pipeline bits of the sort key, so separate lists never interleave if
+  /// they are ever merged.
+  enum class ListType : Core::u8
+  {
+    Geometry = 0,
+    Lights = 1,
+    Shadow = 2,
+  };
+  /// Submissions can be split into layers (shadow cascades, for instance).
+  /// Batches never span layers and are ordered by layer.
+  static constexpr Core::u32 layer_count = 16;
+
+  explicit DrawListBuilder(ListType, Core::u32 bucket_count = 0);
+
+  auto submit(const CommandKey&,
+              const StaticMesh*,
+              const glm::mat4&,
+              Core::u32 user_data = 0) -> void;
+  /// Submits already packed instances that share one key. Instance i gets
+  /// first_user_data + i as its user data.
+  auto submit(const CommandKey&,
+              const StaticMesh*,
+              std::span<const TransformVertexData>,
+              Core::u32 first_user_data = 0,
+              Core::u32 layer = 0) -> void;
+
+  /// Sorts and batches every submission since the last clear(), writing the
+  /// transforms in batch order to `destination` (usually mapped GPU memory),
+  /// which must hold get_submission_count() elements. Instance indices start
+  /// at base_instance, which lets several lists share one transform buffer.
+  /// The thread pool, if given, moves the transforms of each bucket in
+  /// parallel.
+  auto build(std::span<TransformVertexData> destination,
+             Core::u32 base_instance = 0,
+             ED::ThreadPool* = nullptr) -> void;
+  auto clear() -> void;
+
+  [[nodiscard]] auto get_batches() const -> std::span<const DrawBatch>
+  {
+    return batches;
+  }
+  [[nodiscard]] auto get_batches(Core::u32 layer) const
+    -> std::span<const DrawBatch>
+  {
+    return std::span{ batches }.subspan(
+      layer_offsets[layer], layer_offsets[layer + 1] - layer_offsets[layer]);
+  }
+  /// The user data of every instance in batch order, valid after build().
+  [[nodiscard]] auto get_user_data() const -> std::span<const Core::u32>
+  {
+    return std::span{ user_data }.first(item_count);
+  }
+  /// Submissions since the last clear(), across all buckets.
+  [[nodiscard]] auto get_submission_count() const -> Core::usize;
+  [[nodiscard]] auto get_base_instance() const -> Core::u32
+  {
+    return base_instance;
+  }
+  [[nodiscard]] auto empty() const -> bool { return batches.empty(); }
+
+  static auto compute_sort_key(ListType,
+                               const CommandKey&,
+                               Core::u32 layer = 0) -> Core::u64;
+
+private:
+  struct Submission
+  {
+    CommandKey key{};
+    const StaticMesh* static_mesh{ nullptr };
+    Core::u64 sort_key{ 0 };
+    Core::u32 user_data{ 0 };
+    Core::u32 layer{ 0 };
+    TransformVertexData transform{};
+  };
+  struct SortItem
+  {
+    Core::u64 sort_key{ 0 };
+    Core::u32 submission{ 0 };
+  };
+
+  ListType list_type;
+  Core::u32 base_instance{ 0 };
+  Core::u32 item_count{ 0 };
+  std::vector<std::vector<Submission>> buckets;
+  std::vector<Core::u32> bucket_offsets;
+  std::vector<SortItem> sort_items;
+  std::vector<SortItem> sort_scratch;
+  std::vector<Core::u32> destinations;
+  std::vector<Core::u32> batch_indices;
+  std::vector<DrawBatch> batches;
+  std::array<Core::u32, layer_count + 1> layer_offsets{};
+  std::vector<Core::u32> user_data;
+
+  auto current_bucket() -> std::vector<Submission>&;
+  [[nodiscard]] auto submission_at(Core::u32) const -> const Submission&;
+  auto radix_sort() -> void;
+  auto split_colliding_batches() -> void;
+  auto compute_layer_offsets() -> void;
+};
+
+} // namespace Engine::Graphics
+
+inline auto
+std::hash<Engine::Graphics::CommandKey>::operator()(
+  const Engine::Graphics::CommandKey& key) const noexcept -> Engine::Core::usize
+{
+  return static_cast<Engine::Core::usize>(
+    Engine::Core::hash_values(key.vertex_buffer,
+                              key.index_buffer,
+                              key.material,
+                              key.submesh_index));
+}
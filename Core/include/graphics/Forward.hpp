@@ -17,6 +17,7 @@ class Renderer;
 class Shader;
 class VertexBuffer;
 class IndexBuffer;
+class StorageBuffer;
 class GraphicsPipeline;
 class Material;
 class RenderPass;
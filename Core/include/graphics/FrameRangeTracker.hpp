@@ -0,0 +1,48 @@
+#pragma once
+
+#include "core/Types.hpp"
+
+#include <vector>
+
+namespace Engine::Graphics {
+
+/// Tracks, for every frame in flight, the bytes of a per-frame buffer that
+/// are older than the CPU copy of its data.
+///
+/// A frame's buffer may only be written while that frame is recorded, so a
+/// change made during one frame reaches the buffers of the other frames when
+/// they come around again, together with their own changes.
+class FrameRangeTracker
+{
+public:
+  struct Range
+  {
+    Core::usize offset{ 0 };
+    Core::usize size{ 0 };
+
+    [[nodiscard]] auto empty() const -> bool { return size == 0; }
+    /// The smallest range covering both.
+    [[nodiscard]] auto merged(const Range&) const -> Range;
+  };
+
+  explicit FrameRangeTracker(Core::u32 frame_count);
+
+  /// Records that `changed` was modified while recording `frame`, and
+  /// returns the range to write into that frame's buffer.
+  auto update(Core::u32 frame, const Range& changed) -> Range;
+  /// Returns what the buffer of `frame` has missed, which is then assumed
+  /// written. Empty when it is up to date.
+  auto refresh(Core::u32 frame) -> Range;
+  /// Every buffer has just been written in full.
+  auto reset() -> void;
+
+  [[nodiscard]] auto get_stale(Core::u32 frame) const -> const Range&
+  {
+    return stale.at(frame);
+  }
+
+private:
+  std::vector<Range> stale;
+};
+
+} // namespace Engine::Graphics
@@ -1,8 +1,13 @@
 #pragma once
 
+#include "core/Application.hpp"
 #include "core/DataBuffer.hpp"
 #include "core/Types.hpp"
 
+#include "graphics/FrameRangeTracker.hpp"
+
+#include <bit>
+#include <cstddef>
 #include <span>
 #include <vector>
 #include <vulkan/vulkan.h>
@@ -17,6 +22,10 @@ enum class GPUBufferType : Core::u8
   Uniform,
   Storage,
   Staging,
+  // Storage written by compute, read as draw parameters.
+  Indirect,
+  // Storage written by compute, read as instance-rate vertex input.
+  Instance,
 };
 
 template<class T, GPUBufferType BufferType>
@@ -53,6 +62,17 @@ public:
   [[nodiscard]] auto get_buffer() const -> VkBuffer { return buffer; }
   auto copy_to(GPUBuffer&) -> void;
 
+  /// The persistent mapping of the allocation, or nullptr if the memory VMA
+  /// picked is not host visible.
+  [[nodiscard]] auto get_mapped_data() const -> void*;
+  /// Makes host writes through the mapping visible to the device. A no-op on
+  /// host coherent memory.
+  auto flush(Core::usize offset, Core::usize flush_size) const -> void;
+  /// Makes device writes visible through the mapping. A no-op on host
+  /// coherent memory.
+  auto invalidate(Core::usize offset, Core::usize invalidate_size) const
+    -> void;
+
   [[nodiscard]] auto get_descriptor_info() const -> const auto&
   {
     return descriptor_info;
@@ -68,7 +88,7 @@ private:
 
   VkDescriptorBufferInfo descriptor_info{};
 
-  auto write(const void*, Core::usize) -> void;
+  auto write(const void*, Core::usize, Core::usize offset = 0) -> void;
   auto construct_buffer() -> void;
   [[nodiscard]] auto buffer_usage_flags() const -> VkBufferUsageFlags;
 
@@ -178,6 +198,15 @@ public:
     buffer.write(data, size);
   }
 
+  [[nodiscard]] auto get_mapped_data() const -> void*
+  {
+    return buffer.get_mapped_data();
+  }
+  auto flush(Core::usize offset, Core::usize flush_size) const -> void
+  {
+    buffer.flush(offset, flush_size);
+  }
+
   [[nodiscard]] auto get_descriptor_info() const -> const auto&
   {
     return buffer.get_descriptor_info();
@@ -242,6 +271,12 @@ public:
   {
   }
 
+  /// A storage buffer that is also bound as `type` (Indirect or Instance).
+  StorageBuffer(const Core::usize size, GPUBufferType type)
+    : buffer(type, size)
+  {
+  }
+
   [[nodiscard]] auto size() const -> Core::usize { return buffer.get_size(); }
   [[nodiscard]] auto get_buffer() const -> VkBuffer
   {
@@ -259,6 +294,20 @@ public:
     buffer.write(data.data(), data.size_bytes());
   }
 
+  [[nodiscard]] auto get_mapped_data() const -> void*
+  {
+    return buffer.get_mapped_data();
+  }
+  auto flush(Core::usize offset, Core::usize flush_size) const -> void
+  {
+    buffer.flush(offset, flush_size);
+  }
+  auto invalidate(Core::usize offset, Core::usize invalidate_size) const
+    -> void
+  {
+    buffer.invalidate(offset, invalidate_size);
+  }
+
 private:
   GPUBuffer buffer;
 };
@@ -274,6 +323,10 @@ public:
   [[nodiscard]] virtual auto size() const -> Core::usize = 0;
 };
 
+/// Shader data with one buffer per frame in flight, so that the data of the
+/// next frame can be written while the GPU still reads the previous ones.
+/// Writes go to the current frame's buffer, and the other buffers pick them
+/// up when their frame is recorded again.
 template<class T, GPUBufferType BufferType = GPUBufferType::Uniform>
 class UniformBufferObject : public IShaderBindable
 {
@@ -283,61 +336,84 @@ public:
     : pod_data(data)
     , identifier(input_identifier)
   {
-    buffer = Core::make_scope<GPUBuffer>(BufferType, sizeof(T));
-    buffer->write(&pod_data, sizeof(T));
+    create_buffers(sizeof(T));
+    for (auto& buffer : buffers) {
+      buffer->write(&pod_data, sizeof(T));
+    }
   }
 
   UniformBufferObject()
     : identifier(T::name)
   {
-    buffer = Core::make_scope<GPUBuffer>(BufferType, sizeof(T));
-    buffer->write(&pod_data, sizeof(T));
+    create_buffers(sizeof(T));
+    for (auto& buffer : buffers) {
+      buffer->write(&pod_data, sizeof(T));
+    }
   }
 
   explicit UniformBufferObject(Core::usize size,
                                const std::string_view input_identifier)
     : identifier(input_identifier)
   {
-    buffer = Core::make_scope<GPUBuffer>(BufferType, size);
-    Core::DataBuffer zero{ size };
-    zero.fill_zero();
-    buffer->write(zero.raw(), size);
+    resize(size);
   }
 
   ~UniformBufferObject() override = default;
 
+  /// Replaces every frame's buffer with a zeroed one. The GPU must not be
+  /// using any of them.
   auto resize(Core::usize new_size) -> void
   {
-    buffer = Core::make_scope<GPUBuffer>(BufferType, new_size);
+    create_buffers(new_size);
     Core::DataBuffer zero{ new_size };
     zero.fill_zero();
-    buffer->write(zero.raw(), new_size);
+    for (auto& buffer : buffers) {
+      buffer->write(zero.raw(), new_size);
+    }
   }
 
   [[nodiscard]] auto size() const -> Core::usize override
   {
-    return buffer->get_size();
+    return current()->get_size();
   }
   [[nodiscard]] auto get_buffer() const -> VkBuffer override
   {
-    return buffer->get_buffer();
+    return current()->get_buffer();
   }
 
-  auto update(const T& data) -> void { buffer->write(&data, sizeof(T)); }
-  auto update() -> void { buffer->write(&pod_data, sizeof(T)); }
-
-  template<typename U>
-  void write(std::span<U> data)
+  auto update(const T& data) -> void
+  {
+    pod_data = data;
+    update();
+  }
+  auto update() -> void { update(0, sizeof(T)); }
+  /// Uploads only `range_size` bytes of the data, starting at `offset`, and
+  /// whatever this frame's buffer missed since it was last written.
+  auto update(Core::usize offset, Core::usize range_size) -> void
+  {
+    write_range(stale_ranges.update(current_frame(), { offset, range_size }));
+  }
+  /// Uploads what this frame's buffer missed while other frames were
+  /// updated, for data that is not updated every frame.
+  auto refresh() -> void
   {
-    buffer->write(data.data(), data.size_bytes());
+    write_range(stale_ranges.refresh(current_frame()));
   }
+  /// Byte offset of a subobject of the data, for the ranged update().
+  template<class U>
+  [[nodiscard]] auto offset_of(const U& member) const -> Core::usize
+  {
+    return static_cast<Core::usize>(std::bit_cast<const std::byte*>(&member) -
+                                    std::bit_cast<const std::byte*>(&pod_data));
+  }
+
   auto get_data() const -> const T& { return pod_data; }
   auto get_data() -> T& { return pod_data; }
 
   [[nodiscard]] auto get_descriptor_info() const
     -> const VkDescriptorBufferInfo& override
   {
-    return buffer->get_descriptor_info();
+    return current()->get_descriptor_info();
   }
 
   [[nodiscard]] auto get_name() const -> const std::string& override
@@ -347,8 +423,37 @@ public:
 
 private:
   T pod_data{};
-  Core::Scope<GPUBuffer> buffer;
+  std::vector<Core::Scope<GPUBuffer>> buffers;
+  FrameRangeTracker stale_ranges{ 1 };
   std::string identifier;
+
+  static auto current_frame() -> Core::u32
+  {
+    return Core::Application::the().current_frame_index();
+  }
+  [[nodiscard]] auto current() const -> const Core::Scope<GPUBuffer>&
+  {
+    return buffers.at(current_frame());
+  }
+
+  auto create_buffers(Core::usize buffer_size) -> void
+  {
+    const auto frame_count = Core::Application::the().get_image_count();
+    buffers.clear();
+    for (auto i = 0U; i < frame_count; i++) {
+      buffers.push_back(Core::make_scope<GPUBuffer>(BufferType, buffer_size));
+    }
+    stale_ranges = FrameRangeTracker{ frame_count };
+  }
+
+  auto write_range(const FrameRangeTracker::Range& range) -> void
+  {
+    if (range.empty()) {
+      return;
+    }
+    const auto* bytes = std::bit_cast<const std::byte*>(&pod_data);
+    current()->write(bytes + range.offset, range.size, range.offset);
+  }
 };
 
 } // namespace Engine::Graphics
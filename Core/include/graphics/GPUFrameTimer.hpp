@@ -0,0 +1,44 @@
+#pragma once
+
+#include "core/Types.hpp"
+
+#include "graphics/Forward.hpp"
+
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Engine::Graphics {
+
+/// Measures the GPU time of the work between begin() and end() for every
+/// frame in flight, with a pair of timestamps per frame.
+///
+/// The timestamps are read when the frame comes around again, after its
+/// previous submission has been waited for, so reading never stalls and
+/// the time reported is frame_count frames old.
+class GPUFrameTimer
+{
+public:
+  explicit GPUFrameTimer(Core::u32 frame_count);
+  ~GPUFrameTimer();
+
+  GPUFrameTimer(const GPUFrameTimer&) = delete;
+  auto operator=(const GPUFrameTimer&) -> GPUFrameTimer& = delete;
+
+  /// Reads the time of the previous use of `frame`, then resets its queries
+  /// and writes the first timestamp. Must be recorded outside a render pass.
+  auto begin(const CommandBuffer&, Core::u32 frame) -> void;
+  /// Writes the second timestamp once all earlier commands have completed.
+  auto end(const CommandBuffer&) -> void;
+
+  /// Milliseconds between the timestamps of the last frame read back.
+  [[nodiscard]] auto get_time() const -> Core::f64 { return time; }
+
+private:
+  VkQueryPool query_pool{ nullptr };
+  Core::f64 nanoseconds_per_tick{ 0.0 };
+  std::vector<bool> written;
+  Core::u32 current_frame{ 0 };
+  Core::f64 time{ 0.0 };
+};
+
+} // namespace Engine::Graphics
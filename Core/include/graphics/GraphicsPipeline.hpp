@@ -38,7 +38,8 @@ public:
   explicit GraphicsPipeline(const Configuration&);
   ~GraphicsPipeline() override;
 
-  auto on_resize(const Core::Extent&) -> void override;
+  [[nodiscard]] auto needs_recreation() const -> bool override;
+  auto recreate() -> void override;
 
   [[nodiscard]] auto get_pipeline() const -> VkPipeline override
   {
@@ -70,6 +71,19 @@ private:
   const IFramebuffer* framebuffer{ nullptr };
   const Shader* shader{ nullptr };
 
+  // What the pipeline's render pass compatibility depends on, as it was when
+  // the pipeline was created.
+  struct AttachmentState
+  {
+    VkFormat format{ VK_FORMAT_UNDEFINED };
+    VkSampleCountFlagBits samples{ VK_SAMPLE_COUNT_1_BIT };
+
+    auto operator==(const AttachmentState&) const -> bool = default;
+  };
+  std::vector<AttachmentState> baked_attachments;
+  [[nodiscard]] auto get_attachment_states() const
+    -> std::vector<AttachmentState>;
+
   auto create_pipeline() -> void;
   auto create_layout() -> void;
   auto destroy() -> void;
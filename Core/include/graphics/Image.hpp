@@ -151,6 +151,7 @@ create_sampler(VkFilter,
                Core::u32 mips = 1) -> VkSampler;
 
 struct ImageImpl;
+class TransientImageMemory;
 class Image
 {
 public:
@@ -166,6 +167,10 @@ public:
 
   std::optional<Core::usize> hash_value{ std::nullopt };
 
+  // Set when the image lives in memory shared with other transients.
+  const TransientImageMemory* transient_memory{ nullptr };
+  VkDeviceSize transient_offset{ 0 };
+
   bool destroyed{ false };
 
   ~Image();
@@ -222,6 +227,11 @@ public:
     -> void;
   auto invalidate() -> void;
   auto generate_mips(VkCommandBuffer) -> void;
+  /// From the next invalidate() on, the image is created in `memory` at
+  /// `offset`, or in memory of its own again when `memory` is null.
+  auto place_in(const TransientImageMemory* memory, VkDeviceSize offset)
+    -> void;
+  [[nodiscard]] auto get_memory_requirements() const -> VkMemoryRequirements;
 
   [[nodiscard]] auto get_mip_levels() const { return configuration.mip_levels; }
   [[nodiscard]] auto get_sample_count() const
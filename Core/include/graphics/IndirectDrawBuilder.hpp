@@ -0,0 +1,133 @@
+#pragma once
+
+#include "core/AABB.hpp"
+#include "core/Types.hpp"
+#include "graphics/DrawListBuilder.hpp"
+
+#include <array>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Engine::Graphics {
+
+/// One submesh drawn by the GPU-driven path, as instance_culling.comp reads
+/// it (std430).
+struct IndirectDrawData
+{
+  glm::vec4 bounds_min{ 0.0F };
+  glm::vec4 bounds_max{ 0.0F };
+  /// Slot of the draw's command within a view.
+  Core::u32 command{ 0 };
+  Core::u32 group{ 0 };
+  /// First compacted command slot of the group, within a view.
+  Core::u32 group_first_command{ 0 };
+  /// First transform slot of the draw's visible instances, within a view.
+  Core::u32 instance_offset{ 0 };
+};
+static_assert(sizeof(IndirectDrawData) == 48);
+
+/// One instance to cull, as instance_culling.comp reads it (std430).
+struct IndirectInstanceData
+{
+  TransformVertexData transform{};
+  Core::u32 draw{ 0 };
+  std::array<Core::u32, 3> padding{};
+};
+static_assert(sizeof(IndirectInstanceData) == 64);
+
+/// Consecutive commands sharing vertex, index buffer and material, which the
+/// passes bind once and draw with one indirect count call.
+struct IndirectDrawGroup
+{
+  CommandKey key{};
+  const StaticMesh* static_mesh{ nullptr };
+  /// The submesh of the group's first draw, for its material.
+  Core::u32 submesh_index{ 0 };
+  Core::u32 first_command{ 0 };
+  Core::u32 command_count{ 0 };
+};
+
+/// Lays out a frame of GPU-driven draws. Every submitted submesh becomes one
+/// draw with a command slot in each view (the camera, then every shadow
+/// cascade). Commands are ordered by material and mesh, as the draw lists
+/// batch them, and neighbours with the same buffers and material form a
+/// group.
+///
+/// The culling shader counts every visible instance into its view's command,
+/// writing its transform to the command's range of the instance output, and
+/// then compacts the commands that drew anything to the front of their
+/// group, counting them per view and group. Every view has room for every
+/// instance, so the output holds view_count times the instances.
+class IndirectDrawBuilder
+{
+public:
+  static constexpr Core::u32 cascade_count = 10;
+  static constexpr Core::u32 view_count = cascade_count + 1;
+
+  /// Submits the packed instances of one submesh. Only the index range and
+  /// vertex offset of the command are used.
+  auto submit(const CommandKey&,
+              const StaticMesh*,
+              const Core::AABB& local_bounds,
+              const VkDrawIndexedIndirectCommand& command,
+              std::span<const TransformVertexData> transforms) -> void;
+
+  /// Orders the commands, forms the groups and fills in the draws.
+  auto build() -> void;
+  auto clear() -> void;
+
+  /// The commands of every view, with no instances yet, and the first
+  /// instance of each at its output range.
+  auto write_commands(std::span<VkDrawIndexedIndirectCommand>) const -> void;
+
+  /// Visible instances per view, from the commands of a culled frame.
+  static auto count_visible(std::span<const VkDrawIndexedIndirectCommand>,
+                            Core::u32 draw_count)
+    -> std::array<Core::u32, view_count>;
+
+  [[nodiscard]] auto get_draws() const -> std::span<const IndirectDrawData>
+  {
+    return draws;
+  }
+  [[nodiscard]] auto get_instances() const
+    -> std::span<const IndirectInstanceData>
+  {
+    return instances;
+  }
+  [[nodiscard]] auto get_groups() const -> std::span<const IndirectDrawGroup>
+  {
+    return groups;
+  }
+  [[nodiscard]] auto get_draw_count() const -> Core::u32
+  {
+    return static_cast<Core::u32>(draws.size());
+  }
+  [[nodiscard]] auto get_instance_count() const -> Core::u32
+  {
+    return static_cast<Core::u32>(instances.size());
+  }
+  [[nodiscard]] auto get_group_count() const -> Core::u32
+  {
+    return static_cast<Core::u32>(groups.size());
+  }
+  [[nodiscard]] auto empty() const -> bool { return draws.empty(); }
+
+private:
+  struct Submission
+  {
+    CommandKey key{};
+    const StaticMesh* static_mesh{ nullptr };
+    VkDrawIndexedIndirectCommand command{};
+    Core::u64 sort_key{ 0 };
+  };
+
+  std::vector<Submission> submissions;
+  std::vector<IndirectDrawData> draws;
+  std::vector<IndirectInstanceData> instances;
+  std::vector<IndirectDrawGroup> groups;
+  // Draw of every command slot.
+  std::vector<Core::u32> command_draws;
+};
+
+} // namespace Engine::Graphics
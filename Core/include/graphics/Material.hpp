@@ -4,6 +4,7 @@
 #include "core/Types.hpp"
 
 #include "graphics/Image.hpp"
+#include "graphics/PersistentDescriptorSet.hpp"
 #include "graphics/Shader.hpp"
 
 #include "reflection/ReflectionData.hpp"
@@ -45,11 +46,25 @@ public:
     set(name, &padded, sizeof(padded));
   }
 
-  auto get_descriptor_set() -> decltype(auto) { return descriptor_sets.get(); }
-
   [[nodiscard]] auto get_shader() const -> const auto* { return shader; }
+
+  /// Enables or disables a shader variant key. Passes that draw with
+  /// ShaderPermutations use the variant compiled for the enabled keys.
+  auto set_variant(std::string_view key, bool enabled) -> void;
+  /// The enabled variant keys, sorted.
+  [[nodiscard]] auto get_variants() const -> const auto& { return variants; }
+  /// Writes the material's bindings into another set. Into this frame's
+  /// renderer set of the material, only changed bindings are written.
   auto update_descriptor_write_sets(VkDescriptorSet) -> void;
+  /// Returns this frame's material set (set 1), writing only the bindings
+  /// that changed since it was last used.
   auto generate_and_update_descriptor_write_sets() -> VkDescriptorSet;
+  /// The renderer-global set (set 0) this material draws with, filled by
+  /// Renderer::generate_and_update_descriptor_write_sets.
+  auto get_renderer_descriptor_set() -> PersistentDescriptorSet&
+  {
+    return renderer_descriptor_set;
+  }
 
   [[nodiscard]] auto get_constant_buffer() const -> const auto&
   {
@@ -70,15 +85,20 @@ private:
   const Shader* shader{ nullptr };
   std::unordered_map<std::string, Core::Ref<Image>> images{};
   std::unordered_map<std::string, const StorageBuffer*> storage_buffers;
+  std::vector<std::string> variants{};
 
   Core::FrameBasedCollection<
     std::unordered_map<Core::u32, VkWriteDescriptorSet>>
     write_descriptors;
-  Core::FrameBasedCollection<Reflection::MaterialDescriptorSet> descriptor_sets;
+  PersistentDescriptorSet material_descriptor_set;
+  PersistentDescriptorSet renderer_descriptor_set;
+  std::vector<VkWriteDescriptorSet> flattened_writes{};
 
   Core::DataBuffer uniform_storage;
 
   auto set(std::string_view, const void*, Core::usize) -> void;
+  auto mark_dirty(Core::u32 binding) -> void;
+  auto flatten_writes() -> std::span<const VkWriteDescriptorSet>;
   [[nodiscard]] auto find_resource_by_name(std::string_view) const
     -> const Reflection::ShaderResourceDeclaration*;
 };
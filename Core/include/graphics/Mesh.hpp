@@ -3,6 +3,7 @@
 #include "core/AABB.hpp"
 #include "core/Types.hpp"
 #include "graphics/Material.hpp"
+#include "graphics/MeshData.hpp"
 #include "graphics/Vertex.hpp"
 
 #include "thread_pool/CommandBufferDispatcher.hpp"
@@ -20,63 +21,41 @@ class Importer;
 
 namespace Engine::Graphics {
 
-enum class TextureType : Core::u8
-{
-  Albedo,
-  Normal,
-  Specular,
-  Roughness,
-};
+class CookedMesh;
+struct ImportedMesh;
 
-struct Index
+/// How the textures of a MeshAsset were loaded. Decode time is summed over
+/// the worker threads, so it can exceed the wall time.
+struct TextureLoadStatistics
 {
-  Core::u32 V1, V2, V3;
-};
-
-static_assert(sizeof(Index) == 3 * sizeof(Core::u32));
-
-struct Triangle
-{
-  Vertex V0{};
-  Vertex V1{};
-  Vertex V2{};
-
-  Triangle(const Vertex& v0, const Vertex& v1, const Vertex& v2)
-    : V0(v0)
-    , V1(v1)
-    , V2(v2)
-  {
-  }
-};
-
-class Submesh
-{
-public:
-  Core::u32 base_vertex;
-  Core::u32 base_index;
-  Core::u32 material_index;
-  Core::u32 index_count;
-  Core::u32 vertex_count;
-
-  glm::mat4 transform{ 1.0F };
-  glm::mat4 local_transform{ 1.0F };
-  Core::AABB bounding_box;
-
-  std::string node_name;
-  std::string mesh_name;
+  Core::u32 texture_count{ 0 };
+  Core::u32 shared_texture_count{ 0 };
+  Core::u32 upload_batch_count{ 0 };
+  Core::usize peak_staging_bytes{ 0 };
+  Core::f64 decode_ms{ 0.0 };
+  Core::f64 upload_ms{ 0.0 };
+  Core::f64 wall_ms{ 0.0 };
 };
 
 class MeshAsset
 {
 public:
+  /// Loads the cooked file of the model if it is up to date, and otherwise
+  /// imports the model with Assimp and cooks it for the next load.
   explicit MeshAsset(const std::string&);
   ~MeshAsset();
 
   [[nodiscard]] auto get_submeshes() -> auto& { return submeshes; }
   [[nodiscard]] auto get_submeshes() const -> const auto& { return submeshes; }
 
-  [[nodiscard]] auto get_vertices() const -> const auto& { return vertices; }
-  [[nodiscard]] auto get_indices() const -> const auto& { return indices; }
+  [[nodiscard]] auto get_vertices() const -> std::span<const Vertex>
+  {
+    return vertices;
+  }
+  [[nodiscard]] auto get_indices() const -> std::span<const Index>
+  {
+    return indices;
+  }
 
   [[nodiscard]] auto get_materials() -> auto& { return materials; }
   [[nodiscard]] auto get_materials() const -> const auto& { return materials; }
@@ -85,9 +64,10 @@ public:
     return file_path;
   }
 
-  [[nodiscard]] auto get_triangle_cache(Core::u32 index) const -> const auto&
+  /// The triangles of a submesh, read from the vertex and index arrays.
+  [[nodiscard]] auto get_triangles(Core::u32 submesh) const -> SubmeshTriangles
   {
-    return triangle_cache.at(index);
+    return { vertices, indices, submeshes.at(submesh) };
   }
 
   [[nodiscard]] auto get_vertex_buffer() const -> const auto&
@@ -103,27 +83,28 @@ public:
   {
     return bounding_box;
   }
+  [[nodiscard]] auto get_texture_load_statistics() const
+    -> const TextureLoadStatistics&
+  {
+    return texture_load_statistics;
+  }
 
 private:
-  void traverse_nodes(aiNode*,
-                      const glm::mat4& = glm::mat4(1.0F),
-                      Core::u32 = 0);
-
   std::vector<Submesh> submeshes;
 
-  Core::Scope<Assimp::Importer> importer;
+  // Exactly one of them holds the geometry.
+  Core::Scope<ImportedMesh> imported_mesh;
+  Core::Scope<CookedMesh> cooked_mesh;
 
   Core::Scope<VertexBuffer> vertex_buffer;
   Core::Scope<IndexBuffer> index_buffer;
   Core::Scope<Shader> deferred_pbr_shader;
 
-  std::vector<Vertex> vertices;
-  std::vector<Index> indices;
-  std::unordered_map<aiNode*, std::vector<Core::u32>> ai_node_map;
-  const aiScene* ai_scene;
+  // Views into the imported or cooked mesh.
+  std::span<const Vertex> vertices;
+  std::span<const Index> indices;
 
   std::vector<Core::Scope<Material>> materials;
-  std::unordered_map<Core::u32, std::vector<Triangle>> triangle_cache;
 
   Core::AABB bounding_box;
 
@@ -131,7 +112,7 @@ private:
 
   Core::Scope<CommandBuffer> command_buffer;
   ED::CommandBufferDispatcher dispatcher;
-  std::mutex mutex;
+  TextureLoadStatistics texture_load_statistics{};
   std::unordered_map<Core::u32,
                      std::unordered_map<TextureType, Core::Ref<Image>>>
     output_images;
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "core/Types.hpp"
+#include "graphics/MeshData.hpp"
+
+#include <filesystem>
+#include <optional>
+#include <span>
+
+namespace ED::Platform {
+class MappedFile;
+}
+
+namespace Engine::Graphics {
+
+/// A mesh read from a cooked file. The vertices and indices of its MeshData
+/// point into the file mapping, which lives as long as the CookedMesh.
+class CookedMesh
+{
+public:
+  ~CookedMesh();
+
+  [[nodiscard]] auto get_data() const -> const MeshData& { return data; }
+
+private:
+  CookedMesh(Core::Scope<ED::Platform::MappedFile>, MeshData);
+
+  Core::Scope<ED::Platform::MappedFile> file;
+  MeshData data;
+
+  friend class MeshCooker;
+};
+
+/// Reads and writes cooked meshes: a versioned binary file with the final
+/// vertex and index arrays, the submesh table (node transforms and bounds
+/// included) and the material texture references of a model file.
+///
+/// A cooked file stores a hash of the contents of the file it was cooked
+/// from, and of every file that one references, and is only loaded while all
+/// of them still match, so editing the source or e.g. a glTF's external
+/// buffer invalidates it.
+class MeshCooker
+{
+public:
+  // 2: the mesh bounds enclose every corner of the transformed submeshes.
+  // 3: the files the source references are recorded with their hashes.
+  static constexpr Core::u32 format_version = 3;
+
+  /// Where the cooked file of a model file lives: next to it, with
+  /// ".astmesh" appended.
+  static auto get_cooked_path(const std::filesystem::path& source)
+    -> std::filesystem::path;
+  /// A 64-bit hash of the contents of a file, or nothing if it cannot be
+  /// read.
+  static auto hash_file(const std::filesystem::path&)
+    -> std::optional<Core::u64>;
+  static auto hash(std::span<const std::byte>) -> Core::u64;
+
+  /// Writes to a temporary file first and renames it into place, so a
+  /// cooked file is never seen half written. The dependencies are hashed
+  /// now and stored relative to the cooked file, and must be readable.
+  static auto write(const std::filesystem::path&,
+                    Core::u64 source_hash,
+                    const MeshData&,
+                    std::span<const std::filesystem::path> dependencies = {})
+    -> bool;
+  /// Returns nullptr if the file does not exist, was cooked from other
+  /// source contents or by another format version, if a dependency changed
+  /// or is gone, or if it is malformed.
+  static auto load(const std::filesystem::path&, Core::u64 source_hash)
+    -> Core::Scope<CookedMesh>;
+};
+
+} // namespace Engine::Graphics
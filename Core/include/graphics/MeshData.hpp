@@ -0,0 +1,157 @@
+#pragma once
+
+#include "core/AABB.hpp"
+#include "core/Types.hpp"
+#include "graphics/Vertex.hpp"
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <glm/glm.hpp>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Engine::Graphics {
+
+enum class TextureType : Core::u8
+{
+  Albedo,
+  Normal,
+  Specular,
+  Roughness,
+};
+static constexpr Core::usize texture_type_count = 4;
+
+struct Index
+{
+  Core::u32 V1, V2, V3;
+};
+
+static_assert(sizeof(Index) == 3 * sizeof(Core::u32));
+
+class Submesh
+{
+public:
+  Core::u32 base_vertex;
+  Core::u32 base_index;
+  Core::u32 material_index;
+  Core::u32 index_count;
+  Core::u32 vertex_count;
+
+  glm::mat4 transform{ 1.0F };
+  glm::mat4 local_transform{ 1.0F };
+  Core::AABB bounding_box;
+
+  std::string node_name;
+  std::string mesh_name;
+};
+
+/// The positions of one triangle of a mesh, for CPU side queries.
+struct Triangle
+{
+  glm::vec3 V0;
+  glm::vec3 V1;
+  glm::vec3 V2;
+};
+
+/// The triangles of one submesh. Nothing is copied: each triangle is read
+/// from the shared vertex and index arrays of the mesh when accessed, so the
+/// arrays must outlive this view.
+class SubmeshTriangles
+{
+public:
+  class Iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Triangle;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() = default;
+    Iterator(const SubmeshTriangles* owner, Core::usize position)
+      : triangles(owner)
+      , index(position)
+    {
+    }
+
+    auto operator*() const -> Triangle { return (*triangles)[index]; }
+    auto operator++() -> Iterator&
+    {
+      index++;
+      return *this;
+    }
+    auto operator++(int) -> Iterator
+    {
+      auto copy = *this;
+      index++;
+      return copy;
+    }
+    auto operator==(const Iterator& other) const -> bool
+    {
+      return index == other.index;
+    }
+
+  private:
+    const SubmeshTriangles* triangles{ nullptr };
+    Core::usize index{ 0 };
+  };
+
+  SubmeshTriangles(std::span<const Vertex> mesh_vertices,
+                   std::span<const Index> mesh_indices,
+                   const Submesh& submesh)
+    : vertices(mesh_vertices.subspan(submesh.base_vertex))
+    , indices(mesh_indices.subspan(submesh.base_index / 3,
+                                   submesh.index_count / 3))
+  {
+  }
+
+  [[nodiscard]] auto size() const -> Core::usize { return indices.size(); }
+  [[nodiscard]] auto empty() const -> bool { return indices.empty(); }
+  [[nodiscard]] auto operator[](Core::usize index) const -> Triangle
+  {
+    const auto& face = indices[index];
+    return {
+      vertices[face.V1].position,
+      vertices[face.V2].position,
+      vertices[face.V3].position,
+    };
+  }
+
+  [[nodiscard]] auto begin() const -> Iterator { return { this, 0 }; }
+  [[nodiscard]] auto end() const -> Iterator { return { this, size() }; }
+
+private:
+  std::span<const Vertex> vertices;
+  std::span<const Index> indices;
+};
+
+/// What one material of a model file asks for. Texture paths are relative to
+/// the model file or name an embedded texture, and are empty for maps the
+/// material does not have.
+struct MaterialDescription
+{
+  Core::f32 shininess{ 80.0F };
+  Core::f32 reflectivity{ 0.0F };
+  std::array<std::string, texture_type_count> texture_paths{};
+
+  [[nodiscard]] auto get_texture_path(TextureType type) const
+    -> const std::string&
+  {
+    return texture_paths.at(static_cast<Core::usize>(type));
+  }
+};
+
+/// The geometry and materials of a model file, in the layout MeshAsset
+/// uploads. Vertices and indices are views, owned by whoever produced the
+/// MeshData (an Assimp import or a mapped cooked file).
+struct MeshData
+{
+  std::span<const Vertex> vertices;
+  std::span<const Index> indices;
+  std::vector<Submesh> submeshes;
+  std::vector<MaterialDescription> materials;
+  Core::AABB bounding_box;
+};
+
+} // namespace Engine::Graphics
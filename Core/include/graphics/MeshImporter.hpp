@@ -0,0 +1,46 @@
+#pragma once
+
+#include "core/Types.hpp"
+#include "graphics/MeshData.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct aiScene;
+
+namespace Assimp {
+class Importer;
+}
+
+namespace Engine::Graphics {
+
+/// The result of importing a model file with Assimp. The scene is kept alive
+/// for the embedded textures it owns. `data` views `vertices` and `indices`.
+struct ImportedMesh
+{
+  Core::Scope<Assimp::Importer> importer;
+  const aiScene* scene{ nullptr };
+  std::vector<Vertex> vertices;
+  std::vector<Index> indices;
+  MeshData data;
+  bool has_embedded_textures{ false };
+  /// Every file besides the model file that Assimp read, such as the
+  /// external buffers of a glTF or the material library of an OBJ.
+  std::vector<std::filesystem::path> dependencies;
+
+  ImportedMesh();
+  ~ImportedMesh();
+  ImportedMesh(const ImportedMesh&) = delete;
+  auto operator=(const ImportedMesh&) -> ImportedMesh& = delete;
+};
+
+class MeshImporter
+{
+public:
+  /// Reads a model file and converts it to the vertex and index layout the
+  /// renderer uses, or returns nullptr if Assimp cannot read it.
+  static auto import(const std::string&) -> Core::Scope<ImportedMesh>;
+};
+
+} // namespace Engine::Graphics
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "core/Types.hpp"
+
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Engine::Graphics {
+
+/// Remembers what was last written to each binding of one descriptor set and
+/// reports, as a bitmask over binding numbers, which bindings a list of writes
+/// would change. Bindings from 63 upwards share the top bit.
+class DescriptorBindingTracker
+{
+public:
+  static constexpr Core::u64 all_bindings = ~Core::u64{ 0 };
+
+  static constexpr auto binding_bit(Core::u32 binding) -> Core::u64
+  {
+    return Core::u64{ 1 } << (binding < 63 ? binding : 63);
+  }
+
+  /// Forces the binding to count as changed on the next track().
+  auto mark_dirty(Core::u32 binding) -> void { dirty |= binding_bit(binding); }
+  /// Forgets everything written, for a freshly allocated set.
+  auto reset() -> void;
+
+  /// Compares the writes with what was last recorded for their bindings and
+  /// returns the dirty bindings among them. Their new contents are recorded,
+  /// and their dirty bits cleared, on the assumption that the caller writes
+  /// them right away.
+  auto track(std::span<const VkWriteDescriptorSet>) -> Core::u64;
+
+private:
+  // What a write points at, copied. Resources such as framebuffer
+  // attachments are recreated behind the same pointer on resize, so the
+  // pointers alone say nothing.
+  struct WrittenDescriptor
+  {
+    Core::u32 binding{ 0 };
+    Core::u32 array_element{ 0 };
+    VkDescriptorType type{};
+    VkDescriptorImageInfo image{};
+    VkDescriptorBufferInfo buffer{};
+  };
+
+  Core::u64 dirty{ all_bindings };
+  std::vector<WrittenDescriptor> written{};
+};
+
+/// One descriptor set per frame in flight, allocated once and kept across
+/// frames. update() writes only the bindings whose resource changed since
+/// that frame's set was last written, so an unchanged set costs no
+/// allocation and no vkUpdateDescriptorSets.
+class PersistentDescriptorSet
+{
+public:
+  PersistentDescriptorSet();
+  ~PersistentDescriptorSet();
+
+  PersistentDescriptorSet(const PersistentDescriptorSet&) = delete;
+  auto operator=(const PersistentDescriptorSet&)
+    -> PersistentDescriptorSet& = delete;
+  PersistentDescriptorSet(PersistentDescriptorSet&&) = delete;
+  auto operator=(PersistentDescriptorSet&&)
+    -> PersistentDescriptorSet& = delete;
+
+  /// Rewrites the binding in every frame's set on its next update().
+  auto mark_dirty(Core::u32 binding) -> void;
+
+  /// Returns this frame's set, allocated with the layout on first use or
+  /// when the layout changes, after writing the dirty bindings among the
+  /// writes. The writes' dstSet is ignored. Several calls per frame may
+  /// cover different bindings of the same set.
+  auto update(VkDescriptorSetLayout, std::span<const VkWriteDescriptorSet>)
+    -> VkDescriptorSet;
+  /// This frame's set, or null before the first update().
+  [[nodiscard]] auto get() const -> VkDescriptorSet;
+
+private:
+  struct Frame
+  {
+    VkDescriptorSet set{ nullptr };
+    VkDescriptorSetLayout layout{ nullptr };
+    DescriptorBindingTracker tracker{};
+  };
+  std::vector<Frame> frames{};
+  std::vector<VkWriteDescriptorSet> pending_writes{};
+};
+
+} // namespace Engine::Graphics
@@ -10,7 +10,12 @@ struct IPipeline
 {
   virtual ~IPipeline() = default;
 
-  virtual auto on_resize(const Core::Extent&) -> void = 0;
+  /// Whether state baked into the pipeline, such as the formats and sample
+  /// counts of the attachments it draws into, no longer matches. Viewport
+  /// and scissor are dynamic, so a new size alone never changes it.
+  [[nodiscard]] virtual auto needs_recreation() const -> bool = 0;
+  /// Safe from workers, one pipeline per worker.
+  virtual auto recreate() -> void = 0;
   virtual auto get_pipeline() const -> VkPipeline = 0;
   virtual auto get_layout() const -> VkPipelineLayout = 0;
   virtual auto get_bind_point () const -> VkPipelineBindPoint = 0;
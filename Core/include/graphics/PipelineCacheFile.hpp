@@ -0,0 +1,45 @@
+#pragma once
+
+#include "core/Types.hpp"
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Engine::Graphics {
+
+/// Reads and writes the contents of a VkPipelineCache, so pipelines compiled
+/// in one run are not compiled again in the next.
+///
+/// The data starts with the header Vulkan defines, naming the vendor, device
+/// and driver (by its pipeline cache UUID) that wrote it. Data written by
+/// anything else is not loaded, as drivers are not all trusted to reject it.
+class PipelineCacheFile
+{
+public:
+  struct DeviceIdentity
+  {
+    Core::u32 vendor_id{ 0 };
+    Core::u32 device_id{ 0 };
+    std::array<Core::u8, VK_UUID_SIZE> cache_uuid{};
+  };
+
+  static auto get_identity(const VkPhysicalDeviceProperties&)
+    -> DeviceIdentity;
+
+  /// Whether the data has a version one header written by this device.
+  static auto is_compatible(std::span<const std::byte> data,
+                            const DeviceIdentity&) -> bool;
+  /// Empty if the file does not exist, cannot be read or is not compatible.
+  static auto read(const std::filesystem::path&, const DeviceIdentity&)
+    -> std::vector<std::byte>;
+  /// Writes to a temporary file first and renames it into place, so the
+  /// file is never seen half written.
+  static auto write(const std::filesystem::path&, std::span<const std::byte>)
+    -> bool;
+};
+
+} // namespace Engine::Graphics
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "core/Types.hpp"
+#include "graphics/Types.hpp"
+
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Engine::Graphics {
+
+/// Splits the passes of a frame into stages, each recorded into its own
+/// command buffer and submitted to the graphics or the compute queue in the
+/// order the stages were added.
+///
+/// Stages on the same queue are ordered by submission alone. compile() works
+/// out the semaphores between stages on different queues, and the queue
+/// family ownership transfers of the images they hand to each other.
+class QueueSchedule
+{
+public:
+  using StageIndex = Core::u32;
+
+  /// An image written in `from` and read in `to`. The resource is an index
+  /// chosen by the caller.
+  struct Handoff
+  {
+    Core::u32 resource{ 0 };
+    StageIndex from{ 0 };
+    StageIndex to{ 0 };
+    /// Where `from` last accesses the image.
+    VkPipelineStageFlags src_stages{ 0 };
+    /// Where `to` first accesses the image.
+    VkPipelineStageFlags dst_stages{ 0 };
+  };
+
+  struct Wait
+  {
+    Core::u32 semaphore{ 0 };
+    VkPipelineStageFlags stages{ 0 };
+  };
+
+  struct Stage
+  {
+    std::string name;
+    QueueType queue{ QueueType::Graphics };
+    std::vector<std::string> passes;
+
+    // Filled in by compile(). Semaphores are indices into the frame's set of
+    // get_semaphore_count() semaphores, each signalled and waited once.
+    std::vector<Wait> waits{};
+    std::vector<Core::u32> signals{};
+    /// Recorded first, taking ownership from another queue.
+    std::vector<Handoff> acquires{};
+    /// Recorded last, giving ownership to another queue.
+    std::vector<Handoff> releases{};
+  };
+
+  auto clear() -> void;
+
+  auto add_stage(std::string name, QueueType, std::vector<std::string> passes)
+    -> StageIndex;
+  /// `to` may not start its `stages` before `from` has completed. Throws
+  /// unless `from` was added before `to`.
+  auto add_dependency(StageIndex from,
+                      StageIndex to,
+                      VkPipelineStageFlags stages) -> void;
+  /// Also makes `to` depend on `from` at the handoff's destination stages.
+  auto add_handoff(const Handoff&) -> void;
+
+  auto compile() -> void;
+
+  [[nodiscard]] auto get_stages() const -> const std::vector<Stage>&
+  {
+    return stages;
+  }
+  [[nodiscard]] auto get_semaphore_count() const -> Core::u32
+  {
+    return semaphore_count;
+  }
+  [[nodiscard]] auto empty() const -> bool { return stages.empty(); }
+
+private:
+  struct Dependency
+  {
+    StageIndex from{ 0 };
+    StageIndex to{ 0 };
+    VkPipelineStageFlags stages{ 0 };
+  };
+
+  std::vector<Stage> stages;
+  std::vector<Dependency> dependencies;
+  std::vector<Handoff> handoffs;
+  Core::u32 semaphore_count{ 0 };
+};
+
+} // namespace Engine::Graphics
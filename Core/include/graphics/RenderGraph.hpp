@@ -0,0 +1,243 @@
+#pragma once
+
+#include "core/Types.hpp"
+#include "graphics/QueueSchedule.hpp"
+#include "graphics/Types.hpp"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Engine::Graphics {
+
+class Image;
+
+/// The passes of a frame and the resources they read and write.
+///
+/// Passes are declared in the order they would run on a single queue, which
+/// is what decides which write a read sees. compile() then culls the passes
+/// no output depends on, orders the rest, finds the hazards between them and
+/// which of those need a barrier of their own, and places transient images
+/// whose lifetimes do not overlap in the same memory.
+class RenderGraph
+{
+public:
+  using PassIndex = Core::u32;
+  using ResourceIndex = Core::u32;
+
+  struct Access
+  {
+    VkPipelineStageFlags stages{ 0 };
+    VkAccessFlags access{ 0 };
+  };
+
+  static constexpr Access sampled_in_fragment{
+    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+    VK_ACCESS_SHADER_READ_BIT,
+  };
+  static constexpr Access colour_attachment{
+    VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+    VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+  };
+  static constexpr Access depth_attachment{
+    VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+      VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+  };
+  static constexpr Access depth_test{
+    VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+      VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+  };
+  static constexpr Access compute_read{
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    VK_ACCESS_SHADER_READ_BIT,
+  };
+  static constexpr Access compute_write{
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+  };
+  static constexpr Access indirect_arguments{
+    VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+    VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+  };
+
+  struct Pass
+  {
+    std::string name;
+    QueueType queue{ QueueType::Graphics };
+    /// Stages of earlier work the pass already waits for when it starts, the
+    /// source stages of a render pass's incoming subpass dependency.
+    VkPipelineStageFlags waits_for{ 0 };
+    /// Stages of later work that already wait for the pass when it ends.
+    VkPipelineStageFlags blocks{ 0 };
+  };
+
+  struct Resource
+  {
+    std::string name;
+    /// Buffers are shared by the queues, images are owned by one queue
+    /// family at a time.
+    bool is_image{ false };
+    Image* image{ nullptr };
+    /// The layout the image is in between passes.
+    VkImageLayout layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+    bool output{ false };
+    bool transient{ false };
+    VkDeviceSize size{ 0 };
+    VkDeviceSize alignment{ 1 };
+  };
+
+  /// Two accesses that must not overlap. Aliasing hazards are between two
+  /// transients sharing memory, `to` may then run before `from` when the
+  /// hazard is between one frame and the next.
+  struct Hazard
+  {
+    PassIndex from{ 0 };
+    PassIndex to{ 0 };
+    ResourceIndex resource{ 0 };
+    Access src{};
+    Access dst{};
+    bool cross_queue{ false };
+    bool aliasing{ false };
+  };
+
+  /// Recorded right before a pass, every hazard it needs a barrier for
+  /// merged into one.
+  struct Barrier
+  {
+    VkPipelineStageFlags src_stages{ 0 };
+    VkPipelineStageFlags dst_stages{ 0 };
+    VkAccessFlags src_access{ 0 };
+    VkAccessFlags dst_access{ 0 };
+
+    [[nodiscard]] auto empty() const -> bool { return src_stages == 0; }
+  };
+
+  struct Placement
+  {
+    ResourceIndex resource{ 0 };
+    VkDeviceSize offset{ 0 };
+
+    auto operator==(const Placement&) const -> bool = default;
+  };
+
+  struct Statistics
+  {
+    Core::u32 passes{ 0 };
+    Core::u32 culled{ 0 };
+    Core::u32 hazards{ 0 };
+    /// Hazards already ordered by the dependencies of the passes themselves.
+    Core::u32 covered{ 0 };
+    /// Hazards between queues, ordered by semaphores.
+    Core::u32 cross_queue{ 0 };
+    /// Pipeline barriers recorded for the remaining hazards.
+    Core::u32 barriers{ 0 };
+    /// Memory of the transients, each on its own and placed by the graph.
+    VkDeviceSize transient_bytes{ 0 };
+    VkDeviceSize aliased_bytes{ 0 };
+  };
+
+  auto clear() -> void;
+
+  auto add_pass(std::string name,
+                QueueType,
+                VkPipelineStageFlags waits_for = 0,
+                VkPipelineStageFlags blocks = 0) -> PassIndex;
+  /// Adding a resource again by name returns the one already there.
+  auto add_buffer(std::string_view name) -> ResourceIndex;
+  auto add_image(std::string_view name, Image*, VkImageLayout)
+    -> ResourceIndex;
+  auto read(PassIndex, ResourceIndex, Access) -> void;
+  auto write(PassIndex, ResourceIndex, Access) -> void;
+  /// Keeps every pass the resource depends on.
+  auto set_output(ResourceIndex) -> void;
+  /// The contents are not needed from one frame to the next, so the
+  /// resource may share memory with transients it is never alive with.
+  auto set_transient(ResourceIndex, VkDeviceSize size, VkDeviceSize alignment)
+    -> void;
+
+  auto compile() -> void;
+
+  /// Adds a stage per run of passes on one queue to `schedule`, the
+  /// semaphores and ownership transfers following from the hazards between
+  /// queues. The schedule is compiled.
+  auto build_schedule(QueueSchedule& schedule) const -> void;
+
+  [[nodiscard]] auto get_passes() const -> const std::vector<Pass>&
+  {
+    return passes;
+  }
+  [[nodiscard]] auto get_resources() const -> const std::vector<Resource>&
+  {
+    return resources;
+  }
+  [[nodiscard]] auto find_resource(std::string_view) const
+    -> std::optional<ResourceIndex>;
+  /// The passes not culled, in the order they run.
+  [[nodiscard]] auto get_order() const -> const std::vector<PassIndex>&
+  {
+    return order;
+  }
+  [[nodiscard]] auto is_culled(PassIndex pass) const -> bool
+  {
+    return !live.at(pass);
+  }
+  [[nodiscard]] auto get_hazards() const -> const std::vector<Hazard>&
+  {
+    return hazards;
+  }
+  [[nodiscard]] auto get_barrier(PassIndex pass) const -> const Barrier&
+  {
+    return barriers.at(pass);
+  }
+  [[nodiscard]] auto get_placements() const -> const std::vector<Placement>&
+  {
+    return placements;
+  }
+  /// Memory needed by every placed transient.
+  [[nodiscard]] auto get_transient_size() const -> VkDeviceSize
+  {
+    return statistics.aliased_bytes;
+  }
+  [[nodiscard]] auto get_statistics() const -> const Statistics&
+  {
+    return statistics;
+  }
+
+private:
+  struct Use
+  {
+    PassIndex pass{ 0 };
+    ResourceIndex resource{ 0 };
+    Access access{};
+    bool read{ false };
+    bool write{ false };
+  };
+
+  auto add_resource(std::string_view name) -> ResourceIndex;
+  auto add_use(PassIndex, ResourceIndex, Access, bool write) -> void;
+  [[nodiscard]] auto find_use(PassIndex, ResourceIndex) const -> const Use&;
+  auto cull() -> void;
+  auto find_hazards() -> void;
+  auto sort() -> void;
+  auto place_transients() -> void;
+  auto place_barriers() -> void;
+
+  std::vector<Pass> passes;
+  std::vector<Resource> resources;
+  std::vector<Use> uses;
+
+  // Filled in by compile().
+  std::vector<bool> live;
+  std::vector<PassIndex> order;
+  std::vector<Hazard> hazards;
+  std::vector<Barrier> barriers;
+  std::vector<Placement> placements;
+  Statistics statistics{};
+};
+
+} // namespace Engine::Graphics
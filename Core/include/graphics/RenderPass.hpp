@@ -5,11 +5,14 @@
 #include "graphics/IFramebuffer.hpp"
 
 #include "graphics/Pipeline.hpp"
+#include "graphics/RenderGraph.hpp"
+#include "graphics/StateTrackingRecorder.hpp"
 
 #include "core/FrameBasedCollection.hpp"
 #include "core/Profiler.hpp"
 #include "core/Types.hpp"
 
+#include <mutex>
 #include <tuple>
 #include <vulkan/vulkan.h>
 
@@ -30,6 +33,16 @@ public:
 
   virtual auto on_resize(const Core::Extent& new_size) -> void = 0;
   auto execute(CommandBuffer& command_buffer) -> void;
+  /// Adds every pipeline the pass draws or dispatches with.
+  virtual auto collect_pipelines(std::vector<IPipeline*>& pipelines) -> void
+  {
+    if (const auto& pipeline = std::get<Core::Scope<IPipeline>>(pass)) {
+      pipelines.push_back(pipeline.get());
+    }
+  }
+  /// Adds the pass to the frame's graph as `name`, with the resources it
+  /// reads and writes.
+  virtual auto declare(RenderGraph&, const std::string& name) -> void = 0;
 
   auto destruct() -> void
   {
@@ -75,6 +88,14 @@ public:
     }
   }
 
+  /// Binds and pushes the last execution of the pass recorded, and those it
+  /// skipped as redundant.
+  [[nodiscard]] auto get_command_statistics() const -> CommandStatistics
+  {
+    std::scoped_lock lock{ command_statistics_mutex };
+    return last_command_statistics;
+  }
+
   struct BlitProperties
   {
     std::optional<Core::u32> colour_attachment_index{};
@@ -98,11 +119,20 @@ protected:
   virtual auto bind(CommandBuffer& command_buffer) -> void;
   virtual auto unbind(CommandBuffer& command_buffer) -> void;
   auto generate_and_update_descriptor_write_sets(Material&) -> VkDescriptorSet;
+  /// A graphics pass drawing into framebuffers, whose subpass dependencies
+  /// order it after and before fragment shading.
+  static auto add_framebuffer_pass(RenderGraph&, const std::string& name)
+    -> RenderGraph::PassIndex;
+  /// Marks an image the pass owns as transient, sized as it is now.
+  static auto set_transient(RenderGraph&, RenderGraph::ResourceIndex, Image&)
+    -> void;
   auto get_data() -> auto& { return pass; }
   auto get_material() -> auto& { return std::get<Core::Scope<Material>>(pass); }
   [[nodiscard]] auto get_data() const -> const auto& { return pass; }
   auto get_renderer() -> Renderer& { return renderer; }
   static auto get_mutex() -> auto& { return render_pass_mutex; }
+  /// Adds a recorder's counts to this execution's. Safe from workers.
+  auto add_command_statistics(const CommandStatistics&) -> void;
   template<class T>
     requires(std::is_base_of_v<RenderPassSettings, T> &&
              std::is_default_constructible_v<T>)
@@ -137,6 +167,9 @@ private:
   RenderTuple pass{};
   bool is_compute{ false };
   Core::Scope<RenderPassSettings> settings{ nullptr };
+  mutable std::mutex command_statistics_mutex;
+  CommandStatistics command_statistics{};
+  CommandStatistics last_command_statistics{};
 
   static inline std::mutex render_pass_mutex;
   friend class Renderer;
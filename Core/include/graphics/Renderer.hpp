@@ -3,35 +3,38 @@
 #include "core/Camera.hpp"
 #include "core/DataBuffer.hpp"
 #include "core/Forward.hpp"
+#include "core/Frustum.hpp"
 #include "core/Types.hpp"
 
 #include "logging/Logger.hpp"
 
 #include "graphics/CommandBuffer.hpp"
+#include "graphics/DrawListBuilder.hpp"
 #include "graphics/GPUBuffer.hpp"
+#include "graphics/IndirectDrawBuilder.hpp"
 #include "graphics/Material.hpp"
 #include "graphics/Mesh.hpp"
+#include "graphics/QueueSchedule.hpp"
+#include "graphics/RenderGraph.hpp"
 #include "graphics/RenderPass.hpp"
 #include "graphics/Renderer2D.hpp"
 #include "graphics/TextureCube.hpp"
+#include "graphics/TransformRingBuffer.hpp"
 
 #include "graphics/ShaderBuffers.hpp"
 
+#include <algorithm>
+#include <array>
 #include <glm/glm.hpp>
+#include <span>
 #include <string_view>
+#include <vector>
 
 namespace Engine::Graphics {
-struct CommandKey;
-}
-
-template<>
-struct std::hash<Engine::Graphics::CommandKey>
-{
-  auto operator()(const Engine::Graphics::CommandKey& key) const noexcept
-    -> Engine::Core::usize;
-}; // namespace std
 
-namespace Engine::Graphics {
+class GPUFrameTimer;
+class InstanceCullingRenderPass;
+class TransientImageMemory;
 
 namespace Detail {
 template<typename... Bases>
@@ -54,35 +57,25 @@ using transparent_string_hash = Overload<std::hash<std::string>,
                                          CharPointerHash>;
 }
 
-struct TransformVertexData
-{
-  std::array<glm::vec4, 3> transform_rows{};
-};
-struct TransformMapData
-{
-  std::vector<TransformVertexData> transforms;
-  Core::u32 offset = 0;
-};
-struct SubmeshTransformBuffer
+enum class RendererTechnique : Core::u8
 {
-  Core::Scope<Graphics::VertexBuffer> transform_buffer{ nullptr };
-  Core::Scope<Core::DataBuffer> data_buffer{ nullptr };
+  Deferred,
+  ForwardPlus,
+  /// Deferred, with the meshes culled and their draws compacted by a compute
+  /// pass, and drawn through indirect count calls. Lights stay CPU culled.
+  GPUDriven,
 };
 
-struct CommandKey
+/// Submesh instances tested by the CPU culling stage in the last frame.
+struct CullingStatistics
 {
-  const VertexBuffer* vertex_buffer{ nullptr };
-  const IndexBuffer* index_buffer{ nullptr };
-  const Material* material{ nullptr };
-  Core::u32 submesh_index{ 0 };
+  static constexpr Core::u32 cascade_count = 10;
 
-  auto operator<=>(const CommandKey&) const = default;
-};
+  Core::u32 tested{ 0 };
+  Core::u32 visible{ 0 };
+  std::array<Core::u32, cascade_count> cascade_visible{};
 
-enum class RendererTechnique : Core::u8
-{
-  Deferred,
-  ForwardPlus
+  [[nodiscard]] auto culled() const -> Core::u32 { return tested - visible; }
 };
 
 class Renderer
@@ -104,6 +97,14 @@ public:
   auto submit_static_light(Core::Ref<StaticMesh>&,
                            const glm::mat4&,
                            const glm::vec4&) -> void;
+  /// Submits every instance of a mesh at once. Instances are culled per
+  /// submesh against the camera and every shadow cascade at end_scene(), in
+  /// parallel on the renderer thread pool.
+  auto submit_static_meshes(Core::Ref<StaticMesh>&, std::span<const glm::mat4>)
+    -> void;
+  auto submit_static_lights(Core::Ref<StaticMesh>&,
+                            std::span<const glm::mat4>,
+                            std::span<const glm::vec4>) -> void;
 
   auto get_2d_renderer() -> Graphics::Renderer2D& { return *renderer_2d; }
 
@@ -119,6 +120,19 @@ public:
   {
     return lights_instance_data;
   }
+  [[nodiscard]] auto get_culling_statistics() const -> const auto&
+  {
+    return culling_statistics;
+  }
+  /// Valid after begin_scene(). Scenes narrow their submissions with these.
+  [[nodiscard]] auto get_camera_frustum() const -> const Core::Frustum&
+  {
+    return camera_frustum;
+  }
+  [[nodiscard]] auto get_cascade_frustums() const -> const auto&
+  {
+    return cascade_frustums;
+  }
   [[nodiscard]] auto get_shadow_output_image() const -> const Image*;
   [[nodiscard]] auto get_final_output() const -> const Image*;
 
@@ -164,10 +178,30 @@ public:
     }
   }
 
+  /// Steps run in the order of post_processing_order, whichever order they
+  /// were activated in.
   auto activate_post_processing_step(const std::string& name,
                                      const bool is_compute = false) -> void
   {
-    post_processing_steps.emplace(name, is_compute);
+    const auto rank = [](std::string_view step) {
+      return std::ranges::find(post_processing_order, step) -
+             post_processing_order.begin();
+    };
+    if (rank(name) == std::ssize(post_processing_order)) {
+      error("Unknown post-processing step '{}'.", name);
+      return;
+    }
+    if (std::ranges::find(post_processing_steps,
+                          name,
+                          &PostProcessingStep::name) !=
+        post_processing_steps.end()) {
+      return;
+    }
+    post_processing_steps.push_back({ name, is_compute });
+    std::ranges::sort(post_processing_steps, {}, [&](const auto& step) {
+      return rank(step.name);
+    });
+    schedule_dirty = true;
   }
 
   auto deactivate_post_processing_step(const std::string& name,
@@ -177,20 +211,73 @@ public:
       error("Cannot remove the composition pass.");
       return;
     }
-    PostProcessingStep step{ name, is_compute };
-    post_processing_steps.erase(step);
+    std::erase_if(post_processing_steps, [&](const auto& step) {
+      return step.name == name && step.is_compute == is_compute;
+    });
+    schedule_dirty = true;
   }
 
-  auto set_technique(RendererTechnique tech) -> void { technique = tech; }
+  /// Falls back to Deferred for GPUDriven on devices without indirect count
+  /// draws.
+  auto set_technique(RendererTechnique) -> void;
+  [[nodiscard]] auto get_technique() const -> RendererTechnique
+  {
+    return technique;
+  }
   auto screenshot() const -> void;
+  /// GPU milliseconds from the start of the first submission of a frame to
+  /// the end of its last, frames in flight ago.
+  [[nodiscard]] auto get_gpu_frame_time() const -> Core::f64;
+  /// GPU milliseconds the frame's submissions to `queue` took, frames in
+  /// flight ago. With async compute, the queues overlap by the amount their
+  /// sum exceeds get_gpu_frame_time().
+  [[nodiscard]] auto get_gpu_queue_time(QueueType queue) const -> Core::f64;
+  /// Of the render graph the current schedule was built from.
+  [[nodiscard]] auto get_render_graph_statistics() const
+    -> const RenderGraph::Statistics&
+  {
+    return render_graph.get_statistics();
+  }
 
   static auto get_thread_pool() -> ED::ThreadPool& { return *thread_pool; }
 
 private:
   Core::Extent size{ 0, 0 };
   Core::Extent old_size{ 0, 0 };
-  Core::Scope<CommandBuffer> command_buffer{ nullptr };
-  Core::Scope<CommandBuffer> compute_command_buffer{ nullptr };
+  // The passes of a frame and what they read and write, split into
+  // submissions on the graphics and the compute queue. Rebuilt when the
+  // technique, post-processing or size changes.
+  RenderGraph render_graph;
+  QueueSchedule schedule;
+  bool schedule_dirty{ true };
+  struct ScheduledStage
+  {
+    Core::Scope<CommandBuffer> command_buffer{ nullptr };
+    Core::Scope<GPUFrameTimer> timer{ nullptr };
+  };
+  std::unordered_map<std::string, ScheduledStage> scheduled_stages;
+  // The schedule's semaphores for every frame in flight. Each is signalled
+  // and waited for once per frame.
+  std::vector<std::vector<VkSemaphore>> frame_semaphores;
+  Core::Scope<GPUFrameTimer> gpu_frame_timer{ nullptr };
+  // The transients the graph placed in one block, and where, as applied to
+  // the images. Empty while they have memory of their own.
+  Core::Scope<TransientImageMemory> transient_memory{ nullptr };
+  std::vector<std::pair<Image*, VkDeviceSize>> placed_images;
+  auto build_schedule() -> void;
+  auto place_transient_images() -> void;
+  auto release_transient_images() -> void;
+  /// Recreates, in parallel, the pipelines whose attachments changed in a
+  /// way they bake in.
+  auto recreate_stale_pipelines() -> void;
+  auto get_scheduled_stage(const QueueSchedule::Stage&) -> ScheduledStage&;
+  auto execute_scheduled_pass(const std::string&, CommandBuffer&) -> void;
+  /// The graph's barrier before a pass, if it needs one.
+  auto record_barrier(const CommandBuffer&, const RenderGraph::Barrier&) const
+    -> void;
+  auto record_ownership_transfer(const CommandBuffer&,
+                                 const QueueSchedule::Handoff&,
+                                 bool release) const -> void;
   Core::Scope<Renderer2D> renderer_2d{ nullptr };
   RendererTechnique technique{ RendererTechnique::Deferred };
 
@@ -223,56 +310,106 @@ private:
   struct PostProcessingStep
   {
     std::string name;
-    const bool is_compute{ false };
-
-    constexpr auto operator<=>(const PostProcessingStep&) const
-      -> std::strong_ordering = default;
+    bool is_compute{ false };
   };
-  struct HasherPPStep
-  {
-    auto operator()(const PostProcessingStep& step) const noexcept
-    {
-      static constexpr auto hasher_str = std::hash<std::string>();
-      static constexpr auto hasher_bool = std::hash<bool>();
-      return hasher_str(step.name) ^ hasher_bool(step.is_compute);
-    }
+  // Each step reads what the ones before it wrote, so the graph sees them in
+  // this order.
+  static constexpr std::array<std::string_view, 3> post_processing_order{
+    "ChromaticAberration",
+    "Bloom",
+    "Composition",
   };
-  std::unordered_set<PostProcessingStep, HasherPPStep> post_processing_steps;
+  std::vector<PostProcessingStep> post_processing_steps;
 
   glm::uvec3 light_culling_work_groups{};
   std::array<Core::f32, 10> cascade_splits{};
   Core::f32 cascade_near_plane_offset{ -50.0F };
   Core::f32 cascade_far_plane_offset{ 50.0F };
 
-  struct DrawCommand
+  DrawListBuilder draw_list{
+    DrawListBuilder::ListType::Geometry,
+    thread_pool_size + 1,
+  };
+  DrawListBuilder lights_draw_list{
+    DrawListBuilder::ListType::Lights,
+    thread_pool_size + 1,
+  };
+  // Every mesh but the lights casts shadows. Each cascade is one layer, so
+  // an instance is only drawn into the cascades it overlaps.
+  DrawListBuilder shadow_draw_list{
+    DrawListBuilder::ListType::Shadow,
+    thread_pool_size + 1,
+  };
+  static_assert(CullingStatistics::cascade_count <=
+                DrawListBuilder::layer_count);
+
+  // Submissions wait here until end_scene(), when the culling stage has the
+  // final camera and cascades.
+  struct SubmittedMesh
   {
-    Core::Ref<StaticMesh> static_mesh;
-    Core::u32 submesh_index{ 0 };
+    StaticMesh* static_mesh{ nullptr };
+    Core::u32 first_transform{ 0 };
     Core::u32 instance_count{ 0 };
+    std::optional<Core::u32> first_light_colour{};
   };
-
-  struct LightDrawCommand : public DrawCommand
+  struct CullingJob
   {
-    glm::vec4 colour_times_intensity;
+    Core::u32 submitted_mesh{ 0 };
+    Core::u32 submesh_index{ 0 };
+    Core::u32 first_instance{ 0 };
+    Core::u32 instance_count{ 0 };
   };
+  std::vector<SubmittedMesh> submitted_meshes;
+  std::vector<glm::mat4> submitted_transforms;
+  std::vector<CullingJob> culling_jobs;
+  // One per draw list bucket, so workers never share them.
+  std::vector<std::vector<TransformVertexData>> culling_scratch;
+  std::vector<CullingStatistics> culling_thread_statistics;
+  CullingStatistics culling_statistics{};
+  Core::Frustum camera_frustum{};
+  std::array<Core::Frustum, CullingStatistics::cascade_count>
+    cascade_frustums{};
+  auto cull_submitted_meshes() -> void;
+  auto cull(const CullingJob&) -> void;
+
+  // Meshes the InstanceCulling pass culls on the GPU, with GPUDriven.
+  IndirectDrawBuilder indirect_draws;
+  static_assert(IndirectDrawBuilder::cascade_count ==
+                CullingStatistics::cascade_count);
+  auto submit_indirect(const SubmittedMesh&) -> void;
+  auto get_instance_culling() -> InstanceCullingRenderPass&;
 
-  std::unordered_map<CommandKey, DrawCommand> draw_commands;
-  std::unordered_map<CommandKey, DrawCommand> shadow_draw_commands;
-
-  std::unordered_map<CommandKey, DrawCommand> lights_draw_commands;
   struct LightInstanceData
   {
     glm::vec4 colour;
   };
   std::vector<glm::vec4> lights_instance_data;
+  std::vector<glm::vec4> lights_instance_scratch;
 
-  std::vector<SubmeshTransformBuffer> transform_buffers;
-  std::unordered_map<CommandKey, TransformMapData> mesh_transform_map;
+  Core::Scope<TransformRingBuffer> transform_ring{ nullptr };
+  [[nodiscard]] auto get_transform_buffer() const -> const VertexBuffer&
+  {
+    return transform_ring->get_buffer();
+  }
+  /// Where this frame's transforms start. Bound there once, a batch's
+  /// transforms are reached through its first instance.
+  [[nodiscard]] auto get_transform_frame_offset() const -> Core::usize
+  {
+    return transform_ring->get_frame_offset();
+  }
+  [[nodiscard]] auto get_transform_offset(const DrawBatch& batch) const
+    -> Core::usize
+  {
+    return transform_ring->get_frame_offset() +
+           static_cast<Core::usize>(batch.first_instance) *
+             sizeof(TransformVertexData);
+  }
 
   Core::Ref<TextureCube> current_cubemap;
 
   static inline Core::Ref<Image> white_texture;
   static inline Core::Ref<Image> black_texture;
+  static constexpr Core::u32 thread_pool_size = 4U;
   static inline Core::Scope<ED::ThreadPool> thread_pool{ nullptr };
 
   friend class RenderPass;
@@ -280,6 +417,7 @@ private:
   friend class ChromaticAberrationRenderPass;
   friend class CompositionRenderPass;
   friend class DeferredRenderPass;
+  friend class InstanceCullingRenderPass;
   friend class LightCullingRenderPass;
   friend class LightsRenderPass;
   friend class MainGeometryRenderPass;
@@ -289,21 +427,3 @@ private:
 };
 
 }
-
-inline auto
-std::hash<Engine::Graphics::CommandKey>::operator()(
-  const Engine::Graphics::CommandKey& key) const noexcept -> Engine::Core::usize
-{
-  static constexpr auto combine = []<class... T>(auto& seed,
-                                                 const T&... values) {
-    (...,
-     (seed ^= std::hash<T>{}(values) + 0x9e3779b9 + (seed << 6) + (seed >> 2)));
-    return seed;
-  };
-  std::size_t seed{ 0 };
-  return combine(seed,
-                 std::bit_cast<std::size_t>(key.vertex_buffer),
-                 std::bit_cast<std::size_t>(key.index_buffer),
-                 std::bit_cast<std::size_t>(key.material),
-                 key.submesh_index);
-}
@@ -42,8 +42,9 @@ private:
   Renderer* renderer;
   std::vector<LineVertex> vertices;
 
-  Core::Scope<VertexBuffer> line_vertices;
-  Core::Scope<IndexBuffer> line_indices;
+  // One of each per frame in flight, as the lines change every frame.
+  std::vector<Core::Scope<VertexBuffer>> line_vertices;
+  std::vector<Core::Scope<IndexBuffer>> line_indices;
   Core::Scope<GraphicsPipeline> line_pipeline;
   Core::Scope<Material> line_material;
   Core::Scope<Shader> line_shader;
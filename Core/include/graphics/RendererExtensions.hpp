@@ -17,6 +17,12 @@ begin_renderpass(const CommandBuffer&,
                  bool primary_pass = true) -> void;
 auto
 end_renderpass(const CommandBuffer&) -> void;
+/// The dynamic viewport and scissor covering the framebuffer, which
+/// secondary command buffers have to set themselves.
+auto
+set_viewport_and_scissor(const CommandBuffer&,
+                         const IFramebuffer&,
+                         bool flip = false) -> void;
 auto
 bind_vertex_buffer(const CommandBuffer&,
                    const VertexBuffer&,
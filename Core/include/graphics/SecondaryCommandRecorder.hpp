@@ -0,0 +1,93 @@
+#pragma once
+
+#include "core/Types.hpp"
+#include "graphics/Forward.hpp"
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <optional>
+#include <vector>
+
+namespace ED {
+class ThreadPool;
+}
+
+namespace Engine::Graphics {
+
+/// A half-open range of draws recorded into one secondary command buffer.
+struct DrawChunk
+{
+  Core::usize begin{ 0 };
+  Core::usize end{ 0 };
+
+  [[nodiscard]] auto size() const -> Core::usize { return end - begin; }
+};
+
+/// Records the draws of a render pass on the thread pool. The draws of one
+/// render pass instance are split into chunks, each recorded into its own
+/// secondary command buffer inheriting that render pass, and executed from
+/// the primary in draw order. Every secondary owns its command pool, so all
+/// of them record at once. A recorder belongs to one pass: its buffers stay
+/// in use until the frame's primary has been submitted.
+class SecondaryCommandRecorder
+{
+public:
+  /// Draws per chunk below which another chunk costs more than it saves.
+  static constexpr Core::usize minimum_chunk_size = 64;
+
+  using RecordFunction = std::function<void(CommandBuffer&, DrawChunk)>;
+
+  /// Each slot has a command buffer per frame in flight, as many as the
+  /// application has images unless `image_count` says otherwise.
+  explicit SecondaryCommandRecorder(
+    ED::ThreadPool&,
+    std::optional<Core::u32> image_count = std::nullopt);
+  ~SecondaryCommandRecorder();
+
+  SecondaryCommandRecorder(const SecondaryCommandRecorder&) = delete;
+  auto operator=(const SecondaryCommandRecorder&)
+    -> SecondaryCommandRecorder& = delete;
+
+  /// `draw_count` draws as at most `max_chunks` near-equal chunks of at least
+  /// minimum_chunk_size draws, or one chunk for fewer.
+  static auto split(Core::usize draw_count, Core::u32 max_chunks)
+    -> std::vector<DrawChunk>;
+
+  /// Forgets the recordings of the previous execution of the pass.
+  auto reset() -> void;
+
+  /// Starts recording the draws of one instance of the framebuffer's render
+  /// pass on the pool, with its viewport and scissor set. `record` is
+  /// called once per chunk, concurrently, and must stay valid until
+  /// execute(). Returns the recording to execute.
+  auto record(const IFramebuffer&,
+              Core::usize draw_count,
+              RecordFunction record,
+              bool flip = false) -> Core::u32;
+
+  /// Waits for the recording and executes its secondaries into the primary,
+  /// which must be inside the render pass, begun with secondary contents.
+  auto execute(CommandBuffer& primary, Core::u32 recording) -> void;
+
+private:
+  struct Recording
+  {
+    RecordFunction record;
+    std::vector<CommandBuffer*> buffers;
+    std::vector<std::future<void>> pending;
+  };
+
+  ED::ThreadPool& thread_pool;
+  std::optional<Core::u32> image_count;
+  Core::u32 max_chunks{ 1 };
+  // Grown on demand; a slot is used once per execution of the pass.
+  std::vector<Core::Scope<CommandBuffer>> slots;
+  Core::usize next_slot{ 0 };
+  // Stable addresses, as the workers hold on to them.
+  std::deque<Recording> recordings;
+
+  auto acquire_slot() -> CommandBuffer&;
+};
+
+} // namespace Engine::Graphics
@@ -102,6 +102,7 @@ public:
   [[nodiscard]] auto get_descriptor_set(std::string_view, Core::u32 = 0) const
     -> const VkWriteDescriptorSet*;
 
+  /// Hash of the SPIR-V stages alone, so identical shaders hash equal.
   [[nodiscard]] auto hash() const -> Core::usize;
   [[nodiscard]] auto has_descriptor_set(Core::u32 set) const -> bool;
 
@@ -109,15 +110,28 @@ public:
                                const std::filesystem::path&,
                                bool force_recompile = false)
     -> Core::Ref<Shader>;
-  static auto compile_compute(const std::filesystem::path&)
+  static auto compile_compute(const std::filesystem::path&,
+                              bool force_recompile = false)
     -> Core::Ref<Shader>;
   static auto compile_graphics_scoped(const std::filesystem::path&,
                                       const std::filesystem::path&,
                                       bool force_recompile = false)
     -> Core::Scope<Shader>;
-  static auto compile_compute_scoped(const std::filesystem::path&)
+  static auto compile_compute_scoped(const std::filesystem::path&,
+                                     bool force_recompile = false)
     -> Core::Scope<Shader>;
 
+  /// Compiles every job in parallel, so that the compile calls above find
+  /// them in the compiler's cache. Returns how many jobs failed.
+  static auto precompile(std::span<const Compilation::ShaderCompileJob>)
+    -> Core::usize;
+  /// Compiles the jobs in parallel and returns their SPIR-V in job order,
+  /// empty for jobs that failed.
+  static auto compile_stages(std::span<const Compilation::ShaderCompileJob>)
+    -> std::vector<std::vector<Core::u32>>;
+  static auto get_variant_keys(const std::filesystem::path&)
+    -> std::vector<std::string>;
+
   static auto initialise_compiler(
     const Compilation::ShaderCompilerConfiguration&) -> void;
 
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "core/Types.hpp"
+
+#include "graphics/Forward.hpp"
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine::Graphics {
+
+struct ShaderPermutationReport
+{
+  Core::usize key_count{ 0 };
+  // Combinations asked for so far, each compiled once.
+  Core::usize variant_count{ 0 };
+  // Distinct shaders behind them, after merging identical SPIR-V.
+  Core::usize unique_shader_count{ 0 };
+  Core::f64 compile_ms{ 0.0 };
+};
+
+/// The specialised variants of one graphics shader. Each stage declares the
+/// keys it can be specialised on with `#pragma variant NAME`, and a variant
+/// defines every declared key as 1 or 0. Variants are compiled the first time
+/// their combination is asked for, and combinations that produce identical
+/// SPIR-V share one Shader.
+class ShaderPermutations
+{
+public:
+  struct Configuration
+  {
+    const std::filesystem::path vertex_path;
+    const std::filesystem::path fragment_path;
+  };
+  explicit ShaderPermutations(Configuration);
+  ~ShaderPermutations();
+
+  /// The keys declared by either stage, sorted.
+  [[nodiscard]] auto get_keys() const -> std::span<const std::string>
+  {
+    return keys;
+  }
+
+  /// The shader with the given keys enabled and all others disabled. Keys no
+  /// stage declares are ignored. Null if compilation failed.
+  auto get(std::span<const std::string> enabled_keys) -> const Shader*;
+
+  [[nodiscard]] auto get_report() const -> ShaderPermutationReport;
+
+private:
+  const Configuration configuration;
+  std::vector<std::string> vertex_keys;
+  std::vector<std::string> fragment_keys;
+  std::vector<std::string> keys;
+
+  // Keyed by a bitmask over keys.
+  std::unordered_map<Core::u64, const Shader*> variants{};
+  // Keyed by a hash of both stages' SPIR-V.
+  std::unordered_map<Core::usize, Core::Scope<Shader>> shaders{};
+  Core::f64 compile_ms{ 0.0 };
+};
+
+} // namespace Engine::Graphics
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "core/Types.hpp"
+#include "graphics/Forward.hpp"
+#include "graphics/Pipeline.hpp"
+
+#include <array>
+#include <span>
+#include <vulkan/vulkan.h>
+
+namespace Engine::Graphics {
+
+/// State-setting calls a pass recorded, and those dropped as redundant.
+struct CommandStatistics
+{
+  Core::u32 emitted{ 0 };
+  Core::u32 skipped{ 0 };
+
+  auto operator+=(const CommandStatistics& other) -> CommandStatistics&
+  {
+    emitted += other.emitted;
+    skipped += other.skipped;
+    return *this;
+  }
+};
+
+/// What is bound in one command buffer. Every function returns whether the
+/// call it describes changes anything, and if so remembers the new state.
+/// Descriptor sets and push constants are only reused under the same
+/// pipeline layout.
+class BoundStateCache
+{
+public:
+  static constexpr Core::u32 max_vertex_bindings = 4;
+  static constexpr Core::u32 max_descriptor_sets = 4;
+  static constexpr Core::u32 max_push_constant_size = 128;
+
+  auto pipeline(VkPipeline) -> bool;
+  auto vertex_buffer(Core::u32 binding, VkBuffer, VkDeviceSize offset) -> bool;
+  auto index_buffer(VkBuffer, VkDeviceSize offset, VkIndexType) -> bool;
+  auto descriptor_sets(VkPipelineLayout,
+                       Core::u32 first_set,
+                       std::span<const VkDescriptorSet>) -> bool;
+  auto push_constants(VkPipelineLayout,
+                      VkShaderStageFlags,
+                      Core::u32 offset,
+                      std::span<const Core::u8>) -> bool;
+
+  /// Forgets everything, as for a freshly begun command buffer.
+  auto reset() -> void;
+
+  [[nodiscard]] auto get_statistics() const -> const CommandStatistics&
+  {
+    return statistics;
+  }
+
+private:
+  struct VertexBinding
+  {
+    VkBuffer buffer{ nullptr };
+    VkDeviceSize offset{ 0 };
+  };
+
+  VkPipeline bound_pipeline{ nullptr };
+  std::array<VertexBinding, max_vertex_bindings> vertex_bindings{};
+  VkBuffer bound_index_buffer{ nullptr };
+  VkDeviceSize index_offset{ 0 };
+  VkIndexType index_type{};
+
+  VkPipelineLayout descriptor_layout{ nullptr };
+  std::array<VkDescriptorSet, max_descriptor_sets> bound_sets{};
+
+  VkPipelineLayout push_constant_layout{ nullptr };
+  VkShaderStageFlags push_constant_stages{ 0 };
+  Core::u32 push_constant_offset{ 0 };
+  Core::u32 push_constant_size{ 0 };
+  std::array<Core::u8, max_push_constant_size> push_constant_data{};
+
+  CommandStatistics statistics{};
+
+  auto count(bool emit) -> bool;
+};
+
+/// Records binds and pushes through RendererExtensions, dropping the ones
+/// that would leave the command buffer's state as it is. One per command
+/// buffer being recorded.
+class StateTrackingRecorder
+{
+public:
+  explicit StateTrackingRecorder(const CommandBuffer&);
+
+  auto bind_pipeline(const IPipeline&) -> void;
+  auto bind_vertex_buffer(const VertexBuffer&,
+                          Core::u32 binding = 0,
+                          VkDeviceSize offset = 0) -> void;
+  /// A storage buffer written as instance-rate vertex input.
+  auto bind_vertex_buffer(const StorageBuffer&,
+                          Core::u32 binding,
+                          VkDeviceSize offset = 0) -> void;
+  auto bind_index_buffer(const IndexBuffer&) -> void;
+  auto bind_descriptor_sets(const IPipeline&,
+                            std::span<const VkDescriptorSet>,
+                            Core::u32 first_set = 0) -> void;
+  auto push_constants(const IPipeline&, const void* data, Core::u32 size)
+    -> void;
+
+  [[nodiscard]] auto get_statistics() const -> const CommandStatistics&
+  {
+    return cache.get_statistics();
+  }
+
+private:
+  const CommandBuffer& command_buffer;
+  BoundStateCache cache;
+};
+
+} // namespace Engine::Graphics
@@ -64,6 +64,9 @@ public:
   {
     return command_buffers[get_current_buffer_index()].command_buffer;
   }
+  /// Milliseconds begin_frame() spent waiting for the GPU to finish the
+  /// previous use of this frame in flight.
+  auto get_frame_wait_time() const -> Core::f64 { return frame_wait_time; }
 
 private:
   const Window* backpointer{ nullptr };
@@ -108,6 +111,7 @@ private:
   VkRenderPass render_pass{ nullptr };
   Core::u32 current_buffer_index{ 0 };
   Core::u32 current_image_index{ 0 };
+  Core::f64 frame_wait_time{ 0.0 };
 
   Core::u32 queue_node_index = UINT32_MAX;
   Core::Extent size{};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "core/Types.hpp"
+
+#include "graphics/DrawListBuilder.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <span>
+#include <string_view>
+
+namespace Engine::Graphics {
+
+/// Batched kernels for building instance transforms.
+///
+/// pack() multiplies many instance matrices by one submesh matrix and writes
+/// the top three rows of each product as TransformVertexData. The best kernel
+/// for the running CPU (AVX2 + FMA, SSE2 or scalar) is selected once, at
+/// runtime, so the binary does not need to be built for a newer target.
+/// compose() does the same for the translation, rotation and scale of a
+/// whole batch, such as every entity of a view.
+class TransformPacker
+{
+public:
+  enum class InstructionSet : Core::u8
+  {
+    Scalar = 0,
+    SSE2 = 1,
+    AVX2 = 2,
+  };
+
+  /// The widest instruction set the running CPU supports.
+  static auto get_instruction_set() -> InstructionSet;
+  static auto to_string(InstructionSet) -> std::string_view;
+
+  /// output[i] = top three rows of instances[i] * local. Output must hold at
+  /// least instances.size() elements.
+  static auto pack(std::span<const glm::mat4> instances,
+                   const glm::mat4& local,
+                   std::span<TransformVertexData> output) -> void;
+  /// As above, with a given kernel. Unsupported sets fall back to the best
+  /// supported one.
+  static auto pack(InstructionSet,
+                   std::span<const glm::mat4> instances,
+                   const glm::mat4& local,
+                   std::span<TransformVertexData> output) -> void;
+
+  /// output[i] = compose(translations[i], rotations[i], scales[i]). All
+  /// spans must have the same size.
+  static auto compose(std::span<const glm::vec3> translations,
+                      std::span<const glm::quat> rotations,
+                      std::span<const glm::vec3> scales,
+                      std::span<glm::mat4> output) -> void;
+  /// As above, with a given kernel.
+  static auto compose(InstructionSet,
+                      std::span<const glm::vec3> translations,
+                      std::span<const glm::quat> rotations,
+                      std::span<const glm::vec3> scales,
+                      std::span<glm::mat4> output) -> void;
+
+  /// translate(translation) * mat4_cast(rotation) * scale(scale), written out
+  /// directly rather than as two matrix products.
+  static auto compose(const glm::vec3& translation,
+                      const glm::quat& rotation,
+                      const glm::vec3& scale) -> glm::mat4
+  {
+    const auto xx = rotation.x * rotation.x;
+    const auto yy = rotation.y * rotation.y;
+    const auto zz = rotation.z * rotation.z;
+    const auto xy = rotation.x * rotation.y;
+    const auto xz = rotation.x * rotation.z;
+    const auto yz = rotation.y * rotation.z;
+    const auto wx = rotation.w * rotation.x;
+    const auto wy = rotation.w * rotation.y;
+    const auto wz = rotation.w * rotation.z;
+
+    glm::mat4 output{ 1.0F };
+    output[0] = glm::vec4{
+      (1.0F - 2.0F * (yy + zz)) * scale.x,
+      2.0F * (xy + wz) * scale.x,
+      2.0F * (xz - wy) * scale.x,
+      0.0F,
+    };
+    output[1] = glm::vec4{
+      2.0F * (xy - wz) * scale.y,
+      (1.0F - 2.0F * (xx + zz)) * scale.y,
+      2.0F * (yz + wx) * scale.y,
+      0.0F,
+    };
+    output[2] = glm::vec4{
+      2.0F * (xz + wy) * scale.z,
+      2.0F * (yz - wx) * scale.z,
+      (1.0F - 2.0F * (xx + yy)) * scale.z,
+      0.0F,
+    };
+    output[3] = glm::vec4{ translation.x, translation.y, translation.z, 1.0F };
+    return output;
+  }
+};
+
+} // namespace Engine::Graphics
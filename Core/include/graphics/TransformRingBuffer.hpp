@@ -0,0 +1,67 @@
+#pragma once
+
+#include "core/Types.hpp"
+
+#include "graphics/DrawListBuilder.hpp"
+#include "graphics/GPUBuffer.hpp"
+
+#include <span>
+#include <vector>
+
+namespace Engine::Graphics {
+
+/// Instance transforms for every frame in flight, in one persistently mapped
+/// vertex buffer split into one region per frame. The draw lists write their
+/// sorted transforms straight into the mapped region of the current frame.
+///
+/// When a frame needs more instances than a region holds, the buffer is
+/// replaced with one of twice the capacity. The old buffer may still be read
+/// by frames in flight, so it is kept alive for another frame_count frames.
+class TransformRingBuffer
+{
+public:
+  struct Configuration
+  {
+    const Core::u32 frame_count{ 3 };
+    const Core::u32 initial_capacity{ 100U * 1000U };
+  };
+  explicit TransformRingBuffer(const Configuration&);
+
+  /// Selects the region of `frame`, grows it to hold at least
+  /// `instance_count` transforms and returns the mapping of that many.
+  auto begin_frame(Core::u32 frame, Core::u32 instance_count)
+    -> std::span<TransformVertexData>;
+  /// Flushes what was written since begin_frame to the device.
+  auto end_frame() -> void;
+
+  [[nodiscard]] auto get_buffer() const -> const VertexBuffer&
+  {
+    return *buffer;
+  }
+  /// Byte offset of the current frame's region in get_buffer().
+  [[nodiscard]] auto get_frame_offset() const -> Core::usize
+  {
+    return static_cast<Core::usize>(current_frame) * capacity *
+           sizeof(TransformVertexData);
+  }
+  [[nodiscard]] auto get_capacity() const -> Core::u32 { return capacity; }
+
+private:
+  Core::u32 frame_count{ 0 };
+  Core::u32 capacity{ 0 };
+  Core::u32 current_frame{ 0 };
+  Core::u32 current_count{ 0 };
+  Core::u64 frames_begun{ 0 };
+  Core::Scope<VertexBuffer> buffer{ nullptr };
+
+  struct RetiredBuffer
+  {
+    Core::Scope<VertexBuffer> buffer{ nullptr };
+    Core::u64 retired_at{ 0 };
+  };
+  std::vector<RetiredBuffer> retired_buffers;
+
+  auto grow(Core::u32 required) -> void;
+};
+
+} // namespace Engine::Graphics
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "core/Types.hpp"
+
+#include <vulkan/vulkan.h>
+
+namespace Engine::Graphics {
+
+struct TransientImageMemoryImpl;
+
+/// One block of device memory for images whose contents are only needed
+/// within a frame. The render graph chooses their offsets, so that images
+/// never alive at the same time share it.
+class TransientImageMemory
+{
+public:
+  TransientImageMemory(VkDeviceSize size, Core::u32 memory_type_bits);
+  ~TransientImageMemory();
+
+  TransientImageMemory(const TransientImageMemory&) = delete;
+  auto operator=(const TransientImageMemory&)
+    -> TransientImageMemory& = delete;
+
+  [[nodiscard]] auto get_size() const -> VkDeviceSize { return size; }
+  auto bind(VkImage, VkDeviceSize offset) const -> void;
+
+private:
+  VkDeviceSize size{ 0 };
+  Core::Scope<TransientImageMemoryImpl> impl{ nullptr };
+};
+
+} // namespace Engine::Graphics
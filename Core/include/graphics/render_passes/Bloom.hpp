@@ -1,5 +1,6 @@
 #pragma once
 
+#include "graphics/PersistentDescriptorSet.hpp"
 #include "graphics/RenderPass.hpp"
 
 namespace Engine::Graphics {
@@ -14,6 +15,7 @@ public:
   }
   ~BloomRenderPass() override = default;
   auto on_resize(const Core::Extent&) -> void override;
+  auto declare(RenderGraph&, const std::string&) -> void override;
 
   auto get_bloom_texture_output() const -> const auto&
   {
@@ -29,7 +31,15 @@ private:
     return shader && pipeline && material;
   }
 
+  /// The set of the dispatch'th dispatch this frame. The chain's image views
+  /// only change on resize, so after the first frame these are not written.
+  auto get_dispatch_set(Core::u32 dispatch,
+                        VkDescriptorSetLayout,
+                        std::span<const VkWriteDescriptorSet>)
+    -> VkDescriptorSet;
+
   std::array<Core::Ref<Image>, 3> bloom_chain;
+  std::vector<Core::Scope<PersistentDescriptorSet>> dispatch_descriptor_sets;
 
   class BloomSettings : public RenderPassSettings
   {
@@ -14,6 +14,7 @@ public:
   }
   ~CompositionRenderPass() override = default;
   auto on_resize(const Core::Extent&) -> void override;
+  auto declare(RenderGraph&, const std::string&) -> void override;
 
 private:
   auto construct_impl() -> void override;
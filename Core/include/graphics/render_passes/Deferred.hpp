@@ -16,6 +16,7 @@ public:
   explicit DeferredRenderPass(Renderer&, const Core::Ref<Image>&);
   ~DeferredRenderPass() override;
   auto on_resize(const Core::Extent&) -> void override;
+  auto declare(RenderGraph&, const std::string&) -> void override;
 
   auto set_cubemap(const Core::Ref<Image>& new_cubemap)
   {
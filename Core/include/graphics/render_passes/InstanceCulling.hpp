@@ -0,0 +1,76 @@
+#pragma once
+
+#include "graphics/IndirectDrawBuilder.hpp"
+#include "graphics/RenderPass.hpp"
+
+#include <array>
+#include <vector>
+
+namespace Engine::Graphics {
+
+/// Culls the frame's GPU-driven instances against the camera and every
+/// shadow cascade in a compute shader, and compacts what is left into
+/// indirect commands. The geometry, predepth and shadow passes then draw
+/// each group of the IndirectDrawBuilder with one indirect count call.
+///
+/// Every frame in flight has its own buffers, grown as the scene needs.
+class InstanceCullingRenderPass final : public RenderPass
+{
+public:
+  explicit InstanceCullingRenderPass(Renderer& ren)
+    : RenderPass(ren)
+  {
+  }
+  ~InstanceCullingRenderPass() override = default;
+  auto on_resize(const Core::Extent&) -> void override;
+  auto declare(RenderGraph&, const std::string&) -> void override;
+
+  /// The visible transforms of this frame, to bind as instance-rate vertex
+  /// input. The commands select the range of their view.
+  [[nodiscard]] auto get_culled_transforms() const -> const StorageBuffer&;
+  /// Draws the visible commands of one group in one view, the camera being
+  /// view zero and cascade i view i + 1.
+  auto draw_group(const CommandBuffer&, Core::u32 view, Core::u32 group)
+    -> void;
+  /// Visible instances per view, as the GPU counted them the last time this
+  /// frame in flight was culled.
+  [[nodiscard]] auto get_visible_instances() const -> const auto&
+  {
+    return visible_instances;
+  }
+
+protected:
+  auto construct_impl() -> void override;
+  auto destruct_impl() -> void override;
+  auto execute_impl(CommandBuffer&) -> void override;
+  auto is_valid() const -> bool override
+  {
+    auto&& [_, shader, pipeline, material] = get_data();
+    return shader && pipeline && material;
+  }
+
+private:
+  struct FrameBuffers
+  {
+    Core::Scope<StorageBuffer> draws;
+    Core::Scope<StorageBuffer> instances;
+    Core::Scope<StorageBuffer> commands;
+    Core::Scope<StorageBuffer> compacted_commands;
+    Core::Scope<StorageBuffer> counts;
+    Core::Scope<StorageBuffer> culled_transforms;
+    Core::u32 draw_capacity{ 0 };
+    Core::u32 instance_capacity{ 0 };
+    Core::u32 group_capacity{ 0 };
+    // Layout of the last frame culled with these buffers.
+    Core::u32 draw_count{ 0 };
+    Core::u32 group_count{ 0 };
+  };
+  std::vector<FrameBuffers> frames;
+  Core::u32 current_frame{ 0 };
+  std::array<Core::u32, IndirectDrawBuilder::view_count> visible_instances{};
+
+  auto reserve(FrameBuffers&, const IndirectDrawBuilder&) -> void;
+  auto upload(FrameBuffers&, const IndirectDrawBuilder&) -> void;
+};
+
+} // namespace Engine::Graphics
@@ -16,6 +16,7 @@ public:
   }
   ~LightCullingRenderPass() override = default;
   auto on_resize(const Core::Extent&) -> void override;
+  auto declare(RenderGraph&, const std::string&) -> void override;
 
 protected:
   auto construct_impl() -> void override;
@@ -4,6 +4,7 @@
 #include "graphics/RenderPass.hpp"
 
 #include <glm/glm.hpp>
+#include <vector>
 
 namespace Engine::Graphics {
 
@@ -13,6 +14,7 @@ public:
   explicit LightsRenderPass(Renderer&);
   ~LightsRenderPass() override = default;
   auto on_resize(const Core::Extent&) -> void override;
+  auto declare(RenderGraph&, const std::string&) -> void override;
 
 protected:
   auto construct_impl() -> void override;
@@ -20,7 +22,8 @@ protected:
   auto execute_impl(CommandBuffer&) -> void override;
 
 private:
-  StorageBuffer storage_buffer;
+  // Light colours, one buffer per frame in flight.
+  std::vector<Core::Scope<StorageBuffer>> storage_buffers;
 };
 
 } // namespace Engine::Graphics
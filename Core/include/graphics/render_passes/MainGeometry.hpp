@@ -1,6 +1,11 @@
 #pragma once
 
 #include "graphics/RenderPass.hpp"
+#include "graphics/SecondaryCommandRecorder.hpp"
+#include "graphics/ShaderPermutations.hpp"
+
+#include <array>
+#include <string_view>
 
 namespace Engine::Graphics {
 
@@ -11,13 +16,35 @@ public:
     : RenderPass(ren)
   {
   }
-  ~MainGeometryRenderPass() override = default;
+  ~MainGeometryRenderPass() override;
   auto on_resize(const Core::Extent&) -> void override;
+  auto declare(RenderGraph&, const std::string&) -> void override;
+  auto collect_pipelines(std::vector<IPipeline*>&) -> void override;
+
+  /// The colour attachments, as resources of the render graph.
+  static constexpr std::array<std::string_view, 4> gbuffer_names{
+    "MainGeometry.Position",
+    "MainGeometry.Normal",
+    "MainGeometry.AlbedoSpecular",
+    "MainGeometry.ShadowPosition",
+  };
 
 protected:
   auto construct_impl() -> void override;
   auto destruct_impl() -> void override;
   auto execute_impl(CommandBuffer&) -> void override;
+  auto bind(CommandBuffer&) -> void override;
+
+private:
+  // Materials draw with the variant compiled for their enabled keys, and
+  // every distinct variant shader gets its own pipeline.
+  Core::Scope<ShaderPermutations> permutations;
+  std::unordered_map<const Shader*, Core::Scope<GraphicsPipeline>>
+    variant_pipelines;
+  // The draws are recorded in parallel into secondaries.
+  Core::Scope<SecondaryCommandRecorder> recorder;
+
+  auto get_pipeline(const Material&) -> const GraphicsPipeline&;
 };
 
 } // namespace Engine::Graphics
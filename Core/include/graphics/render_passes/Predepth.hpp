@@ -13,6 +13,7 @@ public:
   }
   ~PredepthRenderPass() override = default;
   auto on_resize(const Core::Extent&) -> void override;
+  auto declare(RenderGraph&, const std::string&) -> void override;
 
 protected:
   auto construct_impl() -> void override;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "graphics/RenderPass.hpp"
+#include "graphics/SecondaryCommandRecorder.hpp"
 
 namespace Engine::Graphics {
 
@@ -14,6 +15,8 @@ public:
   }
   ~ShadowRenderPass() override = default;
   auto on_resize(const Core::Extent&) -> void override;
+  auto declare(RenderGraph&, const std::string&) -> void override;
+  auto collect_pipelines(std::vector<IPipeline*>&) -> void override;
   auto get_extraneous_framebuffer(Core::u32 index)
     -> Core::Scope<IFramebuffer>& override
   {
@@ -40,6 +43,8 @@ private:
   Core::Ref<Image> cascaded_shadow_map;
   std::vector<Core::Scope<IFramebuffer>> other_framebuffers;
   std::vector<Core::Scope<IPipeline>> other_pipelines;
+  // One set of secondaries per cascade, recorded in parallel.
+  Core::Scope<SecondaryCommandRecorder> recorder;
 };
 
 } // namespace Engine::Graphics
@@ -108,6 +108,8 @@ Application::run() -> i32
       frame_count = 0;
       last_fps_time = current_second_time;
       statistics.frame_time = frame_duration * 1000.0;
+      statistics.frame_wait_time =
+        window->get_swapchain().get_frame_wait_time();
 
       trace("Frametime: {:.5f}ms. FPS: {}Hz",
             statistics.frame_time,
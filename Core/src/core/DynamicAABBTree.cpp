@@ -0,0 +1,321 @@
+#include "pch/CorePCH.hpp"
+
+#include "core/DynamicAABBTree.hpp"
+
+#include "core/Verify.hpp"
+
+namespace Engine::Core {
+
+namespace {
+auto
+merge(const AABB& first, const AABB& second) -> AABB
+{
+  return { glm::min(first.min, second.min), glm::max(first.max, second.max) };
+}
+
+auto
+surface_area(const AABB& bounds) -> f32
+{
+  const auto size = bounds.max - bounds.min;
+  return 2.0F * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+auto
+contains(const AABB& outer, const AABB& inner) -> bool
+{
+  return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y &&
+         outer.min.z <= inner.min.z && inner.max.x <= outer.max.x &&
+         inner.max.y <= outer.max.y && inner.max.z <= outer.max.z;
+}
+
+auto
+fatten(const AABB& bounds, f32 margin) -> AABB
+{
+  return { bounds.min - glm::vec3{ margin }, bounds.max + glm::vec3{ margin } };
+}
+}
+
+DynamicAABBTree::DynamicAABBTree()
+  : DynamicAABBTree(Configuration{})
+{
+}
+
+DynamicAABBTree::DynamicAABBTree(const Configuration& config)
+  : margin(config.margin)
+{
+}
+
+auto
+DynamicAABBTree::allocate_node() -> i32
+{
+  if (free_list == null_node) {
+    nodes.emplace_back();
+    return static_cast<i32>(nodes.size() - 1);
+  }
+
+  const auto index = free_list;
+  free_list = node(index).next;
+  node(index) = Node{};
+  return index;
+}
+
+auto
+DynamicAABBTree::free_node(i32 index) -> void
+{
+  auto& freed = node(index);
+  freed.height = -1;
+  freed.next = free_list;
+  free_list = index;
+}
+
+auto
+DynamicAABBTree::create_proxy(const AABB& bounds, u32 user_data) -> i32
+{
+  const auto proxy = allocate_node();
+  auto& leaf = node(proxy);
+  leaf.bounds = fatten(bounds, margin);
+  leaf.user_data = user_data;
+  leaf.height = 0;
+  insert_leaf(proxy);
+  proxy_count++;
+  return proxy;
+}
+
+auto
+DynamicAABBTree::destroy_proxy(i32 proxy) -> void
+{
+  ensure(node(proxy).is_leaf() && node(proxy).height == 0,
+         "Destroying a proxy that is not in the tree.");
+  remove_leaf(proxy);
+  free_node(proxy);
+  proxy_count--;
+}
+
+auto
+DynamicAABBTree::move_proxy(i32 proxy, const AABB& bounds) -> bool
+{
+  const auto& fat = node(proxy).bounds;
+  // Proxies that shrank a lot are re-inserted too, so fat bounds never grow
+  // far past what they hold.
+  const auto loose = fatten(bounds, 4.0F * margin);
+  if (contains(fat, bounds) && contains(loose, fat)) {
+    return false;
+  }
+
+  remove_leaf(proxy);
+  node(proxy).bounds = fatten(bounds, margin);
+  insert_leaf(proxy);
+  return true;
+}
+
+auto
+DynamicAABBTree::clear() -> void
+{
+  nodes.clear();
+  root = null_node;
+  free_list = null_node;
+  proxy_count = 0;
+}
+
+auto
+DynamicAABBTree::insert_leaf(i32 leaf) -> void
+{
+  if (root == null_node) {
+    root = leaf;
+    node(root).parent = null_node;
+    return;
+  }
+
+  // Walk down to the sibling with the smallest increase in surface area. The
+  // cost of descending includes the growth every ancestor has to absorb.
+  const auto leaf_bounds = node(leaf).bounds;
+  auto index = root;
+  while (!node(index).is_leaf()) {
+    const auto& current = node(index);
+    const auto area = surface_area(current.bounds);
+    const auto combined_area = surface_area(merge(current.bounds, leaf_bounds));
+
+    const auto cost = 2.0F * combined_area;
+    const auto inheritance_cost = 2.0F * (combined_area - area);
+
+    const auto descend_cost = [&](i32 child_index) {
+      const auto& child = node(child_index);
+      const auto merged_area = surface_area(merge(leaf_bounds, child.bounds));
+      if (child.is_leaf()) {
+        return merged_area + inheritance_cost;
+      }
+      return merged_area - surface_area(child.bounds) + inheritance_cost;
+    };
+    const auto left_cost = descend_cost(current.left);
+    const auto right_cost = descend_cost(current.right);
+
+    if (cost < left_cost && cost < right_cost) {
+      break;
+    }
+    index = left_cost < right_cost ? current.left : current.right;
+  }
+
+  const auto sibling = index;
+  const auto old_parent = node(sibling).parent;
+  const auto new_parent = allocate_node();
+  {
+    auto& parent = node(new_parent);
+    parent.parent = old_parent;
+    parent.bounds = merge(leaf_bounds, node(sibling).bounds);
+    parent.height = node(sibling).height + 1;
+    parent.left = sibling;
+    parent.right = leaf;
+  }
+  node(sibling).parent = new_parent;
+  node(leaf).parent = new_parent;
+
+  if (old_parent == null_node) {
+    root = new_parent;
+  } else if (node(old_parent).left == sibling) {
+    node(old_parent).left = new_parent;
+  } else {
+    node(old_parent).right = new_parent;
+  }
+
+  refit_upwards(node(leaf).parent);
+}
+
+auto
+DynamicAABBTree::remove_leaf(i32 leaf) -> void
+{
+  if (leaf == root) {
+    root = null_node;
+    return;
+  }
+
+  const auto parent = node(leaf).parent;
+  const auto grand_parent = node(parent).parent;
+  const auto sibling =
+    node(parent).left == leaf ? node(parent).right : node(parent).left;
+
+  if (grand_parent == null_node) {
+    root = sibling;
+    node(sibling).parent = null_node;
+    free_node(parent);
+    return;
+  }
+
+  if (node(grand_parent).left == parent) {
+    node(grand_parent).left = sibling;
+  } else {
+    node(grand_parent).right = sibling;
+  }
+  node(sibling).parent = grand_parent;
+  free_node(parent);
+
+  refit_upwards(grand_parent);
+}
+
+auto
+DynamicAABBTree::refit_upwards(i32 index) -> void
+{
+  while (index != null_node) {
+    index = balance(index);
+
+    auto& current = node(index);
+    const auto& left = node(current.left);
+    const auto& right = node(current.right);
+    current.height = 1 + std::max(left.height, right.height);
+    current.bounds = merge(left.bounds, right.bounds);
+
+    index = current.parent;
+  }
+}
+
+auto
+DynamicAABBTree::balance(i32 index_a) -> i32
+{
+  // Rotates the taller child of A up into A's place when the two subtrees
+  // differ by more than one level. Returns the node now at A's position.
+  auto& a = node(index_a);
+  if (a.is_leaf() || a.height < 2) {
+    return index_a;
+  }
+
+  const auto index_b = a.left;
+  const auto index_c = a.right;
+  auto& b = node(index_b);
+  auto& c = node(index_c);
+
+  const auto replace_in_parent = [this](i32 parent, i32 from, i32 to) {
+    if (parent == null_node) {
+      root = to;
+    } else if (node(parent).left == from) {
+      node(parent).left = to;
+    } else {
+      node(parent).right = to;
+    }
+  };
+
+  const auto difference = c.height - b.height;
+  if (difference > 1) {
+    const auto index_f = c.left;
+    const auto index_g = c.right;
+    auto& f = node(index_f);
+    auto& g = node(index_g);
+
+    c.left = index_a;
+    c.parent = a.parent;
+    a.parent = index_c;
+    replace_in_parent(c.parent, index_a, index_c);
+
+    if (f.height > g.height) {
+      c.right = index_f;
+      a.right = index_g;
+      g.parent = index_a;
+      a.bounds = merge(b.bounds, g.bounds);
+      c.bounds = merge(a.bounds, f.bounds);
+      a.height = 1 + std::max(b.height, g.height);
+      c.height = 1 + std::max(a.height, f.height);
+    } else {
+      c.right = index_g;
+      a.right = index_f;
+      f.parent = index_a;
+      a.bounds = merge(b.bounds, f.bounds);
+      c.bounds = merge(a.bounds, g.bounds);
+      a.height = 1 + std::max(b.height, f.height);
+      c.height = 1 + std::max(a.height, g.height);
+    }
+    return index_c;
+  }
+
+  if (difference < -1) {
+    const auto index_d = b.left;
+    const auto index_e = b.right;
+    auto& d = node(index_d);
+    auto& e = node(index_e);
+
+    b.left = index_a;
+    b.parent = a.parent;
+    a.parent = index_b;
+    replace_in_parent(b.parent, index_a, index_b);
+
+    if (d.height > e.height) {
+      b.right = index_d;
+      a.left = index_e;
+      e.parent = index_a;
+      a.bounds = merge(c.bounds, e.bounds);
+      b.bounds = merge(a.bounds, d.bounds);
+      a.height = 1 + std::max(c.height, e.height);
+      b.height = 1 + std::max(a.height, d.height);
+    } else {
+      b.right = index_e;
+      a.left = index_d;
+      d.parent = index_a;
+      a.bounds = merge(c.bounds, d.bounds);
+      b.bounds = merge(a.bounds, e.bounds);
+      a.height = 1 + std::max(c.height, d.height);
+      b.height = 1 + std::max(a.height, e.height);
+    }
+    return index_b;
+  }
+
+  return index_a;
+}
+
+} // namespace Engine::Core
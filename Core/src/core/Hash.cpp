@@ -0,0 +1,79 @@
+#include "pch/CorePCH.hpp"
+
+#include "core/Hash.hpp"
+
+#include <cstring>
+
+namespace Engine::Core {
+
+namespace {
+using namespace Detail;
+
+template<class T>
+auto
+read(const byte* input) -> T
+{
+  T value;
+  std::memcpy(&value, input, sizeof(T));
+  return value;
+}
+
+auto
+merge_round(u64 accumulator, u64 lane) -> u64
+{
+  accumulator ^= hash_round(0, lane);
+  return accumulator * hash_prime_1 + hash_prime_4;
+}
+} // namespace
+
+auto
+hash_bytes(std::span<const byte> bytes, u64 seed) -> u64
+{
+  const auto* input = bytes.data();
+  const auto* const end = input + bytes.size();
+  u64 value{};
+
+  if (bytes.size() >= 32) {
+    // Four independent lanes over 32-byte stripes, which the compiler keeps
+    // in registers and interleaves.
+    u64 lane_0 = seed + hash_prime_1 + hash_prime_2;
+    u64 lane_1 = seed + hash_prime_2;
+    u64 lane_2 = seed;
+    u64 lane_3 = seed - hash_prime_1;
+    const auto* const last_stripe = end - 32;
+    do {
+      lane_0 = hash_round(lane_0, read<u64>(input));
+      lane_1 = hash_round(lane_1, read<u64>(input + 8));
+      lane_2 = hash_round(lane_2, read<u64>(input + 16));
+      lane_3 = hash_round(lane_3, read<u64>(input + 24));
+      input += 32;
+    } while (input <= last_stripe);
+
+    value = std::rotl(lane_0, 1) + std::rotl(lane_1, 7) +
+            std::rotl(lane_2, 12) + std::rotl(lane_3, 18);
+    value = merge_round(value, lane_0);
+    value = merge_round(value, lane_1);
+    value = merge_round(value, lane_2);
+    value = merge_round(value, lane_3);
+  } else {
+    value = seed + hash_prime_5;
+  }
+  value += static_cast<u64>(bytes.size());
+
+  for (; input + 8 <= end; input += 8) {
+    value ^= hash_round(0, read<u64>(input));
+    value = std::rotl(value, 27) * hash_prime_1 + hash_prime_4;
+  }
+  if (input + 4 <= end) {
+    value ^= static_cast<u64>(read<u32>(input)) * hash_prime_1;
+    value = std::rotl(value, 23) * hash_prime_2 + hash_prime_3;
+    input += 4;
+  }
+  for (; input < end; input++) {
+    value ^= std::to_integer<u64>(*input) * hash_prime_5;
+    value = std::rotl(value, 11) * hash_prime_1;
+  }
+  return hash_avalanche(value);
+}
+
+} // namespace Engine::Core
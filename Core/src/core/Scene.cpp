@@ -1,6 +1,7 @@
 #include "pch/CorePCH.hpp"
 
 #include "core/Maths.hpp"
+#include "core/Profiler.hpp"
 #include "core/Random.hpp"
 #include "core/Scene.hpp"
 #include "graphics/Device.hpp"
@@ -64,6 +65,36 @@ calculate_aabb(const TransformComponent& transform) -> Engine::Core::AABB
   return aabb;
 }
 
+// The picking box, grown by the mesh bounds if there is a mesh, so the same
+// bounds serve both picking and visibility queries.
+auto
+calculate_entity_bounds(const entt::registry& registry, entt::entity entity)
+  -> Engine::Core::AABB
+{
+  const auto& transform = registry.get<TransformComponent>(entity);
+  auto aabb = calculate_aabb(transform);
+
+  const auto* mesh = registry.try_get<MeshComponent>(entity);
+  if (mesh == nullptr || !mesh->mesh) {
+    return aabb;
+  }
+
+  const auto& local = mesh->mesh->get_mesh_asset()->get_bounding_box();
+  if (local.min.x > local.max.x) {
+    return aabb;
+  }
+  const auto model_matrix = transform.compute();
+  for (auto corner = 0; corner < 8; corner++) {
+    const glm::vec3 vertex{
+      (corner & 1) != 0 ? local.max.x : local.min.x,
+      (corner & 2) != 0 ? local.max.y : local.min.y,
+      (corner & 4) != 0 ? local.max.z : local.min.z,
+    };
+    aabb.update_min_max(glm::vec3(model_matrix * glm::vec4(vertex, 1.0F)));
+  }
+  return aabb;
+}
+
 }
 
 static constexpr auto sun_radius = sqrt(30 * 30 + 70 * 70 + 30 * 30);
@@ -106,30 +137,126 @@ map(const glm::vec3& position,
   light.falloff = component.falloff;
 }
 
-template<typename Component, typename Light, typename Container>
-void
-update_lights(entt::registry& registry,
-              Container& lights,
-              std::size_t& prev_count)
+template<class Component>
+auto
+Scene::get_light_storage()
 {
-  auto count = 0U;
-  lights.reserve(prev_count + 1);
-
-  for (auto&& [entity, transform, light_component] :
-       registry.view<TransformComponent, Component>().each()) {
-    auto& light = lights.emplace_back();
-    map(transform.translation, light_component, light);
-    count++;
+  if constexpr (std::is_same_v<Component, PointLightComponent>) {
+    return std::tie(point_light_slots,
+                    light_environment.point_lights,
+                    light_environment.dirty_point_lights);
+  } else {
+    return std::tie(spot_light_slots,
+                    light_environment.spot_lights,
+                    light_environment.dirty_spot_lights);
   }
+}
 
-  if (count != prev_count) {
-    prev_count = count;
+// Connected to both the light component and the transform, so a light gets
+// its slot once it has both and is re-mapped whenever either changes.
+template<class Component>
+auto
+Scene::on_light_changed(entt::registry& changed_registry, entt::entity entity)
+  -> void
+{
+  if (!changed_registry.all_of<TransformComponent, Component>(entity)) {
+    return;
+  }
+
+  auto [light_slots, lights, dirty] = get_light_storage<Component>();
+  const auto next_slot = static_cast<u32>(light_slots.entities.size());
+  const auto [it, inserted] = light_slots.slots.try_emplace(entity, next_slot);
+  if (inserted) {
+    light_slots.entities.push_back(entity);
+    lights.emplace_back();
   }
+  light_slots.pending.push_back(it->second);
+}
+
+// The last light moves into the freed slot, so the arrays stay dense.
+template<class Component>
+auto
+Scene::on_light_removed(entt::registry&, entt::entity entity) -> void
+{
+  auto [light_slots, lights, dirty] = get_light_storage<Component>();
+  const auto it = light_slots.slots.find(entity);
+  if (it == light_slots.slots.end()) {
+    return;
+  }
+
+  const auto slot = it->second;
+  light_slots.slots.erase(it);
+  const auto last = static_cast<u32>(light_slots.entities.size() - 1);
+  if (slot != last) {
+    const auto moved = light_slots.entities[last];
+    light_slots.entities[slot] = moved;
+    light_slots.slots[moved] = slot;
+    lights[slot] = lights[last];
+    light_slots.pending.push_back(slot);
+  }
+  light_slots.entities.pop_back();
+  lights.pop_back();
+}
+
+template<class Component>
+auto
+Scene::update_lights() -> void
+{
+  auto [light_slots, lights, dirty] = get_light_storage<Component>();
+  if (light_slots.pending.empty()) {
+    return;
+  }
+
+  std::ranges::sort(light_slots.pending);
+  const auto duplicates = std::ranges::unique(light_slots.pending);
+  light_slots.pending.erase(duplicates.begin(), duplicates.end());
+  for (const auto slot : light_slots.pending) {
+    if (slot >= light_slots.entities.size()) {
+      continue;
+    }
+    const auto entity = light_slots.entities[slot];
+    map(registry.get<TransformComponent>(entity).translation,
+        registry.get<Component>(entity),
+        lights[slot]);
+  }
+
+  const auto previous = static_cast<std::ptrdiff_t>(dirty.size());
+  dirty.insert(
+    dirty.end(), light_slots.pending.begin(), light_slots.pending.end());
+  std::ranges::inplace_merge(dirty, dirty.begin() + previous);
+  const auto dirty_duplicates = std::ranges::unique(dirty);
+  dirty.erase(dirty_duplicates.begin(), dirty_duplicates.end());
+  std::erase_if(dirty, [size = lights.size()](u32 slot) {
+    return slot >= size;
+  });
+  light_slots.pending.clear();
 }
 
 Scene::Scene(const std::string_view name_view)
   : name(name_view)
 {
+  registry.on_construct<TransformComponent>().connect<&Scene::mark_dirty>(
+    *this);
+  registry.on_update<TransformComponent>().connect<&Scene::mark_dirty>(*this);
+  registry.on_destroy<TransformComponent>().connect<&Scene::remove_from_tree>(
+    *this);
+  registry.on_construct<MeshComponent>().connect<&Scene::mark_dirty>(*this);
+  registry.on_update<MeshComponent>().connect<&Scene::mark_dirty>(*this);
+  registry.on_destroy<MeshComponent>().connect<&Scene::mark_dirty>(*this);
+
+  const auto track_lights = [this]<class Component>() {
+    constexpr auto changed = &Scene::on_light_changed<Component>;
+    constexpr auto removed = &Scene::on_light_removed<Component>;
+    registry.on_construct<Component>().template connect<changed>(*this);
+    registry.on_update<Component>().template connect<changed>(*this);
+    registry.on_destroy<Component>().template connect<removed>(*this);
+    registry.on_construct<TransformComponent>().template connect<changed>(
+      *this);
+    registry.on_update<TransformComponent>().template connect<changed>(*this);
+    registry.on_destroy<TransformComponent>().template connect<removed>(*this);
+  };
+  track_lights.operator()<PointLightComponent>();
+  track_lights.operator()<SpotLightComponent>();
 
   auto cube_mesh = Core::make_ref<Graphics::StaticMesh>(
     Core::make_ref<Graphics::MeshAsset>("Assets/meshes/cube/cube.gltf"));
@@ -188,6 +315,8 @@ Scene::on_update_editor(f64 ts) -> void
   static f64 time = 0.0F;
   time += ts;
 
+  update_entity_tree();
+
   // Update sun position to orbit around the origin
   light_environment.sun_position = glm::vec4{
     sun_radius * glm::cos(time * 0.1F),
@@ -204,15 +333,8 @@ Scene::on_update_editor(f64 ts) -> void
     }
   }
 
-  light_environment.spot_lights.clear();
-  light_environment.point_lights.clear();
-
-  static auto prev_point_light_count = 15ULL;
-  static auto prev_spot_light_count = 15ULL;
-  update_lights<PointLightComponent, Graphics::PointLight>(
-    registry, light_environment.point_lights, prev_point_light_count);
-  update_lights<SpotLightComponent, Graphics::SpotLight>(
-    registry, light_environment.spot_lights, prev_spot_light_count);
+  update_lights<PointLightComponent>();
+  update_lights<SpotLightComponent>();
 }
 
 auto
@@ -227,29 +349,98 @@ Scene::on_render_editor(Graphics::Renderer& renderer, const Camera& camera)
                          camera.get_far_clip(),
                          camera.get_fov(),
                        });
-  for (auto&& [entity, mesh, transform] :
-       registry
-         .view<MeshComponent, TransformComponent>(
-           entt::exclude<PointLightComponent, SpotLightComponent>)
-         .each()) {
-    renderer.submit_static_mesh(mesh.mesh, transform.compute());
+  // Only entities the camera or a shadow cascade may see are submitted. The
+  // tree query is conservative, the renderer still culls every instance.
+  update_entity_tree();
+  visible_entities.clear();
+  const auto collect = [this](u32 user_data) {
+    visible_entities.push_back(static_cast<entt::entity>(user_data));
+  };
+  entity_tree.query(renderer.get_camera_frustum(), collect);
+  for (const auto& frustum : renderer.get_cascade_frustums()) {
+    entity_tree.query(frustum, collect);
   }
-
-  for (auto&& [entity, light, mesh, transform] :
-       registry.view<PointLightComponent, MeshComponent, TransformComponent>()
-         .each()) {
-    const auto light_colour = light.radiance * light.intensity;
-    renderer.submit_static_light(
-      mesh.mesh, transform.compute(), glm::vec4{ light_colour, 1.0F });
+  std::ranges::sort(visible_entities);
+  const auto duplicates = std::ranges::unique(visible_entities);
+  visible_entities.erase(duplicates.begin(), duplicates.end());
+  std::erase_if(visible_entities, [this](entt::entity entity) {
+    const auto* mesh = registry.try_get<MeshComponent>(entity);
+    return mesh == nullptr || !mesh->mesh;
+  });
+  // Entities sharing a mesh become adjacent, each run of one mesh is then
+  // submitted as a single batch.
+  std::ranges::stable_sort(visible_entities, {}, [this](entt::entity entity) {
+    return registry.get<MeshComponent>(entity).mesh.get();
+  });
+
+  // Every visible transform is composed in one batch.
+  visible_translations.clear();
+  visible_rotations.clear();
+  visible_scales.clear();
+  for (const auto entity : visible_entities) {
+    const auto& transform = registry.get<TransformComponent>(entity);
+    visible_translations.push_back(transform.translation);
+    visible_rotations.push_back(transform.rotation);
+    visible_scales.push_back(transform.scale);
+  }
+  visible_transforms.resize(visible_entities.size());
+  Graphics::TransformPacker::compose(visible_translations,
+                                     visible_rotations,
+                                     visible_scales,
+                                     visible_transforms);
+
+  Core::Ref<Graphics::StaticMesh>* run_mesh = nullptr;
+  const auto submit_meshes = [&]() {
+    if (!instance_transforms.empty()) {
+      renderer.submit_static_meshes(*run_mesh, instance_transforms);
+    }
+    instance_transforms.clear();
+  };
+  for (auto i = 0ULL; i < visible_entities.size(); i++) {
+    const auto entity = visible_entities[i];
+    if (registry.any_of<PointLightComponent, SpotLightComponent>(entity)) {
+      continue;
+    }
+    auto& mesh = registry.get<MeshComponent>(entity);
+    if (run_mesh != nullptr && run_mesh->get() != mesh.mesh.get()) {
+      submit_meshes();
+    }
+    run_mesh = &mesh.mesh;
+    instance_transforms.push_back(visible_transforms[i]);
   }
+  submit_meshes();
 
-  for (auto&& [entity, light, mesh, transform] :
-       registry.view<SpotLightComponent, MeshComponent, TransformComponent>()
-         .each()) {
-    const auto light_colour = light.radiance * light.intensity;
-    renderer.submit_static_light(
-      mesh.mesh, transform.compute(), glm::vec4{ light_colour, 1.0F });
+  run_mesh = nullptr;
+  const auto submit_lights = [&]() {
+    if (!instance_transforms.empty()) {
+      renderer.submit_static_lights(
+        *run_mesh, instance_transforms, instance_colours);
+    }
+    instance_transforms.clear();
+    instance_colours.clear();
+  };
+  const auto add_light = [&](auto& mesh,
+                             const auto& light,
+                             const glm::mat4& transform) {
+    if (run_mesh != nullptr && run_mesh->get() != mesh.mesh.get()) {
+      submit_lights();
+    }
+    run_mesh = &mesh.mesh;
+    instance_transforms.push_back(transform);
+    instance_colours.emplace_back(light.radiance * light.intensity, 1.0F);
+  };
+  for (auto i = 0ULL; i < visible_entities.size(); i++) {
+    const auto entity = visible_entities[i];
+    auto& mesh = registry.get<MeshComponent>(entity);
+    const auto& transform = visible_transforms[i];
+    if (const auto* point = registry.try_get<PointLightComponent>(entity)) {
+      add_light(mesh, *point, transform);
+    } else if (const auto* spot =
+                 registry.try_get<SpotLightComponent>(entity)) {
+      add_light(mesh, *spot, transform);
+    }
   }
+  submit_lights();
 
   for (auto&& [entity, transform] :
        registry
@@ -276,23 +467,64 @@ auto
 Scene::find_intersected_entity(const glm::vec3& ray,
                                const glm::vec3& camera_position) -> entt::entity
 {
+  update_entity_tree();
+
   auto closest_distance = std::numeric_limits<float>::max();
   entt::entity closest_entity = entt::null;
 
-  auto view = registry.view<const TransformComponent>(
-    entt::exclude<PointLightComponent, SpotLightComponent>);
-  for (auto&& [entity, transform] : view.each()) {
+  entity_tree.ray_cast(camera_position, ray, [&](u32 user_data) {
+    const auto entity = static_cast<entt::entity>(user_data);
+    if (registry.any_of<PointLightComponent, SpotLightComponent>(entity)) {
+      return;
+    }
+    const auto& transform = registry.get<TransformComponent>(entity);
     const auto aabb = Utilities::calculate_aabb(transform);
-    if (Utilities::intersects(aabb, ray, camera_position)) {
-      float distance = glm::distance(camera_position, transform.translation);
-      if (distance < closest_distance) {
-        closest_distance = distance;
-        closest_entity = entity;
-      }
+    if (!Utilities::intersects(aabb, ray, camera_position)) {
+      return;
     }
-  }
+    float distance = glm::distance(camera_position, transform.translation);
+    if (distance < closest_distance) {
+      closest_distance = distance;
+      closest_entity = entity;
+    }
+  });
 
   return closest_entity;
 }
 
+auto
+Scene::update_entity_tree() -> void
+{
+  ASTUTE_PROFILE_FUNCTION();
+  for (const auto entity : dirty_entities) {
+    if (!registry.valid(entity) ||
+        !registry.all_of<TransformComponent>(entity)) {
+      continue;
+    }
+    const auto bounds = Utilities::calculate_entity_bounds(registry, entity);
+    if (auto it = entity_proxies.find(entity); it != entity_proxies.end()) {
+      entity_tree.move_proxy(it->second, bounds);
+    } else {
+      entity_proxies.try_emplace(
+        entity, entity_tree.create_proxy(bounds, entt::to_integral(entity)));
+    }
+  }
+  dirty_entities.clear();
+}
+
+auto
+Scene::mark_dirty(entt::registry&, entt::entity entity) -> void
+{
+  dirty_entities.push_back(entity);
+}
+
+auto
+Scene::remove_from_tree(entt::registry&, entt::entity entity) -> void
+{
+  if (auto it = entity_proxies.find(entity); it != entity_proxies.end()) {
+    entity_tree.destroy_proxy(it->second);
+    entity_proxies.erase(it);
+  }
+}
+
 } // namespace Engine::Core
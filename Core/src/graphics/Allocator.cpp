@@ -129,6 +129,31 @@ Allocator::allocate_image(VkImage& image,
   return allocation;
 }
 
+auto
+Allocator::allocate_memory(const VkMemoryRequirements& requirements,
+                           const AllocationProperties& props) -> VmaAllocation
+{
+  VmaAllocationCreateInfo allocation_create_info = {};
+  allocation_create_info.usage = static_cast<VmaMemoryUsage>(props.usage);
+  allocation_create_info.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+  allocation_create_info.priority = props.priority;
+
+  VmaAllocation allocation{};
+  VK_CHECK(vmaAllocateMemory(
+    allocator, &requirements, &allocation_create_info, &allocation, nullptr));
+  vmaSetAllocationName(allocator, allocation, resource_name.data());
+
+  return allocation;
+}
+
+void
+Allocator::bind_image(VmaAllocation allocation,
+                      VkDeviceSize offset,
+                      VkImage image)
+{
+  VK_CHECK(vmaBindImageMemory2(allocator, allocation, offset, image, nullptr));
+}
+
 void
 Allocator::deallocate_buffer(VmaAllocation allocation, VkBuffer& buffer)
 {
@@ -142,6 +167,12 @@ Allocator::deallocate_image(VmaAllocation allocation, VkImage& image)
   vmaDestroyImage(allocator, image, allocation);
 }
 
+void
+Allocator::deallocate_memory(VmaAllocation allocation)
+{
+  vmaFreeMemory(allocator, allocation);
+}
+
 void
 Allocator::unmap_memory(VmaAllocation allocation)
 {
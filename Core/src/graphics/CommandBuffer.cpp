@@ -39,6 +39,13 @@ CommandBuffer::~CommandBuffer()
 auto
 CommandBuffer::destroy() -> void
 {
+  if (!fences.empty()) {
+    vkWaitForFences(Device::the().device(),
+                    static_cast<Core::u32>(fences.size()),
+                    fences.data(),
+                    VK_TRUE,
+                    UINT64_MAX);
+  }
   for (auto& fence : fences) {
     vkDestroyFence(Device::the().device(), fence, nullptr);
   }
@@ -107,6 +114,15 @@ CommandBuffer::begin(const VkCommandBufferBeginInfo* begin_info) -> void
       Core::Application::the().get_swapchain().get_command_buffer(
         current_frame_index);
   } else {
+    if (primary) {
+      // The fence stays signalled once waited for, so this is free unless
+      // the last submission of this frame is still executing.
+      vkWaitForFences(Device::the().device(),
+                      1,
+                      &fences[current_frame_index],
+                      VK_TRUE,
+                      UINT64_MAX);
+    }
     active_command_buffer = command_buffers[current_frame_index];
   }
   vkBeginCommandBuffer(active_command_buffer, &default_begin_info);
@@ -121,28 +137,57 @@ CommandBuffer::end() -> void
 auto
 CommandBuffer::submit() -> void
 {
-  if (owned_by_swapchain) {
+  if (owned_by_swapchain || is_secondary()) {
     return;
   }
 
-  if (is_secondary()) {
+  queue_submit({});
+  vkWaitForFences(Device::the().device(),
+                  1,
+                  &fences[current_frame_index],
+                  VK_TRUE,
+                  UINT64_MAX);
+}
+
+auto
+CommandBuffer::submit_pipelined(const Dependencies& dependencies) -> void
+{
+  if (owned_by_swapchain || is_secondary()) {
     return;
   }
 
-  const auto& device = Device::the();
+  queue_submit(dependencies);
+}
+
+auto
+CommandBuffer::queue_submit(const Dependencies& dependencies) -> void
+{
+  std::vector<VkSemaphore> wait_semaphores;
+  std::vector<VkPipelineStageFlags> wait_stages;
+  wait_semaphores.reserve(dependencies.waits.size());
+  wait_stages.reserve(dependencies.waits.size());
+  for (const auto& [semaphore, stages] : dependencies.waits) {
+    wait_semaphores.push_back(semaphore);
+    wait_stages.push_back(stages);
+  }
+
   VkSubmitInfo submit_info{};
   submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.waitSemaphoreCount =
+    static_cast<Core::u32>(wait_semaphores.size());
+  submit_info.pWaitSemaphores = wait_semaphores.data();
+  submit_info.pWaitDstStageMask = wait_stages.data();
   submit_info.commandBufferCount = 1;
   VkCommandBuffer buffer = active_command_buffer;
   submit_info.pCommandBuffers = &buffer;
-  vkResetFences(device.device(), 1, &fences[current_frame_index]);
-
-  vkQueueSubmit(queue, 1, &submit_info, fences[current_frame_index]);
-
-  vkWaitForFences(
-    device.device(), 1, &fences[current_frame_index], VK_TRUE, UINT64_MAX);
+  submit_info.signalSemaphoreCount =
+    static_cast<Core::u32>(dependencies.signals.size());
+  submit_info.pSignalSemaphores = dependencies.signals.data();
 
+  // Only reset once begin() has seen the previous submission complete.
+  const auto& device = Device::the();
   vkResetFences(device.device(), 1, &fences[current_frame_index]);
+  vkQueueSubmit(queue, 1, &submit_info, fences[current_frame_index]);
 
   active_command_buffer = nullptr;
 }
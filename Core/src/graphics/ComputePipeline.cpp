@@ -33,10 +33,10 @@ ComputePipeline::destroy() -> void
 }
 
 auto
-ComputePipeline::on_resize(const Core::Extent&) -> void
+ComputePipeline::recreate() -> void
 {
-  destroy();
-  create_layout();
+  // The layout only depends on the shader.
+  vkDestroyPipeline(Device::the().device(), pipeline, nullptr);
   create_pipeline();
 }
 
@@ -58,7 +58,7 @@ ComputePipeline::create_pipeline() -> void
   pipeline_info.stage = shader_stage_info;
 
   VK_CHECK(vkCreateComputePipelines(Device::the().device(),
-                                    VK_NULL_HANDLE,
+                                    Device::the().get_pipeline_cache(),
                                     1,
                                     &pipeline_info,
                                     nullptr,
@@ -0,0 +1,105 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/DescriptorPoolSizing.hpp"
+
+#include <algorithm>
+
+namespace Engine::Graphics {
+
+namespace {
+template<class Transform>
+auto
+transform_counts(const DescriptorPoolUsage& usage, Transform&& transform)
+  -> DescriptorPoolUsage
+{
+  DescriptorPoolUsage result;
+  for (Core::usize i = 0; i < usage.descriptors.size(); i++) {
+    result.descriptors[i] = transform(usage.descriptors[i]);
+  }
+  result.sets = transform(usage.sets);
+  return result;
+}
+} // namespace
+
+auto
+DescriptorPoolUsage::from_bindings(
+  std::span<const VkDescriptorSetLayoutBinding> bindings) -> DescriptorPoolUsage
+{
+  DescriptorPoolUsage usage{ .sets = 1 };
+  for (const auto& binding : bindings) {
+    const auto* const type = std::ranges::find(types, binding.descriptorType);
+    if (type != types.end()) {
+      usage.descriptors[static_cast<Core::usize>(type - types.begin())] +=
+        binding.descriptorCount;
+    }
+  }
+  return usage;
+}
+
+auto
+DescriptorPoolUsage::uniform(Core::u32 count) -> DescriptorPoolUsage
+{
+  DescriptorPoolUsage usage{ .sets = count };
+  usage.descriptors.fill(count);
+  return usage;
+}
+
+auto
+DescriptorPoolUsage::operator+=(const DescriptorPoolUsage& other)
+  -> DescriptorPoolUsage&
+{
+  for (Core::usize i = 0; i < descriptors.size(); i++) {
+    descriptors[i] += other.descriptors[i];
+  }
+  sets += other.sets;
+  return *this;
+}
+
+auto
+DescriptorPoolUsage::max(const DescriptorPoolUsage& left,
+                         const DescriptorPoolUsage& right)
+  -> DescriptorPoolUsage
+{
+  DescriptorPoolUsage result;
+  for (Core::usize i = 0; i < result.descriptors.size(); i++) {
+    result.descriptors[i] = std::max(left.descriptors[i], right.descriptors[i]);
+  }
+  result.sets = std::max(left.sets, right.sets);
+  return result;
+}
+
+auto
+DescriptorPoolUsage::to_pool_sizes() const -> std::vector<VkDescriptorPoolSize>
+{
+  std::vector<VkDescriptorPoolSize> pool_sizes;
+  for (Core::usize i = 0; i < descriptors.size(); i++) {
+    if (descriptors[i] > 0) {
+      pool_sizes.push_back({
+        .type = types[i],
+        .descriptorCount = descriptors[i],
+      });
+    }
+  }
+  return pool_sizes;
+}
+
+auto
+size_chained_pool(const DescriptorPoolUsage& exhausted,
+                  const DescriptorPoolUsage& request) -> DescriptorPoolUsage
+{
+  return DescriptorPoolUsage::max(
+    transform_counts(exhausted, [](Core::u32 count) { return count * 2; }),
+    request);
+}
+
+auto
+size_frame_pool(const DescriptorPoolUsage& peak,
+                const DescriptorPoolUsage& minimum) -> DescriptorPoolUsage
+{
+  return DescriptorPoolUsage::max(
+    transform_counts(peak,
+                     [](Core::u32 count) { return count + (count + 3) / 4; }),
+    minimum);
+}
+
+} // namespace Engine::Graphics
@@ -4,162 +4,298 @@
 
 #include "core/Application.hpp"
 #include "core/Verify.hpp"
+#include "graphics/DescriptorSetLayoutCache.hpp"
 #include "graphics/Device.hpp"
+#include "logging/Logger.hpp"
+
+#include <algorithm>
 
 namespace Engine::Graphics {
 
+namespace {
+// What a frame pool holds before any frame has been measured, and never
+// shrinks below.
+const auto minimum_frame_pool = DescriptorPoolUsage::uniform(64);
+const auto initial_persistent_pool = DescriptorPoolUsage::uniform(256);
+
+auto
+requested_usage(const VkDescriptorSetAllocateInfo& alloc_info)
+  -> DescriptorPoolUsage
+{
+  auto& layout_cache = DescriptorSetLayoutCache::the();
+  DescriptorPoolUsage usage;
+  for (Core::u32 i = 0; i < alloc_info.descriptorSetCount; i++) {
+    auto layout_usage = layout_cache.get_pool_usage(alloc_info.pSetLayouts[i]);
+    if (layout_usage.sets == 0) {
+      // A layout made outside the cache; assume a few of everything.
+      layout_usage = DescriptorPoolUsage::uniform(16);
+      layout_usage.sets = 1;
+    }
+    usage += layout_usage;
+  }
+  return usage;
+}
+} // namespace
+
 DescriptorResource::~DescriptorResource() = default;
 
 auto
 DescriptorResource::destroy() -> void
 {
-  if (descriptor_pools.empty())
+  if (frame_chains.empty())
     return;
 
-  for (auto& descriptor_pool : descriptor_pools) {
-    vkDestroyDescriptorPool(Device::the().device(), descriptor_pool, nullptr);
+  const auto destroy_pools = [](PoolChain& chain) {
+    std::scoped_lock lock{ chain.mutex };
+    for (auto* pool : chain.pools) {
+      vkDestroyDescriptorPool(Device::the().device(), pool, nullptr);
+    }
+    chain.pools.clear();
+    chain.capacities.clear();
+  };
+  for (auto& chain : frame_chains) {
+    destroy_pools(*chain);
   }
+  // Destroying the pools frees every persistent set still allocated.
+  destroy_pools(persistent_chain);
+
+  frame_chains.clear();
+  persistent_owners.clear();
+  pending_frees = {};
+}
 
-  descriptor_pools = {};
+auto
+DescriptorResource::create_chained_pool(PoolChain& chain,
+                                        const DescriptorPoolUsage& capacity,
+                                        VkDescriptorPoolCreateFlags flags)
+  -> void
+{
+  const auto pool_sizes = capacity.to_pool_sizes();
+
+  VkDescriptorPoolCreateInfo pool_info = {};
+  pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  pool_info.flags = flags;
+  pool_info.poolSizeCount = static_cast<Core::u32>(pool_sizes.size());
+  pool_info.pPoolSizes = pool_sizes.data();
+  pool_info.maxSets = std::max(capacity.sets, 1U);
+
+  auto& pool = chain.pools.emplace_back();
+  VK_CHECK(
+    vkCreateDescriptorPool(Device::the().device(), &pool_info, nullptr, &pool));
+  chain.capacities.push_back(capacity);
+}
+
+auto
+DescriptorResource::allocate_from(PoolChain& chain,
+                                  const VkDescriptorSetAllocateInfo& alloc_info,
+                                  VkDescriptorSet* descriptor_sets,
+                                  bool persistent) -> VkDescriptorPool
+{
+  const auto request = requested_usage(alloc_info);
+  const VkDescriptorPoolCreateFlags flags =
+    persistent ? VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT : 0;
+
+  std::scoped_lock lock{ chain.mutex };
+  if (chain.pools.empty()) {
+    return nullptr;
+  }
+
+  // Persistent sets are freed one by one, so any of those pools may have
+  // room again.
+  auto index = persistent ? 0 : chain.active;
+  auto alloc_info_copy = alloc_info;
+  while (true) {
+    const auto chained = index == chain.pools.size();
+    if (chained) {
+      create_chained_pool(
+        chain, size_chained_pool(chain.capacities.back(), request), flags);
+    }
+
+    alloc_info_copy.descriptorPool = chain.pools[index];
+    const auto result = vkAllocateDescriptorSets(
+      Device::the().device(), &alloc_info_copy, descriptor_sets);
+    if (result == VK_SUCCESS) {
+      if (!persistent) {
+        chain.active = index;
+      }
+      chain.used += request;
+      allocated_sets += alloc_info.descriptorSetCount;
+      return chain.pools[index];
+    }
+
+    // An exhausted or fragmented pool is left as it is and the next one
+    // tried, up to a new pool at the end of the chain. A pool created for
+    // this very request failing, or any other error, is not recoverable.
+    const auto exhausted = result == VK_ERROR_OUT_OF_POOL_MEMORY ||
+                           result == VK_ERROR_FRAGMENTED_POOL;
+    if (!exhausted || chained) {
+      error("Failed to allocate {} descriptor set(s): {}",
+            alloc_info.descriptorSetCount,
+            static_cast<Core::i32>(result));
+      return nullptr;
+    }
+    index++;
+  }
 }
 
 auto
 DescriptorResource::allocate_descriptor_set(
-  const VkDescriptorSetAllocateInfo& alloc_info) const -> VkDescriptorSet
+  const VkDescriptorSetAllocateInfo& alloc_info) -> VkDescriptorSet
 {
   VkDescriptorSet descriptor_set = nullptr;
 
-  // Create a allocation info copy, where we insert current pool.
   auto alloc_info_copy = alloc_info;
-  alloc_info_copy.descriptorPool = descriptor_pools[current_frame];
   alloc_info_copy.descriptorSetCount = 1;
-
-  if (const auto result = vkAllocateDescriptorSets(
-        Device::the().device(), &alloc_info_copy, &descriptor_set);
-      result == VK_ERROR_FRAGMENTATION_EXT) {
-    handle_fragmentation();
-  } else if (result == VK_ERROR_OUT_OF_POOL_MEMORY) {
-    handle_out_of_memory();
-  }
+  allocate_from(
+    *frame_chains.at(current_frame), alloc_info_copy, &descriptor_set, false);
 
   return descriptor_set;
 }
 
 auto
 DescriptorResource::allocate_many_descriptor_sets(
-  const VkDescriptorSetAllocateInfo& alloc_info) const
-  -> std::vector<VkDescriptorSet>
+  const VkDescriptorSetAllocateInfo& alloc_info) -> std::vector<VkDescriptorSet>
 {
-  if (alloc_info.descriptorSetCount == 1) {
-    return { allocate_descriptor_set(alloc_info) };
-  }
-
   std::vector<VkDescriptorSet> descriptor_sets(alloc_info.descriptorSetCount);
-  auto alloc_info_copy = alloc_info;
 
-  alloc_info_copy.descriptorPool = descriptor_pools[current_frame];
-
-  VK_CHECK(vkAllocateDescriptorSets(
-    Device::the().device(), &alloc_info_copy, descriptor_sets.data()));
+  if (allocate_from(*frame_chains.at(current_frame),
+                    alloc_info,
+                    descriptor_sets.data(),
+                    false) == nullptr) {
+    return {};
+  }
 
   return descriptor_sets;
 }
 
-void
-DescriptorResource::begin_frame()
+auto
+DescriptorResource::allocate_persistent_descriptor_set(
+  const VkDescriptorSetAllocateInfo& alloc_info) -> VkDescriptorSet
 {
-  current_frame = Core::Application::the().current_frame_index();
-  // Cleanup or reset operations for the beginning of the frame
+  VkDescriptorSet descriptor_set = nullptr;
+  auto alloc_info_copy = alloc_info;
+  alloc_info_copy.descriptorSetCount = 1;
+
+  auto* pool =
+    allocate_from(persistent_chain, alloc_info_copy, &descriptor_set, true);
+  if (pool != nullptr) {
+    std::scoped_lock lock{ persistent_chain.mutex };
+    persistent_owners[descriptor_set] = pool;
+  }
 
-  vkResetDescriptorPool(
-    Device::the().device(), descriptor_pools[current_frame], 0);
+  return descriptor_set;
 }
 
-void
-DescriptorResource::end_frame()
+auto
+DescriptorResource::free_persistent_descriptor_set(VkDescriptorSet set) -> void
 {
-  // Cleanup or reset operations for the end of the frame
+  std::scoped_lock lock{ persistent_chain.mutex };
+  // After destroy() the pools, and every set in them, are already gone.
+  if (set == nullptr || persistent_chain.pools.empty()) {
+    return;
+  }
+  pending_frees.at(current_frame).push_back(set);
 }
 
-void
-DescriptorResource::create_pool()
+auto
+DescriptorResource::update_descriptor_sets(
+  std::span<const VkWriteDescriptorSet> writes) const -> void
 {
+  if (writes.empty()) {
+    return;
+  }
+  vkUpdateDescriptorSets(Device::the().device(),
+                         static_cast<Core::u32>(writes.size()),
+                         writes.data(),
+                         0,
+                         nullptr);
+  descriptor_writes += static_cast<Core::u32>(writes.size());
+}
 
-  auto frame_count = Core::Application::the().get_image_count();
-
-  pool_sizes = {
-    VkDescriptorPoolSize{
-      .type = VK_DESCRIPTOR_TYPE_SAMPLER,
-      .descriptorCount = 10000 * frame_count,
-    },
-    VkDescriptorPoolSize{
-      .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-      .descriptorCount = 10000 * frame_count,
-    },
-    VkDescriptorPoolSize{
-      .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-      .descriptorCount = 10000 * frame_count,
-    },
-    VkDescriptorPoolSize{
-      .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-      .descriptorCount = 10000 * frame_count,
-    },
-    VkDescriptorPoolSize{
-      .type = VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,
-      .descriptorCount = 10000 * frame_count,
-    },
-    VkDescriptorPoolSize{
-      .type = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,
-      .descriptorCount = 10000 * frame_count,
-    },
-    VkDescriptorPoolSize{
-      .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-      .descriptorCount = 10000 * frame_count,
-    },
-    VkDescriptorPoolSize{
-      .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-      .descriptorCount = 10000 * frame_count,
-    },
-    VkDescriptorPoolSize{
-      .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
-      .descriptorCount = 10000 * frame_count,
-    },
-    VkDescriptorPoolSize{
-      .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
-      .descriptorCount = 10000 * frame_count,
-    },
-    VkDescriptorPoolSize{
-      .type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
-      .descriptorCount = 10000 * frame_count,
-    },
-  };
-
-  VkDescriptorPoolCreateInfo pool_info = {};
-  pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-  pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
-  pool_info.pPoolSizes = pool_sizes.data();
-
-  // We only use two descriptor sets for now
-  pool_info.maxSets = 10000 * frame_count;
+void
+DescriptorResource::begin_frame()
+{
+  current_frame = Core::Application::the().current_frame_index();
 
-  descriptor_pools.resize(frame_count);
+  {
+    auto& chain = *frame_chains.at(current_frame);
+    std::scoped_lock lock{ chain.mutex };
+    if (chain.pools.size() == 1) {
+      vkResetDescriptorPool(Device::the().device(), chain.pools.front(), 0);
+    } else {
+      // The chain had to grow: start over with one pool that would have
+      // held the busiest frame.
+      for (auto* pool : chain.pools) {
+        vkDestroyDescriptorPool(Device::the().device(), pool, nullptr);
+      }
+      chain.pools.clear();
+      chain.capacities.clear();
+      create_chained_pool(
+        chain, size_frame_pool(peak_frame_usage, minimum_frame_pool), 0);
+    }
+    chain.active = 0;
+    chain.used = {};
+  }
 
-  for (auto& descriptor_pool : descriptor_pools) {
-    VK_CHECK(vkCreateDescriptorPool(
-      Device::the().device(), &pool_info, nullptr, &descriptor_pool));
+  // This frame's previous submission has finished, so sets released while
+  // recording it are no longer in use.
+  std::scoped_lock lock{ persistent_chain.mutex };
+  auto& frees = pending_frees.at(current_frame);
+  for (auto* set : frees) {
+    const auto owner = persistent_owners.find(set);
+    if (owner == persistent_owners.end()) {
+      continue;
+    }
+    vkFreeDescriptorSets(Device::the().device(), owner->second, 1, &set);
+    persistent_owners.erase(owner);
   }
+  frees.clear();
 }
 
 void
-DescriptorResource::handle_fragmentation() const
+DescriptorResource::end_frame()
 {
-  // Handle fragmentation issues
+  auto& chain = *frame_chains.at(current_frame);
+  Core::u32 frame_pools{ 0 };
+  {
+    std::scoped_lock lock{ chain.mutex };
+    peak_frame_usage = DescriptorPoolUsage::max(peak_frame_usage, chain.used);
+    frame_pools = static_cast<Core::u32>(chain.pools.size());
+  }
+  peak_frame_pools = std::max(peak_frame_pools, frame_pools);
+
+  Core::u32 persistent_pools{ 0 };
+  {
+    std::scoped_lock lock{ persistent_chain.mutex };
+    persistent_pools = static_cast<Core::u32>(persistent_chain.pools.size());
+  }
+
+  last_frame_statistics = {
+    .allocated_sets = allocated_sets.exchange(0),
+    .descriptor_writes = descriptor_writes.exchange(0),
+    .frame_pools = frame_pools,
+    .peak_frame_pools = peak_frame_pools,
+    .peak_frame_sets = peak_frame_usage.sets,
+    .persistent_pools = persistent_pools,
+  };
 }
 
 void
-DescriptorResource::handle_out_of_memory() const
+DescriptorResource::create_pool()
 {
-  // Handle out of memory errors
-}
+  const auto frame_count = Core::Application::the().get_image_count();
+
+  frame_chains.resize(frame_count);
+  for (auto& chain : frame_chains) {
+    chain = Core::make_scope<PoolChain>();
+    create_chained_pool(
+      *chain, size_frame_pool(peak_frame_usage, minimum_frame_pool), 0);
+  }
 
+  create_chained_pool(persistent_chain,
+                      initial_persistent_pool,
+                      VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+  pending_frees.resize(frame_count);
 }
+
+} // namespace Engine::Graphics
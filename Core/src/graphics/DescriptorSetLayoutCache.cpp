@@ -0,0 +1,107 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/DescriptorSetLayoutCache.hpp"
+
+#include "core/Verify.hpp"
+#include "graphics/Device.hpp"
+#include "logging/Logger.hpp"
+
+namespace Engine::Graphics {
+
+namespace {
+auto
+make_signature(std::span<const VkDescriptorSetLayoutBinding> bindings)
+  -> std::string
+{
+  std::string signature;
+  signature.reserve(bindings.size() * 4 * sizeof(Core::u32));
+  const auto append = [&signature](Core::u32 value) {
+    signature.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  for (const auto& binding : bindings) {
+    // Immutable samplers are never used by reflected layouts.
+    Core::ensure(binding.pImmutableSamplers == nullptr,
+                 "Cached layouts cannot have immutable samplers.");
+    append(binding.binding);
+    append(static_cast<Core::u32>(binding.descriptorType));
+    append(binding.descriptorCount);
+    append(binding.stageFlags);
+  }
+  return signature;
+}
+} // namespace
+
+auto
+DescriptorSetLayoutCache::acquire(
+  std::span<const VkDescriptorSetLayoutBinding> bindings)
+  -> VkDescriptorSetLayout
+{
+  auto signature = make_signature(bindings);
+
+  std::scoped_lock lock{ mutex };
+  auto& entry = entries[signature];
+  if (entry.layout != VK_NULL_HANDLE) {
+    entry.users++;
+    reused++;
+    return entry.layout;
+  }
+
+  VkDescriptorSetLayoutCreateInfo create_info{};
+  create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  create_info.bindingCount = static_cast<Core::u32>(bindings.size());
+  create_info.pBindings = bindings.data();
+  VK_CHECK(vkCreateDescriptorSetLayout(
+    Device::the().device(), &create_info, nullptr, &entry.layout));
+  entry.users = 1;
+  created++;
+  signatures[entry.layout] = std::move(signature);
+  pool_usages[entry.layout] = DescriptorPoolUsage::from_bindings(bindings);
+  return entry.layout;
+}
+
+auto
+DescriptorSetLayoutCache::release(VkDescriptorSetLayout layout) -> void
+{
+  if (layout == VK_NULL_HANDLE) {
+    return;
+  }
+
+  std::scoped_lock lock{ mutex };
+  const auto signature = signatures.find(layout);
+  if (signature == signatures.end()) {
+    warn("Released a descriptor set layout the cache does not own");
+    return;
+  }
+  auto& entry = entries.at(signature->second);
+  if (--entry.users > 0) {
+    return;
+  }
+
+  vkDestroyDescriptorSetLayout(Device::the().device(), layout, nullptr);
+  entries.erase(signature->second);
+  signatures.erase(signature);
+  pool_usages.erase(layout);
+}
+
+auto
+DescriptorSetLayoutCache::get_pool_usage(VkDescriptorSetLayout layout) const
+  -> DescriptorPoolUsage
+{
+  std::shared_lock lock{ mutex };
+  const auto usage = pool_usages.find(layout);
+  return usage != pool_usages.end() ? usage->second : DescriptorPoolUsage{};
+}
+
+auto
+DescriptorSetLayoutCache::get_statistics() const
+  -> DescriptorSetLayoutCacheStatistics
+{
+  std::scoped_lock lock{ mutex };
+  return {
+    .created = created,
+    .reused = reused,
+    .alive = static_cast<Core::u32>(entries.size()),
+  };
+}
+
+} // namespace Engine::Graphics
@@ -1,10 +1,13 @@
 #include "pch/CorePCH.hpp"
 
 #include "graphics/Device.hpp"
+
+#include "core/Verify.hpp"
 #include "graphics/Instance.hpp"
 #include "logging/Logger.hpp"
 
 #include "graphics/CommandBuffer.hpp"
+#include "graphics/PipelineCacheFile.hpp"
 
 namespace Engine::Graphics {
 
@@ -16,6 +19,7 @@ Device::is_device_suitable(VkPhysicalDevice device,
   Core::i32 present_family_index = -1;
   Core::i32 compute_family_index = -1;
   Core::i32 transfer_family_index = -1;
+  bool is_dedicated_compute = false;
 
   Core::u32 family_count = 0;
   vkGetPhysicalDeviceQueueFamilyProperties(device, &family_count, nullptr);
@@ -29,8 +33,14 @@ Device::is_device_suitable(VkPhysicalDevice device,
       graphics_family_index = static_cast<Core::i32>(i);
     }
 
-    if (families[i].queueFlags & VK_QUEUE_COMPUTE_BIT) {
+    // A compute family without graphics runs asynchronously to the
+    // graphics queue, so it is preferred over any other.
+    const auto has_compute = families[i].queueFlags & VK_QUEUE_COMPUTE_BIT;
+    const auto has_graphics = families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT;
+    if (has_compute && (!has_graphics || compute_family_index < 0) &&
+        !is_dedicated_compute) {
       compute_family_index = static_cast<Core::i32>(i);
+      is_dedicated_compute = !has_graphics;
     }
 
     if (families[i].queueFlags & VK_QUEUE_TRANSFER_BIT) {
@@ -135,6 +145,25 @@ check_memory_priority_support(VkPhysicalDevice device)
   return memory_priority_features.memoryPriority == VK_TRUE;
 }
 
+bool
+check_gpu_driven_draw_support(VkPhysicalDevice device)
+{
+  VkPhysicalDeviceFeatures2 base_features{};
+  VkPhysicalDeviceVulkan12Features vulkan_12_features{};
+
+  base_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  vulkan_12_features.sType =
+    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+  base_features.pNext = &vulkan_12_features;
+
+  vkGetPhysicalDeviceFeatures2(device, &base_features);
+
+  return vulkan_12_features.drawIndirectCount == VK_TRUE &&
+         base_features.features.multiDrawIndirect == VK_TRUE &&
+         base_features.features.drawIndirectFirstInstance == VK_TRUE;
+}
+
 Device::Device(VkSurfaceKHR surf)
 {
   create_device(surf);
@@ -244,11 +273,23 @@ Device::create_device(VkSurfaceKHR surface) -> void
   device_features.independentBlend = VK_TRUE;
   device_features.textureCompressionBC = VK_TRUE;
 
+  // Optional: without these the renderer keeps to CPU culled draws.
+  gpu_driven_draw_support = check_gpu_driven_draw_support(vk_physical_device);
+  VkPhysicalDeviceVulkan12Features vulkan_12_features{};
+  vulkan_12_features.sType =
+    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+  if (gpu_driven_draw_support) {
+    device_features.multiDrawIndirect = VK_TRUE;
+    device_features.drawIndirectFirstInstance = VK_TRUE;
+    vulkan_12_features.drawIndirectCount = VK_TRUE;
+  }
+
   VkPhysicalDeviceFeatures2 device_features_2{};
   VkPhysicalDeviceMemoryPriorityFeaturesEXT memory_priority_features{};
   memory_priority_features.sType =
     VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PRIORITY_FEATURES_EXT;
   memory_priority_features.memoryPriority = VK_TRUE;
+  memory_priority_features.pNext = &vulkan_12_features;
 
   device_features_2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
   device_features_2.pNext = &memory_priority_features;
@@ -314,6 +355,57 @@ Device::create_device(VkSurfaceKHR surface) -> void
     queue_support.at(QueueType::Transfer).family_index;
   vkCreateCommandPool(
     device(), &command_pool_create_info, nullptr, &transfer_command_pool);
+
+  create_pipeline_cache();
+}
+
+namespace {
+constexpr std::string_view pipeline_cache_path =
+  "Assets/shaders/.cache/pipelines.bin";
+
+auto
+get_device_identity(VkPhysicalDevice physical_device)
+  -> PipelineCacheFile::DeviceIdentity
+{
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+  return PipelineCacheFile::get_identity(properties);
+}
+}
+
+auto
+Device::create_pipeline_cache() -> void
+{
+  // Written by another device or driver, the data is dropped and the cache
+  // starts out empty.
+  const auto data = PipelineCacheFile::read(
+    pipeline_cache_path, get_device_identity(vk_physical_device));
+
+  VkPipelineCacheCreateInfo create_info{};
+  create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  create_info.initialDataSize = data.size();
+  create_info.pInitialData = data.data();
+  VK_CHECK(
+    vkCreatePipelineCache(vk_device, &create_info, nullptr, &pipeline_cache));
+
+  info("Pipeline cache: loaded {} bytes from {}",
+       data.size(),
+       pipeline_cache_path);
+}
+
+auto
+Device::save_pipeline_cache() const -> void
+{
+  Core::usize size = 0;
+  VK_CHECK(vkGetPipelineCacheData(vk_device, pipeline_cache, &size, nullptr));
+  std::vector<std::byte> data(size);
+  VK_CHECK(
+    vkGetPipelineCacheData(vk_device, pipeline_cache, &size, data.data()));
+  data.resize(size);
+
+  if (!PipelineCacheFile::write(pipeline_cache_path, data)) {
+    warn("Could not write the pipeline cache to {}", pipeline_cache_path);
+  }
 }
 
 auto
@@ -402,6 +494,9 @@ Device::reset_command_pools() -> void
 auto
 Device::deinitialise() -> void
 {
+  save_pipeline_cache();
+  vkDestroyPipelineCache(vk_device, pipeline_cache, nullptr);
+
   vkDestroyCommandPool(vk_device, graphics_command_pool, nullptr);
   vkDestroyCommandPool(vk_device, compute_command_pool, nullptr);
   vkDestroyCommandPool(vk_device, transfer_command_pool, nullptr);
@@ -0,0 +1,343 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/DrawListBuilder.hpp"
+
+#include "core/Profiler.hpp"
+#include "core/Verify.hpp"
+
+#include "thread_pool/ThreadPool.hpp"
+
+#include <bit>
+
+namespace Engine::Graphics {
+
+namespace {
+// Fields are byte aligned so that a field which is constant over a frame (one
+// vertex buffer, fewer than 256 submeshes, ...) costs no radix passes at all.
+// The list type and layer share the top byte.
+constexpr Core::u32 list_bits = 4;
+constexpr Core::u32 layer_bits = 4;
+constexpr Core::u32 material_bits = 16;
+constexpr Core::u32 vertex_buffer_bits = 24;
+constexpr Core::u32 submesh_bits = 16;
+static_assert(list_bits + layer_bits + material_bits + vertex_buffer_bits +
+                submesh_bits ==
+              64);
+static_assert(DrawListBuilder::layer_count == 1U << layer_bits);
+
+constexpr Core::u32 radix_bits = 8;
+constexpr Core::u32 radix_size = 1U << radix_bits;
+constexpr Core::u32 radix_passes = 64 / radix_bits;
+
+// Fibonacci hashing folds a pointer into the top `bits` bits. Collisions only
+// cost batching (build() still splits on the full CommandKey), never
+// correctness.
+constexpr auto fold_pointer = [](const void* pointer, Core::u32 bits) {
+  const auto value =
+    static_cast<Core::u64>(std::bit_cast<std::uintptr_t>(pointer));
+  return (value * 0x9E3779B97F4A7C15ULL) >> (64U - bits);
+};
+
+auto
+pack_rows(const glm::mat4& transform) -> TransformVertexData
+{
+  TransformVertexData output;
+  output.transform_rows[0] = {
+    transform[0][0],
+    transform[1][0],
+    transform[2][0],
+    transform[3][0],
+  };
+  output.transform_rows[1] = {
+    transform[0][1],
+    transform[1][1],
+    transform[2][1],
+    transform[3][1],
+  };
+  output.transform_rows[2] = {
+    transform[0][2],
+    transform[1][2],
+    transform[2][2],
+    transform[3][2],
+  };
+  return output;
+}
+}
+
+DrawListBuilder::DrawListBuilder(ListType type, Core::u32 bucket_count)
+  : list_type(type)
+{
+  // One bucket for the calling thread plus one per pool worker.
+  if (bucket_count == 0) {
+    bucket_count = std::max(std::thread::hardware_concurrency(), 1U) + 1;
+  }
+  buckets.resize(bucket_count);
+}
+
+auto
+DrawListBuilder::compute_sort_key(ListType type,
+                                  const CommandKey& key,
+                                  Core::u32 layer) -> Core::u64
+{
+  auto sort_key = static_cast<Core::u64>(type);
+  sort_key = (sort_key << layer_bits) | (layer & ((1U << layer_bits) - 1));
+  sort_key =
+    (sort_key << material_bits) | fold_pointer(key.material, material_bits);
+  sort_key = (sort_key << vertex_buffer_bits) |
+             fold_pointer(key.vertex_buffer, vertex_buffer_bits);
+  sort_key = (sort_key << submesh_bits) |
+             (key.submesh_index & ((1U << submesh_bits) - 1));
+  return sort_key;
+}
+
+auto
+DrawListBuilder::current_bucket() -> std::vector<Submission>&
+{
+  const auto thread_index = BS::this_thread::get_index();
+  const auto slot = thread_index ? *thread_index + 1 : 0;
+  Core::ensure(slot < buckets.size(),
+               "Draw list submitted from more threads than it has buckets.");
+  return buckets[slot];
+}
+
+auto
+DrawListBuilder::submit(const CommandKey& key,
+                        const StaticMesh* static_mesh,
+                        const glm::mat4& transform,
+                        Core::u32 data) -> void
+{
+  current_bucket().push_back(Submission{
+    .key = key,
+    .static_mesh = static_mesh,
+    .sort_key = compute_sort_key(list_type, key),
+    .user_data = data,
+    .transform = pack_rows(transform),
+  });
+}
+
+auto
+DrawListBuilder::submit(const CommandKey& key,
+                        const StaticMesh* static_mesh,
+                        std::span<const TransformVertexData> transforms,
+                        Core::u32 first_user_data,
+                        Core::u32 layer) -> void
+{
+  Core::ensure(layer < layer_count, "Draw list layer out of range.");
+  auto& bucket = current_bucket();
+  const auto sort_key = compute_sort_key(list_type, key, layer);
+  for (auto i = 0U; i < transforms.size(); i++) {
+    bucket.push_back(Submission{
+      .key = key,
+      .static_mesh = static_mesh,
+      .sort_key = sort_key,
+      .user_data = first_user_data + i,
+      .layer = layer,
+      .transform = transforms[i],
+    });
+  }
+}
+
+auto
+DrawListBuilder::get_submission_count() const -> Core::usize
+{
+  Core::usize count = 0;
+  for (const auto& bucket : buckets) {
+    count += bucket.size();
+  }
+  return count;
+}
+
+auto
+DrawListBuilder::radix_sort() -> void
+{
+  ASTUTE_PROFILE_FUNCTION();
+
+  // Only bytes that differ between keys need a pass, which with byte aligned
+  // fields is usually two or three out of eight.
+  Core::u64 varying = 0;
+  const auto first_key = sort_items[0].sort_key;
+  for (auto i = 1U; i < item_count; i++) {
+    varying |= sort_items[i].sort_key ^ first_key;
+  }
+
+  for (auto pass = 0U; pass < radix_passes; pass++) {
+    const auto shift = pass * radix_bits;
+    if (((varying >> shift) & 0xFF) == 0) {
+      continue;
+    }
+
+    std::array<Core::u32, radix_size> histogram{};
+    for (auto i = 0U; i < item_count; i++) {
+      histogram[(sort_items[i].sort_key >> shift) & 0xFF]++;
+    }
+
+    Core::u32 running = 0;
+    for (auto& bin : histogram) {
+      const auto bin_count = bin;
+      bin = running;
+      running += bin_count;
+    }
+
+    for (auto i = 0U; i < item_count; i++) {
+      const auto& item = sort_items[i];
+      const auto digit = (item.sort_key >> shift) & 0xFF;
+      sort_scratch[histogram[digit]++] = item;
+    }
+    std::swap(sort_items, sort_scratch);
+  }
+}
+
+auto
+DrawListBuilder::submission_at(Core::u32 index) const -> const Submission&
+{
+  const auto bucket = std::ranges::upper_bound(bucket_offsets, index) - 1;
+  return buckets[static_cast<Core::usize>(bucket - bucket_offsets.begin())]
+                [index - *bucket];
+}
+
+auto
+DrawListBuilder::build(std::span<TransformVertexData> destination,
+                       Core::u32 base,
+                       ED::ThreadPool* thread_pool) -> void
+{
+  ASTUTE_PROFILE_FUNCTION();
+
+  base_instance = base;
+  batches.clear();
+  layer_offsets.fill(0);
+
+  item_count = static_cast<Core::u32>(get_submission_count());
+  Core::ensure(destination.size() >= item_count,
+               "Draw list transform destination is too small.");
+  // Only ever grows, so steady state frames do not touch the allocator.
+  if (sort_items.size() < item_count) {
+    sort_items.resize(item_count);
+    sort_scratch.resize(item_count);
+    destinations.resize(item_count);
+    batch_indices.resize(item_count);
+    user_data.resize(item_count);
+  }
+
+  bucket_offsets.resize(buckets.size());
+  Core::u32 write_index = 0;
+  for (auto bucket_index = 0U; bucket_index < buckets.size(); bucket_index++) {
+    bucket_offsets[bucket_index] = write_index;
+    for (const auto& submission : buckets[bucket_index]) {
+      sort_items[write_index] = {
+        .sort_key = submission.sort_key,
+        .submission = write_index,
+      };
+      write_index++;
+    }
+  }
+  if (item_count == 0) {
+    return;
+  }
+
+  // LSD radix sort is stable, so instances of one batch keep their submission
+  // order (the lights pass relies on this for its per-instance colours).
+  radix_sort();
+
+  // Batches split on the sort key alone, which only touches the sorted keys.
+  // Submission data is then moved with one sequential read of the buckets,
+  // rather than a random gather per instance. With a mapped destination that
+  // is the only copy a transform makes on its way to the GPU.
+  for (auto i = 0U; i < item_count; i++) {
+    const auto& item = sort_items[i];
+    if (i == 0 || item.sort_key != sort_items[i - 1].sort_key) {
+      const auto& first = submission_at(item.submission);
+      layer_offsets[first.layer + 1]++;
+      batches.push_back(DrawBatch{
+        .key = first.key,
+        .static_mesh = first.static_mesh,
+        .submesh_index = first.key.submesh_index,
+        .instance_count = 0,
+        .first_instance = base_instance + i,
+      });
+    }
+    batches.back().instance_count++;
+    destinations[item.submission] = i;
+    batch_indices[item.submission] = static_cast<Core::u32>(batches.size() - 1);
+  }
+
+  std::atomic_bool collided{ false };
+  const auto scatter = [this, &collided, destination](
+                         Core::usize bucket_index) {
+    const auto& bucket = buckets[bucket_index];
+    const auto offset = bucket_offsets[bucket_index];
+    for (auto i = 0U; i < bucket.size(); i++) {
+      const auto& submission = bucket[i];
+      const auto sorted_index = destinations[offset + i];
+      destination[sorted_index] = submission.transform;
+      user_data[sorted_index] = submission.user_data;
+      if (batches[batch_indices[offset + i]].key != submission.key) {
+        collided.store(true, std::memory_order_relaxed);
+      }
+    }
+  };
+  if (thread_pool != nullptr) {
+    thread_pool->enqueue_loop_split(buckets, scatter).wait();
+  } else {
+    for (auto i = 0ULL; i < buckets.size(); i++) {
+      scatter(i);
+    }
+  }
+
+  if (collided.load(std::memory_order_relaxed)) {
+    split_colliding_batches();
+  }
+  compute_layer_offsets();
+}
+
+auto
+DrawListBuilder::split_colliding_batches() -> void
+{
+  ASTUTE_PROFILE_FUNCTION();
+
+  // Two CommandKeys folded to the same sort key. The sorted order (and so the
+  // transforms) is still valid, only the batches need splitting on the full
+  // key. Equal keys may end up in several batches, which is merely slower.
+  batches.clear();
+  layer_offsets.fill(0);
+  Core::u32 previous_layer = 0;
+  for (auto i = 0U; i < item_count; i++) {
+    const auto& submission = submission_at(sort_items[i].submission);
+    if (!batches.empty() && batches.back().key == submission.key &&
+        previous_layer == submission.layer) {
+      batches.back().instance_count++;
+      continue;
+    }
+    previous_layer = submission.layer;
+    layer_offsets[submission.layer + 1]++;
+    batches.push_back(DrawBatch{
+      .key = submission.key,
+      .static_mesh = submission.static_mesh,
+      .submesh_index = submission.key.submesh_index,
+      .instance_count = 1,
+      .first_instance = base_instance + i,
+    });
+  }
+}
+
+auto
+DrawListBuilder::compute_layer_offsets() -> void
+{
+  // Holds the batch count of each layer at index layer + 1. Batches are
+  // sorted by layer, so a prefix sum gives where each layer starts.
+  for (auto layer = 1U; layer <= layer_count; layer++) {
+    layer_offsets[layer] += layer_offsets[layer - 1];
+  }
+}
+
+auto
+DrawListBuilder::clear() -> void
+{
+  for (auto& bucket : buckets) {
+    bucket.clear();
+  }
+  batches.clear();
+  layer_offsets.fill(0);
+  item_count = 0;
+}
+
+} // namespace Engine::Graphics
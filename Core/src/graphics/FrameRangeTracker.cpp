@@ -0,0 +1,50 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/FrameRangeTracker.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace Engine::Graphics {
+
+auto
+FrameRangeTracker::Range::merged(const Range& other) const -> Range
+{
+  if (empty()) {
+    return other;
+  }
+  if (other.empty()) {
+    return *this;
+  }
+  const auto begin = std::min(offset, other.offset);
+  const auto end = std::max(offset + size, other.offset + other.size);
+  return { begin, end - begin };
+}
+
+FrameRangeTracker::FrameRangeTracker(Core::u32 frame_count)
+  : stale(std::max(frame_count, 1U))
+{
+}
+
+auto
+FrameRangeTracker::update(Core::u32 frame, const Range& changed) -> Range
+{
+  for (auto& range : stale) {
+    range = range.merged(changed);
+  }
+  return refresh(frame);
+}
+
+auto
+FrameRangeTracker::refresh(Core::u32 frame) -> Range
+{
+  return std::exchange(stale.at(frame), Range{});
+}
+
+auto
+FrameRangeTracker::reset() -> void
+{
+  std::ranges::fill(stale, Range{});
+}
+
+} // namespace Engine::Graphics
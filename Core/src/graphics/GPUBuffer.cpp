@@ -2,12 +2,15 @@
 
 #include "graphics/GPUBuffer.hpp"
 
+#include "core/Verify.hpp"
 #include "graphics/Allocator.hpp"
 
 #include "logging/Logger.hpp"
 
 #include <vk_mem_alloc.h>
 
+#include <algorithm>
+
 namespace Engine::Graphics {
 
 static auto
@@ -25,6 +28,10 @@ to_string(GPUBufferType buffer_type) -> std::string
       return "Uniform";
     case Staging:
       return "Staging";
+    case Indirect:
+      return "Indirect";
+    case Instance:
+      return "Instance";
     default:
       return "Unknown";
   }
@@ -92,6 +99,12 @@ GPUBuffer::buffer_usage_flags() const -> VkBufferUsageFlags
       return VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
     case Staging:
       return VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    case Indirect:
+      return VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+             VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    case Instance:
+      return VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+             VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
     default:
       return 0;
   }
@@ -109,18 +122,25 @@ GPUBuffer::construct_buffer() -> void
         to_string(buffer_type),
         Core::human_readable_size(size));
 
+  // Buffers are shared by every queue that may touch them, so that passes
+  // on the compute queue need no ownership transfers for them.
   std::array family_indices{
     Device::the().get_family(QueueType::Graphics),
     Device::the().get_family(QueueType::Transfer),
+    Device::the().get_family(QueueType::Compute),
   };
+  std::ranges::sort(family_indices);
+  const auto unique_count = static_cast<Core::u32>(
+    std::ranges::unique(family_indices).begin() - family_indices.begin());
   VkBufferCreateInfo buffer_info{
     .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
     .pNext = nullptr,
     .flags = 0,
     .size = size,
     .usage = buffer_usage_flags(),
-    .sharingMode = VK_SHARING_MODE_CONCURRENT,
-    .queueFamilyIndexCount = static_cast<Core::u32>(family_indices.size()),
+    .sharingMode = unique_count > 1 ? VK_SHARING_MODE_CONCURRENT
+                                    : VK_SHARING_MODE_EXCLUSIVE,
+    .queueFamilyIndexCount = unique_count,
     .pQueueFamilyIndices = family_indices.data(),
   };
 
@@ -140,26 +160,53 @@ GPUBuffer::construct_buffer() -> void
 }
 
 auto
-GPUBuffer::write(const void* write_data, const Core::usize write_size) -> void
+GPUBuffer::write(const void* write_data,
+                 const Core::usize write_size,
+                 const Core::usize offset) -> void
 {
   Allocator allocator{
     std::format("GPUBuffer::write({}, {})", to_string(buffer_type), size),
   };
-  if (write_size > size) {
+  if (offset + write_size > size) {
     throw std::runtime_error("Data size is larger than buffer size");
   }
 
   if (alloc_impl->allocation_info.pMappedData != nullptr) {
-    std::memcpy(
-      alloc_impl->allocation_info.pMappedData, write_data, write_size);
-  } else {
     auto* mapped =
-      std::bit_cast<void*>(allocator.map_memory(alloc_impl->allocation));
-    std::memcpy(mapped, write_data, write_size);
+      std::bit_cast<std::byte*>(alloc_impl->allocation_info.pMappedData);
+    std::memcpy(mapped + offset, write_data, write_size);
+  } else {
+    auto* mapped = allocator.map_memory<std::byte>(alloc_impl->allocation);
+    std::memcpy(mapped + offset, write_data, write_size);
     allocator.unmap_memory(alloc_impl->allocation);
   }
 }
 
+auto
+GPUBuffer::get_mapped_data() const -> void*
+{
+  return alloc_impl->allocation_info.pMappedData;
+}
+
+auto
+GPUBuffer::flush(Core::usize offset, Core::usize flush_size) const -> void
+{
+  VK_CHECK(vmaFlushAllocation(Allocator::get_allocator(),
+                              alloc_impl->allocation,
+                              offset,
+                              flush_size));
+}
+
+auto
+GPUBuffer::invalidate(Core::usize offset, Core::usize invalidate_size) const
+  -> void
+{
+  VK_CHECK(vmaInvalidateAllocation(Allocator::get_allocator(),
+                                   alloc_impl->allocation,
+                                   offset,
+                                   invalidate_size));
+}
+
 auto
 GPUBuffer::copy_to(GPUBuffer& dest) -> void
 {
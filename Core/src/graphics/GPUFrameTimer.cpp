@@ -0,0 +1,88 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/GPUFrameTimer.hpp"
+
+#include "graphics/CommandBuffer.hpp"
+#include "graphics/Device.hpp"
+
+#include "logging/Logger.hpp"
+
+#include <array>
+
+namespace Engine::Graphics {
+
+GPUFrameTimer::GPUFrameTimer(Core::u32 frame_count)
+  : written(frame_count, false)
+{
+  VkPhysicalDeviceProperties properties{};
+  vkGetPhysicalDeviceProperties(Device::the().physical(), &properties);
+  if (properties.limits.timestampComputeAndGraphics == VK_FALSE) {
+    info("Timestamps are not supported on every queue, GPU frame times "
+         "are not measured.");
+    return;
+  }
+  nanoseconds_per_tick = properties.limits.timestampPeriod;
+
+  VkQueryPoolCreateInfo create_info{};
+  create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  create_info.queryCount = 2 * frame_count;
+  vkCreateQueryPool(
+    Device::the().device(), &create_info, nullptr, &query_pool);
+}
+
+GPUFrameTimer::~GPUFrameTimer()
+{
+  if (query_pool != nullptr) {
+    vkDestroyQueryPool(Device::the().device(), query_pool, nullptr);
+  }
+}
+
+auto
+GPUFrameTimer::begin(const CommandBuffer& command_buffer, Core::u32 frame)
+  -> void
+{
+  if (query_pool == nullptr) {
+    return;
+  }
+
+  current_frame = frame;
+  if (written.at(frame)) {
+    std::array<Core::u64, 2> timestamps{};
+    const auto result = vkGetQueryPoolResults(Device::the().device(),
+                                              query_pool,
+                                              2 * frame,
+                                              2,
+                                              sizeof(timestamps),
+                                              timestamps.data(),
+                                              sizeof(Core::u64),
+                                              VK_QUERY_RESULT_64_BIT);
+    if (result == VK_SUCCESS && timestamps[1] >= timestamps[0]) {
+      time = static_cast<Core::f64>(timestamps[1] - timestamps[0]) *
+             nanoseconds_per_tick / 1'000'000.0;
+    }
+  }
+
+  vkCmdResetQueryPool(
+    command_buffer.get_command_buffer(), query_pool, 2 * frame, 2);
+  vkCmdWriteTimestamp(command_buffer.get_command_buffer(),
+                      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                      query_pool,
+                      2 * frame);
+}
+
+auto
+GPUFrameTimer::end(const CommandBuffer& command_buffer) -> void
+{
+  if (query_pool == nullptr) {
+    return;
+  }
+
+  vkCmdWriteTimestamp(command_buffer.get_command_buffer(),
+                      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                      query_pool,
+                      2 * current_frame + 1);
+  written.at(current_frame) = true;
+}
+
+} // namespace Engine::Graphics
@@ -79,13 +79,35 @@ GraphicsPipeline::destroy() -> void
 }
 
 auto
-GraphicsPipeline::on_resize(const Core::Extent&) -> void
+GraphicsPipeline::needs_recreation() const -> bool
 {
-  destroy();
-  create_layout();
+  return get_attachment_states() != baked_attachments;
+}
+
+auto
+GraphicsPipeline::recreate() -> void
+{
+  // The layout only depends on the shader.
+  vkDestroyPipeline(Device::the().device(), pipeline, nullptr);
   create_pipeline();
 }
 
+auto
+GraphicsPipeline::get_attachment_states() const
+  -> std::vector<AttachmentState>
+{
+  std::vector<AttachmentState> states;
+  for (auto i = 0U; i < framebuffer->get_colour_attachment_count(); i++) {
+    const auto& image = framebuffer->get_colour_attachment(i);
+    states.push_back({ image->get_format(), image->get_sample_count() });
+  }
+  if (framebuffer->has_depth_attachment()) {
+    const auto& image = framebuffer->get_depth_attachment();
+    states.push_back({ image->get_format(), image->get_sample_count() });
+  }
+  return states;
+}
+
 auto
 GraphicsPipeline::create_pipeline() -> void
 {
@@ -281,11 +303,12 @@ GraphicsPipeline::create_pipeline() -> void
   pipeline_info.basePipelineIndex = -1;
 
   VK_CHECK(vkCreateGraphicsPipelines(Device::the().device(),
-                                     VK_NULL_HANDLE,
+                                     Device::the().get_pipeline_cache(),
                                      1,
                                      &pipeline_info,
                                      nullptr,
                                      &pipeline));
+  baked_attachments = get_attachment_states();
 }
 
 auto
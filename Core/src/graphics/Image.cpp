@@ -6,8 +6,10 @@
 #include "graphics/CommandBuffer.hpp"
 #include "graphics/Image.hpp"
 #include "graphics/Renderer.hpp"
+#include "graphics/TransientImageMemory.hpp"
 
 #include "core/DataBuffer.hpp"
+#include "core/Hash.hpp"
 
 #include "core/Verify.hpp"
 
@@ -16,16 +18,6 @@
 #include <stb_image_write.h>
 #include <vk_mem_alloc.h>
 
-template<>
-struct std::hash<VkImage>
-{
-  auto operator()(VkImage const& image) const -> Engine::Core::usize
-  {
-    return std::hash<Engine::Core::usize>{}(
-      std::bit_cast<Engine::Core::usize>(image));
-  }
-};
-
 template<>
 struct std::formatter<VkFormat> : public std::formatter<std::string_view>
 {
@@ -45,11 +37,8 @@ struct std::formatter<VkImageLayout> : public std::formatter<std::string_view>
 
 namespace Engine::Graphics {
 
-void
-create_image(const ImageConfiguration& config,
-             VkImage& image,
-             VmaAllocation& allocation,
-             VmaAllocationInfo& allocation_info)
+auto
+make_image_create_info(const ImageConfiguration& config) -> VkImageCreateInfo
 {
   VkImageCreateInfo imageInfo{};
   imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -69,6 +58,16 @@ create_image(const ImageConfiguration& config,
   }
   imageInfo.samples = config.sample_count;
   imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  return imageInfo;
+}
+
+void
+create_image(const ImageConfiguration& config,
+             VkImage& image,
+             VmaAllocation& allocation,
+             VmaAllocationInfo& allocation_info)
+{
+  auto imageInfo = make_image_create_info(config);
 
   Allocator allocator{
     std::format("Format-{}-SampleCount-{}-AdditionalData-{}",
@@ -93,6 +92,23 @@ create_image(const ImageConfiguration& config,
         (const void*)image);
 }
 
+void
+create_placed_image(const ImageConfiguration& config,
+                    const TransientImageMemory& memory,
+                    VkDeviceSize offset,
+                    VkImage& image)
+{
+  const auto imageInfo = make_image_create_info(config);
+  VK_CHECK(
+    vkCreateImage(Device::the().device(), &imageInfo, nullptr, &image));
+  memory.bind(image, offset);
+
+  trace("Placed image '{}' at offset {}, Vulkan pointer: {}",
+        config.additional_name_data,
+        offset,
+        (const void*)image);
+}
+
 void
 transition_image_layout(VkCommandBuffer buffer,
                         VkImage image,
@@ -436,8 +452,13 @@ Image::destroy() -> void
   }
   mip_image_views.clear();
 
-  Allocator allocator{ "destroy_image" };
-  allocator.deallocate_image(alloc_impl->allocation, image);
+  if (alloc_impl->allocation == nullptr) {
+    // Placed in transient memory, which outlives the image.
+    vkDestroyImage(Device::the().device(), image, nullptr);
+  } else {
+    Allocator allocator{ "destroy_image" };
+    allocator.deallocate_image(alloc_impl->allocation, image);
+  }
   alloc_impl.reset(new ImageImpl);
 
   destroyed = true;
@@ -462,7 +483,7 @@ Image::get_descriptor_info() const -> const VkDescriptorImageInfo&
 auto
 Image::hash() const -> Core::usize
 {
-  return std::hash<VkImage>{}(image);
+  return Core::hash_values(std::bit_cast<const void*>(image));
 }
 
 auto
@@ -482,15 +503,23 @@ Image::load_from_file_into_staging(const std::string_view path,
   Core::i32 channels{};
   auto* pixel_data = stbi_load(
     whole_path.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+  if (pixel_data == nullptr) {
+    error("Could not decode image at '{}': {}",
+          whole_path.string(),
+          stbi_failure_reason());
+    throw std::runtime_error("Could not decode image");
+  }
 
-  Core::DataBuffer data_buffer{
-    width * height * STBI_rgb_alpha,
-  };
-  data_buffer.write(std::span{
-    pixel_data, static_cast<Core::usize>(width * height * STBI_rgb_alpha) });
+  // Straight into the staging buffer, without an intermediate copy. This runs
+  // on worker threads when meshes load their textures.
+  auto staging = Core::make_ref<StagingBuffer>(std::span{
+    pixel_data,
+    static_cast<Core::usize>(width) * static_cast<Core::usize>(height) *
+      STBI_rgb_alpha,
+  });
   trace("Loaded image from file '{}', size: {}",
         whole_path.string(),
-        data_buffer.size());
+        staging->size());
   stbi_image_free(pixel_data);
 
   if (out_w != nullptr) {
@@ -500,7 +529,7 @@ Image::load_from_file_into_staging(const std::string_view path,
     *out_h = static_cast<Core::u32>(height);
   }
 
-  return Core::make_ref<StagingBuffer>(std::move(data_buffer));
+  return staging;
 }
 
 auto
@@ -804,8 +833,15 @@ Image::invalidate() -> void
 {
   destroy();
 
-  create_image(
-    configuration, image, alloc_impl->allocation, alloc_impl->allocation_info);
+  if (transient_memory != nullptr) {
+    create_placed_image(
+      configuration, *transient_memory, transient_offset, image);
+  } else {
+    create_image(configuration,
+                 image,
+                 alloc_impl->allocation,
+                 alloc_impl->allocation_info);
+  }
 
   VkImageViewCreateInfo view_create_info{};
   view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -850,6 +886,22 @@ Image::invalidate() -> void
   });
 }
 
+auto
+Image::place_in(const TransientImageMemory* memory, VkDeviceSize offset)
+  -> void
+{
+  transient_memory = memory;
+  transient_offset = memory != nullptr ? offset : 0;
+}
+
+auto
+Image::get_memory_requirements() const -> VkMemoryRequirements
+{
+  VkMemoryRequirements requirements{};
+  vkGetImageMemoryRequirements(Device::the().device(), image, &requirements);
+  return requirements;
+}
+
 auto
 Image::generate_mips(VkCommandBuffer buf) -> void
 {
@@ -968,34 +1020,26 @@ Image::hash() -> Core::usize
 auto
 Image::invalidate_hash() -> void
 {
-  static constexpr auto golden_ratio_constant = 0x9e3779b9;
-  static constexpr auto hash_combine = []<typename... Ts>(Core::usize& seed,
-                                                          Ts... ts) {
-    ((seed ^=
-      std::hash<Ts>{}(ts) + golden_ratio_constant + (seed << 6) + (seed >> 2)),
-     ...);
-  };
-
-  hash_value = 0;
-  hash_combine(hash_value.value(),
-               configuration.width,
-               configuration.height,
-               configuration.format,
-               configuration.sample_count,
-               configuration.mip_levels,
-               configuration.layers,
-               configuration.usage,
-               configuration.tiling,
-               configuration.layout,
-               configuration.min_filter,
-               configuration.mag_filter,
-               configuration.address_mode_u,
-               configuration.address_mode_v,
-               configuration.address_mode_w,
-               configuration.border_colour,
-               std::bit_cast<const void*>(view),
-               std::bit_cast<const void*>(sampler),
-               std::bit_cast<const void*>(image));
+  // The handles make this an identity hash: two images with the same
+  // configuration are still different descriptors.
+  hash_value = Core::hash_values(configuration.width,
+                                configuration.height,
+                                configuration.format,
+                                configuration.sample_count,
+                                configuration.mip_levels,
+                                configuration.layers,
+                                configuration.usage,
+                                configuration.tiling,
+                                configuration.layout,
+                                configuration.min_filter,
+                                configuration.mag_filter,
+                                configuration.address_mode_u,
+                                configuration.address_mode_v,
+                                configuration.address_mode_w,
+                                configuration.border_colour,
+                                std::bit_cast<const void*>(view),
+                                std::bit_cast<const void*>(sampler),
+                                std::bit_cast<const void*>(image));
 }
 
 auto
@@ -0,0 +1,135 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/IndirectDrawBuilder.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Engine::Graphics {
+
+namespace {
+// Commands of one group are drawn with the same bindings.
+auto
+same_group(const CommandKey& lhs, const CommandKey& rhs) -> bool
+{
+  return lhs.vertex_buffer == rhs.vertex_buffer &&
+         lhs.index_buffer == rhs.index_buffer && lhs.material == rhs.material;
+}
+}
+
+auto
+IndirectDrawBuilder::submit(const CommandKey& key,
+                            const StaticMesh* static_mesh,
+                            const Core::AABB& local_bounds,
+                            const VkDrawIndexedIndirectCommand& command,
+                            std::span<const TransformVertexData> transforms)
+  -> void
+{
+  if (transforms.empty()) {
+    return;
+  }
+
+  // The submesh is left out of the sort key, so a mesh's submeshes with the
+  // same material end up next to each other.
+  auto group_key = key;
+  group_key.submesh_index = 0;
+  const auto draw = static_cast<Core::u32>(submissions.size());
+  submissions.push_back(Submission{
+    .key = key,
+    .static_mesh = static_mesh,
+    .command = command,
+    .sort_key = DrawListBuilder::compute_sort_key(
+      DrawListBuilder::ListType::Geometry, group_key),
+  });
+  draws.push_back(IndirectDrawData{
+    .bounds_min = glm::vec4{ local_bounds.min, 1.0F },
+    .bounds_max = glm::vec4{ local_bounds.max, 1.0F },
+    .instance_offset = static_cast<Core::u32>(instances.size()),
+  });
+  for (const auto& transform : transforms) {
+    instances.push_back(IndirectInstanceData{
+      .transform = transform,
+      .draw = draw,
+    });
+  }
+}
+
+auto
+IndirectDrawBuilder::build() -> void
+{
+  command_draws.resize(submissions.size());
+  std::iota(command_draws.begin(), command_draws.end(), 0U);
+  std::ranges::stable_sort(command_draws, {}, [this](Core::u32 draw) {
+    return submissions[draw].sort_key;
+  });
+
+  groups.clear();
+  for (auto command = 0U; command < command_draws.size(); command++) {
+    const auto draw = command_draws[command];
+    const auto& submission = submissions[draw];
+    // Sort keys are hashes; a collision only splits a group in two.
+    if (groups.empty() || !same_group(groups.back().key, submission.key)) {
+      groups.push_back(IndirectDrawGroup{
+        .key = submission.key,
+        .static_mesh = submission.static_mesh,
+        .submesh_index = submission.key.submesh_index,
+        .first_command = command,
+      });
+    }
+    auto& group = groups.back();
+    group.command_count++;
+
+    auto& data = draws[draw];
+    data.command = command;
+    data.group = static_cast<Core::u32>(groups.size() - 1);
+    data.group_first_command = group.first_command;
+  }
+}
+
+auto
+IndirectDrawBuilder::clear() -> void
+{
+  submissions.clear();
+  draws.clear();
+  instances.clear();
+  groups.clear();
+  command_draws.clear();
+}
+
+auto
+IndirectDrawBuilder::write_commands(
+  std::span<VkDrawIndexedIndirectCommand> commands) const -> void
+{
+  const auto draw_count = get_draw_count();
+  const auto instance_count = get_instance_count();
+  for (auto view = 0U; view < view_count; view++) {
+    for (auto command = 0U; command < draw_count; command++) {
+      const auto draw = command_draws[command];
+      auto& written = commands[view * draw_count + command];
+      written = submissions[draw].command;
+      written.instanceCount = 0;
+      written.firstInstance =
+        view * instance_count + draws[draw].instance_offset;
+    }
+  }
+}
+
+auto
+IndirectDrawBuilder::count_visible(
+  std::span<const VkDrawIndexedIndirectCommand> commands,
+  Core::u32 draw_count) -> std::array<Core::u32, view_count>
+{
+  std::array<Core::u32, view_count> visible{};
+  if (draw_count == 0) {
+    return visible;
+  }
+  for (auto view = 0U; view < view_count; view++) {
+    for (const auto& command :
+         commands.subspan(view * draw_count, draw_count)) {
+      visible.at(view) += command.instanceCount;
+    }
+  }
+  return visible;
+}
+
+} // namespace Engine::Graphics
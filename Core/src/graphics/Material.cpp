@@ -4,7 +4,6 @@
 
 #include "core/Application.hpp"
 #include "graphics/DescriptorResource.hpp"
-#include "graphics/Device.hpp"
 
 #include "logging/Logger.hpp"
 
@@ -65,6 +64,7 @@ Material::set(const std::string_view name, const Core::Ref<Image>& image)
       desc.dstBinding = resource->get_register();
       desc.pImageInfo = &imgs.at(as_string)->descriptor_info;
     });
+  mark_dirty(resource->get_register());
 
   return true;
 }
@@ -89,6 +89,7 @@ Material::set(const std::string_view name, const StorageBuffer& storage) -> bool
     desc.dstBinding = resource->get_register();
     desc.pBufferInfo = &buf;
   });
+  mark_dirty(resource->get_register());
 
   return true;
 }
@@ -118,6 +119,7 @@ Material::override_property(const std::string_view name,
       desc.dstBinding = resource->get_register();
       desc.pImageInfo = &images.at(as_string)->descriptor_info;
     });
+  mark_dirty(resource->get_register());
 
   return true;
 }
@@ -125,58 +127,64 @@ Material::override_property(const std::string_view name,
 auto
 Material::update_descriptor_write_sets(VkDescriptorSet dst) -> void
 {
-  auto& current_writes = *write_descriptors;
-
-  for (auto& [index, write] : current_writes) {
-    write.dstSet = dst;
+  const auto writes = flatten_writes();
+  if (dst != nullptr && dst == renderer_descriptor_set.get()) {
+    renderer_descriptor_set.update(shader->get_descriptor_set_layouts().at(0),
+                                   writes);
+    return;
   }
 
-  std::vector<VkWriteDescriptorSet> values{};
-  values.resize(current_writes.size());
-  auto i = 0ULL;
-  for (const auto& [index, write] : current_writes) {
-    values.at(i++) = write;
+  for (auto& write : flattened_writes) {
+    write.dstSet = dst;
   }
-
-  vkUpdateDescriptorSets(Device::the().device(),
-                         static_cast<Core::u32>(values.size()),
-                         values.data(),
-                         0,
-                         nullptr);
+  DescriptorResource::the().update_descriptor_sets(writes);
 }
 
 auto
 Material::generate_and_update_descriptor_write_sets() -> VkDescriptorSet
 {
-  auto& current_writes = *write_descriptors;
-
-  auto allocated = shader->allocate_descriptor_set(1);
-
-  if (allocated.descriptor_sets.empty()) {
+  const auto& layouts = shader->get_descriptor_set_layouts();
+  if (layouts.size() < 2) {
     error("Failed to allocate descriptor set for material");
     return VK_NULL_HANDLE;
   }
 
-  descriptor_sets.get() = allocated;
-
-  for (auto& [index, write] : current_writes) {
-    write.dstSet = allocated.descriptor_sets.at(0);
+  auto* descriptor_set =
+    material_descriptor_set.update(layouts.at(1), flatten_writes());
+  if (descriptor_set == VK_NULL_HANDLE) {
+    error("Failed to allocate descriptor set for material");
   }
+  return descriptor_set;
+}
 
-  std::vector<VkWriteDescriptorSet> values{};
-  values.resize(current_writes.size());
-  auto i = 0ULL;
+auto
+Material::mark_dirty(Core::u32 binding) -> void
+{
+  material_descriptor_set.mark_dirty(binding);
+  renderer_descriptor_set.mark_dirty(binding);
+}
+
+auto
+Material::flatten_writes() -> std::span<const VkWriteDescriptorSet>
+{
+  const auto& current_writes = *write_descriptors;
+  flattened_writes.clear();
   for (const auto& [index, write] : current_writes) {
-    values.at(i++) = write;
+    flattened_writes.push_back(write);
   }
+  return flattened_writes;
+}
 
-  vkUpdateDescriptorSets(Device::the().device(),
-                         static_cast<Core::u32>(values.size()),
-                         values.data(),
-                         0,
-                         nullptr);
-
-  return allocated.descriptor_sets.at(0);
+auto
+Material::set_variant(const std::string_view key, const bool enabled) -> void
+{
+  const auto it = std::ranges::lower_bound(variants, key);
+  const auto present = it != variants.end() && *it == key;
+  if (enabled && !present) {
+    variants.emplace(it, key);
+  } else if (!enabled && present) {
+    variants.erase(it);
+  }
 }
 
 auto
@@ -3,14 +3,15 @@
 
 #include "graphics/Mesh.hpp"
 
+#include "graphics/MeshCooker.hpp"
+#include "graphics/MeshImporter.hpp"
+
 #include "graphics/Renderer.hpp"
 #include "logging/Logger.hpp"
 #include "thread_pool/CommandBufferDispatcher.hpp"
+#include "thread_pool/ThreadPool.hpp"
 
-#include <assimp/DefaultLogger.hpp>
 #include <assimp/Importer.hpp>
-#include <assimp/LogStream.hpp>
-#include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
 #define GLM_ENABLE_EXPERIMENTAL
@@ -18,148 +19,72 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/quaternion.hpp>
 
+#include <chrono>
+#include <deque>
+#include <future>
 #include <memory>
 #include <utility>
 namespace Engine::Graphics {
 
-static constexpr auto maybe_load_embedded_texture =
-  [](auto& dispatcher,
-     auto index,
-     TextureType T,
-     const std::string& name,
-     const aiTexture* embedded_texture,
-     auto& outputs,
-     auto& mutex,
-     auto& cache) -> void {
-  if (embedded_texture == nullptr) {
-    throw std::runtime_error("No texture");
-  }
-
-  Core::DataBuffer buffer{ embedded_texture->mWidth *
-                           embedded_texture->mHeight * 4 };
-  buffer.write(embedded_texture->pcData,
-               embedded_texture->mWidth * embedded_texture->mHeight * 4);
-
-  std::unique_lock lock(mutex);
-  auto& back = cache.emplace_back();
-  back = Core::make_ref<StagingBuffer>(std::move(buffer));
-  lock.unlock();
-
-  const auto width = embedded_texture->mWidth;
-  const auto height = embedded_texture->mHeight;
-
-  dispatcher.dispatch(
-    [=, staging = back, &images = outputs, &m = mutex](auto* cmd) {
-      std::lock_guard lock(m);
-      images[index][T] = Image::load_from_memory(cmd,
-                                                 width,
-                                                 height,
-                                                 staging,
-                                                 {
-                                                   .path = name,
-                                                   .use_mips = true,
-                                                 });
-    });
+namespace {
+// Decoded textures wait in staging memory until their uploads are submitted.
+// At most this many decodes run ahead of the upload recording, and uploads
+// are flushed once this much staging memory is pending, which together bound
+// the staging memory a mesh holds at once.
+constexpr Core::usize max_decodes_in_flight = 8;
+constexpr Core::usize max_pending_staging_bytes = 256ULL * 1024ULL * 1024ULL;
+
+// One texture the materials of a mesh use, with every material slot that
+// uses it, so textures shared between materials are decoded once.
+struct TextureRequest
+{
+  std::string path;
+  const aiTexture* embedded_texture{ nullptr };
+  std::vector<std::pair<Core::u32, TextureType>> users;
 };
 
-static constexpr auto load_texture_from_file =
-  [](auto& dispatcher,
-     auto index,
-     TextureType T,
-     const std::string& base_path,
-     const std::string& texture_path,
-     auto& outputs,
-     auto& mutex,
-     auto& cache) -> void {
-  std::filesystem::path path = base_path;
-  auto parent_path = path.parent_path();
-  parent_path /= texture_path;
-  std::string real_path = parent_path.string();
-
-  Core::u32 w{};
-  Core::u32 h{};
-
-  std::unique_lock lock(mutex);
-  auto& back = cache.emplace_back();
-  back = Image::load_from_file_into_staging(real_path, &w, &h);
-  lock.unlock();
-
-  dispatcher.dispatch([=, c = back, &images = outputs, &m = mutex](auto* cmd) {
-    std::lock_guard lock(m);
-    images[index][T] = Image::load_from_memory(cmd,
-                                               w,
-                                               h,
-                                               c,
-                                               {
-                                                 .path = real_path,
-                                                 .use_mips = true,
-                                               });
-  });
+struct DecodedTexture
+{
+  Core::Ref<StagingBuffer> staging;
+  Core::u32 width{};
+  Core::u32 height{};
+  Core::f64 decode_ms{};
 };
 
-struct AssimpLogStream : public Assimp::LogStream
+// A texture that cannot be decoded comes back without staging, and its
+// material slots keep the default texture. Throwing instead would leave the
+// constructor while other decodes still read the importer's scene.
+auto
+decode_texture(const std::string& path, const aiTexture* embedded_texture)
+  -> DecodedTexture
 {
-  static void initialize()
-  {
-    if (Assimp::DefaultLogger::isNullLogger()) {
-      Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE);
-      Assimp::DefaultLogger::get()->attachStream(
-        new AssimpLogStream,
-        Assimp::Logger::Debugging | Assimp::Logger::Info |
-          Assimp::Logger::Warn | Assimp::Logger::Err);
-    }
-  }
-
-  void write(const char* message) override
-  {
-    std::string msg(message);
-    if (!msg.empty() && msg[msg.length() - 1] == '\n') {
-      msg.erase(msg.length() - 1);
-    }
-    if (strncmp(message, "Debug", 5) == 0) {
-      trace("Assimp: {}", msg);
-    } else if (strncmp(message, "Info", 4) == 0) {
-      trace("Assimp: {}", msg);
-    } else if (strncmp(message, "Warn", 4) == 0) {
-      warn("Assimp: {}", msg);
+  const auto start = std::chrono::high_resolution_clock::now();
+  DecodedTexture decoded{};
+  try {
+    if (embedded_texture != nullptr) {
+      decoded.width = embedded_texture->mWidth;
+      decoded.height = embedded_texture->mHeight;
+      decoded.staging = Core::make_ref<StagingBuffer>(
+        std::span{ embedded_texture->pcData,
+                   static_cast<Core::usize>(decoded.width) * decoded.height });
     } else {
-      error("Assimp: {}", msg);
+      decoded.staging = Image::load_from_file_into_staging(
+        path, &decoded.width, &decoded.height);
     }
+  } catch (const std::exception& exception) {
+    warn("Could not decode texture '{}': {}", path, exception.what());
+    decoded.staging = nullptr;
   }
-};
-
-static constexpr Core::u32 mesh_import_flags =
-  aiProcess_ConvertToLeftHanded | aiProcessPreset_TargetRealtime_Fast;
-
-namespace Utils {
-
-auto
-mat4_from_assimp_matrix4(const aiMatrix4x4& matrix) -> glm::mat4
-{
-  glm::mat4 result;
-  // the a,b,c,d in assimp is the row ; the 1,2,3,4 is the column
-  result[0][0] = matrix.a1;
-  result[1][0] = matrix.a2;
-  result[2][0] = matrix.a3;
-  result[3][0] = matrix.a4;
-  result[0][1] = matrix.b1;
-  result[1][1] = matrix.b2;
-  result[2][1] = matrix.b3;
-  result[3][1] = matrix.b4;
-  result[0][2] = matrix.c1;
-  result[1][2] = matrix.c2;
-  result[2][2] = matrix.c3;
-  result[3][2] = matrix.c4;
-  result[0][3] = matrix.d1;
-  result[1][3] = matrix.d2;
-  result[2][3] = matrix.d3;
-  result[3][3] = matrix.d4;
-  return result;
+  decoded.decode_ms = std::chrono::duration<Core::f64, std::milli>(
+                        std::chrono::high_resolution_clock::now() - start)
+                        .count();
+  return decoded;
 }
 }
 
 MeshAsset::MeshAsset(const std::string& file_name)
-  : command_buffer{
+  : file_path(file_name)
+  , command_buffer{
     Core::make_scope<CommandBuffer>(CommandBuffer::Properties{
       .queue_type = QueueType::Graphics,
       .primary = true,
@@ -170,307 +95,190 @@ MeshAsset::MeshAsset(const std::string& file_name)
   deferred_pbr_shader = Shader::compile_graphics_scoped(
     "Assets/shaders/main_geometry.vert", "Assets/shaders/main_geometry.frag");
 
-  AssimpLogStream::initialize();
-
   info("Loading mesh: {0}", file_name.c_str());
 
-  importer = Core::make_scope<Assimp::Importer>();
-  importer->SetPropertyFloat(AI_CONFIG_GLOBAL_SCALE_FACTOR_KEY, 100.0F);
-
-  const aiScene* scene = importer->ReadFile(file_name, mesh_import_flags);
-  if (scene == nullptr) {
-    error("Failed to load mesh file: {0}", file_name);
-    return;
+  const auto cooked_path = MeshCooker::get_cooked_path(file_name);
+  const auto source_hash = MeshCooker::hash_file(file_name);
+  if (source_hash.has_value()) {
+    cooked_mesh = MeshCooker::load(cooked_path, *source_hash);
   }
 
-  ai_scene = scene;
-
-  if (!scene->HasMeshes()) {
-    return;
-  }
-  static constexpr auto flt_max = std::numeric_limits<float>::max();
-
-  Core::u32 vertex_count = 0;
-  Core::u32 index_count = 0;
-
-  bounding_box.min = { flt_max, flt_max, flt_max };
-  bounding_box.max = { -flt_max, -flt_max, -flt_max };
-
-  submeshes.reserve(scene->mNumMeshes);
-  for (unsigned m = 0; m < scene->mNumMeshes; m++) {
-    aiMesh* mesh = scene->mMeshes[m];
-
-    Submesh& submesh = submeshes.emplace_back();
-    submesh.base_vertex = vertex_count;
-    submesh.base_index = index_count;
-    submesh.material_index = mesh->mMaterialIndex;
-    submesh.vertex_count = mesh->mNumVertices;
-    submesh.index_count = mesh->mNumFaces * 3;
-    submesh.mesh_name = mesh->mName.C_Str();
-
-    vertex_count += mesh->mNumVertices;
-    index_count += submesh.index_count;
-
-    // Vertices
-    auto& aabb = submesh.bounding_box;
-    aabb.min = {
-      flt_max,
-      flt_max,
-      flt_max,
-    };
-    aabb.max = {
-      -flt_max,
-      -flt_max,
-      -flt_max,
-    };
-
-    const auto count = mesh->mNumVertices;
-
-    const auto vertices_span = std::span{ mesh->mVertices, count };
-    const auto normals_span = std::span{ mesh->mNormals, count };
-    const auto tangents_span = std::span{ mesh->mTangents, count };
-    const auto bitangents_span = std::span{ mesh->mBitangents, count };
-    const auto uvs_span = std::span{ mesh->mTextureCoords, count };
-    const auto index_span = std::span{ mesh->mFaces, mesh->mNumFaces };
-
-    const auto has_normals = mesh->HasNormals();
-    const auto has_tangents = mesh->HasTangentsAndBitangents();
-    const auto has_uvs = mesh->HasTextureCoords(0);
-
-    for (auto i = 0U; i < count; i++) {
-      Vertex vertex{};
-      vertex.position = {
-        vertices_span[i].x,
-        vertices_span[i].y,
-        vertices_span[i].z,
-      };
-      vertex.normals = {
-        has_normals ? normals_span[i].x : 0.0F,
-        has_normals ? normals_span[i].y : 0.0F,
-        has_normals ? normals_span[i].z : 0.0F,
-      };
-
-      aabb.update_min_max(vertex.position);
-
-      if (has_tangents) {
-        vertex.tangent = {
-          tangents_span[i].x,
-          tangents_span[i].y,
-          tangents_span[i].z,
-        };
-        vertex.bitangent = {
-          bitangents_span[i].x,
-          bitangents_span[i].y,
-          bitangents_span[i].z,
-        };
-      }
-
-      if (has_uvs) {
-        vertex.uvs = {
-          uvs_span[0][i].x,
-          uvs_span[0][i].y,
-        };
-      }
-
-      vertices.push_back(vertex);
+  const MeshData* data = nullptr;
+  if (cooked_mesh) {
+    trace("Using cooked mesh: {0}", cooked_path.string());
+    data = &cooked_mesh->get_data();
+  } else {
+    imported_mesh = MeshImporter::import(file_name);
+    if (!imported_mesh) {
+      return;
     }
-
-    // Indices
-    for (auto i = 0U; i < mesh->mNumFaces; i++) {
-      Index index = {
-        .V1 = index_span[i].mIndices[0],
-        .V2 = index_span[i].mIndices[1],
-        .V3 = index_span[i].mIndices[2],
-      };
-      indices.push_back(index);
-
-      triangle_cache[m].emplace_back(vertices[index.V1 + submesh.base_vertex],
-                                     vertices[index.V2 + submesh.base_vertex],
-                                     vertices[index.V3 + submesh.base_vertex]);
+    data = &imported_mesh->data;
+
+    // Embedded textures live in the Assimp scene, which a cooked mesh does
+    // not have, so such models are always imported.
+    if (source_hash.has_value() && !imported_mesh->has_embedded_textures &&
+        !MeshCooker::write(
+          cooked_path, *source_hash, *data, imported_mesh->dependencies)) {
+      warn("Could not write cooked mesh: {0}", cooked_path.string());
     }
   }
 
-  traverse_nodes(scene->mRootNode);
-
-  for (const auto& submesh : submeshes) {
-    Core::AABB transformed_submesh_aabb = submesh.bounding_box;
-    glm::vec3 min = glm::vec3(submesh.transform *
-                              glm::vec4(transformed_submesh_aabb.min, 1.0F));
-    glm::vec3 max = glm::vec3(submesh.transform *
-                              glm::vec4(transformed_submesh_aabb.max, 1.0F));
-
-    bounding_box.update_min_max(min);
-    bounding_box.update_min_max(max);
-  }
-
-  if (!scene->HasMaterials()) {
+  if (data->submeshes.empty()) {
     return;
   }
 
-  std::vector<Core::Ref<StagingBuffer>> cache;
-  cache.reserve(150);
+  vertices = data->vertices;
+  indices = data->indices;
+  submeshes = data->submeshes;
+  bounding_box = data->bounding_box;
 
-  std::span scene_mats{ scene->mMaterials, scene->mNumMaterials };
-  materials.resize(scene_mats.size());
+  const auto load_start = std::chrono::high_resolution_clock::now();
+  std::vector<TextureRequest> requests;
+  std::unordered_map<std::string, Core::usize> request_indices;
+
+  materials.resize(data->materials.size());
   const auto& white_texture = Renderer::get_white_texture();
-  auto i = 0ULL;
-  for (const auto& ai_material : scene_mats) {
+  const auto* scene = imported_mesh ? imported_mesh->scene : nullptr;
+  const auto model_directory =
+    std::filesystem::path{ file_name }.parent_path();
+  for (Core::u32 i = 0; i < data->materials.size(); i++) {
+    const auto& description = data->materials.at(i);
     materials.at(i) = Core::make_scope<Material>(Material::Configuration{
       .shader = deferred_pbr_shader.get(),
     });
-    aiString ai_tex_path;
-
-    float shininess{};
-    float metalness{};
-    if (ai_material->Get(AI_MATKEY_SHININESS, shininess) != aiReturn_SUCCESS) {
-      shininess = 80.0F;
-    }
 
-    if (ai_material->Get(AI_MATKEY_REFLECTIVITY, metalness) !=
-        aiReturn_SUCCESS) {
-      metalness = 0.0F;
-    }
-    auto roughness = 1.0F - glm::sqrt(shininess / 100.0F);
+    auto roughness = 1.0F - glm::sqrt(description.shininess / 100.0F);
 
     materials.at(i)->set("mat_pc.albedo_colour", glm::vec3(1.0F));
     materials.at(i)->set("mat_pc.emission", 1.0F);
 
-    materials.at(i)->set("mat_pc.use_normal_map", false);
-
     materials.at(i)->set("mat_pc.roughness", roughness);
 
-    const auto casted_index = static_cast<Core::u32>(i);
-
-    bool has_albedo_map =
-      ai_material->GetTexture(aiTextureType_DIFFUSE, 0, &ai_tex_path) ==
-      AI_SUCCESS;
-    if (has_albedo_map) {
-      if (const auto* embedded_texture =
-            scene->GetEmbeddedTexture(ai_tex_path.C_Str())) {
-        maybe_load_embedded_texture(dispatcher,
-                                    casted_index,
-                                    TextureType::Albedo,
-                                    std::string{ ai_tex_path.C_Str() },
-                                    embedded_texture,
-                                    output_images,
-                                    mutex,
-                                    cache);
-      } else {
-        load_texture_from_file(dispatcher,
-                               casted_index,
-                               TextureType::Albedo,
-                               file_name,
-                               ai_tex_path.C_Str(),
-                               output_images,
-                               mutex,
-                               cache);
+    for (const auto type : { TextureType::Albedo,
+                             TextureType::Normal,
+                             TextureType::Specular,
+                             TextureType::Roughness }) {
+      const auto& texture_path = description.get_texture_path(type);
+      if (texture_path.empty()) {
+        continue;
       }
-    }
 
-    // Normal maps
-    bool has_normal_map =
-      ai_material->GetTexture(aiTextureType_NORMALS, 0, &ai_tex_path) ==
-      AI_SUCCESS;
-    if (has_normal_map) {
-      if (const auto* embedded_texture =
-            scene->GetEmbeddedTexture(ai_tex_path.C_Str())) {
-        maybe_load_embedded_texture(dispatcher,
-                                    casted_index,
-                                    TextureType::Normal,
-                                    std::string{ ai_tex_path.C_Str() },
-                                    embedded_texture,
-                                    output_images,
-                                    mutex,
-                                    cache);
+      const auto* embedded_texture =
+        scene != nullptr ? scene->GetEmbeddedTexture(texture_path.c_str())
+                         : nullptr;
+      auto path = embedded_texture != nullptr
+                    ? texture_path
+                    : (model_directory / texture_path).string();
+      const auto [found, inserted] =
+        request_indices.try_emplace(path, requests.size());
+      if (inserted) {
+        requests.push_back({
+          .path = std::move(path),
+          .embedded_texture = embedded_texture,
+          .users = {},
+        });
       } else {
-        load_texture_from_file(dispatcher,
-                               casted_index,
-                               TextureType::Normal,
-                               file_name,
-                               ai_tex_path.C_Str(),
-                               output_images,
-                               mutex,
-                               cache);
+        texture_load_statistics.shared_texture_count++;
       }
+      requests.at(found->second).users.emplace_back(i, type);
     }
+  }
 
-    // Specular maps
-    bool has_specular_map =
-      ai_material->GetTexture(aiTextureType_SPECULAR, 0, &ai_tex_path) ==
-      AI_SUCCESS;
-    if (has_specular_map) {
-      if (const auto* embedded_texture =
-            scene->GetEmbeddedTexture(ai_tex_path.C_Str())) {
-        maybe_load_embedded_texture(dispatcher,
-                                    casted_index,
-                                    TextureType::Specular,
-                                    std::string{ ai_tex_path.C_Str() },
-                                    embedded_texture,
-                                    output_images,
-                                    mutex,
-                                    cache);
-      } else {
-        load_texture_from_file(dispatcher,
-                               casted_index,
-                               TextureType::Specular,
-                               file_name,
-                               ai_tex_path.C_Str(),
-
-                               output_images,
-                               mutex,
-                               cache);
-      }
+  // Decoding fans out over the renderer's workers, in request order, while
+  // this thread records the uploads of the textures already decoded.
+  auto& thread_pool = Renderer::get_thread_pool();
+  std::deque<std::future<DecodedTexture>> in_flight;
+  Core::usize next_request = 0;
+  const auto launch_decodes = [&]() {
+    while (next_request < requests.size() &&
+           in_flight.size() < max_decodes_in_flight) {
+      const auto& request = requests.at(next_request++);
+      in_flight.push_back(thread_pool.enqueue_task(
+        [path = request.path, embedded = request.embedded_texture]() {
+          return decode_texture(path, embedded);
+        }));
     }
-
-    // Roughness map
-    bool has_roughness_map =
-      ai_material->GetTexture(aiTextureType_SHININESS, 0, &ai_tex_path) ==
-      AI_SUCCESS;
-
-    aiString combined_roughness_metallic_file;
-    ai_material->GetTexture(
-      aiTextureType_UNKNOWN, 0, &combined_roughness_metallic_file);
-
-    bool prefer_combined = false;
-    if (combined_roughness_metallic_file.length > 0) {
-      prefer_combined = true;
-      has_roughness_map = true;
+  };
+
+  std::vector<Core::Ref<Image>> images(requests.size());
+  std::vector<Core::Ref<StagingBuffer>> pending_staging;
+  Core::usize pending_bytes = 0;
+  const auto flush_uploads = [&]() {
+    if (pending_staging.empty()) {
+      return;
     }
-
-    if (has_roughness_map) {
-      if (const auto* embedded_texture = scene->GetEmbeddedTexture(
-            prefer_combined ? combined_roughness_metallic_file.C_Str()
-                            : ai_tex_path.C_Str())) {
-        maybe_load_embedded_texture(dispatcher,
-                                    casted_index,
-                                    TextureType::Roughness,
-                                    std::string{ ai_tex_path.C_Str() },
-                                    embedded_texture,
-                                    output_images,
-                                    mutex,
-                                    cache);
-      } else {
-        load_texture_from_file(dispatcher,
-                               casted_index,
-                               TextureType::Roughness,
-                               file_name,
-                               prefer_combined
-                                 ? combined_roughness_metallic_file.C_Str()
-                                 : ai_tex_path.C_Str(),
-                               output_images,
-                               mutex,
-                               cache);
-      }
+    const auto upload_start = std::chrono::high_resolution_clock::now();
+    dispatcher.execute();
+    texture_load_statistics.upload_ms +=
+      std::chrono::duration<Core::f64, std::milli>(
+        std::chrono::high_resolution_clock::now() - upload_start)
+        .count();
+    texture_load_statistics.upload_batch_count++;
+    pending_staging.clear();
+    pending_bytes = 0;
+  };
+
+  launch_decodes();
+  for (Core::usize i = 0; i < requests.size(); i++) {
+    auto decoded = in_flight.front().get();
+    in_flight.pop_front();
+    launch_decodes();
+
+    texture_load_statistics.decode_ms += decoded.decode_ms;
+    if (!decoded.staging) {
+      continue;
+    }
+    pending_bytes += decoded.staging->size();
+    texture_load_statistics.peak_staging_bytes =
+      std::max(texture_load_statistics.peak_staging_bytes, pending_bytes);
+    pending_staging.push_back(decoded.staging);
+
+    dispatcher.dispatch([&image = images.at(i),
+                         name = requests.at(i).path,
+                         decoded = std::move(decoded)](auto* cmd) {
+      image = Image::load_from_memory(cmd,
+                                      decoded.width,
+                                      decoded.height,
+                                      decoded.staging,
+                                      {
+                                        .path = name,
+                                        .use_mips = true,
+                                      });
+    });
+    if (pending_bytes >= max_pending_staging_bytes) {
+      flush_uploads();
     }
-
-    i++;
   }
+  flush_uploads();
 
-  dispatcher.execute();
+  for (Core::usize i = 0; i < requests.size(); i++) {
+    if (!images.at(i)) {
+      continue;
+    }
+    for (const auto& [material_index, type] : requests.at(i).users) {
+      output_images[material_index][type] = images.at(i);
+    }
+  }
 
-  vertex_buffer = Core::make_scope<VertexBuffer>(std::span{ vertices });
-  index_buffer = Core::make_scope<IndexBuffer>(indices.data(),
-                                               indices.size() * sizeof(Index));
+  texture_load_statistics.texture_count =
+    static_cast<Core::u32>(requests.size());
+  texture_load_statistics.wall_ms =
+    std::chrono::duration<Core::f64, std::milli>(
+      std::chrono::high_resolution_clock::now() - load_start)
+      .count();
+  info("Loaded {} textures ({} shared) for '{}' in {:.2f}ms: decode {:.2f}ms "
+       "over workers, upload {:.2f}ms in {} batches",
+       texture_load_statistics.texture_count,
+       texture_load_statistics.shared_texture_count,
+       file_name,
+       texture_load_statistics.wall_ms,
+       texture_load_statistics.decode_ms,
+       texture_load_statistics.upload_ms,
+       texture_load_statistics.upload_batch_count);
+
+  vertex_buffer = Core::make_scope<VertexBuffer>(vertices);
+  index_buffer =
+    Core::make_scope<IndexBuffer>(indices.data(), indices.size_bytes());
 
   // Patch up material settings based on loaded textures
   for (auto index = 0U; index < materials.size(); index++) {
@@ -493,7 +301,7 @@ MeshAsset::MeshAsset(const std::string& file_name)
     if (current_images.contains(TextureType::Normal)) {
       material->override_property("normal_map",
                                   current_images.at(TextureType::Normal));
-      material->set("mat_pc.use_normal_map", true);
+      material->set_variant("USE_NORMAL_MAP", true);
     }
     if (current_images.contains(TextureType::Specular)) {
       material->override_property("specular_map",
@@ -511,38 +319,6 @@ MeshAsset::MeshAsset(const std::string& file_name)
 
 MeshAsset::~MeshAsset() = default;
 
-auto
-MeshAsset::traverse_nodes(aiNode* node,
-                          const glm::mat4& parent_transform,
-                          Core::u32 level) -> void
-{
-  if (node == nullptr) {
-    return;
-  }
-
-  glm::mat4 local_transform =
-    Utils::mat4_from_assimp_matrix4(node->mTransformation);
-  glm::mat4 transform = parent_transform * local_transform;
-  ai_node_map[node].resize(node->mNumMeshes);
-  for (Core::u32 i = 0; i < node->mNumMeshes; i++) {
-    Core::u32 mesh = node->mMeshes[i];
-    auto& submesh = submeshes[mesh];
-    submesh.node_name = node->mName.C_Str();
-    submesh.transform = transform;
-    submesh.local_transform = local_transform;
-    ai_node_map[node][i] = mesh;
-  }
-
-  const auto span = std::span{ node->mChildren, node->mNumChildren };
-  for (const auto& child : span) {
-    if (child == nullptr) {
-      continue;
-    }
-
-    traverse_nodes(child, transform, level + 1);
-  }
-}
-
 StaticMesh::StaticMesh(Core::Ref<MeshAsset> asset)
   : mesh_asset(std::move(asset))
 {
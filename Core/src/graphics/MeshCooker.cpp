@@ -0,0 +1,413 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/MeshCooker.hpp"
+
+#include "core/Hash.hpp"
+#include "platform/Platform.hpp"
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+
+namespace Engine::Graphics {
+
+namespace {
+
+constexpr Core::u32 magic = 0x4D545341; // "ASTM"
+constexpr Core::u64 section_alignment = 16;
+
+struct StringReference
+{
+  Core::u32 offset{ 0 };
+  Core::u32 size{ 0 };
+};
+
+struct FileHeader
+{
+  Core::u32 magic{ 0 };
+  Core::u32 version{ 0 };
+  Core::u64 source_hash{ 0 };
+  Core::u32 vertex_count{ 0 };
+  Core::u32 index_count{ 0 };
+  Core::u32 submesh_count{ 0 };
+  Core::u32 material_count{ 0 };
+  Core::u64 vertex_offset{ 0 };
+  Core::u64 index_offset{ 0 };
+  Core::u64 submesh_offset{ 0 };
+  Core::u64 material_offset{ 0 };
+  Core::u64 string_offset{ 0 };
+  Core::u64 string_size{ 0 };
+  Core::u64 dependency_offset{ 0 };
+  Core::u32 dependency_count{ 0 };
+  Core::AABB bounding_box{};
+};
+
+struct SubmeshRecord
+{
+  Core::u32 base_vertex{ 0 };
+  Core::u32 base_index{ 0 };
+  Core::u32 material_index{ 0 };
+  Core::u32 index_count{ 0 };
+  Core::u32 vertex_count{ 0 };
+  StringReference node_name{};
+  StringReference mesh_name{};
+  glm::mat4 transform{ 1.0F };
+  glm::mat4 local_transform{ 1.0F };
+  Core::AABB bounding_box{};
+};
+
+struct MaterialRecord
+{
+  Core::f32 shininess{ 0.0F };
+  Core::f32 reflectivity{ 0.0F };
+  std::array<StringReference, texture_type_count> texture_paths{};
+};
+
+// A file the source references, relative to the cooked file's directory.
+struct DependencyRecord
+{
+  StringReference path{};
+  Core::u64 content_hash{ 0 };
+};
+
+static_assert(std::is_trivially_copyable_v<Vertex>);
+static_assert(std::is_trivially_copyable_v<FileHeader>);
+static_assert(std::is_trivially_copyable_v<SubmeshRecord>);
+static_assert(std::is_trivially_copyable_v<MaterialRecord>);
+static_assert(std::is_trivially_copyable_v<DependencyRecord>);
+
+constexpr auto
+align_up(Core::u64 value) -> Core::u64
+{
+  return (value + section_alignment - 1) & ~(section_alignment - 1);
+}
+
+template<class T>
+auto
+read_record(std::span<const std::byte> bytes, Core::u64 offset) -> T
+{
+  T record;
+  std::memcpy(&record, bytes.data() + offset, sizeof(T));
+  return record;
+}
+
+// True if `count` elements of `element_size` bytes at `offset` fit in a
+// file of `file_size` bytes, without overflowing.
+constexpr auto
+fits(Core::u64 offset,
+     Core::u64 count,
+     Core::u64 element_size,
+     Core::u64 file_size) -> bool
+{
+  return offset <= file_size &&
+         count <= (file_size - offset) / std::max(element_size, Core::u64{ 1 });
+}
+
+class StringTable
+{
+public:
+  auto add(const std::string& value) -> StringReference
+  {
+    const StringReference reference{
+      .offset = static_cast<Core::u32>(bytes.size()),
+      .size = static_cast<Core::u32>(value.size()),
+    };
+    bytes.insert(bytes.end(), value.begin(), value.end());
+    return reference;
+  }
+  [[nodiscard]] auto get_bytes() const -> const std::string& { return bytes; }
+
+private:
+  std::string bytes;
+};
+
+}
+
+CookedMesh::CookedMesh(Core::Scope<ED::Platform::MappedFile> mapped_file,
+                       MeshData mesh_data)
+  : file(std::move(mapped_file))
+  , data(std::move(mesh_data))
+{
+}
+
+CookedMesh::~CookedMesh() = default;
+
+auto
+MeshCooker::get_cooked_path(const std::filesystem::path& source)
+  -> std::filesystem::path
+{
+  auto cooked = source;
+  cooked += ".astmesh";
+  return cooked;
+}
+
+auto
+MeshCooker::hash(std::span<const std::byte> bytes) -> Core::u64
+{
+  // Cooked files hashed with the older FNV-1a no longer match, and are cooked
+  // again once.
+  return Core::hash_bytes(bytes);
+}
+
+auto
+MeshCooker::hash_file(const std::filesystem::path& path)
+  -> std::optional<Core::u64>
+{
+  const ED::Platform::MappedFile file{ path };
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  return hash(file.data());
+}
+
+auto
+MeshCooker::write(const std::filesystem::path& path,
+                  Core::u64 source_hash,
+                  const MeshData& mesh,
+                  std::span<const std::filesystem::path> dependencies) -> bool
+{
+  StringTable strings;
+  std::vector<DependencyRecord> dependency_records;
+  dependency_records.reserve(dependencies.size());
+  const auto directory = path.parent_path();
+  for (const auto& dependency : dependencies) {
+    const auto content_hash = hash_file(dependency);
+    std::error_code error_code;
+    const auto relative =
+      std::filesystem::relative(dependency,
+                                directory.empty() ? "." : directory,
+                                error_code);
+    if (!content_hash.has_value() || error_code || relative.empty()) {
+      return false;
+    }
+    dependency_records.push_back({
+      .path = strings.add(relative.generic_string()),
+      .content_hash = *content_hash,
+    });
+  }
+  std::vector<SubmeshRecord> submeshes;
+  submeshes.reserve(mesh.submeshes.size());
+  for (const auto& submesh : mesh.submeshes) {
+    submeshes.push_back({
+      .base_vertex = submesh.base_vertex,
+      .base_index = submesh.base_index,
+      .material_index = submesh.material_index,
+      .index_count = submesh.index_count,
+      .vertex_count = submesh.vertex_count,
+      .node_name = strings.add(submesh.node_name),
+      .mesh_name = strings.add(submesh.mesh_name),
+      .transform = submesh.transform,
+      .local_transform = submesh.local_transform,
+      .bounding_box = submesh.bounding_box,
+    });
+  }
+  std::vector<MaterialRecord> materials;
+  materials.reserve(mesh.materials.size());
+  for (const auto& material : mesh.materials) {
+    auto& record = materials.emplace_back();
+    record.shininess = material.shininess;
+    record.reflectivity = material.reflectivity;
+    for (Core::usize i = 0; i < texture_type_count; i++) {
+      record.texture_paths.at(i) = strings.add(material.texture_paths.at(i));
+    }
+  }
+
+  FileHeader header{
+    .magic = magic,
+    .version = format_version,
+    .source_hash = source_hash,
+    .vertex_count = static_cast<Core::u32>(mesh.vertices.size()),
+    .index_count = static_cast<Core::u32>(mesh.indices.size()),
+    .submesh_count = static_cast<Core::u32>(submeshes.size()),
+    .material_count = static_cast<Core::u32>(materials.size()),
+    .dependency_count = static_cast<Core::u32>(dependency_records.size()),
+    .bounding_box = mesh.bounding_box,
+  };
+  header.vertex_offset = align_up(sizeof(FileHeader));
+  header.index_offset =
+    align_up(header.vertex_offset + mesh.vertices.size_bytes());
+  header.submesh_offset =
+    align_up(header.index_offset + mesh.indices.size_bytes());
+  header.material_offset = align_up(header.submesh_offset +
+                                    submeshes.size() * sizeof(SubmeshRecord));
+  header.dependency_offset = align_up(
+    header.material_offset + materials.size() * sizeof(MaterialRecord));
+  header.string_offset =
+    align_up(header.dependency_offset +
+             dependency_records.size() * sizeof(DependencyRecord));
+  header.string_size = strings.get_bytes().size();
+
+  auto temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream output{ temporary, std::ios::binary | std::ios::trunc };
+    if (!output) {
+      return false;
+    }
+    const auto write_at = [&output](Core::u64 offset,
+                                    const void* data,
+                                    Core::usize size) {
+      static constexpr std::array<char, section_alignment> zeroes{};
+      const auto position = static_cast<Core::u64>(output.tellp());
+      output.write(zeroes.data(),
+                   static_cast<std::streamsize>(offset - position));
+      output.write(static_cast<const char*>(data),
+                   static_cast<std::streamsize>(size));
+    };
+    write_at(0, &header, sizeof(header));
+    write_at(
+      header.vertex_offset, mesh.vertices.data(), mesh.vertices.size_bytes());
+    write_at(
+      header.index_offset, mesh.indices.data(), mesh.indices.size_bytes());
+    write_at(header.submesh_offset,
+             submeshes.data(),
+             submeshes.size() * sizeof(SubmeshRecord));
+    write_at(header.material_offset,
+             materials.data(),
+             materials.size() * sizeof(MaterialRecord));
+    write_at(header.dependency_offset,
+             dependency_records.data(),
+             dependency_records.size() * sizeof(DependencyRecord));
+    write_at(
+      header.string_offset, strings.get_bytes().data(), header.string_size);
+    if (!output) {
+      return false;
+    }
+  }
+
+  std::error_code error_code;
+  std::filesystem::rename(temporary, path, error_code);
+  if (error_code) {
+    std::filesystem::remove(temporary, error_code);
+    return false;
+  }
+  return true;
+}
+
+auto
+MeshCooker::load(const std::filesystem::path& path, Core::u64 source_hash)
+  -> Core::Scope<CookedMesh>
+{
+  auto file = Core::make_scope<ED::Platform::MappedFile>(path);
+  const auto bytes = file->data();
+  if (bytes.size() < sizeof(FileHeader)) {
+    return nullptr;
+  }
+
+  const auto header = read_record<FileHeader>(bytes, 0);
+  const auto file_size = static_cast<Core::u64>(bytes.size());
+  if (header.magic != magic || header.version != format_version ||
+      header.source_hash != source_hash) {
+    return nullptr;
+  }
+  const auto aligned = [](Core::u64 offset) {
+    return offset % section_alignment == 0;
+  };
+  if (!aligned(header.vertex_offset) || !aligned(header.index_offset) ||
+      !fits(header.vertex_offset,
+            header.vertex_count,
+            sizeof(Vertex),
+            file_size) ||
+      !fits(
+        header.index_offset, header.index_count, sizeof(Index), file_size) ||
+      !fits(header.submesh_offset,
+            header.submesh_count,
+            sizeof(SubmeshRecord),
+            file_size) ||
+      !fits(header.material_offset,
+            header.material_count,
+            sizeof(MaterialRecord),
+            file_size) ||
+      !fits(header.dependency_offset,
+            header.dependency_count,
+            sizeof(DependencyRecord),
+            file_size) ||
+      !fits(header.string_offset, header.string_size, 1, file_size)) {
+    return nullptr;
+  }
+
+  const auto* strings = std::bit_cast<const char*>(
+    bytes.data() + static_cast<Core::usize>(header.string_offset));
+  bool strings_valid = true;
+  const auto read_string = [&](const StringReference& reference) {
+    if (static_cast<Core::u64>(reference.offset) + reference.size >
+        header.string_size) {
+      strings_valid = false;
+      return std::string{};
+    }
+    return std::string{ strings + reference.offset, reference.size };
+  };
+
+  // Checked before anything else is read, a changed dependency means the
+  // geometry is stale.
+  const auto directory = path.parent_path();
+  for (Core::u32 i = 0; i < header.dependency_count; i++) {
+    const auto record = read_record<DependencyRecord>(
+      bytes, header.dependency_offset + i * sizeof(DependencyRecord));
+    const auto dependency = read_string(record.path);
+    if (!strings_valid ||
+        hash_file(directory / dependency) != record.content_hash) {
+      return nullptr;
+    }
+  }
+
+  MeshData data{
+    .vertices = { std::bit_cast<const Vertex*>(bytes.data() +
+                                               header.vertex_offset),
+                  header.vertex_count },
+    .indices = { std::bit_cast<const Index*>(bytes.data() +
+                                             header.index_offset),
+                 header.index_count },
+    .submeshes = {},
+    .materials = {},
+    .bounding_box = header.bounding_box,
+  };
+
+  data.submeshes.reserve(header.submesh_count);
+  for (Core::u32 i = 0; i < header.submesh_count; i++) {
+    const auto record = read_record<SubmeshRecord>(
+      bytes, header.submesh_offset + i * sizeof(SubmeshRecord));
+    const auto vertex_end =
+      static_cast<Core::u64>(record.base_vertex) + record.vertex_count;
+    const auto index_end =
+      static_cast<Core::u64>(record.base_index) + record.index_count;
+    if (vertex_end > header.vertex_count ||
+        index_end > static_cast<Core::u64>(header.index_count) * 3 ||
+        record.material_index >= header.material_count) {
+      return nullptr;
+    }
+
+    auto& submesh = data.submeshes.emplace_back();
+    submesh.base_vertex = record.base_vertex;
+    submesh.base_index = record.base_index;
+    submesh.material_index = record.material_index;
+    submesh.index_count = record.index_count;
+    submesh.vertex_count = record.vertex_count;
+    submesh.transform = record.transform;
+    submesh.local_transform = record.local_transform;
+    submesh.bounding_box = record.bounding_box;
+    submesh.node_name = read_string(record.node_name);
+    submesh.mesh_name = read_string(record.mesh_name);
+  }
+
+  data.materials.reserve(header.material_count);
+  for (Core::u32 i = 0; i < header.material_count; i++) {
+    const auto record = read_record<MaterialRecord>(
+      bytes, header.material_offset + i * sizeof(MaterialRecord));
+    auto& material = data.materials.emplace_back();
+    material.shininess = record.shininess;
+    material.reflectivity = record.reflectivity;
+    for (Core::usize type = 0; type < texture_type_count; type++) {
+      material.texture_paths.at(type) =
+        read_string(record.texture_paths.at(type));
+    }
+  }
+
+  if (!strings_valid) {
+    return nullptr;
+  }
+  return Core::Scope<CookedMesh>{ new CookedMesh{ std::move(file),
+                                                  std::move(data) } };
+}
+
+} // namespace Engine::Graphics
@@ -0,0 +1,350 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/MeshImporter.hpp"
+
+#include "logging/Logger.hpp"
+
+#include <assimp/DefaultIOSystem.h>
+#include <assimp/DefaultLogger.hpp>
+#include <assimp/Importer.hpp>
+#include <assimp/LogStream.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+namespace Engine::Graphics {
+
+struct AssimpLogStream : public Assimp::LogStream
+{
+  static void initialize()
+  {
+    if (Assimp::DefaultLogger::isNullLogger()) {
+      Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE);
+      Assimp::DefaultLogger::get()->attachStream(
+        new AssimpLogStream,
+        Assimp::Logger::Debugging | Assimp::Logger::Info |
+          Assimp::Logger::Warn | Assimp::Logger::Err);
+    }
+  }
+
+  void write(const char* message) override
+  {
+    std::string msg(message);
+    if (!msg.empty() && msg[msg.length() - 1] == '\n') {
+      msg.erase(msg.length() - 1);
+    }
+    if (strncmp(message, "Debug", 5) == 0) {
+      trace("Assimp: {}", msg);
+    } else if (strncmp(message, "Info", 4) == 0) {
+      trace("Assimp: {}", msg);
+    } else if (strncmp(message, "Warn", 4) == 0) {
+      warn("Assimp: {}", msg);
+    } else {
+      error("Assimp: {}", msg);
+    }
+  }
+};
+
+// Reads through the default file system and records every file opened, so
+// the cooker can hash what the model references along with the model.
+class RecordingIOSystem : public Assimp::DefaultIOSystem
+{
+public:
+  explicit RecordingIOSystem(std::vector<std::filesystem::path>& opened_files)
+    : opened(opened_files)
+  {
+  }
+
+  auto Open(const char* file, const char* mode) -> Assimp::IOStream* override
+  {
+    auto* stream = DefaultIOSystem::Open(file, mode);
+    if (stream != nullptr) {
+      opened.push_back(std::filesystem::path{ file }.lexically_normal());
+    }
+    return stream;
+  }
+
+private:
+  std::vector<std::filesystem::path>& opened;
+};
+
+static constexpr Core::u32 mesh_import_flags =
+  aiProcess_ConvertToLeftHanded | aiProcessPreset_TargetRealtime_Fast;
+
+namespace Utils {
+
+auto
+mat4_from_assimp_matrix4(const aiMatrix4x4& matrix) -> glm::mat4
+{
+  glm::mat4 result;
+  // the a,b,c,d in assimp is the row ; the 1,2,3,4 is the column
+  result[0][0] = matrix.a1;
+  result[1][0] = matrix.a2;
+  result[2][0] = matrix.a3;
+  result[3][0] = matrix.a4;
+  result[0][1] = matrix.b1;
+  result[1][1] = matrix.b2;
+  result[2][1] = matrix.b3;
+  result[3][1] = matrix.b4;
+  result[0][2] = matrix.c1;
+  result[1][2] = matrix.c2;
+  result[2][2] = matrix.c3;
+  result[3][2] = matrix.c4;
+  result[0][3] = matrix.d1;
+  result[1][3] = matrix.d2;
+  result[2][3] = matrix.d3;
+  result[3][3] = matrix.d4;
+  return result;
+}
+}
+
+namespace {
+auto
+traverse_nodes(std::vector<Submesh>& submeshes,
+               const aiNode* node,
+               const glm::mat4& parent_transform = glm::mat4(1.0F)) -> void
+{
+  if (node == nullptr) {
+    return;
+  }
+
+  glm::mat4 local_transform =
+    Utils::mat4_from_assimp_matrix4(node->mTransformation);
+  glm::mat4 transform = parent_transform * local_transform;
+  for (Core::u32 i = 0; i < node->mNumMeshes; i++) {
+    Core::u32 mesh = node->mMeshes[i];
+    auto& submesh = submeshes[mesh];
+    submesh.node_name = node->mName.C_Str();
+    submesh.transform = transform;
+    submesh.local_transform = local_transform;
+  }
+
+  const auto span = std::span{ node->mChildren, node->mNumChildren };
+  for (const auto& child : span) {
+    if (child == nullptr) {
+      continue;
+    }
+
+    traverse_nodes(submeshes, child, transform);
+  }
+}
+
+auto
+describe_material(const aiScene* scene,
+                  const aiMaterial* ai_material,
+                  bool& has_embedded_textures) -> MaterialDescription
+{
+  MaterialDescription description;
+  if (ai_material->Get(AI_MATKEY_SHININESS, description.shininess) !=
+      aiReturn_SUCCESS) {
+    description.shininess = 80.0F;
+  }
+  if (ai_material->Get(AI_MATKEY_REFLECTIVITY, description.reflectivity) !=
+      aiReturn_SUCCESS) {
+    description.reflectivity = 0.0F;
+  }
+
+  const auto set_path = [&](TextureType type, const aiString& path) {
+    description.texture_paths.at(static_cast<Core::usize>(type)) =
+      path.C_Str();
+    if (scene->GetEmbeddedTexture(path.C_Str()) != nullptr) {
+      has_embedded_textures = true;
+    }
+  };
+
+  aiString ai_tex_path;
+  if (ai_material->GetTexture(aiTextureType_DIFFUSE, 0, &ai_tex_path) ==
+      AI_SUCCESS) {
+    set_path(TextureType::Albedo, ai_tex_path);
+  }
+  if (ai_material->GetTexture(aiTextureType_NORMALS, 0, &ai_tex_path) ==
+      AI_SUCCESS) {
+    set_path(TextureType::Normal, ai_tex_path);
+  }
+  if (ai_material->GetTexture(aiTextureType_SPECULAR, 0, &ai_tex_path) ==
+      AI_SUCCESS) {
+    set_path(TextureType::Specular, ai_tex_path);
+  }
+
+  // A combined roughness/metallic map wins over a plain roughness map.
+  aiString combined_roughness_metallic_file;
+  ai_material->GetTexture(
+    aiTextureType_UNKNOWN, 0, &combined_roughness_metallic_file);
+  if (combined_roughness_metallic_file.length > 0) {
+    set_path(TextureType::Roughness, combined_roughness_metallic_file);
+  } else if (ai_material->GetTexture(
+               aiTextureType_SHININESS, 0, &ai_tex_path) == AI_SUCCESS) {
+    set_path(TextureType::Roughness, ai_tex_path);
+  }
+
+  return description;
+}
+}
+
+ImportedMesh::ImportedMesh() = default;
+ImportedMesh::~ImportedMesh() = default;
+
+auto
+MeshImporter::import(const std::string& file_name) -> Core::Scope<ImportedMesh>
+{
+  AssimpLogStream::initialize();
+
+  auto imported = Core::make_scope<ImportedMesh>();
+  imported->importer = Core::make_scope<Assimp::Importer>();
+  imported->importer->SetPropertyFloat(AI_CONFIG_GLOBAL_SCALE_FACTOR_KEY,
+                                       100.0F);
+
+  // The importer owns its IO system.
+  auto& dependencies = imported->dependencies;
+  imported->importer->SetIOHandler(new RecordingIOSystem{ dependencies });
+
+  const aiScene* scene =
+    imported->importer->ReadFile(file_name, mesh_import_flags);
+  if (scene == nullptr) {
+    error("Failed to load mesh file: {0}", file_name);
+    return nullptr;
+  }
+  imported->scene = scene;
+
+  // Assimp opens the model file itself more than once, and some references
+  // more than once too.
+  std::erase_if(dependencies, [&file_name](const auto& dependency) {
+    std::error_code error_code;
+    return std::filesystem::equivalent(dependency, file_name, error_code);
+  });
+  std::ranges::sort(dependencies);
+  const auto duplicates = std::ranges::unique(dependencies);
+  dependencies.erase(duplicates.begin(), duplicates.end());
+
+  if (!scene->HasMeshes()) {
+    return imported;
+  }
+  static constexpr auto flt_max = std::numeric_limits<float>::max();
+
+  Core::u32 vertex_count = 0;
+  Core::u32 index_count = 0;
+
+  auto& data = imported->data;
+  auto& vertices = imported->vertices;
+  auto& indices = imported->indices;
+  data.bounding_box.min = { flt_max, flt_max, flt_max };
+  data.bounding_box.max = { -flt_max, -flt_max, -flt_max };
+
+  auto& submeshes = data.submeshes;
+  submeshes.reserve(scene->mNumMeshes);
+  for (unsigned m = 0; m < scene->mNumMeshes; m++) {
+    aiMesh* mesh = scene->mMeshes[m];
+
+    Submesh& submesh = submeshes.emplace_back();
+    submesh.base_vertex = vertex_count;
+    submesh.base_index = index_count;
+    submesh.material_index = mesh->mMaterialIndex;
+    submesh.vertex_count = mesh->mNumVertices;
+    submesh.index_count = mesh->mNumFaces * 3;
+    submesh.mesh_name = mesh->mName.C_Str();
+
+    vertex_count += mesh->mNumVertices;
+    index_count += submesh.index_count;
+
+    // Vertices
+    auto& aabb = submesh.bounding_box;
+    aabb.min = {
+      flt_max,
+      flt_max,
+      flt_max,
+    };
+    aabb.max = {
+      -flt_max,
+      -flt_max,
+      -flt_max,
+    };
+
+    const auto count = mesh->mNumVertices;
+
+    const auto vertices_span = std::span{ mesh->mVertices, count };
+    const auto normals_span = std::span{ mesh->mNormals, count };
+    const auto tangents_span = std::span{ mesh->mTangents, count };
+    const auto bitangents_span = std::span{ mesh->mBitangents, count };
+    const auto uvs_span = std::span{ mesh->mTextureCoords, count };
+    const auto index_span = std::span{ mesh->mFaces, mesh->mNumFaces };
+
+    const auto has_normals = mesh->HasNormals();
+    const auto has_tangents = mesh->HasTangentsAndBitangents();
+    const auto has_uvs = mesh->HasTextureCoords(0);
+
+    for (auto i = 0U; i < count; i++) {
+      Vertex vertex{};
+      vertex.position = {
+        vertices_span[i].x,
+        vertices_span[i].y,
+        vertices_span[i].z,
+      };
+      vertex.normals = {
+        has_normals ? normals_span[i].x : 0.0F,
+        has_normals ? normals_span[i].y : 0.0F,
+        has_normals ? normals_span[i].z : 0.0F,
+      };
+
+      aabb.update_min_max(vertex.position);
+
+      if (has_tangents) {
+        vertex.tangent = {
+          tangents_span[i].x,
+          tangents_span[i].y,
+          tangents_span[i].z,
+        };
+        vertex.bitangent = {
+          bitangents_span[i].x,
+          bitangents_span[i].y,
+          bitangents_span[i].z,
+        };
+      }
+
+      if (has_uvs) {
+        vertex.uvs = {
+          uvs_span[0][i].x,
+          uvs_span[0][i].y,
+        };
+      }
+
+      vertices.push_back(vertex);
+    }
+
+    // Indices
+    for (auto i = 0U; i < mesh->mNumFaces; i++) {
+      indices.push_back({
+        .V1 = index_span[i].mIndices[0],
+        .V2 = index_span[i].mIndices[1],
+        .V3 = index_span[i].mIndices[2],
+      });
+    }
+  }
+
+  traverse_nodes(submeshes, scene->mRootNode);
+
+  // Every corner, so a rotated submesh still lies inside the mesh bounds.
+  for (const auto& submesh : submeshes) {
+    const auto& local = submesh.bounding_box;
+    for (auto corner = 0; corner < 8; corner++) {
+      const glm::vec3 vertex{
+        (corner & 1) != 0 ? local.max.x : local.min.x,
+        (corner & 2) != 0 ? local.max.y : local.min.y,
+        (corner & 4) != 0 ? local.max.z : local.min.z,
+      };
+      data.bounding_box.update_min_max(
+        glm::vec3(submesh.transform * glm::vec4(vertex, 1.0F)));
+    }
+  }
+
+  std::span scene_mats{ scene->mMaterials, scene->mNumMaterials };
+  data.materials.reserve(scene_mats.size());
+  for (const auto* ai_material : scene_mats) {
+    data.materials.push_back(
+      describe_material(scene, ai_material, imported->has_embedded_textures));
+  }
+
+  data.vertices = vertices;
+  data.indices = indices;
+  return imported;
+}
+
+} // namespace Engine::Graphics
@@ -0,0 +1,150 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/PersistentDescriptorSet.hpp"
+
+#include "core/Application.hpp"
+#include "graphics/DescriptorResource.hpp"
+
+#include <algorithm>
+
+namespace Engine::Graphics {
+
+namespace {
+auto
+same_image(const VkDescriptorImageInfo& left,
+           const VkDescriptorImageInfo& right) -> bool
+{
+  return left.sampler == right.sampler && left.imageView == right.imageView &&
+         left.imageLayout == right.imageLayout;
+}
+
+auto
+same_buffer(const VkDescriptorBufferInfo& left,
+            const VkDescriptorBufferInfo& right) -> bool
+{
+  return left.buffer == right.buffer && left.offset == right.offset &&
+         left.range == right.range;
+}
+} // namespace
+
+auto
+DescriptorBindingTracker::reset() -> void
+{
+  dirty = all_bindings;
+  written.clear();
+}
+
+auto
+DescriptorBindingTracker::track(std::span<const VkWriteDescriptorSet> writes)
+  -> Core::u64
+{
+  Core::u64 covered = 0;
+  for (const auto& write : writes) {
+    const auto bit = binding_bit(write.dstBinding);
+    covered |= bit;
+    // Arrays and texel buffer views are not recorded, and always rewritten.
+    if (write.descriptorCount != 1 ||
+        (write.pImageInfo == nullptr && write.pBufferInfo == nullptr)) {
+      dirty |= bit;
+      continue;
+    }
+
+    WrittenDescriptor current{
+      .binding = write.dstBinding,
+      .array_element = write.dstArrayElement,
+      .type = write.descriptorType,
+    };
+    if (write.pImageInfo != nullptr) {
+      current.image = *write.pImageInfo;
+    }
+    if (write.pBufferInfo != nullptr) {
+      current.buffer = *write.pBufferInfo;
+    }
+
+    const auto it = std::ranges::find_if(written, [&](const auto& previous) {
+      return previous.binding == current.binding &&
+             previous.array_element == current.array_element;
+    });
+    if (it == written.end()) {
+      written.push_back(current);
+      dirty |= bit;
+    } else if (it->type != current.type ||
+               !same_image(it->image, current.image) ||
+               !same_buffer(it->buffer, current.buffer)) {
+      *it = current;
+      dirty |= bit;
+    }
+  }
+
+  const auto changed = dirty & covered;
+  dirty &= ~changed;
+  return changed;
+}
+
+PersistentDescriptorSet::PersistentDescriptorSet()
+  : frames(Core::Application::the().get_image_count())
+{
+}
+
+PersistentDescriptorSet::~PersistentDescriptorSet()
+{
+  for (const auto& frame : frames) {
+    DescriptorResource::the().free_persistent_descriptor_set(frame.set);
+  }
+}
+
+auto
+PersistentDescriptorSet::mark_dirty(Core::u32 binding) -> void
+{
+  for (auto& frame : frames) {
+    frame.tracker.mark_dirty(binding);
+  }
+}
+
+auto
+PersistentDescriptorSet::update(VkDescriptorSetLayout layout,
+                                std::span<const VkWriteDescriptorSet> writes)
+  -> VkDescriptorSet
+{
+  auto& frame = frames.at(Core::Application::the().current_frame_index());
+  if (frame.layout != layout || frame.set == nullptr) {
+    auto& descriptor_resource = DescriptorResource::the();
+    descriptor_resource.free_persistent_descriptor_set(frame.set);
+
+    VkDescriptorSetAllocateInfo allocation_info{};
+    allocation_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocation_info.descriptorSetCount = 1;
+    allocation_info.pSetLayouts = &layout;
+    frame.set =
+      descriptor_resource.allocate_persistent_descriptor_set(allocation_info);
+    frame.layout = frame.set != nullptr ? layout : nullptr;
+    frame.tracker.reset();
+    if (frame.set == nullptr) {
+      return nullptr;
+    }
+  }
+
+  const auto dirty = frame.tracker.track(writes);
+  if (dirty == 0) {
+    return frame.set;
+  }
+
+  pending_writes.clear();
+  for (const auto& write : writes) {
+    if ((dirty & DescriptorBindingTracker::binding_bit(write.dstBinding)) !=
+        0) {
+      auto& pending = pending_writes.emplace_back(write);
+      pending.dstSet = frame.set;
+    }
+  }
+  DescriptorResource::the().update_descriptor_sets(pending_writes);
+  return frame.set;
+}
+
+auto
+PersistentDescriptorSet::get() const -> VkDescriptorSet
+{
+  return frames.at(Core::Application::the().current_frame_index()).set;
+}
+
+} // namespace Engine::Graphics
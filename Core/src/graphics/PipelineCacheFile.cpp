@@ -0,0 +1,113 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/PipelineCacheFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace Engine::Graphics {
+
+namespace {
+// VkPipelineCacheHeaderVersionOne, read field by field: the data has no
+// alignment guarantees.
+constexpr Core::usize header_size =
+  4 * sizeof(Core::u32) + VK_UUID_SIZE * sizeof(Core::u8);
+
+auto
+read_u32(std::span<const std::byte> data, Core::usize offset) -> Core::u32
+{
+  Core::u32 value{ 0 };
+  std::memcpy(&value, data.data() + offset, sizeof(value));
+  return value;
+}
+}
+
+auto
+PipelineCacheFile::get_identity(const VkPhysicalDeviceProperties& properties)
+  -> DeviceIdentity
+{
+  DeviceIdentity identity{
+    .vendor_id = properties.vendorID,
+    .device_id = properties.deviceID,
+  };
+  std::ranges::copy(properties.pipelineCacheUUID,
+                    identity.cache_uuid.begin());
+  return identity;
+}
+
+auto
+PipelineCacheFile::is_compatible(std::span<const std::byte> data,
+                                 const DeviceIdentity& identity) -> bool
+{
+  if (data.size() < header_size) {
+    return false;
+  }
+
+  const auto length = read_u32(data, 0);
+  const auto version = read_u32(data, 4);
+  if (length < header_size || length > data.size() ||
+      version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+    return false;
+  }
+  if (read_u32(data, 8) != identity.vendor_id ||
+      read_u32(data, 12) != identity.device_id) {
+    return false;
+  }
+  return std::memcmp(data.data() + 16,
+                     identity.cache_uuid.data(),
+                     identity.cache_uuid.size()) == 0;
+}
+
+auto
+PipelineCacheFile::read(const std::filesystem::path& path,
+                        const DeviceIdentity& identity)
+  -> std::vector<std::byte>
+{
+  std::ifstream input{ path, std::ios::binary | std::ios::ate };
+  if (!input) {
+    return {};
+  }
+
+  std::vector<std::byte> data(static_cast<Core::usize>(input.tellg()));
+  input.seekg(0);
+  input.read(reinterpret_cast<char*>(data.data()),
+             static_cast<std::streamsize>(data.size()));
+  if (!input || !is_compatible(data, identity)) {
+    return {};
+  }
+  return data;
+}
+
+auto
+PipelineCacheFile::write(const std::filesystem::path& path,
+                         std::span<const std::byte> data) -> bool
+{
+  std::error_code error_code;
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path(), error_code);
+  }
+
+  auto temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream output{ temporary, std::ios::binary | std::ios::trunc };
+    if (!output) {
+      return false;
+    }
+    output.write(reinterpret_cast<const char*>(data.data()),
+                 static_cast<std::streamsize>(data.size()));
+    if (!output) {
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temporary, path, error_code);
+  if (error_code) {
+    std::filesystem::remove(temporary, error_code);
+    return false;
+  }
+  return true;
+}
+
+} // namespace Engine::Graphics
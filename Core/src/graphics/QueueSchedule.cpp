@@ -0,0 +1,104 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/QueueSchedule.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Engine::Graphics {
+
+auto
+QueueSchedule::clear() -> void
+{
+  stages.clear();
+  dependencies.clear();
+  handoffs.clear();
+  semaphore_count = 0;
+}
+
+auto
+QueueSchedule::add_stage(std::string name,
+                         QueueType queue,
+                         std::vector<std::string> passes) -> StageIndex
+{
+  stages.push_back(Stage{
+    .name = std::move(name),
+    .queue = queue,
+    .passes = std::move(passes),
+  });
+  return static_cast<StageIndex>(stages.size() - 1);
+}
+
+auto
+QueueSchedule::add_dependency(StageIndex from,
+                              StageIndex to,
+                              VkPipelineStageFlags wait_stages) -> void
+{
+  // Submitting in order of addition is what keeps this free of cycles.
+  if (from >= to || to >= stages.size()) {
+    throw std::runtime_error("A stage can only depend on an earlier stage");
+  }
+  dependencies.push_back({ from, to, wait_stages });
+}
+
+auto
+QueueSchedule::add_handoff(const Handoff& handoff) -> void
+{
+  add_dependency(handoff.from, handoff.to, handoff.dst_stages);
+  handoffs.push_back(handoff);
+}
+
+auto
+QueueSchedule::compile() -> void
+{
+  semaphore_count = 0;
+  for (auto& stage : stages) {
+    stage.waits.clear();
+    stage.signals.clear();
+    stage.acquires.clear();
+    stage.releases.clear();
+  }
+
+  for (const auto& handoff : handoffs) {
+    if (stages.at(handoff.from).queue == stages.at(handoff.to).queue) {
+      continue;
+    }
+    stages.at(handoff.from).releases.push_back(handoff);
+    stages.at(handoff.to).acquires.push_back(handoff);
+  }
+
+  // A semaphore signal covers everything submitted before it on its queue,
+  // so each stage only waits for the latest stage it depends on per queue.
+  struct LatestOnQueue
+  {
+    QueueType queue;
+    StageIndex from;
+    VkPipelineStageFlags stages;
+  };
+  std::vector<LatestOnQueue> latest;
+  for (StageIndex to = 0; to < stages.size(); to++) {
+    latest.clear();
+    for (const auto& dependency : dependencies) {
+      const auto queue = stages.at(dependency.from).queue;
+      if (dependency.to != to || queue == stages.at(to).queue) {
+        continue;
+      }
+
+      auto it = std::ranges::find(latest, queue, &LatestOnQueue::queue);
+      if (it == latest.end()) {
+        latest.push_back({ queue, dependency.from, dependency.stages });
+        continue;
+      }
+      it->from = std::max(it->from, dependency.from);
+      it->stages |= dependency.stages;
+    }
+
+    for (const auto& [queue, from, wait_stages] : latest) {
+      const auto semaphore = semaphore_count++;
+      stages.at(from).signals.push_back(semaphore);
+      stages.at(to).waits.push_back({ semaphore, wait_stages });
+    }
+  }
+}
+
+} // namespace Engine::Graphics
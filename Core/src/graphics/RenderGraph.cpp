@@ -0,0 +1,525 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/RenderGraph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Engine::Graphics {
+
+namespace {
+auto
+align_up(VkDeviceSize value, VkDeviceSize alignment) -> VkDeviceSize
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+}
+
+auto
+RenderGraph::clear() -> void
+{
+  passes.clear();
+  resources.clear();
+  uses.clear();
+  live.clear();
+  order.clear();
+  hazards.clear();
+  barriers.clear();
+  placements.clear();
+  statistics = {};
+}
+
+auto
+RenderGraph::add_pass(std::string name,
+                      QueueType queue,
+                      VkPipelineStageFlags waits_for,
+                      VkPipelineStageFlags blocks) -> PassIndex
+{
+  passes.push_back(Pass{
+    .name = std::move(name),
+    .queue = queue,
+    .waits_for = waits_for,
+    .blocks = blocks,
+  });
+  return static_cast<PassIndex>(passes.size() - 1);
+}
+
+auto
+RenderGraph::add_resource(std::string_view name) -> ResourceIndex
+{
+  if (const auto existing = find_resource(name)) {
+    return *existing;
+  }
+  resources.push_back(Resource{ .name = std::string{ name } });
+  return static_cast<ResourceIndex>(resources.size() - 1);
+}
+
+auto
+RenderGraph::add_buffer(std::string_view name) -> ResourceIndex
+{
+  return add_resource(name);
+}
+
+auto
+RenderGraph::add_image(std::string_view name,
+                       Image* image,
+                       VkImageLayout layout) -> ResourceIndex
+{
+  const auto index = add_resource(name);
+  auto& resource = resources.at(index);
+  resource.is_image = true;
+  resource.image = image;
+  resource.layout = layout;
+  return index;
+}
+
+auto
+RenderGraph::find_resource(std::string_view name) const
+  -> std::optional<ResourceIndex>
+{
+  const auto it = std::ranges::find(resources, name, &Resource::name);
+  if (it == resources.end()) {
+    return std::nullopt;
+  }
+  return static_cast<ResourceIndex>(std::distance(resources.begin(), it));
+}
+
+auto
+RenderGraph::add_use(PassIndex pass,
+                     ResourceIndex resource,
+                     Access access,
+                     bool write) -> void
+{
+  if (pass >= passes.size() || resource >= resources.size()) {
+    throw std::runtime_error("Unknown pass or resource in the render graph");
+  }
+
+  // A pass reading and writing a resource uses it once, with both accesses.
+  auto it = std::ranges::find_if(uses, [&](const Use& use) {
+    return use.pass == pass && use.resource == resource;
+  });
+  if (it == uses.end()) {
+    uses.push_back({ pass, resource, {}, false, false });
+    it = std::prev(uses.end());
+  }
+  it->access.stages |= access.stages;
+  it->access.access |= access.access;
+  it->read = it->read || !write;
+  it->write = it->write || write;
+}
+
+auto
+RenderGraph::read(PassIndex pass, ResourceIndex resource, Access access)
+  -> void
+{
+  add_use(pass, resource, access, false);
+}
+
+auto
+RenderGraph::write(PassIndex pass, ResourceIndex resource, Access access)
+  -> void
+{
+  add_use(pass, resource, access, true);
+}
+
+auto
+RenderGraph::find_use(PassIndex pass, ResourceIndex resource) const
+  -> const Use&
+{
+  return *std::ranges::find_if(uses, [&](const Use& use) {
+    return use.pass == pass && use.resource == resource;
+  });
+}
+
+auto
+RenderGraph::set_output(ResourceIndex resource) -> void
+{
+  resources.at(resource).output = true;
+}
+
+auto
+RenderGraph::set_transient(ResourceIndex resource,
+                           VkDeviceSize size,
+                           VkDeviceSize alignment) -> void
+{
+  auto& transient = resources.at(resource);
+  transient.transient = true;
+  transient.size = size;
+  transient.alignment = std::max<VkDeviceSize>(alignment, 1);
+}
+
+auto
+RenderGraph::compile() -> void
+{
+  // Uses in declaration order, which is the order reads see writes in.
+  std::ranges::stable_sort(uses, {}, &Use::pass);
+
+  statistics = {};
+  statistics.passes = static_cast<Core::u32>(passes.size());
+  cull();
+  find_hazards();
+  sort();
+  place_transients();
+  place_barriers();
+}
+
+auto
+RenderGraph::cull() -> void
+{
+  // Walking backwards, a pass is kept when it writes an output or something
+  // a kept pass after it reads.
+  std::vector<bool> needed(resources.size(), false);
+  for (auto i = 0ULL; i < resources.size(); i++) {
+    needed[i] = resources[i].output;
+  }
+
+  live.assign(passes.size(), false);
+  for (auto pass = static_cast<Core::i64>(passes.size()) - 1; pass >= 0;
+       pass--) {
+    const auto index = static_cast<PassIndex>(pass);
+    for (const auto& use : uses) {
+      if (use.pass == index && use.write && needed[use.resource]) {
+        live[index] = true;
+      }
+    }
+    if (!live[index]) {
+      statistics.culled++;
+      continue;
+    }
+    for (const auto& use : uses) {
+      if (use.pass == index && use.read) {
+        needed[use.resource] = true;
+      }
+    }
+  }
+}
+
+auto
+RenderGraph::find_hazards() -> void
+{
+  hazards.clear();
+  const auto add = [&](const Use& from, const Use& to) {
+    if (from.pass == to.pass) {
+      return;
+    }
+    hazards.push_back(Hazard{
+      .from = from.pass,
+      .to = to.pass,
+      .resource = to.resource,
+      .src = from.access,
+      .dst = to.access,
+      .cross_queue = passes[from.pass].queue != passes[to.pass].queue,
+    });
+  };
+
+  for (ResourceIndex resource = 0; resource < resources.size(); resource++) {
+    std::optional<Use> writer;
+    std::vector<Use> readers;
+    std::optional<QueueType> owner;
+
+    for (const auto& use : uses) {
+      if (use.resource != resource || !live[use.pass]) {
+        continue;
+      }
+      const auto queue = passes[use.pass].queue;
+      if (!use.write) {
+        if (writer.has_value()) {
+          add(*writer, use);
+        }
+        // An image read on another queue changes owner once every read on
+        // the queue owning it is done.
+        if (resources[resource].is_image && owner.has_value() &&
+            *owner != queue) {
+          for (const auto& reader : readers) {
+            if (passes[reader.pass].queue == *owner) {
+              add(reader, use);
+            }
+          }
+        }
+        owner = queue;
+        readers.push_back(use);
+        continue;
+      }
+
+      for (const auto& reader : readers) {
+        add(reader, use);
+      }
+      if (writer.has_value() && (readers.empty() || use.read)) {
+        add(*writer, use);
+      }
+      writer = use;
+      readers.clear();
+      owner = queue;
+    }
+  }
+}
+
+auto
+RenderGraph::sort() -> void
+{
+  // Kahn's algorithm. Of the passes ready to run, compute queue passes go
+  // first so the other queue has work sooner, then declaration order.
+  std::vector<Core::u32> incoming(passes.size(), 0);
+  for (const auto& hazard : hazards) {
+    incoming[hazard.to]++;
+  }
+
+  order.clear();
+  std::vector<PassIndex> ready;
+  for (PassIndex pass = 0; pass < passes.size(); pass++) {
+    if (live[pass] && incoming[pass] == 0) {
+      ready.push_back(pass);
+    }
+  }
+
+  while (!ready.empty()) {
+    const auto next = std::ranges::min_element(ready, {}, [&](PassIndex pass) {
+      return std::pair{ passes[pass].queue != QueueType::Compute, pass };
+    });
+    const auto pass = *next;
+    ready.erase(next);
+    order.push_back(pass);
+
+    for (const auto& hazard : hazards) {
+      if (hazard.from == pass && --incoming[hazard.to] == 0) {
+        ready.push_back(hazard.to);
+      }
+    }
+  }
+
+  if (order.size() != passes.size() - statistics.culled) {
+    throw std::runtime_error("The render graph has a cycle");
+  }
+}
+
+auto
+RenderGraph::place_transients() -> void
+{
+  std::vector<Core::u32> position(passes.size(), 0);
+  for (auto i = 0U; i < order.size(); i++) {
+    position[order[i]] = i;
+  }
+
+  struct Lifetime
+  {
+    ResourceIndex resource{ 0 };
+    QueueType queue{ QueueType::Graphics };
+    PassIndex first{ 0 };
+    PassIndex last{ 0 };
+    VkDeviceSize offset{ 0 };
+  };
+  std::vector<Lifetime> lifetimes;
+  for (ResourceIndex resource = 0; resource < resources.size(); resource++) {
+    if (!resources[resource].transient || resources[resource].size == 0) {
+      continue;
+    }
+
+    std::optional<Lifetime> lifetime;
+    bool one_queue = true;
+    for (const auto& use : uses) {
+      if (use.resource != resource || !live[use.pass]) {
+        continue;
+      }
+      if (!lifetime.has_value()) {
+        lifetime = Lifetime{
+          resource, passes[use.pass].queue, use.pass, use.pass, 0,
+        };
+        continue;
+      }
+      one_queue = one_queue && passes[use.pass].queue == lifetime->queue;
+      if (position[use.pass] < position[lifetime->first]) {
+        lifetime->first = use.pass;
+      }
+      if (position[use.pass] > position[lifetime->last]) {
+        lifetime->last = use.pass;
+      }
+    }
+    // Memory shared between queues would need a semaphore per alias.
+    if (lifetime.has_value() && one_queue) {
+      lifetimes.push_back(*lifetime);
+    }
+  }
+
+  // Largest first, each at the lowest offset clear of the transients alive
+  // at the same time.
+  std::ranges::stable_sort(lifetimes, std::greater{}, [&](const Lifetime& l) {
+    return resources[l.resource].size;
+  });
+  const auto overlaps = [&](const Lifetime& left, const Lifetime& right) {
+    return left.queue != right.queue ||
+           (position[left.first] <= position[right.last] &&
+            position[right.first] <= position[left.last]);
+  };
+
+  placements.clear();
+  for (auto i = 0ULL; i < lifetimes.size(); i++) {
+    auto& lifetime = lifetimes[i];
+    const auto& resource = resources[lifetime.resource];
+
+    VkDeviceSize offset = 0;
+    for (auto moved = true; moved;) {
+      moved = false;
+      for (auto j = 0ULL; j < i; j++) {
+        const auto& placed = lifetimes[j];
+        const auto placed_end = placed.offset + resources[placed.resource].size;
+        if (overlaps(lifetime, placed) && offset < placed_end &&
+            placed.offset < offset + resource.size) {
+          offset = align_up(placed_end, resource.alignment);
+          moved = true;
+        }
+      }
+    }
+
+    lifetime.offset = offset;
+    placements.push_back({ lifetime.resource, offset });
+    statistics.transient_bytes += resource.size;
+    statistics.aliased_bytes =
+      std::max(statistics.aliased_bytes, offset + resource.size);
+  }
+
+  // Transients sharing memory take turns: the later one waits for the
+  // earlier one, and the earlier one in the next frame for the later one.
+  const auto add_aliasing = [&](const Lifetime& from, const Lifetime& to) {
+    hazards.push_back(Hazard{
+      .from = from.last,
+      .to = to.first,
+      .resource = to.resource,
+      .src = find_use(from.last, from.resource).access,
+      .dst = find_use(to.first, to.resource).access,
+      .aliasing = true,
+    });
+  };
+  for (auto i = 0ULL; i < lifetimes.size(); i++) {
+    for (auto j = i + 1; j < lifetimes.size(); j++) {
+      const auto& left = lifetimes[i];
+      const auto& right = lifetimes[j];
+      if (overlaps(left, right) ||
+          left.offset >= right.offset + resources[right.resource].size ||
+          right.offset >= left.offset + resources[left.resource].size) {
+        continue;
+      }
+      const auto left_first = position[left.first] < position[right.first];
+      add_aliasing(left_first ? left : right, left_first ? right : left);
+      add_aliasing(left_first ? right : left, left_first ? left : right);
+    }
+  }
+}
+
+auto
+RenderGraph::place_barriers() -> void
+{
+  barriers.assign(passes.size(), {});
+  for (const auto& hazard : hazards) {
+    statistics.hazards++;
+    if (hazard.cross_queue) {
+      statistics.cross_queue++;
+      continue;
+    }
+
+    // Ordered already when the producer holds back the stages the consumer
+    // accesses in, the consumer waits for those the producer accessed in, or
+    // the two dependencies meet at a stage and chain.
+    const auto& from = passes[hazard.from];
+    const auto& to = passes[hazard.to];
+    if ((hazard.dst.stages & ~from.blocks) == 0 ||
+        (hazard.src.stages & ~to.waits_for) == 0 ||
+        (from.blocks & to.waits_for) != 0) {
+      statistics.covered++;
+      continue;
+    }
+
+    auto& barrier = barriers[hazard.to];
+    if (barrier.empty()) {
+      statistics.barriers++;
+    }
+    barrier.src_stages |= hazard.src.stages;
+    barrier.dst_stages |= hazard.dst.stages;
+    barrier.src_access |= hazard.src.access;
+    barrier.dst_access |= hazard.dst.access;
+  }
+}
+
+auto
+RenderGraph::build_schedule(QueueSchedule& schedule) const -> void
+{
+  // A pass joins the last stage of its queue unless another queue's stage
+  // already waits for that stage, or the pass needs a stage on the other
+  // queue the last one does not wait for. Either would hold back work that
+  // could overlap.
+  struct PlannedStage
+  {
+    QueueType queue{ QueueType::Graphics };
+    std::vector<std::string> passes{};
+    std::vector<Core::u32> waits_on{};
+    bool closed{ false };
+  };
+  std::vector<PlannedStage> planned;
+  std::vector<Core::u32> stage_of(passes.size(), 0);
+
+  std::vector<Core::u32> producers;
+  for (const auto pass : order) {
+    const auto queue = passes[pass].queue;
+    producers.clear();
+    for (const auto& hazard : hazards) {
+      const auto stage = stage_of[hazard.from];
+      if (hazard.to == pass && hazard.cross_queue &&
+          std::ranges::find(producers, stage) == producers.end()) {
+        producers.push_back(stage);
+      }
+    }
+
+    auto last = std::ranges::find(
+      planned.rbegin(), planned.rend(), queue, &PlannedStage::queue);
+    const auto joins =
+      last != planned.rend() && !last->closed &&
+      std::ranges::all_of(producers, [&](Core::u32 stage) {
+        return std::ranges::find(last->waits_on, stage) != last->waits_on.end();
+      });
+    if (!joins) {
+      planned.push_back({ queue, {}, producers });
+      last = planned.rbegin();
+    }
+    last->passes.push_back(passes[pass].name);
+    stage_of[pass] =
+      static_cast<Core::u32>(std::distance(last, planned.rend()) - 1);
+    for (const auto stage : producers) {
+      planned[stage].closed = true;
+    }
+  }
+
+  schedule.clear();
+  for (auto& stage : planned) {
+    auto name = stage.passes.front();
+    schedule.add_stage(std::move(name), stage.queue, std::move(stage.passes));
+  }
+
+  std::vector<QueueSchedule::Handoff> handoffs;
+  for (const auto& hazard : hazards) {
+    if (!hazard.cross_queue) {
+      continue;
+    }
+    const auto from = stage_of[hazard.from];
+    const auto to = stage_of[hazard.to];
+    if (!resources[hazard.resource].is_image) {
+      schedule.add_dependency(from, to, hazard.dst.stages);
+      continue;
+    }
+
+    auto it = std::ranges::find_if(handoffs, [&](const auto& handoff) {
+      return handoff.resource == hazard.resource && handoff.from == from &&
+             handoff.to == to;
+    });
+    if (it == handoffs.end()) {
+      handoffs.push_back({ hazard.resource, from, to, 0, 0 });
+      it = std::prev(handoffs.end());
+    }
+    it->src_stages |= hazard.src.stages;
+    it->dst_stages |= hazard.dst.stages;
+  }
+  for (const auto& handoff : handoffs) {
+    schedule.add_handoff(handoff);
+  }
+  schedule.compile();
+}
+
+} // namespace Engine::Graphics
@@ -3,9 +3,12 @@
 #include "graphics/RenderPass.hpp"
 
 #include "graphics/Framebuffer.hpp"
+#include "graphics/Image.hpp"
 #include "graphics/Renderer.hpp"
 #include "graphics/RendererExtensions.hpp"
 
+#include <utility>
+
 namespace Engine::Graphics {
 
 RenderPass::RenderPass(Renderer& input)
@@ -37,6 +40,36 @@ RenderPass::execute(CommandBuffer& command_buffer) -> void
   bind(command_buffer);
   execute_impl(command_buffer);
   unbind(command_buffer);
+
+  std::scoped_lock lock{ command_statistics_mutex };
+  last_command_statistics = std::exchange(command_statistics, {});
+}
+
+auto
+RenderPass::add_framebuffer_pass(RenderGraph& graph, const std::string& name)
+  -> RenderGraph::PassIndex
+{
+  return graph.add_pass(name,
+                        QueueType::Graphics,
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+}
+
+auto
+RenderPass::set_transient(RenderGraph& graph,
+                          RenderGraph::ResourceIndex resource,
+                          Image& image) -> void
+{
+  const auto requirements = image.get_memory_requirements();
+  graph.set_transient(resource, requirements.size, requirements.alignment);
+}
+
+auto
+RenderPass::add_command_statistics(const CommandStatistics& statistics)
+  -> void
+{
+  std::scoped_lock lock{ command_statistics_mutex };
+  command_statistics += statistics;
 }
 
 auto
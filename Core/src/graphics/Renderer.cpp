@@ -4,49 +4,93 @@
 
 #include "core/Application.hpp"
 #include "core/Clock.hpp"
+#include "core/Profiler.hpp"
 #include "core/Random.hpp"
 #include "core/Scene.hpp"
 #include "core/ShadowCascadeCalculator.hpp"
+#include "core/Verify.hpp"
 
 #include "logging/Logger.hpp"
 
-#include "graphics/DescriptorResource.hpp"
 #include "graphics/GPUBuffer.hpp"
 #include "graphics/Swapchain.hpp"
 #include "graphics/Window.hpp"
 
 #include "graphics/Framebuffer.hpp"
+#include "graphics/GPUFrameTimer.hpp"
 
 #include "graphics/RendererExtensions.hpp"
 #include "graphics/TextureGenerator.hpp"
+#include "graphics/TransformPacker.hpp"
+#include "graphics/TransientImageMemory.hpp"
 
 #include "graphics/render_passes/Bloom.hpp"
 #include "graphics/render_passes/ChromaticAberration.hpp"
 #include "graphics/render_passes/Composition.hpp"
 #include "graphics/render_passes/Deferred.hpp"
+#include "graphics/render_passes/InstanceCulling.hpp"
 #include "graphics/render_passes/LightCulling.hpp"
 #include "graphics/render_passes/Lights.hpp"
 #include "graphics/render_passes/MainGeometry.hpp"
 #include "graphics/render_passes/Predepth.hpp"
 #include "graphics/render_passes/Shadow.hpp"
 
+#include <algorithm>
 #include <cstddef>
 #include <glm/gtc/quaternion.hpp>
+#include <optional>
 #include <ranges>
 #include <span>
 
 namespace Engine::Graphics {
 
+// Uploads the light count and the dirty slots only. Dirty slots a few apart
+// share one write, since copying a couple of clean lights is cheaper than
+// another write.
 static constexpr auto update_lights = []<class Light>(Light& light_ubo,
-                                                      auto& env_lights) {
-  auto i = 0ULL;
+                                                      const auto& env_lights,
+                                                      auto& dirty_slots) {
+  static constexpr Core::u32 max_gap = 4;
+
+  // Changes made while recording the other frames in flight.
+  light_ubo.refresh();
+
   auto& [ubo_count, ubo_lights] = light_ubo.get_data();
-  ubo_count = static_cast<Core::i32>(env_lights.size());
-  for (const auto& light : env_lights) {
-    ubo_lights.at(i) = light;
-    i++;
+  const auto count = std::min(env_lights.size(), ubo_lights.size());
+  if (static_cast<Core::usize>(ubo_count) != count) {
+    ubo_count = static_cast<Core::u32>(count);
+    light_ubo.update(light_ubo.offset_of(ubo_count), sizeof(ubo_count));
+  }
+
+  const auto upload = [&](Core::u32 first, Core::u32 last) {
+    std::copy(env_lights.begin() + first,
+              env_lights.begin() + last + 1,
+              ubo_lights.begin() + first);
+    light_ubo.update(light_ubo.offset_of(ubo_lights[first]),
+                     (last - first + 1) * sizeof(ubo_lights[0]));
+  };
+
+  auto first = std::numeric_limits<Core::u32>::max();
+  auto last = first;
+  for (const auto slot : dirty_slots) {
+    if (slot >= count) {
+      break;
+    }
+    if (first != std::numeric_limits<Core::u32>::max() &&
+        slot <= last + max_gap) {
+      last = slot;
+      continue;
+    }
+    if (first != std::numeric_limits<Core::u32>::max()) {
+      upload(first, last);
+    }
+    first = slot;
+    last = slot;
+  }
+  if (first != std::numeric_limits<Core::u32>::max()) {
+    upload(first, last);
   }
-  light_ubo.update();
+  dirty_slots.clear();
 };
 
 auto
@@ -65,11 +109,14 @@ Renderer::generate_and_update_descriptor_write_sets(Material& material)
   };
   const auto& shader = material.get_shader();
 
-  static std::unordered_map<Core::usize, std::vector<VkWriteDescriptorSet>>
-    shader_write_cache{};
+  struct RendererWrites
+  {
+    std::vector<VkWriteDescriptorSet> writes;
+    std::vector<const IShaderBindable*> sources;
+  };
+  static std::unordered_map<Core::usize, RendererWrites> shader_write_cache{};
 
-  std::vector<VkWriteDescriptorSet>& write_descriptor_sets =
-    shader_write_cache[shader->hash()];
+  auto& [write_descriptor_sets, sources] = shader_write_cache[shader->hash()];
   if (write_descriptor_sets.empty()) {
     write_descriptor_sets.reserve(structure_identifiers.size());
     for (const auto& identifier : structure_identifiers) {
@@ -95,28 +142,19 @@ Renderer::generate_and_update_descriptor_write_sets(Material& material)
       descriptor_write.descriptorCount = 1;
       descriptor_write.pBufferInfo = buffer_info;
       write_descriptor_sets.push_back(descriptor_write);
+      sources.push_back(identifier);
     }
   }
 
-  VkDescriptorSetAllocateInfo alloc_info{};
-  alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-  const auto& layouts = shader->get_descriptor_set_layouts();
-  alloc_info.descriptorSetCount = 1;
-  alloc_info.pSetLayouts = &layouts.at(0);
-  auto* allocated =
-    DescriptorResource::the().allocate_descriptor_set(alloc_info);
-
-  for (auto& wds : write_descriptor_sets) {
-    wds.dstSet = allocated;
+  // Every frame in flight has its own buffers.
+  for (auto i = 0ULL; i < sources.size(); i++) {
+    write_descriptor_sets[i].pBufferInfo = &sources[i]->get_descriptor_info();
   }
 
-  vkUpdateDescriptorSets(Device::the().device(),
-                         static_cast<Core::u32>(write_descriptor_sets.size()),
-                         write_descriptor_sets.data(),
-                         0,
-                         nullptr);
-
-  return allocated;
+  // The set is kept per material and frame in flight, and only bindings
+  // whose buffer changed are written again.
+  return material.get_renderer_descriptor_set().update(
+    shader->get_descriptor_set_layouts().at(0), write_descriptor_sets);
 }
 
 Renderer::Renderer(Configuration config, const Window* window)
@@ -134,7 +172,9 @@ Renderer::Renderer(Configuration config, const Window* window)
       return QueueType::Graphics;
     }
   } a{};
-  thread_pool = Core::make_scope<ED::ThreadPool>(a, 4U);
+  thread_pool = Core::make_scope<ED::ThreadPool>(a, thread_pool_size);
+  culling_scratch.resize(thread_pool_size + 1);
+  culling_thread_statistics.resize(thread_pool_size + 1);
 
   {
     Core::DataBuffer data_buffer{
@@ -166,17 +206,35 @@ Renderer::Renderer(Configuration config, const Window* window)
     .warnings_as_errors = false,
     .include_directories = { std::filesystem::path{ "shaders" } },
     .macro_definitions = {},
+    .cache_directory = std::filesystem::path{ "Assets/shaders/.cache" },
   });
 
-  command_buffer = Core::make_scope<CommandBuffer>(CommandBuffer::Properties{
-    .queue_type = QueueType::Graphics,
-    .primary = true,
-  });
-  compute_command_buffer =
-    Core::make_scope<CommandBuffer>(CommandBuffer::Properties{
-      .queue_type = QueueType::Compute,
-      .primary = true,
-    });
+  // Every pass compiles its shaders in its constructor, one after another.
+  // Compiling all stages up front, in parallel, turns those into cache hits.
+  {
+    std::vector<Compilation::ShaderCompileJob> shader_jobs;
+    for (const auto& entry :
+         std::filesystem::directory_iterator("Assets/shaders")) {
+      const auto& path = entry.path();
+      if (path.extension() == ".vert") {
+        shader_jobs.push_back({ path, Compilation::ShaderStage::Vertex });
+      } else if (path.extension() == ".frag") {
+        shader_jobs.push_back({ path, Compilation::ShaderStage::Fragment });
+      } else if (path.extension() == ".comp") {
+        shader_jobs.push_back({ path, Compilation::ShaderStage::Compute });
+      }
+    }
+    if (const auto failed = Shader::precompile(shader_jobs); failed > 0) {
+      warn("{} of {} shader stages failed to precompile",
+           failed,
+           shader_jobs.size());
+    }
+  }
+
+  // Stage command buffers and semaphores are made as the schedule needs them.
+  const auto frame_count = Core::Application::the().get_image_count();
+  frame_semaphores.resize(frame_count);
+  gpu_frame_timer = Core::make_scope<GPUFrameTimer>(frame_count);
 
   std::unordered_map<RendererTechnique, std::vector<std::string>>
     technique_construction_order;
@@ -203,6 +261,8 @@ Renderer::Renderer(Configuration config, const Window* window)
     Core::make_scope<ChromaticAberrationRenderPass>(*this);
   render_passes["Composition"] = Core::make_scope<CompositionRenderPass>(*this);
   render_passes["Bloom"] = Core::make_scope<BloomRenderPass>(*this);
+  render_passes["InstanceCulling"] =
+    Core::make_scope<InstanceCullingRenderPass>(*this);
 
   for (const auto& k :
        technique_construction_order.at(RendererTechnique::Deferred)) {
@@ -217,18 +277,22 @@ Renderer::Renderer(Configuration config, const Window* window)
     render_passes.at(k)->construct();
   }
 
-  activate_post_processing_step("Bloom");
+  technique_construction_order[RendererTechnique::GPUDriven] = {
+    "InstanceCulling"
+  };
+  for (const auto& k :
+       technique_construction_order.at(RendererTechnique::GPUDriven)) {
+    render_passes.at(k)->construct();
+  }
+
+  activate_post_processing_step("Bloom", true);
   activate_post_processing_step("ChromaticAberration");
   activate_post_processing_step("Composition");
 
-  transform_buffers.resize(3);
-  static constexpr auto total_size =
-    100ULL * 1000 * sizeof(TransformVertexData);
-  for (auto& [vertex_buffer, transform_buffer] : transform_buffers) {
-    vertex_buffer = Core::make_scope<VertexBuffer>(total_size);
-    transform_buffer = Core::make_scope<Core::DataBuffer>(total_size);
-    transform_buffer->fill_zero();
-  }
+  transform_ring =
+    Core::make_scope<TransformRingBuffer>(TransformRingBuffer::Configuration{
+      .frame_count = window->get_swapchain().get_image_count(),
+    });
 
   const glm::uvec2 viewport_size{ size.width, size.height };
 
@@ -260,12 +324,44 @@ Renderer::destruct() -> void
   for (const auto& [k, v] : render_passes) {
     v->destruct();
   }
-
-  command_buffer.reset();
+  placed_images.clear();
+  transient_memory.reset();
+
+  scheduled_stages.clear();
+  gpu_frame_timer.reset();
+  for (const auto& semaphores : frame_semaphores) {
+    for (auto* semaphore : semaphores) {
+      vkDestroySemaphore(Device::the().device(), semaphore, nullptr);
+    }
+  }
+  frame_semaphores.clear();
+  transform_ring.reset();
 
   thread_pool.reset();
 }
 
+auto
+Renderer::set_technique(RendererTechnique new_technique) -> void
+{
+  if (new_technique == RendererTechnique::GPUDriven &&
+      !Device::the().supports_gpu_driven_draws()) {
+    warn("GPU-driven drawing is not supported by this device, staying with "
+         "CPU culled draws.");
+    technique = RendererTechnique::Deferred;
+    schedule_dirty = true;
+    return;
+  }
+  technique = new_technique;
+  schedule_dirty = true;
+}
+
+auto
+Renderer::get_instance_culling() -> InstanceCullingRenderPass&
+{
+  return static_cast<InstanceCullingRenderPass&>(
+    *render_passes.at("InstanceCulling"));
+}
+
 auto
 Renderer::begin_scene(Core::Scene& scene,
                       const Core::SceneRendererCamera& camera) -> void
@@ -274,6 +370,7 @@ Renderer::begin_scene(Core::Scene& scene,
     Device::the().wait();
     old_size = size;
     // We've been resized.
+    release_transient_images();
 
     auto& shadow_render_pass = get_render_pass("Shadow");
     auto& main_geom = get_render_pass("MainGeometry");
@@ -287,6 +384,7 @@ Renderer::begin_scene(Core::Scene& scene,
     deferred.on_resize(size);
     lights.on_resize(size);
     chromatic_aberration.on_resize(size);
+    recreate_stale_pipelines();
 
     const glm::uvec2 viewport_size{ size.width, size.height };
 
@@ -299,9 +397,14 @@ Renderer::begin_scene(Core::Scene& scene,
                                      light_culling_work_groups.y * 4 * 1024);
     visible_spot_lights_ssbo.resize(light_culling_work_groups.x *
                                     light_culling_work_groups.y * 4 * 1024);
+    // The transients are sized anew.
+    schedule_dirty = true;
+  }
+  if (schedule_dirty) {
+    build_schedule();
   }
 
-  const auto& light_environment = scene.get_light_environment();
+  auto& light_environment = scene.get_light_environment();
   auto& [view,
          proj,
          view_proj,
@@ -313,6 +416,7 @@ Renderer::begin_scene(Core::Scene& scene,
   view = camera.camera.get_view_matrix();
   proj = camera.camera.get_projection_matrix();
   view_proj = proj * view;
+  camera_frustum = Core::Frustum{ view_proj };
   camera_pos = camera.camera.get_position();
   light_colour_intensity = light_environment.colour_and_intensity;
   specular_colour_intensity = light_environment.specular_colour_and_intensity;
@@ -336,8 +440,12 @@ Renderer::begin_scene(Core::Scene& scene,
   light_dir = glm::normalize(-light_environment.sun_position);
   shadow_ubo.update();
 
-  update_lights(point_light_ubo, light_environment.point_lights);
-  update_lights(spot_light_ubo, light_environment.spot_lights);
+  update_lights(point_light_ubo,
+                light_environment.point_lights,
+                light_environment.dirty_point_lights);
+  update_lights(spot_light_ubo,
+                light_environment.spot_lights,
+                light_environment.dirty_spot_lights);
 
   // Visible spot lights
   auto& screen_data = screen_data_ubo.get_data();
@@ -376,6 +484,7 @@ Renderer::compute_directional_shadow_projections(
   for (auto i = 0ULL; i < 10; i++) {
     cascade_splits[static_cast<Core::i32>(i)] = cascades[i].split_depth;
     view_projections[i] = cascades[i].view_projection;
+    cascade_frustums.at(i) = Core::Frustum{ cascades[i].view_projection };
   }
   directional_shadow_projections_ubo.update();
 }
@@ -384,97 +493,224 @@ auto
 Renderer::submit_static_mesh(Core::Ref<StaticMesh>& static_mesh,
                              const glm::mat4& transform) -> void
 {
-  const auto& source = static_mesh->get_mesh_asset();
-  const auto& submesh_data = source->get_submeshes();
-  for (const auto submesh_index : static_mesh->get_submeshes()) {
-    glm::mat4 submesh_transform =
-      transform * submesh_data[submesh_index].transform;
+  submit_static_meshes(static_mesh, std::span{ &transform, 1 });
+}
+
+auto
+Renderer::submit_static_meshes(Core::Ref<StaticMesh>& static_mesh,
+                               std::span<const glm::mat4> transforms) -> void
+{
+  submitted_meshes.push_back(SubmittedMesh{
+    .static_mesh = static_mesh.get(),
+    .first_transform = static_cast<Core::u32>(submitted_transforms.size()),
+    .instance_count = static_cast<Core::u32>(transforms.size()),
+  });
+  submitted_transforms.insert(
+    submitted_transforms.end(), transforms.begin(), transforms.end());
+}
+
+auto
+Renderer::submit_static_light(Core::Ref<StaticMesh>& static_mesh,
+                              const glm::mat4& transform,
+                              const glm::vec4& colour_times_intensity) -> void
+{
+  submit_static_lights(static_mesh,
+                       std::span{ &transform, 1 },
+                       std::span{ &colour_times_intensity, 1 });
+}
+
+auto
+Renderer::submit_static_lights(
+  Core::Ref<StaticMesh>& static_mesh,
+  std::span<const glm::mat4> transforms,
+  std::span<const glm::vec4> colours_times_intensity) -> void
+{
+  Core::ensure(transforms.size() == colours_times_intensity.size(),
+               "Every light instance needs a colour.");
+
+  submitted_meshes.push_back(SubmittedMesh{
+    .static_mesh = static_mesh.get(),
+    .first_transform = static_cast<Core::u32>(submitted_transforms.size()),
+    .instance_count = static_cast<Core::u32>(transforms.size()),
+    .first_light_colour = static_cast<Core::u32>(lights_instance_data.size()),
+  });
+  submitted_transforms.insert(
+    submitted_transforms.end(), transforms.begin(), transforms.end());
+  lights_instance_data.insert(lights_instance_data.end(),
+                              colours_times_intensity.begin(),
+                              colours_times_intensity.end());
+}
 
-    const auto& vertex_buffer = source->get_vertex_buffer();
-    const auto& index_buffer = source->get_index_buffer();
-    const auto& material =
-      source->get_materials().at(submesh_data[submesh_index].material_index);
+namespace {
+// Same slot as the draw list bucket the calling thread submits to.
+auto
+current_thread_slot() -> Core::usize
+{
+  const auto thread_index = BS::this_thread::get_index();
+  return thread_index ? *thread_index + 1 : 0;
+}
 
-    CommandKey key{
-      &vertex_buffer, &index_buffer, material.get(), submesh_index
-    };
-    auto& mesh_transform = mesh_transform_map[key].transforms.emplace_back();
-    mesh_transform.transform_rows[0] = {
-      submesh_transform[0][0],
-      submesh_transform[1][0],
-      submesh_transform[2][0],
-      submesh_transform[3][0],
-    };
-    mesh_transform.transform_rows[1] = {
-      submesh_transform[0][1],
-      submesh_transform[1][1],
-      submesh_transform[2][1],
-      submesh_transform[3][1],
-    };
-    mesh_transform.transform_rows[2] = {
-      submesh_transform[0][2],
-      submesh_transform[1][2],
-      submesh_transform[2][2],
-      submesh_transform[3][2],
-    };
+// The packed rows are the top three rows of the world matrix, so the world
+// AABB is the transformed centre plus the extents through |rotation-scale|.
+auto
+world_bounds(const Core::AABB& local, const TransformVertexData& transform)
+  -> Core::AABB
+{
+  const auto centre = (local.min + local.max) * 0.5F;
+  const auto extents = (local.max - local.min) * 0.5F;
+  glm::vec3 world_centre{ 0.0F };
+  glm::vec3 world_extents{ 0.0F };
+  for (auto row = 0; row < 3; row++) {
+    const auto& values = transform.transform_rows[row];
+    world_centre[row] = values.x * centre.x + values.y * centre.y +
+                        values.z * centre.z + values.w;
+    world_extents[row] = std::abs(values.x) * extents.x +
+                         std::abs(values.y) * extents.y +
+                         std::abs(values.z) * extents.z;
+  }
+  return { world_centre - world_extents, world_centre + world_extents };
+}
+}
+
+auto
+Renderer::cull_submitted_meshes() -> void
+{
+  ASTUTE_PROFILE_FUNCTION();
+
+  // Large instance counts are split so one mesh still spreads over the pool.
+  static constexpr Core::u32 instances_per_job = 256;
+  culling_jobs.clear();
+  for (auto i = 0U; i < submitted_meshes.size(); i++) {
+    const auto& submitted = submitted_meshes[i];
+    if (technique == RendererTechnique::GPUDriven &&
+        !submitted.first_light_colour) {
+      submit_indirect(submitted);
+      continue;
+    }
+    for (const auto submesh_index : submitted.static_mesh->get_submeshes()) {
+      for (auto first = 0U; first < submitted.instance_count;
+           first += instances_per_job) {
+        culling_jobs.push_back(CullingJob{
+          .submitted_mesh = i,
+          .submesh_index = submesh_index,
+          .first_instance = first,
+          .instance_count =
+            std::min(instances_per_job, submitted.instance_count - first),
+        });
+      }
+    }
+  }
 
-    auto& command = draw_commands[key];
-    command.static_mesh = static_mesh;
-    command.submesh_index = submesh_index;
-    command.instance_count++;
-
-    if (true /*mesh->casts_shadows()*/) {
-      auto& shadow_command = shadow_draw_commands[key];
-      shadow_command.static_mesh = static_mesh;
-      shadow_command.submesh_index = submesh_index;
-      shadow_command.instance_count++;
-      // shadow_command.material = shadow_material.get();
+  std::ranges::fill(culling_thread_statistics, CullingStatistics{});
+  thread_pool
+    ->enqueue_loop_split(culling_jobs,
+                         [this](Core::usize job) { cull(culling_jobs[job]); })
+    .wait();
+
+  culling_statistics = {};
+  for (const auto& statistics : culling_thread_statistics) {
+    culling_statistics.tested += statistics.tested;
+    culling_statistics.visible += statistics.visible;
+    for (auto i = 0ULL; i < statistics.cascade_visible.size(); i++) {
+      culling_statistics.cascade_visible.at(i) +=
+        statistics.cascade_visible.at(i);
     }
   }
+
+  submitted_meshes.clear();
+  submitted_transforms.clear();
 }
 
 auto
-Renderer::submit_static_light(Core::Ref<StaticMesh>& static_mesh,
-                              const glm::mat4& transform,
-                              const glm::vec4& colour_times_intensity) -> void
+Renderer::submit_indirect(const SubmittedMesh& submitted) -> void
 {
-  const auto& source = static_mesh->get_mesh_asset();
-  const auto& submesh_data = source->get_submeshes();
-  for (const auto submesh_index : static_mesh->get_submeshes()) {
-    glm::mat4 submesh_transform =
-      transform * submesh_data[submesh_index].transform;
-
-    const auto& vertex_buffer = source->get_vertex_buffer();
-    const auto& index_buffer = source->get_index_buffer();
-    const auto& material =
-      source->get_materials().at(submesh_data[submesh_index].material_index);
-
-    CommandKey key{ &vertex_buffer, &index_buffer, material.get(), 0 };
-    auto& mesh_transform = mesh_transform_map[key].transforms.emplace_back();
-    mesh_transform.transform_rows[0] = {
-      submesh_transform[0][0],
-      submesh_transform[1][0],
-      submesh_transform[2][0],
-      submesh_transform[3][0],
-    };
-    mesh_transform.transform_rows[1] = {
-      submesh_transform[0][1],
-      submesh_transform[1][1],
-      submesh_transform[2][1],
-      submesh_transform[3][1],
-    };
-    mesh_transform.transform_rows[2] = {
-      submesh_transform[0][2],
-      submesh_transform[1][2],
-      submesh_transform[2][2],
-      submesh_transform[3][2],
+  const auto& source = submitted.static_mesh->get_mesh_asset();
+  // Runs before the culling jobs, so the main thread's scratch is free.
+  auto& packed = culling_scratch.front();
+  if (packed.size() < submitted.instance_count) {
+    packed.resize(submitted.instance_count);
+  }
+
+  const auto transforms = std::span{ submitted_transforms }.subspan(
+    submitted.first_transform, submitted.instance_count);
+  for (const auto submesh_index : submitted.static_mesh->get_submeshes()) {
+    const auto& submesh = source->get_submeshes()[submesh_index];
+    const CommandKey key{
+      &source->get_vertex_buffer(),
+      &source->get_index_buffer(),
+      source->get_materials().at(submesh.material_index).get(),
+      submesh_index,
     };
+    TransformPacker::pack(transforms, submesh.transform, packed);
+
+    VkDrawIndexedIndirectCommand command{};
+    command.indexCount = submesh.index_count;
+    command.firstIndex = submesh.base_index;
+    command.vertexOffset = static_cast<Core::i32>(submesh.base_vertex);
+    indirect_draws.submit(
+      key,
+      submitted.static_mesh,
+      submesh.bounding_box,
+      command,
+      std::span{ packed }.first(submitted.instance_count));
+  }
+}
+
+auto
+Renderer::cull(const CullingJob& job) -> void
+{
+  const auto& submitted = submitted_meshes[job.submitted_mesh];
+  const auto& source = submitted.static_mesh->get_mesh_asset();
+  const auto& submesh = source->get_submeshes()[job.submesh_index];
+  const CommandKey key{
+    &source->get_vertex_buffer(),
+    &source->get_index_buffer(),
+    source->get_materials().at(submesh.material_index).get(),
+    job.submesh_index,
+  };
+
+  const auto slot = current_thread_slot();
+  Core::ensure(slot < culling_scratch.size(),
+               "Culling ran on more threads than it has scratch space for.");
+  auto& packed = culling_scratch[slot];
+  if (packed.size() < job.instance_count) {
+    packed.resize(job.instance_count);
+  }
+  TransformPacker::pack(std::span{ submitted_transforms }.subspan(
+                          submitted.first_transform + job.first_instance,
+                          job.instance_count),
+                        submesh.transform,
+                        packed);
+
+  auto& statistics = culling_thread_statistics[slot];
+  for (auto i = 0U; i < job.instance_count; i++) {
+    const auto bounds = world_bounds(submesh.bounding_box, packed[i]);
+    const auto instance = std::span{ &packed[i], 1 };
+    statistics.tested++;
+
+    if (camera_frustum.intersects(bounds)) {
+      statistics.visible++;
+      if (submitted.first_light_colour) {
+        lights_draw_list.submit(key,
+                                submitted.static_mesh,
+                                instance,
+                                *submitted.first_light_colour +
+                                  job.first_instance + i);
+      } else {
+        draw_list.submit(key, submitted.static_mesh, instance);
+      }
+    }
 
-    auto& command = lights_draw_commands[key];
-    command.static_mesh = static_mesh;
-    command.submesh_index = submesh_index;
-    command.instance_count++;
-    lights_instance_data.emplace_back(colour_times_intensity);
+    if (submitted.first_light_colour) {
+      continue;
+    }
+    for (auto cascade = 0U; cascade < cascade_frustums.size(); cascade++) {
+      if (cascade_frustums.at(cascade).intersects(bounds)) {
+        statistics.cascade_visible.at(cascade)++;
+        shadow_draw_list.submit(
+          key, submitted.static_mesh, instance, 0, cascade);
+      }
+    }
   }
 }
 
@@ -493,65 +729,367 @@ Renderer::on_resize(const Core::Extent& new_size) -> void
 auto
 Renderer::flush_draw_lists() -> void
 {
-  Core::u32 offset = 0;
-  const auto& [vb, tb] =
-    transform_buffers.at(Core::Application::the().current_frame_index());
-
-  for (auto& transform_data : mesh_transform_map | std::views::values) {
-    transform_data.offset = offset * sizeof(TransformVertexData);
-    for (const auto& transform : transform_data.transforms) {
-      tb->write(&transform,
-                sizeof(TransformVertexData),
-                offset * sizeof(TransformVertexData));
-      offset++;
-    }
+  cull_submitted_meshes();
+  indirect_draws.build();
+
+  const auto frame = Core::Application::the().current_frame_index();
+  const auto geometry_count =
+    static_cast<Core::u32>(draw_list.get_submission_count());
+  const auto lights_count =
+    static_cast<Core::u32>(lights_draw_list.get_submission_count());
+  const auto shadow_count =
+    static_cast<Core::u32>(shadow_draw_list.get_submission_count());
+
+  // All lists write their sorted transforms straight into this frame's
+  // mapped region: geometry, then lights, then shadow casters.
+  auto transforms = transform_ring->begin_frame(
+    frame, geometry_count + lights_count + shadow_count);
+  draw_list.build(transforms.first(geometry_count), 0, thread_pool.get());
+  lights_draw_list.build(transforms.subspan(geometry_count, lights_count),
+                         geometry_count,
+                         thread_pool.get());
+  shadow_draw_list.build(transforms.subspan(geometry_count + lights_count),
+                         geometry_count + lights_count,
+                         thread_pool.get());
+  transform_ring->end_frame();
+
+  // The lights pass reads its colours per instance, so they have to follow
+  // the batch order of the transforms. Culled lights are dropped here.
+  lights_instance_scratch.resize(lights_draw_list.get_submission_count());
+  const auto light_order = lights_draw_list.get_user_data();
+  for (auto i = 0ULL; i < light_order.size(); i++) {
+    lights_instance_scratch[i] = lights_instance_data[light_order[i]];
+  }
+  std::swap(lights_instance_data, lights_instance_scratch);
+
+  auto& semaphores = frame_semaphores.at(frame);
+  while (semaphores.size() < schedule.get_semaphore_count()) {
+    VkSemaphoreCreateInfo semaphore_info{};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    VkSemaphore semaphore{ nullptr };
+    vkCreateSemaphore(
+      Device::the().device(), &semaphore_info, nullptr, &semaphore);
+    semaphores.push_back(semaphore);
   }
-  std::vector<TransformVertexData> output;
-  output.resize(offset);
 
-  tb->read(std::span{ output });
-  vb->write(std::span{ output });
+  // Every stage is its own submission. Nothing waits on the CPU: the next
+  // use of this frame in flight waits for them instead.
+  std::vector<CommandBuffer::SemaphoreWait> waits;
+  std::vector<VkSemaphore> signals;
+  const auto& stages = schedule.get_stages();
+  for (auto i = 0ULL; i < stages.size(); i++) {
+    const auto& stage = stages.at(i);
+    auto& [stage_command_buffer, stage_timer] = get_scheduled_stage(stage);
+
+    stage_command_buffer->begin();
+    if (i == 0) {
+      gpu_frame_timer->begin(*stage_command_buffer, frame);
+    }
+    stage_timer->begin(*stage_command_buffer, frame);
+
+    for (const auto& handoff : stage.acquires) {
+      record_ownership_transfer(*stage_command_buffer, handoff, false);
+    }
+    for (const auto& pass : stage.passes) {
+      execute_scheduled_pass(pass, *stage_command_buffer);
+    }
+    for (const auto& handoff : stage.releases) {
+      record_ownership_transfer(*stage_command_buffer, handoff, true);
+    }
 
-  command_buffer->begin();
+    stage_timer->end(*stage_command_buffer);
+    if (i == stages.size() - 1) {
+      gpu_frame_timer->end(*stage_command_buffer);
+    }
+    stage_command_buffer->end();
 
-  // Shadow pass
-  render_passes.at("Shadow")->execute(*command_buffer);
-  // Predepth pass
-  render_passes.at("Predepth")->execute(*command_buffer);
-  {
-    compute_command_buffer->begin();
-    render_passes.at("LightCulling")->execute(*compute_command_buffer);
-    compute_command_buffer->end();
-    compute_command_buffer->submit();
+    waits.clear();
+    for (const auto& [semaphore, wait_stages] : stage.waits) {
+      waits.push_back({ semaphores.at(semaphore), wait_stages });
+    }
+    signals.clear();
+    for (const auto semaphore : stage.signals) {
+      signals.push_back(semaphores.at(semaphore));
+    }
+    stage_command_buffer->submit_pipelined({
+      .waits = waits,
+      .signals = signals,
+    });
   }
-  if (technique == RendererTechnique::Deferred) {
-    // Geometry pass
-    render_passes.at("MainGeometry")->execute(*command_buffer);
-    // Deferred
-    render_passes.at("Deferred")->execute(*command_buffer);
 
-    render_passes.at("Lights")->execute(*command_buffer);
-  } else if (technique == RendererTechnique::ForwardPlus) {
-    render_passes.at("ForwardPlusGeometry")->execute(*command_buffer);
-    render_passes.at("Composite")->execute(*command_buffer);
+  draw_list.clear();
+  lights_draw_list.clear();
+  shadow_draw_list.clear();
+  indirect_draws.clear();
+  lights_instance_data.clear();
+}
+
+auto
+Renderer::get_gpu_frame_time() const -> Core::f64
+{
+  return gpu_frame_timer->get_time();
+}
+
+auto
+Renderer::get_gpu_queue_time(QueueType queue) const -> Core::f64
+{
+  Core::f64 time = 0.0;
+  for (const auto& stage : schedule.get_stages()) {
+    if (stage.queue != queue || !scheduled_stages.contains(stage.name)) {
+      continue;
+    }
+    time += scheduled_stages.at(stage.name).timer->get_time();
   }
+  return time;
+}
+
+auto
+Renderer::build_schedule() -> void
+{
+  render_graph.clear();
 
+  std::vector<std::string> passes;
+  if (technique == RendererTechnique::GPUDriven) {
+    passes.emplace_back("InstanceCulling");
+  }
+  passes.insert(passes.end(), { "Predepth", "LightCulling", "Shadow" });
+  if (technique == RendererTechnique::ForwardPlus) {
+    passes.insert(passes.end(), { "ForwardPlusGeometry", "Composite" });
+  } else {
+    passes.insert(passes.end(), { "MainGeometry", "Deferred", "Lights" });
+  }
   for (const auto& step : post_processing_steps) {
-    if (!render_passes.contains(step.name)) {
+    passes.push_back(step.name);
+  }
+  for (const auto& name : passes) {
+    render_passes.at(name)->declare(render_graph, name);
+  }
+
+  const auto output = render_graph.find_resource(
+    post_processing_steps.empty() ? "Deferred.Colour" : "Composition.Colour");
+  Core::ensure(output.has_value(), "The render graph has no output");
+  render_graph.set_output(*output);
+  render_graph.compile();
+
+  schedule.clear();
+  render_graph.build_schedule(schedule);
+  place_transient_images();
+  schedule_dirty = false;
+
+  const auto& statistics = render_graph.get_statistics();
+  info("Render graph: {} passes ({} culled), {} hazards, {} covered by the "
+       "passes, {} between queues, {} barriers. Transients take {} bytes, "
+       "{} aliased.",
+       statistics.passes,
+       statistics.culled,
+       statistics.hazards,
+       statistics.covered,
+       statistics.cross_queue,
+       statistics.barriers,
+       statistics.transient_bytes,
+       statistics.aliased_bytes);
+}
+
+auto
+Renderer::place_transient_images() -> void
+{
+  const auto& resources = render_graph.get_resources();
+  std::vector<std::pair<Image*, VkDeviceSize>> placements;
+  Core::u32 memory_types = ~0U;
+  for (const auto& [resource, offset] : render_graph.get_placements()) {
+    auto* image = resources.at(resource).image;
+    placements.emplace_back(image, offset);
+    memory_types &= image->get_memory_requirements().memoryTypeBits;
+  }
+  if (memory_types == 0) {
+    warn("The transient images share no memory type, so none are aliased.");
+    placements.clear();
+  }
+  if (placements == placed_images) {
+    return;
+  }
+
+  Device::the().wait();
+  Core::Scope<TransientImageMemory> memory{ nullptr };
+  if (!placements.empty()) {
+    memory = Core::make_scope<TransientImageMemory>(
+      render_graph.get_transient_size(), memory_types);
+  }
+
+  // Moved images are made again, and so are the framebuffers they are
+  // attached to.
+  std::unordered_set<const Image*> moved;
+  for (const auto& [image, offset] : placed_images) {
+    image->place_in(nullptr, 0);
+    moved.insert(image);
+  }
+  for (const auto& [image, offset] : placements) {
+    image->place_in(memory.get(), offset);
+    moved.insert(image);
+  }
+  for (const auto& [name, render_pass] : render_passes) {
+    const auto& framebuffer = render_pass->get_framebuffer();
+    if (framebuffer == nullptr) {
       continue;
     }
-    const auto& render_pass = render_passes.at(step.name);
-    render_pass->execute(*command_buffer);
+    for (auto i = 0U; i < framebuffer->get_colour_attachment_count(); i++) {
+      if (moved.contains(framebuffer->get_colour_attachment(i).get())) {
+        framebuffer->on_resize(size);
+        break;
+      }
+    }
   }
 
-  command_buffer->end();
-  command_buffer->submit();
+  // Nothing is left in the old block.
+  transient_memory = std::move(memory);
+  placed_images = std::move(placements);
+}
 
-  draw_commands.clear();
-  shadow_draw_commands.clear();
-  lights_draw_commands.clear();
-  mesh_transform_map.clear();
-  lights_instance_data.clear();
+auto
+Renderer::recreate_stale_pipelines() -> void
+{
+  std::vector<IPipeline*> pipelines;
+  for (const auto& [name, render_pass] : render_passes) {
+    render_pass->collect_pipelines(pipelines);
+  }
+  std::erase_if(pipelines, [](const IPipeline* pipeline) {
+    return !pipeline->needs_recreation();
+  });
+  if (pipelines.empty()) {
+    return;
+  }
+
+  thread_pool
+    ->enqueue_loop_split(pipelines,
+                         [&pipelines](Core::usize index) {
+                           pipelines[index]->recreate();
+                         })
+    .wait();
+  info("Recreated {} pipelines", pipelines.size());
+}
+
+auto
+Renderer::release_transient_images() -> void
+{
+  for (const auto& [image, offset] : placed_images) {
+    image->place_in(nullptr, 0);
+  }
+  placed_images.clear();
+}
+
+auto
+Renderer::get_scheduled_stage(const QueueSchedule::Stage& stage)
+  -> ScheduledStage&
+{
+  auto& scheduled = scheduled_stages[stage.name];
+  if (scheduled.command_buffer == nullptr) {
+    scheduled.command_buffer =
+      Core::make_scope<CommandBuffer>(CommandBuffer::Properties{
+        .queue_type = stage.queue,
+        .primary = true,
+      });
+    scheduled.timer = Core::make_scope<GPUFrameTimer>(
+      Core::Application::the().get_image_count());
+  }
+  return scheduled;
+}
+
+auto
+Renderer::execute_scheduled_pass(const std::string& name,
+                                 CommandBuffer& stage_command_buffer) -> void
+{
+  const auto& passes = render_graph.get_passes();
+  const auto pass = std::ranges::find(passes, name, &RenderGraph::Pass::name);
+  if (pass != passes.end()) {
+    const auto index =
+      static_cast<RenderGraph::PassIndex>(pass - passes.begin());
+    record_barrier(stage_command_buffer, render_graph.get_barrier(index));
+  }
+
+  render_passes.at(name)->execute(stage_command_buffer);
+  if (name != "InstanceCulling") {
+    return;
+  }
+
+  // Counted on the GPU, frames in flight ago.
+  const auto& visible = get_instance_culling().get_visible_instances();
+  culling_statistics.tested += indirect_draws.get_instance_count();
+  culling_statistics.visible += visible.front();
+  for (auto i = 0ULL; i < culling_statistics.cascade_visible.size(); i++) {
+    culling_statistics.cascade_visible.at(i) += visible.at(i + 1);
+  }
+}
+
+auto
+Renderer::record_barrier(const CommandBuffer& stage_command_buffer,
+                         const RenderGraph::Barrier& barrier) const -> void
+{
+  if (barrier.empty()) {
+    return;
+  }
+
+  VkMemoryBarrier memory_barrier{};
+  memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  memory_barrier.srcAccessMask = barrier.src_access;
+  memory_barrier.dstAccessMask = barrier.dst_access;
+  vkCmdPipelineBarrier(stage_command_buffer.get_command_buffer(),
+                       barrier.src_stages,
+                       barrier.dst_stages,
+                       0,
+                       1,
+                       &memory_barrier,
+                       0,
+                       nullptr,
+                       0,
+                       nullptr);
+}
+
+auto
+Renderer::record_ownership_transfer(const CommandBuffer& stage_command_buffer,
+                                    const QueueSchedule::Handoff& handoff,
+                                    bool release) const -> void
+{
+  // One queue family owns everything, nothing to transfer.
+  if (!Device::the().has_async_compute()) {
+    return;
+  }
+
+  // Handoffs are of the graph's images.
+  const auto& resource = render_graph.get_resources().at(handoff.resource);
+  const auto* image = resource.image;
+  const auto layout = resource.layout;
+
+  const auto& stages = schedule.get_stages();
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcAccessMask = release ? VK_ACCESS_MEMORY_WRITE_BIT : 0;
+  barrier.dstAccessMask =
+    release ? 0 : VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+  barrier.oldLayout = layout;
+  barrier.newLayout = layout;
+  barrier.srcQueueFamilyIndex =
+    Device::the().get_family(stages.at(handoff.from).queue);
+  barrier.dstQueueFamilyIndex =
+    Device::the().get_family(stages.at(handoff.to).queue);
+  barrier.image = image->image;
+  barrier.subresourceRange = {
+    image->get_aspect_flags(), 0, VK_REMAINING_MIP_LEVELS,
+    0,                         VK_REMAINING_ARRAY_LAYERS,
+  };
+
+  // The acquire starts at the stages the semaphore wait blocks, so the two
+  // form a chain.
+  vkCmdPipelineBarrier(stage_command_buffer.get_command_buffer(),
+                       release ? handoff.src_stages : handoff.dst_stages,
+                       release ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+                               : handoff.dst_stages,
+                       0,
+                       0,
+                       nullptr,
+                       0,
+                       nullptr,
+                       1,
+                       &barrier);
 }
 
 auto
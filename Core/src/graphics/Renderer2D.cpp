@@ -3,6 +3,8 @@
 #include "graphics/Renderer.hpp"
 #include "graphics/Renderer2D.hpp"
 
+#include "core/Application.hpp"
+
 #include <ranges>
 #include <span>
 
@@ -17,8 +19,11 @@ Renderer2D::Renderer2D(Renderer& ren, Core::u32 object_count)
     indices.at(i) = i;
   }
 
-  line_vertices = Core::make_scope<VertexBuffer>(std::span(vertices));
-  line_indices = Core::make_scope<IndexBuffer>(std::span(indices));
+  for (auto i = 0U; i < Core::Application::the().get_image_count(); i++) {
+    line_vertices.push_back(
+      Core::make_scope<VertexBuffer>(std::span(vertices)));
+    line_indices.push_back(Core::make_scope<IndexBuffer>(std::span(indices)));
+  }
   line_shader = Shader::compile_graphics_scoped("Assets/shaders/line.vert",
                                                 "Assets/shaders/line.frag");
   line_material = Core::make_scope<Material>(Material::Configuration{
@@ -133,22 +138,25 @@ Renderer2D::flush(CommandBuffer& buffer) -> void
 {
   ASTUTE_PROFILE_FUNCTION();
   // Lets assume main geometry is started
+  const auto frame = Core::Application::the().current_frame_index();
+  auto& frame_vertices = line_vertices.at(frame);
+  auto& frame_indices = line_indices.at(frame);
   const auto span = std::span(vertices);
-  if (span.size_bytes() >= line_vertices->size()) {
-    line_vertices = Core::make_scope<VertexBuffer>(span);
+  if (span.size_bytes() >= frame_vertices->size()) {
+    frame_vertices = Core::make_scope<VertexBuffer>(span);
 
     std::vector<Core::u32> new_indices;
     new_indices.resize(submitted_line_indices);
     for (const auto i : std::views::iota(0U, submitted_line_indices)) {
       new_indices.at(i) = i;
     }
-    line_indices = Core::make_scope<IndexBuffer>(std::span(new_indices));
+    frame_indices = Core::make_scope<IndexBuffer>(std::span(new_indices));
   }
 
-  line_vertices->write(vertices.data(), submitted_line_indices);
+  frame_vertices->write(vertices.data(), submitted_line_indices);
 
   static constexpr auto offsets = std::array<VkDeviceSize, 1>{ 0 };
-  std::array buffers{ line_vertices->get_buffer() };
+  std::array buffers{ frame_vertices->get_buffer() };
   vkCmdBindVertexBuffers(
     buffer.get_command_buffer(), 0, 1, buffers.data(), offsets.data());
 
@@ -166,7 +174,7 @@ Renderer2D::flush(CommandBuffer& buffer) -> void
                           nullptr);
 
   vkCmdBindIndexBuffer(buffer.get_command_buffer(),
-                       line_indices->get_buffer(),
+                       frame_indices->get_buffer(),
                        0,
                        VK_INDEX_TYPE_UINT32);
 
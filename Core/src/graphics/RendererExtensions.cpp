@@ -38,6 +38,14 @@ begin_renderpass(const CommandBuffer& command_buffer,
     return;
   }
 
+  set_viewport_and_scissor(command_buffer, framebuffer, flip);
+}
+
+auto
+set_viewport_and_scissor(const CommandBuffer& command_buffer,
+                         const IFramebuffer& framebuffer,
+                         const bool flip) -> void
+{
   // Scissors and viewport
   auto&& [width, height] = framebuffer.get_extent();
 
@@ -0,0 +1,146 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/SecondaryCommandRecorder.hpp"
+
+#include "graphics/CommandBuffer.hpp"
+#include "graphics/IFramebuffer.hpp"
+#include "graphics/RendererExtensions.hpp"
+#include "thread_pool/ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace Engine::Graphics {
+
+SecondaryCommandRecorder::SecondaryCommandRecorder(
+  ED::ThreadPool& pool,
+  std::optional<Core::u32> slot_image_count)
+  : thread_pool(pool)
+  , image_count(slot_image_count)
+  , max_chunks(std::max(pool.get_thread_count(), 1U))
+{
+}
+
+SecondaryCommandRecorder::~SecondaryCommandRecorder()
+{
+  // Workers still recording would write into the slots.
+  for (auto& recording : recordings) {
+    for (auto& pending : recording.pending) {
+      if (pending.valid()) {
+        pending.wait();
+      }
+    }
+  }
+}
+
+auto
+SecondaryCommandRecorder::split(Core::usize draw_count, Core::u32 max_chunks)
+  -> std::vector<DrawChunk>
+{
+  if (draw_count == 0) {
+    return {};
+  }
+
+  const auto chunk_count =
+    std::clamp<Core::usize>(draw_count / minimum_chunk_size, 1, max_chunks);
+  std::vector<DrawChunk> chunks(chunk_count);
+  // The first `remainder` chunks take one draw more.
+  const auto base_size = draw_count / chunk_count;
+  const auto remainder = draw_count % chunk_count;
+  Core::usize begin = 0;
+  for (Core::usize i = 0; i < chunk_count; i++) {
+    const auto size = base_size + (i < remainder ? 1 : 0);
+    chunks[i] = { .begin = begin, .end = begin + size };
+    begin += size;
+  }
+  return chunks;
+}
+
+auto
+SecondaryCommandRecorder::reset() -> void
+{
+  for (auto& recording : recordings) {
+    for (auto& pending : recording.pending) {
+      if (pending.valid()) {
+        pending.get();
+      }
+    }
+  }
+  recordings.clear();
+  next_slot = 0;
+}
+
+auto
+SecondaryCommandRecorder::acquire_slot() -> CommandBuffer&
+{
+  if (next_slot == slots.size()) {
+    slots.push_back(Core::make_scope<CommandBuffer>(CommandBuffer::Properties{
+      .queue_type = QueueType::Graphics,
+      .primary = false,
+      .image_count = image_count,
+    }));
+  }
+  return *slots[next_slot++];
+}
+
+auto
+SecondaryCommandRecorder::record(const IFramebuffer& framebuffer,
+                                 Core::usize draw_count,
+                                 RecordFunction record,
+                                 bool flip) -> Core::u32
+{
+  auto& recording = recordings.emplace_back();
+  recording.record = std::move(record);
+
+  for (const auto& chunk : split(draw_count, max_chunks)) {
+    auto& buffer = acquire_slot();
+    recording.buffers.push_back(&buffer);
+    const auto record_chunk = [&recording, &buffer, &framebuffer, chunk, flip] {
+      VkCommandBufferInheritanceInfo inheritance_info{};
+      inheritance_info.sType =
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+      inheritance_info.renderPass = framebuffer.get_renderpass();
+      inheritance_info.subpass = 0;
+      inheritance_info.framebuffer = framebuffer.get_framebuffer();
+
+      VkCommandBufferBeginInfo begin_info{};
+      begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+      begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                         VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+      begin_info.pInheritanceInfo = &inheritance_info;
+
+      buffer.begin(&begin_info);
+      RendererExtensions::set_viewport_and_scissor(buffer, framebuffer, flip);
+      recording.record(buffer, chunk);
+      buffer.end();
+    };
+    recording.pending.push_back(thread_pool.enqueue_task(record_chunk));
+  }
+
+  return static_cast<Core::u32>(recordings.size() - 1);
+}
+
+auto
+SecondaryCommandRecorder::execute(CommandBuffer& primary, Core::u32 index)
+  -> void
+{
+  auto& recording = recordings.at(index);
+  for (auto& pending : recording.pending) {
+    // Rethrows whatever a worker threw while recording.
+    pending.get();
+  }
+  recording.pending.clear();
+  if (recording.buffers.empty()) {
+    return;
+  }
+
+  std::vector<VkCommandBuffer> secondary_buffers;
+  secondary_buffers.reserve(recording.buffers.size());
+  for (const auto* buffer : recording.buffers) {
+    secondary_buffers.push_back(buffer->get_command_buffer());
+  }
+  vkCmdExecuteCommands(primary.get_command_buffer(),
+                       static_cast<Core::u32>(secondary_buffers.size()),
+                       secondary_buffers.data());
+}
+
+} // namespace Engine::Graphics
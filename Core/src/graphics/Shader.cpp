@@ -3,61 +3,23 @@
 #include "graphics/Shader.hpp"
 
 #include "core/Exceptions.hpp"
+#include "core/Hash.hpp"
 #include "core/Verify.hpp"
 #include "graphics/DescriptorResource.hpp"
+#include "graphics/DescriptorSetLayoutCache.hpp"
 #include "graphics/Device.hpp"
 #include "logging/Logger.hpp"
 
 #include <bit>
-#include <execution>
 #include <fstream>
 #include <sstream>
 #include <vulkan/vulkan.h>
 
 #include "compilation/ShaderCompiler.hpp"
 #include "reflection/ReflectionData.hpp"
+#include "reflection/ReflectionSerialisation.hpp"
 #include "reflection/Reflector.hpp"
 
-namespace std {
-template<std::integral T>
-struct hash<vector<T>>
-{
-  const size_t chunk_size = 10;
-
-  size_t operator()(const vector<T>& v) const
-  {
-
-    vector<size_t> chunk_hashes((v.size() + chunk_size - 1) / chunk_size, 0);
-
-    // Hash each chunk in parallel.
-    std::for_each(std::execution::par,
-                  chunk_hashes.begin(),
-                  chunk_hashes.end(),
-                  [&](size_t& chunk_hash) {
-                    const size_t chunk_index = &chunk_hash - &chunk_hashes[0];
-                    const size_t start_index = chunk_index * chunk_size;
-                    const size_t end_index =
-                      std::min(start_index + chunk_size, v.size());
-
-                    for (size_t i = start_index; i < end_index; ++i) {
-                      // Simple hash combination within each chunk.
-                      chunk_hash ^= std::hash<T>{}(v[i]) + 0x9e3779b9 +
-                                    (chunk_hash << 6) + (chunk_hash >> 2);
-                    }
-                  });
-
-    // Combine chunk hashes in a final step.
-    return std::accumulate(chunk_hashes.begin(),
-                           chunk_hashes.end(),
-                           size_t(0),
-                           [](size_t acc, size_t h) {
-                             return acc ^=
-                                    h + 0x9e3779b9 + (acc << 6) + (acc >> 2);
-                           });
-  }
-};
-} // namespace std
-
 namespace Engine::Graphics {
 
 auto
@@ -82,6 +44,28 @@ read_file(const std::filesystem::path& path) -> std::string
   return buffer.str();
 }
 
+namespace {
+// Only the stage bytes count, never the name or the address, so equal SPIR-V
+// gives equal shaders.
+template<class Stages>
+auto
+hash_stages(const Stages& stages) -> Core::u64
+{
+  Core::u64 value = 0;
+  for (const auto type : {
+         Shader::Type::Compute,
+         Shader::Type::Vertex,
+         Shader::Type::Fragment,
+       }) {
+    if (const auto it = stages.find(type); it != stages.end()) {
+      value = Core::hash_bytes(std::as_bytes(std::span{ it->second }),
+                               Core::hash_values(value, type));
+    }
+  }
+  return value;
+}
+} // namespace
+
 Shader::Shader(std::unordered_map<Type, std::vector<Core::u32>> spirv_stages,
                std::string_view input_name)
 {
@@ -99,29 +83,39 @@ Shader::Shader(std::unordered_map<Type, std::vector<Core::u32>> spirv_stages,
   std::stringstream name_stream;
   name_stream << input_name;
   name = name_stream.str();
-  const Reflection::Reflector reflector{ *this };
-  reflector.reflect(descriptor_set_layouts, reflection_data);
-  create_descriptor_set_layouts();
 
-  static constexpr std::hash<std::string> string_hasher;
-  static constexpr std::hash<std::vector<Core::u32>> vector_hasher{
-    .chunk_size = 16,
-  };
-  auto name_hash = string_hasher(name);
-  if (parsed_spirv_per_stage_u32.contains(Type::Compute)) {
-    name_hash ^= vector_hasher(parsed_spirv_per_stage_u32.at(Type::Compute));
-  }
-  if (parsed_spirv_per_stage_u32.contains(Type::Vertex)) {
-    name_hash ^= vector_hasher(parsed_spirv_per_stage_u32.at(Type::Vertex));
-  }
-  if (parsed_spirv_per_stage_u32.contains(Type::Fragment)) {
-    name_hash ^= vector_hasher(parsed_spirv_per_stage_u32.at(Type::Fragment));
+  // Reflection is a pure function of the SPIR-V, so with a cache directory it
+  // is read back instead of running SPIRV-Cross again.
+  auto* cache = compiler ? compiler->get_spirv_cache() : nullptr;
+  std::optional<Core::u64> reflection_key{};
+  std::optional<Reflection::ReflectionData> cached_reflection{};
+  if (cache != nullptr) {
+    std::vector<std::span<const Core::u32>> stages;
+    for (const auto type : { Type::Compute, Type::Vertex, Type::Fragment }) {
+      if (parsed_spirv_per_stage_u32.contains(type)) {
+        stages.emplace_back(parsed_spirv_per_stage_u32.at(type));
+      }
+    }
+    reflection_key = Compilation::SpirvCache::make_reflection_key(stages);
+    if (auto blob = cache->load_reflection(*reflection_key)) {
+      cached_reflection = Reflection::deserialise(*blob);
+    }
   }
 
-  name_hash ^=
-    string_hasher(std::bit_cast<const char*>(std::bit_cast<const void*>(this)));
+  if (cached_reflection.has_value()) {
+    reflection_data = std::move(*cached_reflection);
+  } else {
+    const Reflection::Reflector reflector{ parsed_spirv_per_stage_u32 };
+    reflector.reflect(descriptor_set_layouts, reflection_data);
+    if (reflection_key.has_value() &&
+        !cache->store_reflection(*reflection_key,
+                                 Reflection::serialise(reflection_data))) {
+      warn("Could not write cached reflection data for shader '{}'", name);
+    }
+  }
+  create_descriptor_set_layouts();
 
-  hash_value = name_hash;
+  hash_value = hash_stages(parsed_spirv_per_stage_u32);
 }
 
 Shader::Shader(
@@ -153,19 +147,7 @@ Shader::Shader(
   reflector.reflect(descriptor_set_layouts, reflection_data);
   create_descriptor_set_layouts();
 
-  static constexpr std::hash<std::string> string_hasher;
-  auto name_hash = string_hasher(name);
-  if (parsed_spirv_per_stage.contains(Type::Compute)) {
-    name_hash ^= string_hasher(parsed_spirv_per_stage.at(Type::Compute));
-  }
-  if (parsed_spirv_per_stage.contains(Type::Vertex)) {
-    name_hash ^= string_hasher(parsed_spirv_per_stage.at(Type::Vertex));
-  }
-  if (parsed_spirv_per_stage.contains(Type::Fragment)) {
-    name_hash ^= string_hasher(parsed_spirv_per_stage.at(Type::Fragment));
-  }
-
-  hash_value = name_hash;
+  hash_value = hash_stages(parsed_spirv_per_stage);
 }
 
 Shader::~Shader()
@@ -174,7 +156,7 @@ Shader::~Shader()
     vkDestroyShaderModule(Device::the().device(), shader_module, nullptr);
   }
   for (const auto& layout : descriptor_set_layouts) {
-    vkDestroyDescriptorSetLayout(Device::the().device(), layout, nullptr);
+    DescriptorSetLayoutCache::the().release(layout);
   }
   trace("Destroyed shader '{}'", name);
 }
@@ -243,7 +225,6 @@ Shader::allocate_descriptor_set(Core::u32 set) const
 auto
 Shader::create_descriptor_set_layouts() -> void
 {
-  auto* vk_device = Device::the().device();
   auto& descriptor_sets = reflection_data.shader_descriptor_sets;
 
   for (Core::u32 set = 0; set < descriptor_sets.size(); set++) {
@@ -403,14 +384,6 @@ Shader::create_descriptor_set_layouts() -> void
     std::ranges::sort(layout_bindings,
                       [](auto& a, auto& b) { return a.binding < b.binding; });
 
-    VkDescriptorSetLayoutCreateInfo descriptor_layout = {};
-    descriptor_layout.sType =
-      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    descriptor_layout.pNext = nullptr;
-    descriptor_layout.bindingCount =
-      static_cast<Core::u32>(layout_bindings.size());
-    descriptor_layout.pBindings = layout_bindings.data();
-
     trace("Shader {0}: Creating descriptor set ['{1}'] with {2} ubo's, {3} "
           "ssbo's, "
           "{4} samplers, {5} separate textures, {6} separate samplers and {7} "
@@ -426,9 +399,8 @@ Shader::create_descriptor_set_layouts() -> void
     if (set >= descriptor_set_layouts.size()) {
       descriptor_set_layouts.resize(static_cast<std::size_t>(set) + 1);
     }
-    auto& current_layout_per_set = descriptor_set_layouts[set];
-    VK_CHECK(vkCreateDescriptorSetLayout(
-      vk_device, &descriptor_layout, nullptr, &current_layout_per_set));
+    descriptor_set_layouts[set] =
+      DescriptorSetLayoutCache::the().acquire(layout_bindings);
   }
 }
 
@@ -475,11 +447,11 @@ Shader::compile_graphics(const std::filesystem::path& vertex_path,
 }
 
 auto
-Shader::compile_compute(const std::filesystem::path& compute_path)
-  -> Core::Ref<Shader>
+Shader::compile_compute(const std::filesystem::path& compute_path,
+                        bool force_recompile) -> Core::Ref<Shader>
 {
   Core::ensure(compiler != nullptr, "ShaderCompiler is not initialized!");
-  return compiler->compile_compute(compute_path);
+  return compiler->compile_compute(compute_path, force_recompile);
 }
 
 auto
@@ -493,11 +465,38 @@ Shader::compile_graphics_scoped(const std::filesystem::path& vertex_path,
 }
 
 auto
-Shader::compile_compute_scoped(const std::filesystem::path& compute_path)
-  -> Core::Scope<Shader>
+Shader::compile_compute_scoped(const std::filesystem::path& compute_path,
+                               bool force_recompile) -> Core::Scope<Shader>
+{
+  Core::ensure(compiler != nullptr, "ShaderCompiler is not initialized!");
+  return compiler->compile_compute_scoped(compute_path, force_recompile);
+}
+
+auto
+Shader::precompile(std::span<const Compilation::ShaderCompileJob> jobs)
+  -> Core::usize
+{
+  const auto results = compile_stages(jobs);
+  return static_cast<Core::usize>(
+    std::ranges::count_if(results, [](const auto& spirv) {
+      return spirv.empty();
+    }));
+}
+
+auto
+Shader::compile_stages(std::span<const Compilation::ShaderCompileJob> jobs)
+  -> std::vector<std::vector<Core::u32>>
+{
+  Core::ensure(compiler != nullptr, "ShaderCompiler is not initialized!");
+  return compiler->compile_batch(jobs);
+}
+
+auto
+Shader::get_variant_keys(const std::filesystem::path& path)
+  -> std::vector<std::string>
 {
   Core::ensure(compiler != nullptr, "ShaderCompiler is not initialized!");
-  return compiler->compile_compute_scoped(compute_path);
+  return compiler->get_variant_keys(path);
 }
 
 auto
@@ -0,0 +1,134 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/ShaderPermutations.hpp"
+
+#include "core/Hash.hpp"
+#include "core/Verify.hpp"
+#include "graphics/Shader.hpp"
+#include "logging/Logger.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Engine::Graphics {
+
+namespace {
+auto
+make_macros(std::span<const std::string> stage_keys,
+            std::span<const std::string> enabled_keys)
+  -> std::unordered_map<std::string, std::string>
+{
+  std::unordered_map<std::string, std::string> macros;
+  for (const auto& key : stage_keys) {
+    macros[key] = std::ranges::binary_search(enabled_keys, key) ? "1" : "0";
+  }
+  return macros;
+}
+} // namespace
+
+ShaderPermutations::ShaderPermutations(Configuration conf)
+  : configuration(std::move(conf))
+  , vertex_keys(Shader::get_variant_keys(configuration.vertex_path))
+  , fragment_keys(Shader::get_variant_keys(configuration.fragment_path))
+{
+  std::ranges::set_union(vertex_keys, fragment_keys, std::back_inserter(keys));
+  Core::ensure(keys.size() <= 64,
+               "A shader can declare at most 64 variant keys.");
+}
+
+ShaderPermutations::~ShaderPermutations()
+{
+  if (variants.empty()) {
+    return;
+  }
+  const auto report = get_report();
+  info("Shader '{}': {} keys, {} variants, {} unique shaders, compiled in "
+       "{:.2f}ms",
+       configuration.fragment_path.filename().string(),
+       report.key_count,
+       report.variant_count,
+       report.unique_shader_count,
+       report.compile_ms);
+}
+
+auto
+ShaderPermutations::get(std::span<const std::string> enabled_keys)
+  -> const Shader*
+{
+  // Only declared keys count, so materials may enable keys that a given
+  // shader does not know about.
+  Core::u64 mask = 0;
+  std::vector<std::string> enabled;
+  for (Core::usize i = 0; i < keys.size(); i++) {
+    if (std::ranges::find(enabled_keys, keys[i]) != enabled_keys.end()) {
+      mask |= Core::u64{ 1 } << i;
+      enabled.push_back(keys[i]);
+    }
+  }
+  if (auto it = variants.find(mask); it != variants.end()) {
+    return it->second;
+  }
+
+  const auto start = std::chrono::high_resolution_clock::now();
+  const std::array jobs{
+    Compilation::ShaderCompileJob{
+      .path = configuration.vertex_path,
+      .stage = Compilation::ShaderStage::Vertex,
+      .macro_definitions = make_macros(vertex_keys, enabled),
+    },
+    Compilation::ShaderCompileJob{
+      .path = configuration.fragment_path,
+      .stage = Compilation::ShaderStage::Fragment,
+      .macro_definitions = make_macros(fragment_keys, enabled),
+    },
+  };
+  auto results = Shader::compile_stages(jobs);
+  auto& vertex_spirv = results.at(0);
+  auto& fragment_spirv = results.at(1);
+  if (vertex_spirv.empty() || fragment_spirv.empty()) {
+    error("Could not compile variant {:#x} of '{}'",
+          mask,
+          configuration.fragment_path.string());
+    variants[mask] = nullptr;
+    return nullptr;
+  }
+
+  const auto vertex_hash =
+    Core::hash_bytes(std::span<const Core::u32>{ vertex_spirv });
+  const auto combined_hash = Core::hash_bytes(
+    std::span<const Core::u32>{ fragment_spirv }, vertex_hash);
+  auto& shader = shaders[combined_hash];
+  if (!shader) {
+    auto name =
+      configuration.vertex_path.filename().replace_extension().string() + "_" +
+      configuration.fragment_path.filename().replace_extension().string();
+    for (const auto& key : enabled) {
+      name += "_" + key;
+    }
+    shader = Core::make_scope<Shader>(
+      std::unordered_map<Shader::Type, std::vector<Core::u32>>{
+        { Shader::Type::Vertex, std::move(vertex_spirv) },
+        { Shader::Type::Fragment, std::move(fragment_spirv) },
+      },
+      name);
+  }
+  variants[mask] = shader.get();
+
+  compile_ms += std::chrono::duration<Core::f64, std::milli>(
+                  std::chrono::high_resolution_clock::now() - start)
+                  .count();
+  return shader.get();
+}
+
+auto
+ShaderPermutations::get_report() const -> ShaderPermutationReport
+{
+  return {
+    .key_count = keys.size(),
+    .variant_count = variants.size(),
+    .unique_shader_count = shaders.size(),
+    .compile_ms = compile_ms,
+  };
+}
+
+} // namespace Engine::Graphics
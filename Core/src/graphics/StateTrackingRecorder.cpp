@@ -0,0 +1,188 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/StateTrackingRecorder.hpp"
+
+#include "graphics/CommandBuffer.hpp"
+#include "graphics/GPUBuffer.hpp"
+#include "graphics/RendererExtensions.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Engine::Graphics {
+
+auto
+BoundStateCache::count(bool emit) -> bool
+{
+  if (emit) {
+    statistics.emitted++;
+  } else {
+    statistics.skipped++;
+  }
+  return emit;
+}
+
+auto
+BoundStateCache::pipeline(VkPipeline pipeline) -> bool
+{
+  const auto changed = bound_pipeline != pipeline;
+  bound_pipeline = pipeline;
+  return count(changed);
+}
+
+auto
+BoundStateCache::vertex_buffer(Core::u32 binding,
+                               VkBuffer buffer,
+                               VkDeviceSize offset) -> bool
+{
+  if (binding >= max_vertex_bindings) {
+    return count(true);
+  }
+  auto& bound = vertex_bindings.at(binding);
+  const auto changed = bound.buffer != buffer || bound.offset != offset;
+  bound = { .buffer = buffer, .offset = offset };
+  return count(changed);
+}
+
+auto
+BoundStateCache::index_buffer(VkBuffer buffer,
+                              VkDeviceSize offset,
+                              VkIndexType type) -> bool
+{
+  const auto changed = bound_index_buffer != buffer || index_offset != offset ||
+                       index_type != type;
+  bound_index_buffer = buffer;
+  index_offset = offset;
+  index_type = type;
+  return count(changed);
+}
+
+auto
+BoundStateCache::descriptor_sets(VkPipelineLayout layout,
+                                 Core::u32 first_set,
+                                 std::span<const VkDescriptorSet> sets) -> bool
+{
+  if (first_set + sets.size() > max_descriptor_sets) {
+    return count(true);
+  }
+  if (layout != descriptor_layout) {
+    descriptor_layout = layout;
+    bound_sets.fill(nullptr);
+  }
+  const auto bound = std::span{ bound_sets }.subspan(first_set, sets.size());
+  const auto changed = !std::ranges::equal(bound, sets);
+  std::ranges::copy(sets, bound.begin());
+  return count(changed);
+}
+
+auto
+BoundStateCache::push_constants(VkPipelineLayout layout,
+                                VkShaderStageFlags stages,
+                                Core::u32 offset,
+                                std::span<const Core::u8> data) -> bool
+{
+  if (data.size() > max_push_constant_size) {
+    push_constant_layout = nullptr;
+    return count(true);
+  }
+  const auto changed =
+    push_constant_layout != layout || push_constant_stages != stages ||
+    push_constant_offset != offset || push_constant_size != data.size() ||
+    !std::ranges::equal(std::span{ push_constant_data }.first(data.size()),
+                        data);
+  push_constant_layout = layout;
+  push_constant_stages = stages;
+  push_constant_offset = offset;
+  push_constant_size = static_cast<Core::u32>(data.size());
+  std::ranges::copy(data, push_constant_data.begin());
+  return count(changed);
+}
+
+auto
+BoundStateCache::reset() -> void
+{
+  const auto kept = statistics;
+  *this = {};
+  statistics = kept;
+}
+
+StateTrackingRecorder::StateTrackingRecorder(const CommandBuffer& buffer)
+  : command_buffer(buffer)
+{
+}
+
+auto
+StateTrackingRecorder::bind_pipeline(const IPipeline& pipeline) -> void
+{
+  if (cache.pipeline(pipeline.get_pipeline())) {
+    RendererExtensions::bind_pipeline(command_buffer, pipeline);
+  }
+}
+
+auto
+StateTrackingRecorder::bind_vertex_buffer(const VertexBuffer& buffer,
+                                          Core::u32 binding,
+                                          VkDeviceSize offset) -> void
+{
+  if (cache.vertex_buffer(binding, buffer.get_buffer(), offset)) {
+    RendererExtensions::bind_vertex_buffer(
+      command_buffer, buffer, binding, static_cast<BufferOffset>(offset));
+  }
+}
+
+auto
+StateTrackingRecorder::bind_vertex_buffer(const StorageBuffer& buffer,
+                                          Core::u32 binding,
+                                          VkDeviceSize offset) -> void
+{
+  if (cache.vertex_buffer(binding, buffer.get_buffer(), offset)) {
+    auto* vk_buffer = buffer.get_buffer();
+    vkCmdBindVertexBuffers(
+      command_buffer.get_command_buffer(), binding, 1, &vk_buffer, &offset);
+  }
+}
+
+auto
+StateTrackingRecorder::bind_index_buffer(const IndexBuffer& buffer) -> void
+{
+  if (cache.index_buffer(buffer.get_buffer(), 0, VK_INDEX_TYPE_UINT32)) {
+    RendererExtensions::bind_index_buffer(command_buffer, buffer);
+  }
+}
+
+auto
+StateTrackingRecorder::bind_descriptor_sets(
+  const IPipeline& pipeline,
+  std::span<const VkDescriptorSet> sets,
+  Core::u32 first_set) -> void
+{
+  if (cache.descriptor_sets(pipeline.get_layout(), first_set, sets)) {
+    vkCmdBindDescriptorSets(command_buffer.get_command_buffer(),
+                            pipeline.get_bind_point(),
+                            pipeline.get_layout(),
+                            first_set,
+                            static_cast<Core::u32>(sets.size()),
+                            sets.data(),
+                            0,
+                            nullptr);
+  }
+}
+
+auto
+StateTrackingRecorder::push_constants(const IPipeline& pipeline,
+                                      const void* data,
+                                      Core::u32 size) -> void
+{
+  const std::span bytes{ static_cast<const Core::u8*>(data), size };
+  if (cache.push_constants(
+        pipeline.get_layout(), VK_SHADER_STAGE_ALL, 0, bytes)) {
+    vkCmdPushConstants(command_buffer.get_command_buffer(),
+                       pipeline.get_layout(),
+                       VK_SHADER_STAGE_ALL,
+                       0,
+                       size,
+                       data);
+  }
+}
+
+} // namespace Engine::Graphics
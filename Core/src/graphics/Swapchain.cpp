@@ -7,6 +7,7 @@
 
 #include <GLFW/glfw3.h>
 
+#include "core/Clock.hpp"
 #include "core/Verify.hpp"
 
 #include "Swapchain.inl"
@@ -235,6 +236,16 @@ Swapchain::acquire_next_image() -> Core::Maybe<Core::u32>
 auto
 Swapchain::begin_frame() -> bool
 {
+  // Everything this frame in flight submitted last time went to the
+  // graphics queue before the fence, so its per-frame resources are free
+  // once it signals. The other frames keep the GPU busy meanwhile.
+  const auto wait_start = Core::Clock::now_ms();
+  VK_CHECK(vkWaitForFences(Device::the().device(),
+                           1,
+                           &wait_fences[get_current_buffer_index()],
+                           VK_TRUE,
+                           UINT64_MAX));
+  frame_wait_time = Core::Clock::now_ms() - wait_start;
 
   auto acquired = acquire_next_image();
   if (!acquired)
@@ -0,0 +1,379 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/TransformPacker.hpp"
+
+#include "core/Profiler.hpp"
+#include "core/Verify.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ASTUTE_TRANSFORM_PACKER_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define ASTUTE_TARGET_AVX2
+#else
+#define ASTUTE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+namespace Engine::Graphics {
+
+namespace {
+
+// Row r of (A * B) is sum_k A[k][r] * (row k of B). The rows of the submesh
+// matrix are shared by the whole batch, so every instance costs twelve
+// broadcasts and multiply-adds, with no transpose.
+auto
+transpose_rows(const glm::mat4& local) -> std::array<glm::vec4, 4>
+{
+  std::array<glm::vec4, 4> rows{};
+  for (auto k = 0; k < 4; k++) {
+    rows[k] = { local[0][k], local[1][k], local[2][k], local[3][k] };
+  }
+  return rows;
+}
+
+auto
+pack_scalar(std::span<const glm::mat4> instances,
+            const glm::mat4& local,
+            std::span<TransformVertexData> output) -> void
+{
+  const auto local_rows = transpose_rows(local);
+  for (auto i = 0ULL; i < instances.size(); i++) {
+    const auto& instance = instances[i];
+    auto& rows = output[i].transform_rows;
+    for (auto r = 0; r < 3; r++) {
+      for (auto j = 0; j < 4; j++) {
+        rows[r][j] = instance[0][r] * local_rows[0][j] +
+                     instance[1][r] * local_rows[1][j] +
+                     instance[2][r] * local_rows[2][j] +
+                     instance[3][r] * local_rows[3][j];
+      }
+    }
+  }
+}
+
+auto
+compose_scalar(std::span<const glm::vec3> translations,
+               std::span<const glm::quat> rotations,
+               std::span<const glm::vec3> scales,
+               std::span<glm::mat4> output) -> void
+{
+  for (auto i = 0ULL; i < output.size(); i++) {
+    output[i] =
+      TransformPacker::compose(translations[i], rotations[i], scales[i]);
+  }
+}
+
+#ifdef ASTUTE_TRANSFORM_PACKER_X86
+template<int Lane>
+auto
+broadcast(__m128 value) -> __m128
+{
+  return _mm_shuffle_ps(value, value, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+}
+
+template<int Row>
+auto
+packed_row(const __m128 (&columns)[4], const __m128 (&local_rows)[4]) -> __m128
+{
+  auto row = _mm_mul_ps(broadcast<Row>(columns[0]), local_rows[0]);
+  row = _mm_add_ps(row, _mm_mul_ps(broadcast<Row>(columns[1]), local_rows[1]));
+  row = _mm_add_ps(row, _mm_mul_ps(broadcast<Row>(columns[2]), local_rows[2]));
+  row = _mm_add_ps(row, _mm_mul_ps(broadcast<Row>(columns[3]), local_rows[3]));
+  return row;
+}
+
+auto
+pack_sse2(std::span<const glm::mat4> instances,
+          const glm::mat4& local,
+          std::span<TransformVertexData> output) -> void
+{
+  // Plain arrays, as std::array drops the alignment attributes of __m128.
+  const auto rows = transpose_rows(local);
+  const __m128 local_rows[4]{
+    _mm_loadu_ps(&rows[0][0]),
+    _mm_loadu_ps(&rows[1][0]),
+    _mm_loadu_ps(&rows[2][0]),
+    _mm_loadu_ps(&rows[3][0]),
+  };
+
+  for (auto i = 0ULL; i < instances.size(); i++) {
+    const auto* instance = &instances[i][0][0];
+    const __m128 columns[4]{
+      _mm_loadu_ps(instance),
+      _mm_loadu_ps(instance + 4),
+      _mm_loadu_ps(instance + 8),
+      _mm_loadu_ps(instance + 12),
+    };
+    auto* destination = &output[i].transform_rows[0][0];
+    _mm_storeu_ps(destination, packed_row<0>(columns, local_rows));
+    _mm_storeu_ps(destination + 4, packed_row<1>(columns, local_rows));
+    _mm_storeu_ps(destination + 8, packed_row<2>(columns, local_rows));
+  }
+}
+
+// Rows 0 and 1 share one register: every column is loaded into both lanes,
+// then the low lane broadcasts its x and the high lane its y. Row 2 uses the
+// low halves of the same registers.
+ASTUTE_TARGET_AVX2 auto
+pack_avx2(std::span<const glm::mat4> instances,
+          const glm::mat4& local,
+          std::span<TransformVertexData> output) -> void
+{
+  // Plain arrays, as std::array drops the alignment attributes of __m256.
+  const auto rows = transpose_rows(local);
+  __m256 local_rows[4]{};
+  for (auto k = 0; k < 4; k++) {
+    local_rows[k] = _mm256_broadcast_ps(
+      reinterpret_cast<const __m128*>(&rows[k][0]));
+  }
+  const auto select_rows = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+
+  for (auto i = 0ULL; i < instances.size(); i++) {
+    const auto* instance = &instances[i][0][0];
+    __m256 columns[4]{};
+    for (auto k = 0; k < 4; k++) {
+      columns[k] = _mm256_broadcast_ps(
+        reinterpret_cast<const __m128*>(instance + 4 * k));
+    }
+
+    auto rows_01 = _mm256_mul_ps(
+      _mm256_permutevar_ps(columns[0], select_rows), local_rows[0]);
+    auto row_2 = _mm_mul_ps(broadcast<2>(_mm256_castps256_ps128(columns[0])),
+                            _mm256_castps256_ps128(local_rows[0]));
+    for (auto k = 1; k < 4; k++) {
+      rows_01 = _mm256_fmadd_ps(
+        _mm256_permutevar_ps(columns[k], select_rows), local_rows[k], rows_01);
+      row_2 =
+        _mm_fmadd_ps(broadcast<2>(_mm256_castps256_ps128(columns[k])),
+                     _mm256_castps256_ps128(local_rows[k]),
+                     row_2);
+    }
+
+    auto* destination = &output[i].transform_rows[0][0];
+    _mm256_storeu_ps(destination, rows_01);
+    _mm_storeu_ps(destination + 8, row_2);
+  }
+}
+
+// Compose works on four instances at once, one instance per lane.
+// Every input component is gathered into its own register, and the four
+// columns of each matrix come out as four registers of rows, transposed
+// back to one column per instance on the way out.
+template<class Accessor>
+auto
+gather4(Core::usize first, Accessor&& component) -> __m128
+{
+  return _mm_setr_ps(component(first),
+                     component(first + 1),
+                     component(first + 2),
+                     component(first + 3));
+}
+
+// columns[c][r] holds row r of column c for four consecutive instances.
+auto
+store_columns(__m128 (&columns)[4][4], glm::mat4* output) -> void
+{
+  for (auto c = 0; c < 4; c++) {
+    auto& rows = columns[c];
+    _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+    for (auto i = 0; i < 4; i++) {
+      _mm_storeu_ps(&output[i][c][0], rows[i]);
+    }
+  }
+}
+
+auto
+compose_sse2(std::span<const glm::vec3> translations,
+             std::span<const glm::quat> rotations,
+             std::span<const glm::vec3> scales,
+             std::span<glm::mat4> output) -> void
+{
+  const auto zero = _mm_setzero_ps();
+  const auto one = _mm_set1_ps(1.0F);
+  const auto two = _mm_set1_ps(2.0F);
+
+  auto i = 0ULL;
+  for (; i + 4 <= output.size(); i += 4) {
+    const auto qx = gather4(i, [&](auto j) { return rotations[j].x; });
+    const auto qy = gather4(i, [&](auto j) { return rotations[j].y; });
+    const auto qz = gather4(i, [&](auto j) { return rotations[j].z; });
+    const auto qw = gather4(i, [&](auto j) { return rotations[j].w; });
+    const auto sx = gather4(i, [&](auto j) { return scales[j].x; });
+    const auto sy = gather4(i, [&](auto j) { return scales[j].y; });
+    const auto sz = gather4(i, [&](auto j) { return scales[j].z; });
+
+    const auto xx = _mm_mul_ps(qx, qx);
+    const auto yy = _mm_mul_ps(qy, qy);
+    const auto zz = _mm_mul_ps(qz, qz);
+    const auto xy = _mm_mul_ps(qx, qy);
+    const auto xz = _mm_mul_ps(qx, qz);
+    const auto yz = _mm_mul_ps(qy, qz);
+    const auto wx = _mm_mul_ps(qw, qx);
+    const auto wy = _mm_mul_ps(qw, qy);
+    const auto wz = _mm_mul_ps(qw, qz);
+    const auto diagonal = [&](__m128 a, __m128 b, __m128 s) {
+      return _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(a, b))), s);
+    };
+    const auto sum = [&](__m128 a, __m128 b, __m128 s) {
+      return _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(a, b)), s);
+    };
+    const auto difference = [&](__m128 a, __m128 b, __m128 s) {
+      return _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(a, b)), s);
+    };
+
+    __m128 columns[4][4]{
+      { diagonal(yy, zz, sx), sum(xy, wz, sx), difference(xz, wy, sx), zero },
+      { difference(xy, wz, sy), diagonal(xx, zz, sy), sum(yz, wx, sy), zero },
+      { sum(xz, wy, sz), difference(yz, wx, sz), diagonal(xx, yy, sz), zero },
+      {
+        gather4(i, [&](auto j) { return translations[j].x; }),
+        gather4(i, [&](auto j) { return translations[j].y; }),
+        gather4(i, [&](auto j) { return translations[j].z; }),
+        one,
+      },
+    };
+    store_columns(columns, &output[i]);
+  }
+
+  compose_scalar(translations.subspan(i),
+                 rotations.subspan(i),
+                 scales.subspan(i),
+                 output.subspan(i));
+}
+
+auto
+detect_instruction_set() -> TransformPacker::InstructionSet
+{
+  using enum TransformPacker::InstructionSet;
+#if defined(_MSC_VER) && !defined(__clang__)
+  std::array<int, 4> registers{};
+  __cpuid(registers.data(), 1);
+  const auto has_fma = (registers[2] & (1 << 12)) != 0;
+  const auto has_os_save = (registers[2] & (1 << 27)) != 0;
+  __cpuidex(registers.data(), 7, 0);
+  const auto has_avx2 = (registers[1] & (1 << 5)) != 0;
+  // The OS must also save the upper halves of the YMM registers.
+  const auto has_ymm_state = has_os_save && (_xgetbv(0) & 0x6) == 0x6;
+  if (has_avx2 && has_fma && has_ymm_state) {
+    return AVX2;
+  }
+#else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return AVX2;
+  }
+#endif
+  // SSE2 is part of x86-64 itself.
+  return SSE2;
+}
+#else
+auto
+detect_instruction_set() -> TransformPacker::InstructionSet
+{
+  return TransformPacker::InstructionSet::Scalar;
+}
+#endif
+
+}
+
+auto
+TransformPacker::get_instruction_set() -> InstructionSet
+{
+  static const auto instruction_set = detect_instruction_set();
+  return instruction_set;
+}
+
+auto
+TransformPacker::to_string(InstructionSet instruction_set) -> std::string_view
+{
+  switch (instruction_set) {
+    using enum InstructionSet;
+    case Scalar:
+      return "Scalar";
+    case SSE2:
+      return "SSE2";
+    case AVX2:
+      return "AVX2";
+  }
+  return "Unknown";
+}
+
+auto
+TransformPacker::pack(std::span<const glm::mat4> instances,
+                      const glm::mat4& local,
+                      std::span<TransformVertexData> output) -> void
+{
+  pack(get_instruction_set(), instances, local, output);
+}
+
+auto
+TransformPacker::pack(InstructionSet instruction_set,
+                      std::span<const glm::mat4> instances,
+                      const glm::mat4& local,
+                      std::span<TransformVertexData> output) -> void
+{
+  ASTUTE_PROFILE_FUNCTION();
+
+  Core::ensure(output.size() >= instances.size(),
+               "Packed transform output is too small.");
+
+  instruction_set = std::min(instruction_set, get_instruction_set());
+  switch (instruction_set) {
+    using enum InstructionSet;
+#ifdef ASTUTE_TRANSFORM_PACKER_X86
+    case AVX2:
+      pack_avx2(instances, local, output);
+      return;
+    case SSE2:
+      pack_sse2(instances, local, output);
+      return;
+#endif
+    default:
+      pack_scalar(instances, local, output);
+      return;
+  }
+}
+
+auto
+TransformPacker::compose(std::span<const glm::vec3> translations,
+                         std::span<const glm::quat> rotations,
+                         std::span<const glm::vec3> scales,
+                         std::span<glm::mat4> output) -> void
+{
+  compose(get_instruction_set(), translations, rotations, scales, output);
+}
+
+auto
+TransformPacker::compose(InstructionSet instruction_set,
+                         std::span<const glm::vec3> translations,
+                         std::span<const glm::quat> rotations,
+                         std::span<const glm::vec3> scales,
+                         std::span<glm::mat4> output) -> void
+{
+  ASTUTE_PROFILE_FUNCTION();
+
+  Core::ensure(translations.size() == output.size() &&
+                 rotations.size() == output.size() &&
+                 scales.size() == output.size(),
+               "Composed transforms need one of each component.");
+
+  instruction_set = std::min(instruction_set, get_instruction_set());
+  switch (instruction_set) {
+    using enum InstructionSet;
+#ifdef ASTUTE_TRANSFORM_PACKER_X86
+    // Gathering the components of eight instances costs more than the
+    // wider arithmetic saves, so AVX2 uses the four-wide kernel.
+    case AVX2:
+    case SSE2:
+      compose_sse2(translations, rotations, scales, output);
+      return;
+#endif
+    default:
+      compose_scalar(translations, rotations, scales, output);
+      return;
+  }
+}
+
+} // namespace Engine::Graphics
@@ -0,0 +1,84 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/TransformRingBuffer.hpp"
+
+#include "core/DataBuffer.hpp"
+#include "core/Profiler.hpp"
+#include "core/Verify.hpp"
+
+#include "logging/Logger.hpp"
+
+namespace Engine::Graphics {
+
+TransformRingBuffer::TransformRingBuffer(const Configuration& config)
+  : frame_count(std::max(config.frame_count, 1U))
+{
+  grow(config.initial_capacity);
+}
+
+auto
+TransformRingBuffer::grow(Core::u32 required) -> void
+{
+  auto new_capacity = std::max(capacity, 1U);
+  while (new_capacity < required) {
+    new_capacity *= 2;
+  }
+
+  const auto total_size = static_cast<Core::usize>(new_capacity) *
+                          frame_count * sizeof(TransformVertexData);
+  Core::ensure(total_size <= std::numeric_limits<Core::u32>::max(),
+               "Transform ring buffer cannot be bound past 4GB.");
+
+  if (buffer) {
+    info("Growing transform ring buffer from {} to {} instances per frame "
+         "({})",
+         capacity,
+         new_capacity,
+         Core::human_readable_size(total_size));
+    retired_buffers.push_back(RetiredBuffer{
+      .buffer = std::move(buffer),
+      .retired_at = frames_begun,
+    });
+  }
+
+  buffer = Core::make_scope<VertexBuffer>(total_size);
+  Core::ensure(buffer->get_mapped_data() != nullptr,
+               "Transform ring buffer memory is not host visible.");
+  capacity = new_capacity;
+}
+
+auto
+TransformRingBuffer::begin_frame(Core::u32 frame, Core::u32 instance_count)
+  -> std::span<TransformVertexData>
+{
+  ASTUTE_PROFILE_FUNCTION();
+
+  frames_begun++;
+  std::erase_if(retired_buffers, [this](const RetiredBuffer& retired) {
+    return frames_begun - retired.retired_at > frame_count;
+  });
+
+  if (instance_count > capacity) {
+    grow(instance_count);
+  }
+
+  current_frame = frame % frame_count;
+  current_count = instance_count;
+
+  auto* region = static_cast<Core::u8*>(buffer->get_mapped_data()) +
+                 get_frame_offset();
+  return { reinterpret_cast<TransformVertexData*>(region), instance_count };
+}
+
+auto
+TransformRingBuffer::end_frame() -> void
+{
+  if (current_count == 0) {
+    return;
+  }
+  buffer->flush(get_frame_offset(),
+                static_cast<Core::usize>(current_count) *
+                  sizeof(TransformVertexData));
+}
+
+} // namespace Engine::Graphics
@@ -0,0 +1,48 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/TransientImageMemory.hpp"
+
+#include "graphics/Allocator.hpp"
+
+#include <vk_mem_alloc.h>
+
+namespace Engine::Graphics {
+
+struct TransientImageMemoryImpl
+{
+  VmaAllocation allocation{};
+};
+
+TransientImageMemory::TransientImageMemory(VkDeviceSize block_size,
+                                           Core::u32 memory_type_bits)
+  : size(block_size)
+  , impl(Core::make_scope<TransientImageMemoryImpl>())
+{
+  // Aligned by the graph already, per image.
+  VkMemoryRequirements requirements{};
+  requirements.size = size;
+  requirements.alignment = 1;
+  requirements.memoryTypeBits = memory_type_bits;
+
+  Allocator allocator{ "TransientImageMemory" };
+  impl->allocation = allocator.allocate_memory(requirements,
+                                               {
+                                                 .usage = Usage::GPU_ONLY,
+                                                 .priority = 1.0F,
+                                               });
+}
+
+TransientImageMemory::~TransientImageMemory()
+{
+  Allocator allocator{ "TransientImageMemory" };
+  allocator.deallocate_memory(impl->allocation);
+}
+
+auto
+TransientImageMemory::bind(VkImage image, VkDeviceSize offset) const -> void
+{
+  Allocator allocator{ "TransientImageMemory" };
+  allocator.bind_image(impl->allocation, offset, image);
+}
+
+} // namespace Engine::Graphics
@@ -105,8 +105,6 @@ BloomRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
   // m_GPUTimeQueries.BloomComputePassQuery =
   //   m_CommandBuffer->BeginTimestampQuery();
 
-  VkDevice device = Device::the().device();
-
   auto descriptorImageInfo = bloom_chain.at(0)->get_descriptor_info();
   descriptorImageInfo.imageView = bloom_chain.at(0)->get_mip_image_view(0);
 
@@ -114,35 +112,22 @@ BloomRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
 
   auto* descriptorSetLayout = shader->get_descriptor_set_layouts().at(0);
 
-  VkDescriptorSetAllocateInfo allocInfo = {};
-  allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-  allocInfo.descriptorSetCount = 1;
-  allocInfo.pSetLayouts = &descriptorSetLayout;
+  // Every dispatch below binds its own set, kept between frames.
+  Core::u32 dispatch = 0;
 
   // Output image
-  VkDescriptorSet descriptorSet =
-    shader->allocate_descriptor_set(0).descriptor_sets.at(0);
   write_descriptors[0] = *shader->get_descriptor_set("output_image", 0);
-  write_descriptors[0].dstSet =
-    descriptorSet; // Should this be set inside the shader?
   write_descriptors[0].pImageInfo = &descriptorImageInfo;
 
   // Input image
   write_descriptors[1] = *shader->get_descriptor_set("input_texture");
-  write_descriptors[1].dstSet =
-    descriptorSet; // Should this be set inside the shader?
   write_descriptors[1].pImageInfo = &inputImage->get_descriptor_info();
 
   write_descriptors[2] = *shader->get_descriptor_set("input_bloom_texture");
-  write_descriptors[2].dstSet =
-    descriptorSet; // Should this be set inside the shader?
   write_descriptors[2].pImageInfo = &inputImage->get_descriptor_info();
 
-  vkUpdateDescriptorSets(device,
-                         (uint32_t)write_descriptors.size(),
-                         write_descriptors.data(),
-                         0,
-                         nullptr);
+  VkDescriptorSet descriptorSet =
+    get_dispatch_set(dispatch++, descriptorSetLayout, write_descriptors);
 
   uint32_t workGroupsX = bloom_chain[0]->configuration.width / workgroup_size;
   uint32_t workGroupsY = bloom_chain[0]->configuration.height / workgroup_size;
@@ -202,30 +187,20 @@ BloomRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
       // Output image
       descriptorImageInfo.imageView = bloom_chain[1]->get_mip_image_view(i);
 
-      descriptorSet = shader->allocate_descriptor_set(0).descriptor_sets.at(0);
       write_descriptors[0] = *shader->get_descriptor_set("output_image");
-      write_descriptors[0].dstSet =
-        descriptorSet; // Should this be set inside the shader?
       write_descriptors[0].pImageInfo = &descriptorImageInfo;
 
       // Input image
       write_descriptors[1] = *shader->get_descriptor_set("input_texture");
-      write_descriptors[1].dstSet =
-        descriptorSet; // Should this be set inside the shader?
       const auto& descriptor = bloom_chain[0]->get_descriptor_info();
       // descriptor.sampler = samplerClamp;
       write_descriptors[1].pImageInfo = &descriptor;
 
       write_descriptors[2] = *shader->get_descriptor_set("input_bloom_texture");
-      write_descriptors[2].dstSet =
-        descriptorSet; // Should this be set inside the shader?
       write_descriptors[2].pImageInfo = &inputImage->get_descriptor_info();
 
-      vkUpdateDescriptorSets(device,
-                             (uint32_t)write_descriptors.size(),
-                             write_descriptors.data(),
-                             0,
-                             nullptr);
+      descriptorSet =
+        get_dispatch_set(dispatch++, descriptorSetLayout, write_descriptors);
 
       bloomComputePushConstants.LOD = i - 1.0f;
       vkCmdPushConstants(command_buffer.get_command_buffer(),
@@ -273,30 +248,20 @@ BloomRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
       descriptorImageInfo.imageView = bloom_chain[0]->get_mip_image_view(i);
 
       // Output image
-      descriptorSet = shader->allocate_descriptor_set(0).descriptor_sets.at(0);
       write_descriptors[0] = *shader->get_descriptor_set("output_image");
-      write_descriptors[0].dstSet =
-        descriptorSet; // Should this be set inside the shader?
       write_descriptors[0].pImageInfo = &descriptorImageInfo;
 
       // Input image
       write_descriptors[1] = *shader->get_descriptor_set("input_texture");
-      write_descriptors[1].dstSet =
-        descriptorSet; // Should this be set inside the shader?
       const auto& descriptor = bloom_chain[1]->get_descriptor_info();
       // descriptor.sampler = samplerClamp;
       write_descriptors[1].pImageInfo = &descriptor;
 
       write_descriptors[2] = *shader->get_descriptor_set("input_bloom_texture");
-      write_descriptors[2].dstSet =
-        descriptorSet; // Should this be set inside the shader?
       write_descriptors[2].pImageInfo = &inputImage->get_descriptor_info();
 
-      vkUpdateDescriptorSets(device,
-                             (uint32_t)write_descriptors.size(),
-                             write_descriptors.data(),
-                             0,
-                             nullptr);
+      descriptorSet =
+        get_dispatch_set(dispatch++, descriptorSetLayout, write_descriptors);
 
       bloomComputePushConstants.LOD = (float)i;
       vkCmdPushConstants(command_buffer.get_command_buffer(),
@@ -348,30 +313,20 @@ BloomRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
   workGroupsY *= 2;
 
   // Output image
-  descriptorSet = shader->allocate_descriptor_set(0).descriptor_sets.at(0);
   descriptorImageInfo.imageView = bloom_chain[2]->get_mip_image_view(mips - 2);
 
   write_descriptors[0] = *shader->get_descriptor_set("output_image");
-  write_descriptors[0].dstSet =
-    descriptorSet; // Should this be set inside the shader?
   write_descriptors[0].pImageInfo = &descriptorImageInfo;
 
   // Input image
   write_descriptors[1] = *shader->get_descriptor_set("input_texture");
-  write_descriptors[1].dstSet =
-    descriptorSet; // Should this be set inside the shader?
   write_descriptors[1].pImageInfo = &bloom_chain[0]->get_descriptor_info();
 
   write_descriptors[2] = *shader->get_descriptor_set("input_bloom_texture");
-  write_descriptors[2].dstSet =
-    descriptorSet; // Should this be set inside the shader?
   write_descriptors[2].pImageInfo = &inputImage->get_descriptor_info();
 
-  vkUpdateDescriptorSets(device,
-                         (uint32_t)write_descriptors.size(),
-                         write_descriptors.data(),
-                         0,
-                         nullptr);
+  descriptorSet =
+    get_dispatch_set(dispatch++, descriptorSetLayout, write_descriptors);
 
   auto [mipWidth, mipHeight] = bloom_chain[2]->get_mip_size(mips - 2);
   workGroupsX = (uint32_t)glm::ceil((float)mipWidth / (float)workgroup_size);
@@ -433,29 +388,18 @@ BloomRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
 
     // Output image
     descriptorImageInfo.imageView = bloom_chain[2]->get_mip_image_view(mip);
-    auto current_descriptor_set =
-      shader->allocate_descriptor_set(0).descriptor_sets.at(0);
     write_descriptors[0] = *shader->get_descriptor_set("output_image");
-    write_descriptors[0].dstSet =
-      current_descriptor_set; // Should this be set inside the shader?
     write_descriptors[0].pImageInfo = &descriptorImageInfo;
 
     // Input image
     write_descriptors[1] = *shader->get_descriptor_set("input_texture");
-    write_descriptors[1].dstSet =
-      current_descriptor_set; // Should this be set inside the shader?
     write_descriptors[1].pImageInfo = &bloom_chain[0]->get_descriptor_info();
 
     write_descriptors[2] = *shader->get_descriptor_set("input_bloom_texture");
-    write_descriptors[2].dstSet =
-      current_descriptor_set; // Should this be set inside the shader?
     write_descriptors[2].pImageInfo = &bloom_chain[2]->get_descriptor_info();
 
-    vkUpdateDescriptorSets(device,
-                           (uint32_t)write_descriptors.size(),
-                           write_descriptors.data(),
-                           0,
-                           nullptr);
+    auto* current_descriptor_set =
+      get_dispatch_set(dispatch++, descriptorSetLayout, write_descriptors);
 
     bloomComputePushConstants.LOD = (float)mip;
     vkCmdPushConstants(command_buffer.get_command_buffer(),
@@ -505,11 +449,21 @@ BloomRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
 }
 
 auto
-BloomRenderPass::on_resize(const Core::Extent& ext) -> void
+BloomRenderPass::get_dispatch_set(
+  Core::u32 dispatch,
+  VkDescriptorSetLayout layout,
+  std::span<const VkWriteDescriptorSet> writes) -> VkDescriptorSet
 {
-  auto& [___, __, pipe, _] = get_data();
-  pipe->on_resize(ext);
+  while (dispatch_descriptor_sets.size() <= dispatch) {
+    dispatch_descriptor_sets.push_back(
+      Core::make_scope<PersistentDescriptorSet>());
+  }
+  return dispatch_descriptor_sets.at(dispatch)->update(layout, writes);
+}
 
+auto
+BloomRenderPass::on_resize(const Core::Extent& ext) -> void
+{
   {
     auto* current_settings = get_current_settings<BloomSettings>();
     glm::uvec2 bloomSize = (glm::uvec2(ext.width, ext.height) + 1u) / 2u;
@@ -527,6 +481,23 @@ BloomRenderPass::on_resize(const Core::Extent& ext) -> void
   }
 }
 
+auto
+BloomRenderPass::declare(RenderGraph& graph, const std::string& name) -> void
+{
+  const auto& input = get_renderer().get_render_pass("Deferred");
+  const auto pass = graph.add_pass(name, QueueType::Compute);
+  graph.read(pass,
+             graph.add_image("Deferred.Colour",
+                             input.get_colour_attachment(0).get(),
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+             RenderGraph::compute_read);
+  graph.write(pass,
+              graph.add_image("Bloom.Output",
+                              get_bloom_texture_output().get(),
+                              VK_IMAGE_LAYOUT_GENERAL),
+              RenderGraph::compute_write);
+}
+
 auto
 BloomRenderPass::BloomSettings::expose_to_ui(Material&) -> void
 {
@@ -100,10 +100,29 @@ ChromaticAberrationRenderPass::execute_impl(CommandBuffer& command_buffer)
 auto
 ChromaticAberrationRenderPass::on_resize(const Core::Extent& ext) -> void
 {
-  auto&& [fb, _, pipe, __] = get_data();
+  auto&& [fb, _, __, ___] = get_data();
 
   fb->on_resize(ext);
-  pipe->on_resize(ext);
+}
+
+auto
+ChromaticAberrationRenderPass::declare(RenderGraph& graph,
+                                       const std::string& name) -> void
+{
+  const auto& input = get_renderer().get_render_pass("Deferred");
+  const auto pass = add_framebuffer_pass(graph, name);
+  graph.read(pass,
+             graph.add_image("Deferred.Colour",
+                             input.get_colour_attachment(0).get(),
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+             RenderGraph::sampled_in_fragment);
+  // Drawn over in full every frame, and only read by the composition.
+  auto& image = *get_colour_attachment(0);
+  const auto output = graph.add_image("ChromaticAberration.Colour",
+                                      &image,
+                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  graph.write(pass, output, RenderGraph::colour_attachment);
+  set_transient(graph, output, image);
 }
 
 auto
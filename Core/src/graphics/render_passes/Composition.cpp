@@ -103,10 +103,34 @@ CompositionRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
 auto
 CompositionRenderPass::on_resize(const Core::Extent& ext) -> void
 {
-  auto&& [fb, _, pipe, __] = get_data();
+  auto&& [fb, _, __, ___] = get_data();
 
   fb->on_resize(ext);
-  pipe->on_resize(ext);
+}
+
+auto
+CompositionRenderPass::declare(RenderGraph& graph, const std::string& name)
+  -> void
+{
+  const auto& input = get_renderer().get_render_pass("ChromaticAberration");
+  const auto& bloom = static_cast<const BloomRenderPass&>(
+    get_renderer().get_render_pass("Bloom"));
+  const auto pass = add_framebuffer_pass(graph, name);
+  graph.read(pass,
+             graph.add_image("ChromaticAberration.Colour",
+                             input.get_colour_attachment(0).get(),
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+             RenderGraph::sampled_in_fragment);
+  graph.read(pass,
+             graph.add_image("Bloom.Output",
+                             bloom.get_bloom_texture_output().get(),
+                             VK_IMAGE_LAYOUT_GENERAL),
+             RenderGraph::sampled_in_fragment);
+  graph.write(pass,
+              graph.add_image("Composition.Colour",
+                              get_colour_attachment(0).get(),
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+              RenderGraph::colour_attachment);
 }
 
 CompositionRenderPass::CompositionSettings::CompositionSettings()
@@ -19,6 +19,7 @@
 #include "graphics/Window.hpp"
 
 #include "graphics/RendererExtensions.hpp"
+#include "graphics/render_passes/MainGeometry.hpp"
 
 #include <FileWatch.hpp>
 
@@ -168,10 +169,32 @@ DeferredRenderPass::destruct_impl() -> void
 auto
 DeferredRenderPass::on_resize(const Core::Extent& ext) -> void
 {
-  auto&& [fb, _, pipe, __] = get_data();
+  auto&& [fb, _, __, ___] = get_data();
 
   fb->on_resize(ext);
-  pipe->on_resize(ext);
+}
+
+auto
+DeferredRenderPass::declare(RenderGraph& graph, const std::string& name) -> void
+{
+  const auto& input = get_renderer().get_render_pass("MainGeometry");
+  const auto pass = add_framebuffer_pass(graph, name);
+  const auto& gbuffer_names = MainGeometryRenderPass::gbuffer_names;
+  for (auto i = 0U; i < gbuffer_names.size(); i++) {
+    graph.read(pass,
+               graph.add_image(gbuffer_names.at(i),
+                               input.get_colour_attachment(i).get(),
+                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+               RenderGraph::sampled_in_fragment);
+  }
+  graph.read(pass,
+             graph.add_buffer("LightCulling.VisibleLights"),
+             RenderGraph::sampled_in_fragment);
+  graph.write(pass,
+              graph.add_image("Deferred.Colour",
+                              get_colour_attachment(0).get(),
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+              RenderGraph::colour_attachment);
 }
 
 void
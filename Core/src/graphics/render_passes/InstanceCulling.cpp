@@ -0,0 +1,313 @@
+#include "pch/CorePCH.hpp"
+
+#include "graphics/render_passes/InstanceCulling.hpp"
+
+#include "core/Application.hpp"
+#include "core/Verify.hpp"
+#include "logging/Logger.hpp"
+
+#include "graphics/ComputePipeline.hpp"
+#include "graphics/GPUBuffer.hpp"
+#include "graphics/Material.hpp"
+#include "graphics/Renderer.hpp"
+#include "graphics/Shader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Engine::Graphics {
+
+namespace {
+constexpr Core::u32 workgroup_size = 64;
+constexpr Core::u32 minimum_draw_capacity = 256;
+constexpr Core::u32 minimum_instance_capacity = 4096;
+
+enum class CullingMode : Core::u32
+{
+  CullInstances = 0,
+  CompactCommands = 1,
+};
+
+struct CullingPushConstants
+{
+  CullingMode mode{ CullingMode::CullInstances };
+  Core::u32 instance_count{ 0 };
+  Core::u32 draw_count{ 0 };
+  Core::u32 group_count{ 0 };
+};
+
+auto
+grown_capacity(Core::u32 current, Core::u32 required, Core::u32 minimum)
+  -> Core::u32
+{
+  if (required <= current) {
+    return current;
+  }
+  return std::max({ required, current * 2, minimum });
+}
+
+auto
+workgroups(Core::u32 invocations) -> Core::u32
+{
+  return (invocations + workgroup_size - 1) / workgroup_size;
+}
+
+auto
+barrier(const CommandBuffer& command_buffer,
+        VkPipelineStageFlags destination_stages,
+        VkAccessFlags destination_access) -> void
+{
+  VkMemoryBarrier memory_barrier{};
+  memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  memory_barrier.dstAccessMask = destination_access;
+  vkCmdPipelineBarrier(command_buffer.get_command_buffer(),
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       destination_stages,
+                       0,
+                       1,
+                       &memory_barrier,
+                       0,
+                       nullptr,
+                       0,
+                       nullptr);
+}
+}
+
+auto
+InstanceCullingRenderPass::construct_impl() -> void
+{
+  auto&& [_, shader, pipeline, material] = get_data();
+  shader =
+    Shader::compile_compute_scoped("Assets/shaders/instance_culling.comp");
+  pipeline = Core::make_scope<ComputePipeline>(ComputePipeline::Configuration{
+    .shader = shader.get(),
+  });
+  material = Core::make_scope<Material>(Material::Configuration{
+    .shader = shader.get(),
+  });
+}
+
+auto
+InstanceCullingRenderPass::reserve(FrameBuffers& frame,
+                                   const IndirectDrawBuilder& builder) -> void
+{
+  using enum GPUBufferType;
+  static constexpr auto views = IndirectDrawBuilder::view_count;
+
+  if (const auto capacity = grown_capacity(frame.draw_capacity,
+                                           builder.get_draw_count(),
+                                           minimum_draw_capacity);
+      capacity != frame.draw_capacity) {
+    const auto command_bytes =
+      static_cast<Core::usize>(views) * capacity *
+      sizeof(VkDrawIndexedIndirectCommand);
+    frame.draws = Core::make_scope<StorageBuffer>(
+      static_cast<Core::usize>(capacity) * sizeof(IndirectDrawData));
+    frame.commands = Core::make_scope<StorageBuffer>(command_bytes, Indirect);
+    frame.compacted_commands =
+      Core::make_scope<StorageBuffer>(command_bytes, Indirect);
+    frame.draw_capacity = capacity;
+    // The commands of the previous layout are gone.
+    frame.draw_count = 0;
+  }
+
+  if (const auto capacity = grown_capacity(frame.group_capacity,
+                                           builder.get_group_count(),
+                                           minimum_draw_capacity);
+      capacity != frame.group_capacity) {
+    frame.counts = Core::make_scope<StorageBuffer>(
+      static_cast<Core::usize>(views) * capacity * sizeof(Core::u32),
+      Indirect);
+    frame.group_capacity = capacity;
+  }
+
+  if (const auto capacity = grown_capacity(frame.instance_capacity,
+                                           builder.get_instance_count(),
+                                           minimum_instance_capacity);
+      capacity != frame.instance_capacity) {
+    frame.instances = Core::make_scope<StorageBuffer>(
+      static_cast<Core::usize>(capacity) * sizeof(IndirectInstanceData));
+    frame.culled_transforms = Core::make_scope<StorageBuffer>(
+      static_cast<Core::usize>(views) * capacity *
+        sizeof(TransformVertexData),
+      Instance);
+    frame.instance_capacity = capacity;
+  }
+}
+
+auto
+InstanceCullingRenderPass::upload(FrameBuffers& frame,
+                                  const IndirectDrawBuilder& builder) -> void
+{
+  static constexpr auto views = IndirectDrawBuilder::view_count;
+
+  const auto draws = builder.get_draws();
+  frame.draws->write(draws);
+  frame.draws->flush(0, draws.size_bytes());
+
+  const auto instances = builder.get_instances();
+  frame.instances->write(instances);
+  frame.instances->flush(0, instances.size_bytes());
+
+  auto* mapped_commands = static_cast<VkDrawIndexedIndirectCommand*>(
+    frame.commands->get_mapped_data());
+  auto* mapped_counts =
+    static_cast<Core::u32*>(frame.counts->get_mapped_data());
+  Core::ensure(mapped_commands != nullptr && mapped_counts != nullptr,
+               "Indirect commands must live in host visible memory.");
+
+  const auto command_count = views * builder.get_draw_count();
+  builder.write_commands(std::span{ mapped_commands, command_count });
+  frame.commands->flush(0,
+                        command_count * sizeof(VkDrawIndexedIndirectCommand));
+
+  const auto count_count = views * builder.get_group_count();
+  std::memset(mapped_counts, 0, count_count * sizeof(Core::u32));
+  frame.counts->flush(0, count_count * sizeof(Core::u32));
+
+  frame.draw_count = builder.get_draw_count();
+  frame.group_count = builder.get_group_count();
+}
+
+auto
+InstanceCullingRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
+{
+  ASTUTE_PROFILE_FUNCTION();
+
+  current_frame = Core::Application::the().current_frame_index();
+  if (frames.size() <= current_frame) {
+    frames.resize(current_frame + 1);
+  }
+  auto& frame = frames.at(current_frame);
+  const auto& builder = get_renderer().indirect_draws;
+
+  // The last frame culled with these buffers has completed, so its counts
+  // can be read before they are overwritten.
+  visible_instances = {};
+  if (frame.draw_count > 0) {
+    const auto command_count =
+      IndirectDrawBuilder::view_count * frame.draw_count;
+    frame.commands->invalidate(
+      0, command_count * sizeof(VkDrawIndexedIndirectCommand));
+    visible_instances = IndirectDrawBuilder::count_visible(
+      std::span{ static_cast<const VkDrawIndexedIndirectCommand*>(
+                   frame.commands->get_mapped_data()),
+                 command_count },
+      frame.draw_count);
+  }
+
+  reserve(frame, builder);
+  upload(frame, builder);
+  if (builder.empty()) {
+    return;
+  }
+
+  auto&& [_, shader, pipeline, material] = get_data();
+  material->set("IndirectDrawSSBO", *frame.draws);
+  material->set("IndirectInstanceSSBO", *frame.instances);
+  material->set("IndirectCommandSSBO", *frame.commands);
+  material->set("CompactedCommandSSBO", *frame.compacted_commands);
+  material->set("IndirectCountSSBO", *frame.counts);
+  material->set("CulledTransformSSBO", *frame.culled_transforms);
+
+  std::array descriptor_sets{
+    generate_and_update_descriptor_write_sets(*material),
+    material->generate_and_update_descriptor_write_sets(),
+  };
+  vkCmdBindDescriptorSets(command_buffer.get_command_buffer(),
+                          pipeline->get_bind_point(),
+                          pipeline->get_layout(),
+                          0,
+                          static_cast<Core::u32>(descriptor_sets.size()),
+                          descriptor_sets.data(),
+                          0,
+                          nullptr);
+
+  CullingPushConstants constants{
+    .mode = CullingMode::CullInstances,
+    .instance_count = builder.get_instance_count(),
+    .draw_count = builder.get_draw_count(),
+    .group_count = builder.get_group_count(),
+  };
+  const auto dispatch = [&](Core::u32 invocations) {
+    vkCmdPushConstants(command_buffer.get_command_buffer(),
+                       pipeline->get_layout(),
+                       VK_SHADER_STAGE_ALL,
+                       0,
+                       sizeof(constants),
+                       &constants);
+    vkCmdDispatch(
+      command_buffer.get_command_buffer(), workgroups(invocations), 1, 1);
+  };
+
+  dispatch(constants.instance_count);
+  barrier(command_buffer,
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+  constants.mode = CullingMode::CompactCommands;
+  dispatch(IndirectDrawBuilder::view_count * constants.draw_count);
+  barrier(command_buffer,
+          VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+          VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+}
+
+auto
+InstanceCullingRenderPass::get_culled_transforms() const
+  -> const StorageBuffer&
+{
+  return *frames.at(current_frame).culled_transforms;
+}
+
+auto
+InstanceCullingRenderPass::draw_group(const CommandBuffer& command_buffer,
+                                      Core::u32 view,
+                                      Core::u32 group) -> void
+{
+  const auto& frame = frames.at(current_frame);
+  const auto& draw_group = get_renderer().indirect_draws.get_groups()[group];
+  const auto command =
+    static_cast<VkDeviceSize>(view) * frame.draw_count +
+    draw_group.first_command;
+  const auto count = static_cast<VkDeviceSize>(view) * frame.group_count +
+                     group;
+  vkCmdDrawIndexedIndirectCount(
+    command_buffer.get_command_buffer(),
+    frame.compacted_commands->get_buffer(),
+    command * sizeof(VkDrawIndexedIndirectCommand),
+    frame.counts->get_buffer(),
+    count * sizeof(Core::u32),
+    draw_group.command_count,
+    sizeof(VkDrawIndexedIndirectCommand));
+}
+
+auto
+InstanceCullingRenderPass::destruct_impl() -> void
+{
+  frames.clear();
+}
+
+auto
+InstanceCullingRenderPass::on_resize(const Core::Extent&) -> void
+{
+}
+
+auto
+InstanceCullingRenderPass::declare(RenderGraph& graph, const std::string& name)
+  -> void
+{
+  // Recorded on the graphics queue, ending with a barrier of its own for the
+  // draws reading its commands and transforms.
+  const auto pass = graph.add_pass(name,
+                                   QueueType::Graphics,
+                                   0,
+                                   RenderGraph::indirect_arguments.stages);
+  graph.write(pass,
+              graph.add_buffer("InstanceCulling.Draws"),
+              RenderGraph::compute_write);
+}
+
+} // namespace Engine::Graphics
@@ -82,10 +82,24 @@ LightCullingRenderPass::destruct_impl() -> void
 }
 
 auto
-LightCullingRenderPass::on_resize(const Core::Extent& ext) -> void
+LightCullingRenderPass::on_resize(const Core::Extent&) -> void
 {
-  auto& [___, __, pipe, _] = get_data();
-  pipe->on_resize(ext);
+}
+
+auto
+LightCullingRenderPass::declare(RenderGraph& graph, const std::string& name)
+  -> void
+{
+  const auto& predepth = get_renderer().get_render_pass("Predepth");
+  const auto pass = graph.add_pass(name, QueueType::Compute);
+  graph.read(pass,
+             graph.add_image("Predepth.Depth",
+                             predepth.get_depth_attachment().get(),
+                             VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL),
+             RenderGraph::compute_read);
+  graph.write(pass,
+              graph.add_buffer("LightCulling.VisibleLights"),
+              RenderGraph::compute_write);
 }
 
 } // namespace Engine::Graphics
@@ -13,8 +13,11 @@ namespace Engine::Graphics {
 
 LightsRenderPass::LightsRenderPass(Renderer& ren)
   : RenderPass(ren)
-  , storage_buffer(sizeof(glm::vec4) * 5000)
 {
+  for (auto i = 0U; i < Core::Application::the().get_image_count(); i++) {
+    storage_buffers.push_back(
+      Core::make_scope<StorageBuffer>(sizeof(glm::vec4) * 5000));
+  }
 }
 
 auto
@@ -62,8 +65,6 @@ LightsRenderPass::construct_impl() -> void
   lights_material = Core::make_scope<Material>(Material::Configuration{
     .shader = lights_shader.get(),
   });
-
-  lights_material->set("InstanceColours", storage_buffer);
 }
 
 auto
@@ -75,25 +76,26 @@ LightsRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
                lights_pipeline,
                lights_material] = get_data();
 
+  auto& storage_buffer =
+    *storage_buffers.at(Core::Application::the().current_frame_index());
   storage_buffer.write(std::span(get_renderer().get_lights_data()));
+  lights_material->set("InstanceColours", storage_buffer);
 
   auto* renderer_desc_set =
     generate_and_update_descriptor_write_sets(*lights_material);
 
   lights_material->update_descriptor_write_sets(renderer_desc_set);
 
-  for (auto&& [key, command] : get_renderer().lights_draw_commands) {
+  for (const auto& batch : get_renderer().lights_draw_list.get_batches()) {
     ASTUTE_PROFILE_SCOPE("Lights Render pass draw command");
-    const auto& mesh = command.static_mesh;
-    const auto& submesh_index = command.submesh_index;
-    const auto& instance_count = command.instance_count;
+    const auto& mesh = batch.static_mesh;
+    const auto& submesh_index = batch.submesh_index;
+    const auto& instance_count = batch.instance_count;
 
     const auto& mesh_asset = mesh->get_mesh_asset();
-    const auto& transform_vertex_buffer =
-      get_renderer()
-        .transform_buffers.at(Core::Application::the().current_frame_index())
-        .transform_buffer;
-    auto offset = get_renderer().mesh_transform_map.at(key).offset;
+    const auto& transform_vertex_buffer = get_renderer().get_transform_buffer();
+    const auto offset =
+      static_cast<Core::u32>(get_renderer().get_transform_offset(batch));
     const auto& submesh = mesh_asset->get_submeshes().at(submesh_index);
 
     const auto& material = mesh->get_materials().at(submesh.material_index);
@@ -103,7 +105,7 @@ LightsRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
     RendererExtensions::bind_vertex_buffer(
       command_buffer, mesh_asset->get_vertex_buffer(), 0);
     RendererExtensions::bind_vertex_buffer(
-      command_buffer, *transform_vertex_buffer, 1, offset);
+      command_buffer, transform_vertex_buffer, 1, offset);
     RendererExtensions::bind_index_buffer(command_buffer,
                                           mesh_asset->get_index_buffer());
 
@@ -139,10 +141,28 @@ LightsRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
 auto
 LightsRenderPass::on_resize(const Core::Extent& ext) -> void
 {
-  auto&& [fb, _, pipe, __] = get_data();
+  auto&& [fb, _, __, ___] = get_data();
 
   fb->on_resize(ext);
-  pipe->on_resize(ext);
+}
+
+auto
+LightsRenderPass::declare(RenderGraph& graph, const std::string& name) -> void
+{
+  const auto& predepth = get_renderer().get_render_pass("Predepth");
+  const auto pass = add_framebuffer_pass(graph, name);
+  graph.read(pass,
+             graph.add_image("Predepth.Depth",
+                             predepth.get_depth_attachment().get(),
+                             VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL),
+             RenderGraph::depth_test);
+  // Drawn over the deferred output.
+  const auto colour =
+    graph.add_image("Deferred.Colour",
+                    get_colour_attachment(0).get(),
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  graph.read(pass, colour, RenderGraph::colour_attachment);
+  graph.write(pass, colour, RenderGraph::colour_attachment);
 }
 
 } // namespace Engine::Graphics
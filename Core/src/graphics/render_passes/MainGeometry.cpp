@@ -11,15 +11,19 @@
 #include "core/Application.hpp"
 #include "graphics/Framebuffer.hpp"
 #include "graphics/GraphicsPipeline.hpp"
+#include "graphics/Image.hpp"
 
 #include "graphics/RendererExtensions.hpp"
 
 #include <ranges>
 
+#include "graphics/render_passes/InstanceCulling.hpp"
 #include "graphics/render_passes/MainGeometry.hpp"
 
 namespace Engine::Graphics {
 
+MainGeometryRenderPass::~MainGeometryRenderPass() = default;
+
 auto
 MainGeometryRenderPass::construct_impl() -> void
 {
@@ -56,6 +60,40 @@ MainGeometryRenderPass::construct_impl() -> void
   main_geometry_material = Core::make_scope<Material>(Material::Configuration{
     .shader = main_geometry_shader.get(),
   });
+
+  permutations =
+    Core::make_scope<ShaderPermutations>(ShaderPermutations::Configuration{
+      .vertex_path = "Assets/shaders/main_geometry.vert",
+      .fragment_path = "Assets/shaders/main_geometry.frag",
+    });
+  variant_pipelines.clear();
+  recorder = Core::make_scope<SecondaryCommandRecorder>(
+    Renderer::get_thread_pool());
+}
+
+auto
+MainGeometryRenderPass::get_pipeline(const Material& material)
+  -> const GraphicsPipeline&
+{
+  const auto& base_pipeline = static_cast<const GraphicsPipeline&>(
+    *std::get<Core::Scope<IPipeline>>(get_data()));
+  const auto* shader = permutations->get(material.get_variants());
+  if (shader == nullptr) {
+    return base_pipeline;
+  }
+
+  auto& pipeline = variant_pipelines[shader];
+  if (!pipeline) {
+    const auto& framebuffer = std::get<Core::Scope<IFramebuffer>>(get_data());
+    pipeline =
+      Core::make_scope<GraphicsPipeline>(GraphicsPipeline::Configuration{
+        .framebuffer = framebuffer.get(),
+        .shader = shader,
+        .sample_count = VK_SAMPLE_COUNT_1_BIT,
+        .depth_comparator = VK_COMPARE_OP_EQUAL,
+      });
+  }
+  return *pipeline;
 }
 
 auto
@@ -75,70 +113,122 @@ MainGeometryRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
     generate_and_update_descriptor_write_sets(*main_geometry_material);
 
   main_geometry_material->update_descriptor_write_sets(renderer_desc_set);
-  std::unordered_map<Core::u32, VkDescriptorSet> material_desc_sets;
-  for (const auto& [key, command] : get_renderer().draw_commands) {
-    const auto& [mesh, submesh_index, instance_count] = command;
+  const auto gpu_driven =
+    get_renderer().technique == RendererTechnique::GPUDriven;
+  const auto batches = get_renderer().draw_list.get_batches();
+  const auto groups = get_renderer().indirect_draws.get_groups();
+  // Descriptor sets are written here, before any worker records a draw.
+  std::unordered_map<const Material*, VkDescriptorSet> material_desc_sets;
+  std::unordered_map<const Material*, const GraphicsPipeline*>
+    material_pipelines;
+  const auto prepare_material = [&](const CommandKey& key,
+                                    const StaticMesh* mesh,
+                                    Core::u32 submesh_index) {
+    if (material_desc_sets.contains(key.material)) {
+      return;
+    }
     const auto& submesh =
       mesh->get_mesh_asset()->get_submeshes().at(submesh_index);
     const auto& material = mesh->get_materials().at(submesh.material_index);
-    if (!material_desc_sets.contains(submesh.material_index)) {
-      auto* material_descriptor_set =
-        material->generate_and_update_descriptor_write_sets();
-      material_desc_sets[submesh.material_index] = material_descriptor_set;
+    material_desc_sets[key.material] =
+      material->generate_and_update_descriptor_write_sets();
+    material_pipelines[key.material] = &get_pipeline(*material);
+  };
+  if (gpu_driven) {
+    for (const auto& group : groups) {
+      prepare_material(group.key, group.static_mesh, group.submesh_index);
+    }
+  } else {
+    for (const auto& batch : batches) {
+      prepare_material(batch.key, batch.static_mesh, batch.submesh_index);
     }
   }
 
-  for (const auto& [key, command] : get_renderer().draw_commands) {
-    ASTUTE_PROFILE_SCOPE("Main geometry draw command");
-    const auto& [mesh, submesh_index, instance_count] = command;
-
+  // Binds what every draw of a material and mesh shares.
+  const auto bind_mesh = [&](StateTrackingRecorder& state,
+                             const CommandKey& key,
+                             const StaticMesh* mesh,
+                             Core::u32 submesh_index) {
     const auto& mesh_asset = mesh->get_mesh_asset();
-    const auto& transform_vertex_buffer =
-      get_renderer()
-        .transform_buffers.at(Core::Application::the().current_frame_index())
-        .transform_buffer;
-    auto offset = get_renderer().mesh_transform_map.at(key).offset;
     const auto& submesh = mesh_asset->get_submeshes().at(submesh_index);
     const auto& material = mesh->get_materials().at(submesh.material_index);
-    auto* material_descriptor_set =
-      material_desc_sets.at(submesh.material_index);
-
-    RendererExtensions::bind_vertex_buffer(
-      command_buffer, mesh_asset->get_vertex_buffer(), 0);
-    RendererExtensions::bind_vertex_buffer(
-      command_buffer, *transform_vertex_buffer, 1, offset);
-    RendererExtensions::bind_index_buffer(command_buffer,
-                                          mesh_asset->get_index_buffer());
-
-    std::array desc_sets{ renderer_desc_set, material_descriptor_set };
-    vkCmdBindDescriptorSets(command_buffer.get_command_buffer(),
-                            main_geometry_pipeline->get_bind_point(),
-                            main_geometry_pipeline->get_layout(),
-                            0,
-                            static_cast<Core::u32>(desc_sets.size()),
-                            desc_sets.data(),
-                            0,
-                            nullptr);
+    const auto& pipeline = *material_pipelines.at(key.material);
+
+    state.bind_pipeline(pipeline);
+    state.bind_vertex_buffer(mesh_asset->get_vertex_buffer(), 0);
+    state.bind_index_buffer(mesh_asset->get_index_buffer());
+
+    std::array desc_sets{ renderer_desc_set,
+                          material_desc_sets.at(key.material) };
+    state.bind_descriptor_sets(pipeline, desc_sets);
 
     if (const auto& push_constant_buffer = material->get_constant_buffer();
         push_constant_buffer) {
-      vkCmdPushConstants(command_buffer.get_command_buffer(),
-                         main_geometry_pipeline->get_layout(),
-                         VK_SHADER_STAGE_ALL,
-                         0,
-                         static_cast<Core::u32>(push_constant_buffer.size()),
-                         push_constant_buffer.raw());
+      state.push_constants(pipeline,
+                           push_constant_buffer.raw(),
+                           push_constant_buffer.size_u32());
     }
+  };
 
-    vkCmdDrawIndexed(command_buffer.get_command_buffer(),
-                     submesh.index_count,
-                     instance_count,
-                     submesh.base_index,
-                     static_cast<Core::i32>(submesh.base_vertex),
-                     0);
-  }
+  const auto& transform_vertex_buffer = get_renderer().get_transform_buffer();
+  const auto transform_offset = get_renderer().get_transform_frame_offset();
+  const auto record_draws = [&](CommandBuffer& buffer, DrawChunk chunk) {
+    // Batches come sorted by material and mesh, so neighbours mostly share
+    // their pipeline, sets and buffers.
+    StateTrackingRecorder state{ buffer };
+    state.bind_vertex_buffer(transform_vertex_buffer, 1, transform_offset);
+    for (const auto& batch : batches.subspan(chunk.begin, chunk.size())) {
+      const auto& [key, mesh, submesh_index, instance_count, first_instance] =
+        batch;
+      bind_mesh(state, key, mesh, submesh_index);
+
+      // The transforms are instance-rate, so the first instance selects the
+      // batch's.
+      const auto& submesh =
+        mesh->get_mesh_asset()->get_submeshes().at(submesh_index);
+      vkCmdDrawIndexed(buffer.get_command_buffer(),
+                       submesh.index_count,
+                       instance_count,
+                       submesh.base_index,
+                       static_cast<Core::i32>(submesh.base_vertex),
+                       first_instance);
+    }
+    add_command_statistics(state.get_statistics());
+  };
 
-  get_renderer().get_2d_renderer().flush(command_buffer);
+  auto& instance_culling = get_renderer().get_instance_culling();
+  const auto record_groups = [&](CommandBuffer& buffer, DrawChunk chunk) {
+    // The commands of a group start at the camera's culled transforms.
+    StateTrackingRecorder state{ buffer };
+    state.bind_vertex_buffer(instance_culling.get_culled_transforms(), 1);
+    for (auto i = chunk.begin; i < chunk.end; i++) {
+      const auto& group = groups[i];
+      bind_mesh(state, group.key, group.static_mesh, group.submesh_index);
+      instance_culling.draw_group(buffer, 0, static_cast<Core::u32>(i));
+    }
+    add_command_statistics(state.get_statistics());
+  };
+
+  recorder->reset();
+  const auto& framebuffer = *main_geometry_framebuffer;
+  const auto draws =
+    gpu_driven ? recorder->record(framebuffer, groups.size(), record_groups)
+               : recorder->record(framebuffer, batches.size(), record_draws);
+  // The lines share the subpass, which only takes secondaries now.
+  const auto lines =
+    recorder->record(framebuffer, 1, [this](CommandBuffer& buffer, DrawChunk) {
+      get_renderer().get_2d_renderer().flush(buffer);
+    });
+  recorder->execute(command_buffer, draws);
+  recorder->execute(command_buffer, lines);
+}
+
+auto
+MainGeometryRenderPass::bind(CommandBuffer& command_buffer) -> void
+{
+  // Pipelines are bound by the secondaries that draw with them.
+  RendererExtensions::begin_renderpass(
+    command_buffer, *get_framebuffer(), false, false);
 }
 
 auto
@@ -149,10 +239,51 @@ MainGeometryRenderPass::destruct_impl() -> void
 auto
 MainGeometryRenderPass::on_resize(const Core::Extent& ext) -> void
 {
-  auto&& [fb, _, pipe, __] = get_data();
+  auto&& [fb, _, __, ___] = get_data();
 
   fb->on_resize(ext);
-  pipe->on_resize(ext);
+}
+
+auto
+MainGeometryRenderPass::collect_pipelines(std::vector<IPipeline*>& pipelines)
+  -> void
+{
+  RenderPass::collect_pipelines(pipelines);
+  for (const auto& [shader, pipeline] : variant_pipelines) {
+    pipelines.push_back(pipeline.get());
+  }
+}
+
+auto
+MainGeometryRenderPass::declare(RenderGraph& graph, const std::string& name)
+  -> void
+{
+  const auto& predepth = get_renderer().get_render_pass("Predepth");
+  const auto& shadow = get_renderer().get_render_pass("Shadow");
+  const auto pass = add_framebuffer_pass(graph, name);
+  if (get_renderer().get_technique() == RendererTechnique::GPUDriven) {
+    graph.read(pass,
+               graph.add_buffer("InstanceCulling.Draws"),
+               RenderGraph::indirect_arguments);
+  }
+  graph.read(pass,
+             graph.add_image("Predepth.Depth",
+                             predepth.get_depth_attachment().get(),
+                             VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL),
+             RenderGraph::depth_test);
+  graph.read(pass,
+             graph.add_image("Shadow.Depth",
+                             shadow.get_depth_attachment().get(),
+                             VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL),
+             RenderGraph::sampled_in_fragment);
+  // Cleared every frame and only read by the deferred pass.
+  for (auto i = 0U; i < gbuffer_names.size(); i++) {
+    auto& image = *get_colour_attachment(i);
+    const auto resource = graph.add_image(
+      gbuffer_names.at(i), &image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    graph.write(pass, resource, RenderGraph::colour_attachment);
+    set_transient(graph, resource, image);
+  }
 }
 
 } // namespace Engine::Graphics
@@ -11,6 +11,7 @@
 #include "graphics/Shader.hpp"
 
 #include "graphics/RendererExtensions.hpp"
+#include "graphics/render_passes/InstanceCulling.hpp"
 
 namespace Engine::Graphics {
 
@@ -82,9 +83,26 @@ PredepthRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
                     0.0F,
                     depth_bias_slope);
 
-  for (const auto& [key, command] : get_renderer().draw_commands) {
+  if (get_renderer().technique == RendererTechnique::GPUDriven) {
+    // The camera's commands, against the culled transforms.
+    auto& instance_culling = get_renderer().get_instance_culling();
+    StateTrackingRecorder state{ command_buffer };
+    state.bind_vertex_buffer(instance_culling.get_culled_transforms(), 1);
+    const auto groups = get_renderer().indirect_draws.get_groups();
+    for (auto i = 0U; i < groups.size(); i++) {
+      const auto& mesh_asset = groups[i].static_mesh->get_mesh_asset();
+      state.bind_vertex_buffer(mesh_asset->get_vertex_buffer(), 0);
+      state.bind_index_buffer(mesh_asset->get_index_buffer());
+      instance_culling.draw_group(command_buffer, 0, i);
+    }
+    add_command_statistics(state.get_statistics());
+    return;
+  }
+
+  for (const auto& batch : get_renderer().draw_list.get_batches()) {
     ASTUTE_PROFILE_SCOPE("Predepth Draw Command");
-    const auto& [mesh, submesh_index, instance_count] = command;
+    const auto& [key, mesh, submesh_index, instance_count, first_instance] =
+      batch;
 
     const auto& mesh_asset = mesh->get_mesh_asset();
     auto vertex_buffers =
@@ -96,12 +114,8 @@ PredepthRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
                            vertex_buffers.data(),
                            offsets.data());
 
-    const auto& transform_vertex_buffer =
-      get_renderer()
-        .transform_buffers.at(Core::Application::the().current_frame_index())
-        .transform_buffer;
-    auto* vb = transform_vertex_buffer->get_buffer();
-    auto offset = get_renderer().mesh_transform_map.at(key).offset;
+    auto* vb = get_renderer().get_transform_buffer().get_buffer();
+    auto offset = get_renderer().get_transform_offset(batch);
     const auto& submesh = mesh_asset->get_submeshes().at(submesh_index);
 
     offsets = std::array{ VkDeviceSize{ offset } };
@@ -130,10 +144,25 @@ PredepthRenderPass::destruct_impl() -> void
 auto
 PredepthRenderPass::on_resize(const Core::Extent& ext) -> void
 {
-  auto&& [fb, _, pipe, __] = get_data();
+  auto&& [fb, _, __, ___] = get_data();
 
   fb->on_resize(ext);
-  pipe->on_resize(ext);
+}
+
+auto
+PredepthRenderPass::declare(RenderGraph& graph, const std::string& name) -> void
+{
+  const auto pass = add_framebuffer_pass(graph, name);
+  if (get_renderer().get_technique() == RendererTechnique::GPUDriven) {
+    graph.read(pass,
+               graph.add_buffer("InstanceCulling.Draws"),
+               RenderGraph::indirect_arguments);
+  }
+  graph.write(pass,
+              graph.add_image("Predepth.Depth",
+                              get_depth_attachment().get(),
+                              VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL),
+              RenderGraph::depth_attachment);
 }
 
 } // namespace Engine::Graphics
@@ -14,6 +14,7 @@
 
 #include "graphics/GraphicsPipeline.hpp"
 
+#include "graphics/render_passes/InstanceCulling.hpp"
 #include "graphics/render_passes/Shadow.hpp"
 
 namespace Engine::Graphics {
@@ -77,6 +78,8 @@ ShadowRenderPass::construct_impl() -> void
         }, },
       }));
   }
+  recorder = Core::make_scope<SecondaryCommandRecorder>(
+    Renderer::get_thread_pool());
 }
 
 auto
@@ -87,72 +90,104 @@ ShadowRenderPass::execute_impl(CommandBuffer& command_buffer) -> void
 
   auto* descriptor_set = generate_and_update_descriptor_write_sets(*material);
 
-  static auto perform_pass = [&](const Core::DataBuffer& cascade_buffer,
-                                 const IPipeline& pipeline) {
-    for (const auto& [key, command] : get_renderer().shadow_draw_commands) {
-      const auto& [mesh, submesh_index, instance_count] = command;
+  const auto& transform_vertex_buffer = get_renderer().get_transform_buffer();
+  const auto transform_offset = get_renderer().get_transform_frame_offset();
+  const auto record_cascade = [&](Core::u32 cascade,
+                                  std::span<const DrawBatch> batches,
+                                  const IPipeline& pipeline,
+                                  CommandBuffer& buffer) {
+    // Pipeline, set and cascade index hold for the whole chunk; only the
+    // meshes change, and neighbouring batches often share one.
+    StateTrackingRecorder state{ buffer };
+    state.bind_pipeline(pipeline);
+    state.bind_descriptor_sets(pipeline, std::span{ &descriptor_set, 1 });
+    state.push_constants(pipeline, &cascade, sizeof(cascade));
+    state.bind_vertex_buffer(transform_vertex_buffer, 1, transform_offset);
+
+    for (const auto& batch : batches) {
+      const auto& [key, mesh, submesh_index, instance_count, first_instance] =
+        batch;
 
       const auto& mesh_asset = mesh->get_mesh_asset();
-      auto vertex_buffers =
-        std::array{ mesh_asset->get_vertex_buffer().get_buffer() };
-      auto offsets = std::array<VkDeviceSize, 1>{ 0 };
-      vkCmdBindVertexBuffers(command_buffer.get_command_buffer(),
-                             0,
-                             1,
-                             vertex_buffers.data(),
-                             offsets.data());
-
-      const auto& transform_vertex_buffer =
-        get_renderer()
-          .transform_buffers.at(Core::Application::the().current_frame_index())
-          .transform_buffer;
-      auto* vb = transform_vertex_buffer->get_buffer();
-      auto offset = get_renderer().mesh_transform_map.at(key).offset;
       const auto& submesh = mesh_asset->get_submeshes().at(submesh_index);
+      state.bind_vertex_buffer(mesh_asset->get_vertex_buffer(), 0);
+      state.bind_index_buffer(mesh_asset->get_index_buffer());
 
-      offsets = std::array{ VkDeviceSize{ offset } };
-      vkCmdBindDescriptorSets(command_buffer.get_command_buffer(),
-                              pipeline.get_bind_point(),
-                              pipeline.get_layout(),
-                              0,
-                              1,
-                              &descriptor_set,
-                              0,
-                              nullptr);
-      vkCmdPushConstants(command_buffer.get_command_buffer(),
-                         pipeline.get_layout(),
-                         VK_SHADER_STAGE_ALL,
-                         0,
-                         cascade_buffer.size_u32(),
-                         cascade_buffer.raw());
-
-      vkCmdBindVertexBuffers(
-        command_buffer.get_command_buffer(), 1, 1, &vb, offsets.data());
-
-      vkCmdBindIndexBuffer(command_buffer.get_command_buffer(),
-                           mesh_asset->get_index_buffer().get_buffer(),
-                           0,
-                           VK_INDEX_TYPE_UINT32);
-
-      vkCmdDrawIndexed(command_buffer.get_command_buffer(),
+      // The transforms are instance-rate, so the first instance selects the
+      // batch's.
+      vkCmdDrawIndexed(buffer.get_command_buffer(),
                        submesh.index_count,
                        instance_count,
                        submesh.base_index,
                        static_cast<Core::i32>(submesh.base_vertex),
-                       0);
+                       first_instance);
     }
+    add_command_statistics(state.get_statistics());
   };
 
-  static Core::DataBuffer current_cascade_buffer{ sizeof(Core::u32) };
-  current_cascade_buffer.fill_zero();
-  for (const auto i : std::views::iota(0ULL, other_framebuffers.size())) {
+  auto& instance_culling = get_renderer().get_instance_culling();
+  const auto groups = get_renderer().indirect_draws.get_groups();
+  const auto record_cascade_groups = [&](Core::u32 cascade,
+                                         DrawChunk chunk,
+                                         const IPipeline& pipeline,
+                                         CommandBuffer& buffer) {
+    // The commands of cascade i are view i + 1 of the culling.
+    StateTrackingRecorder state{ buffer };
+    state.bind_pipeline(pipeline);
+    state.bind_descriptor_sets(pipeline, std::span{ &descriptor_set, 1 });
+    state.push_constants(pipeline, &cascade, sizeof(cascade));
+    state.bind_vertex_buffer(instance_culling.get_culled_transforms(), 1);
+
+    for (auto i = chunk.begin; i < chunk.end; i++) {
+      const auto& mesh_asset = groups[i].static_mesh->get_mesh_asset();
+      state.bind_vertex_buffer(mesh_asset->get_vertex_buffer(), 0);
+      state.bind_index_buffer(mesh_asset->get_index_buffer());
+      instance_culling.draw_group(
+        buffer, cascade + 1, static_cast<Core::u32>(i));
+    }
+    add_command_statistics(state.get_statistics());
+  };
+  const auto gpu_driven =
+    get_renderer().technique == RendererTechnique::GPUDriven;
+
+  // Every cascade's chunks record at once; the cascades' render passes then
+  // run one after the other.
+  const auto cascade_count =
+    static_cast<Core::u32>(other_framebuffers.size());
+  recorder->reset();
+  std::vector<Core::u32> recordings;
+  recordings.reserve(cascade_count);
+  for (const auto i : std::views::iota(0U, cascade_count)) {
+    const auto& pipeline = *other_pipelines.at(i);
+    if (gpu_driven) {
+      recordings.push_back(recorder->record(
+        *other_framebuffers.at(i),
+        groups.size(),
+        [&record_cascade_groups, i, &pipeline](CommandBuffer& buffer,
+                                               DrawChunk chunk) {
+          record_cascade_groups(i, chunk, pipeline, buffer);
+        }));
+      continue;
+    }
+
+    // Only the instances the culling stage found inside this cascade.
+    const auto batches = get_renderer().shadow_draw_list.get_batches(i);
+    recordings.push_back(recorder->record(
+      *other_framebuffers.at(i),
+      batches.size(),
+      [&record_cascade, i, batches, &pipeline](CommandBuffer& buffer,
+                                               DrawChunk chunk) {
+        record_cascade(
+          i, batches.subspan(chunk.begin, chunk.size()), pipeline, buffer);
+      }));
+  }
+
+  for (const auto i : std::views::iota(0U, cascade_count)) {
     ASTUTE_PROFILE_SCOPE("Shadow Render Pass Cascade Number: " +
                          std::to_string(i));
-    current_cascade_buffer.write(&i, sizeof(Core::u32));
-    RendererExtensions::begin_renderpass(command_buffer,
-                                         *other_framebuffers.at(i));
-    RendererExtensions::bind_pipeline(command_buffer, *other_pipelines.at(i));
-    perform_pass(current_cascade_buffer, *other_pipelines.at(i));
+    RendererExtensions::begin_renderpass(
+      command_buffer, *other_framebuffers.at(i), false, false);
+    recorder->execute(command_buffer, recordings.at(i));
     RendererExtensions::end_renderpass(command_buffer);
   }
 }
@@ -163,10 +198,31 @@ ShadowRenderPass::on_resize(const Core::Extent& ext) -> void
   for (const auto& other : other_framebuffers) {
     other->on_resize(ext);
   }
+}
 
+auto
+ShadowRenderPass::collect_pipelines(std::vector<IPipeline*>& pipelines)
+  -> void
+{
   for (const auto& other : other_pipelines) {
-    other->on_resize(ext);
+    pipelines.push_back(other.get());
+  }
+}
+
+auto
+ShadowRenderPass::declare(RenderGraph& graph, const std::string& name) -> void
+{
+  const auto pass = add_framebuffer_pass(graph, name);
+  if (get_renderer().get_technique() == RendererTechnique::GPUDriven) {
+    graph.read(pass,
+               graph.add_buffer("InstanceCulling.Draws"),
+               RenderGraph::indirect_arguments);
   }
+  graph.write(pass,
+              graph.add_image("Shadow.Depth",
+                              get_depth_attachment().get(),
+                              VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL),
+              RenderGraph::depth_attachment);
 }
 
 } // namespace Engine::Graphics
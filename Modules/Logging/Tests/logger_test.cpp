@@ -0,0 +1,260 @@
+#include <logging/Logger.hpp>
+#include <logging/MessageRing.hpp>
+
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ED::Logging;
+
+namespace {
+auto
+temporary_path(const char* name) -> std::string
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+auto
+read_lines(const std::string& path) -> std::vector<std::string>
+{
+  std::ifstream file{ path };
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(file, line);) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+auto
+push_text(MessageRing& ring, std::string_view text) -> bool
+{
+  return ring.try_push([&](LogMessage& message) {
+    std::copy(text.begin(), text.end(), message.text.begin());
+    message.length = static_cast<std::uint32_t>(text.size());
+  });
+}
+}
+
+TEST(MessageRingTest, PopsInOrderAndReportsFull)
+{
+  MessageRing ring{ 3 };
+  ASSERT_EQ(ring.capacity(), 4U);
+
+  for (const auto* text : { "a", "b", "c", "d" }) {
+    EXPECT_TRUE(push_text(ring, text));
+  }
+  EXPECT_FALSE(push_text(ring, "e"));
+
+  std::string popped;
+  const auto pop = [&](const LogMessage& message) {
+    popped.append(message.text.data(), message.length);
+  };
+  EXPECT_TRUE(ring.try_pop(pop));
+  EXPECT_TRUE(push_text(ring, "e"));
+  while (ring.try_pop(pop)) {
+  }
+  EXPECT_EQ(popped, "abcde");
+}
+
+TEST(MessageRingTest, KeepsEveryProducersOrder)
+{
+  static constexpr std::uint32_t producer_count = 4;
+  static constexpr std::uint32_t per_producer = 2000;
+  MessageRing ring{ 64 };
+
+  std::vector<std::jthread> producers;
+  for (std::uint32_t producer = 0; producer < producer_count; producer++) {
+    producers.emplace_back([&ring, producer]() {
+      for (std::uint32_t i = 0; i < per_producer; i++) {
+        while (!ring.try_push([&](LogMessage& message) {
+          message.length = producer;
+          std::memcpy(message.text.data(), &i, sizeof(i));
+        })) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::array<std::uint32_t, producer_count> next{};
+  std::uint32_t received = 0;
+  bool ordered = true;
+  while (received < producer_count * per_producer) {
+    ring.try_pop([&](const LogMessage& message) {
+      std::uint32_t value{};
+      std::memcpy(&value, message.text.data(), sizeof(value));
+      ordered = ordered && value == next.at(message.length);
+      next.at(message.length) = value + 1;
+      received++;
+    });
+  }
+  EXPECT_TRUE(ordered);
+  for (const auto count : next) {
+    EXPECT_EQ(count, per_producer);
+  }
+}
+
+TEST(LoggerTest, WritesEveryMessageToTheFile)
+{
+  const auto path = temporary_path("logger_test_messages.log");
+  {
+    Logger logger{ {
+      .level = LogLevel::Trace,
+      .file_path = path,
+      .capacity = 16,
+    } };
+    for (auto i = 0; i < 1000; i++) {
+      logger.info("Message {}", i);
+    }
+    logger.trace("Hidden by nothing");
+    logger.log(std::string(LogMessage::text_capacity + 10, 'x'),
+               LogLevel::Error);
+    EXPECT_EQ(logger.get_dropped_count(), 0U);
+  }
+
+  const auto lines = read_lines(path);
+  ASSERT_EQ(lines.size(), 1002U);
+  EXPECT_NE(lines[0].find("[INFO] Message 0"), std::string::npos);
+  EXPECT_NE(lines[999].find("[INFO] Message 999"), std::string::npos);
+  EXPECT_NE(lines[1000].find("[TRACE] Hidden by nothing"), std::string::npos);
+  // Cut to the slot size and marked as truncated.
+  EXPECT_NE(lines[1001].find(std::string(LogMessage::text_capacity, 'x') +
+                             "..."),
+            std::string::npos);
+  EXPECT_EQ(lines[1001].find(std::string(LogMessage::text_capacity + 1, 'x')),
+            std::string::npos);
+  std::filesystem::remove(path);
+}
+
+TEST(LoggerTest, CountPolicyReportsDroppedMessages)
+{
+  const auto path = temporary_path("logger_test_dropped.log");
+  std::uint64_t dropped = 0;
+  {
+    Logger logger{ {
+      .level = LogLevel::Info,
+      .overflow_policy = OverflowPolicy::Count,
+      .file_path = path,
+      .capacity = 2,
+    } };
+    for (auto i = 0; i < 20000; i++) {
+      logger.info("Message {}", i);
+    }
+    dropped = logger.get_dropped_count();
+  }
+
+  const auto lines = read_lines(path);
+  std::uint64_t written = 0;
+  std::uint64_t reported = 0;
+  for (const auto& line : lines) {
+    if (line.find("[INFO] Message") != std::string::npos) {
+      written++;
+    } else if (const auto at = line.find("Dropped "); at != std::string::npos) {
+      reported += std::stoull(line.substr(at + 8));
+    }
+  }
+  EXPECT_EQ(written + dropped, 20000U);
+  EXPECT_EQ(reported, dropped);
+  std::filesystem::remove(path);
+}
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+TEST(LoggerBenchmark, ThroughputAgainstMutexQueue)
+{
+  static constexpr std::array<std::uint32_t, 3> thread_counts{ 1, 4, 16 };
+  static constexpr std::uint32_t message_count = 400000;
+  const auto path = temporary_path("logger_benchmark.log");
+
+  using clock = std::chrono::high_resolution_clock;
+  const auto millis = [](auto duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  };
+  const auto run_producers = [](std::uint32_t thread_count, auto&& produce) {
+    std::vector<std::jthread> producers;
+    for (std::uint32_t thread = 0; thread < thread_count; thread++) {
+      producers.emplace_back([&produce, thread, thread_count]() {
+        for (auto i = thread; i < message_count; i += thread_count) {
+          produce(i);
+        }
+      });
+    }
+  };
+
+  std::stringstream csv_output;
+  csv_output << "Threads,Messages,MutexQueue(ms),Ring(ms),"
+                "MutexQueue(Mmsg/s),Ring(Mmsg/s)\n";
+  for (const auto thread_count : thread_counts) {
+    // The previous design: a locked std::queue of formatted strings, written
+    // one stream insertion at a time while holding the lock.
+    const auto mutex_start = clock::now();
+    {
+      std::ofstream file{ path };
+      std::queue<std::string> queue;
+      std::mutex mutex;
+      std::condition_variable cv;
+      bool done = false;
+      std::jthread writer([&]() {
+        std::unique_lock lock(mutex);
+        for (;;) {
+          cv.wait(lock, [&] { return !queue.empty() || done; });
+          while (!queue.empty()) {
+            file << "[INFO] " << queue.front() << "\n";
+            queue.pop();
+          }
+          if (done) {
+            break;
+          }
+        }
+      });
+      run_producers(thread_count, [&](std::uint32_t i) {
+        auto message = std::format("Message {} from the benchmark", i);
+        std::lock_guard lock(mutex);
+        queue.emplace(std::move(message));
+        cv.notify_one();
+      });
+      {
+        std::lock_guard lock(mutex);
+        done = true;
+      }
+      cv.notify_one();
+    }
+    const auto mutex_ms = millis(clock::now() - mutex_start);
+
+    const auto ring_start = clock::now();
+    {
+      Logger logger{ {
+        .level = LogLevel::Info,
+        .file_path = path,
+      } };
+      run_producers(thread_count, [&](std::uint32_t i) {
+        logger.info("Message {} from the benchmark", i);
+      });
+    }
+    const auto ring_ms = millis(clock::now() - ring_start);
+    EXPECT_EQ(read_lines(path).size(), message_count);
+
+    csv_output << thread_count << "," << message_count << "," << mutex_ms
+               << "," << ring_ms << "," << message_count / mutex_ms / 1000.0
+               << "," << message_count / ring_ms / 1000.0 << "\n";
+  }
+  std::filesystem::remove(path);
+  std::cout << csv_output.str();
+
+  std::ofstream csv_file("logger_benchmark_results.csv");
+  if (csv_file.is_open()) {
+    csv_file << csv_output.str();
+    csv_file.close();
+  } else {
+    std::cerr << "Failed to open file for writing CSV results." << std::endl;
+  }
+}
+#endif
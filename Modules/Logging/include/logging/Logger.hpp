@@ -1,40 +1,48 @@
 #pragma once
 
+#include "logging/MessageRing.hpp"
+
 #include <atomic>
-#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <format>
-#include <mutex>
-#include <queue>
 #include <string>
+#include <string_view>
 #include <thread>
 
 namespace ED::Logging {
 
-enum class LogLevel
-{
-  Trace,
-  Debug,
-  Info,
-  Warn,
-  Error,
-  None // To disable logging
-};
-
-struct BackgroundLogMessage
+/// What logging does when the message ring is full.
+enum class OverflowPolicy
 {
-  std::string message;
-  LogLevel level{ LogLevel::None };
+  Block, // Wait for the writer thread to free a slot
+  Drop,  // Discard the message
+  Count, // Discard the message, and log how many were discarded
 };
 
 class Logger
 {
 public:
+  struct Configuration
+  {
+    const LogLevel level{ LogLevel::Info };
+    const OverflowPolicy overflow_policy{ OverflowPolicy::Block };
+    // Messages go to the console when empty.
+    const std::string file_path{};
+    const std::size_t capacity{ 2048 };
+  };
+
+  /// Most code logs through the instance, configured from the LOG_LEVEL and
+  /// LOG_FILE environment variables. Separate loggers are for tests.
+  explicit Logger(const Configuration&);
   static auto get_instance() -> Logger&;
   static auto stop() -> void;
   ~Logger();
 
   auto set_level(LogLevel level) -> void;
   auto get_level() const -> LogLevel;
+  auto set_overflow_policy(OverflowPolicy policy) -> void;
+  auto get_dropped_count() const -> std::uint64_t;
 
   Logger(const Logger&) = delete;
   Logger& operator=(const Logger&) = delete;
@@ -54,23 +62,60 @@ public:
   template<typename... Args>
   void error(std::format_string<Args...> format, Args&&... args) noexcept;
 
-  void log(std::string&& message, LogLevel level);
+  void log(std::string_view message, LogLevel level);
 
 private:
   Logger();
 
+  /// Formats straight into a ring slot on the calling thread.
+  template<typename... Args>
+  void push(LogLevel level,
+            std::format_string<Args...> format,
+            Args&&... args) noexcept;
+  template<class Writer>
+  void enqueue(Writer&& write) noexcept
+  {
+    for (;;) {
+      // Read before trying, so a slot freed after the attempt ends the wait.
+      const auto freed = consumed.load();
+      if (ring.try_push(write)) {
+        publish();
+        return;
+      }
+      if (!on_full(freed)) {
+        return;
+      }
+    }
+  }
+  auto on_full(std::uint32_t freed) -> bool;
+  auto publish() -> void;
+
   void stop_all();
-  void process_queue(const std::stop_token&);
+  void process_queue();
 
-  LogLevel current_level{ LogLevel::None };
-  static void process_single(const BackgroundLogMessage& message);
+  void append(std::string& batch, const LogMessage& message) const;
+  auto write(std::string& batch) -> void;
   static LogLevel get_log_level_from_environment();
 
-  std::queue<BackgroundLogMessage> log_queue;
-  std::mutex queue_mutex;
-  std::condition_variable cv;
+  LogLevel current_level{ LogLevel::None };
+  std::atomic<OverflowPolicy> overflow_policy{ OverflowPolicy::Block };
+
+  MessageRing ring;
+  std::FILE* sink{ nullptr };
+  bool owns_sink{ false };
+
+  // Bumped after every push, for the writer thread to wait on. Producers
+  // only notify a writer that is waiting, which keeps the wake-up call off
+  // the logging path while it is busy.
+  std::atomic<std::uint32_t> published{ 0 };
+  std::atomic_bool writer_waiting{ false };
+  // Bumped whenever the writer thread frees slots, for blocked producers.
+  std::atomic<std::uint32_t> consumed{ 0 };
+  std::atomic<std::uint32_t> blocked_producers{ 0 };
+  std::atomic<std::uint64_t> dropped{ 0 };
+  std::atomic<std::uint64_t> unreported_drops{ 0 };
+  std::atomic_bool exit_flag{ false };
   std::jthread worker;
-  std::atomic_bool exit_flag;
 };
 
 }
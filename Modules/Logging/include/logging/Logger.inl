@@ -11,7 +11,7 @@ Logger::trace(std::format_string<Args...> format, Args&&... args) noexcept
 {
   if (current_level > LogLevel::Trace)
     return;
-  log(std::format(format, std::forward<Args>(args)...), LogLevel::Trace);
+  push(LogLevel::Trace, format, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
@@ -20,7 +20,7 @@ Logger::debug(std::format_string<Args...> format, Args&&... args) noexcept
 {
   if (current_level > LogLevel::Debug)
     return;
-  log(std::format(format, std::forward<Args>(args)...), LogLevel::Debug);
+  push(LogLevel::Debug, format, std::forward<Args>(args)...);
 }
 
 #else
@@ -38,27 +38,48 @@ Logger::debug(std::format_string<Args...> format, Args&&... args) noexcept
 
 #endif
 
+template<typename... Args>
+void
+Logger::push(LogLevel level,
+             std::format_string<Args...> format,
+             Args&&... args) noexcept
+{
+  // Only called once a slot is claimed, so the arguments are forwarded once.
+  const auto write = [&](LogMessage& message) {
+    const auto result = std::format_to_n(message.text.data(),
+                                         LogMessage::text_capacity,
+                                         format,
+                                         std::forward<Args>(args)...);
+    message.level = level;
+    message.length =
+      static_cast<std::uint32_t>(result.out - message.text.data());
+    message.truncated =
+      result.size > static_cast<std::ptrdiff_t>(LogMessage::text_capacity);
+  };
+  enqueue(write);
+}
+
 template<typename... Args>
 void
 Logger::info(std::format_string<Args...> format, Args&&... args) noexcept
 {
   if (current_level > LogLevel::Info)
     return;
-  log(std::format(format, std::forward<Args>(args)...), LogLevel::Info);
+  push(LogLevel::Info, format, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 void
 Logger::warn(std::format_string<Args...> format, Args&&... args) noexcept
 {
-  log(std::format(format, std::forward<Args>(args)...), LogLevel::Warn);
+  push(LogLevel::Warn, format, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 void
 Logger::error(std::format_string<Args...> format, Args&&... args) noexcept
 {
-  log(std::format(format, std::forward<Args>(args)...), LogLevel::Error);
+  push(LogLevel::Error, format, std::forward<Args>(args)...);
 }
 
-} // namespace Core
+} // namespace ED::Logging
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ED::Logging {
+
+enum class LogLevel
+{
+  Trace,
+  Debug,
+  Info,
+  Warn,
+  Error,
+  None // To disable logging
+};
+
+/// A message formatted in place by the thread that logged it. Messages
+/// longer than the slot are cut short and marked as truncated.
+struct alignas(64) LogMessage
+{
+  static constexpr std::size_t text_capacity = 1008;
+
+  std::atomic<std::size_t> sequence{ 0 };
+  LogLevel level{ LogLevel::None };
+  std::uint32_t length{ 0 };
+  bool truncated{ false };
+  std::array<char, text_capacity> text{};
+};
+
+/// A bounded multi-producer, single-consumer ring of preallocated messages.
+/// Each slot carries a sequence number that tells producers and the consumer
+/// whose turn it is, so neither side takes a lock or allocates.
+class MessageRing
+{
+public:
+  /// The capacity is rounded up to a power of two.
+  explicit MessageRing(std::size_t capacity)
+    : mask(std::bit_ceil(capacity < 2 ? 2 : capacity) - 1)
+    , slots(std::make_unique<LogMessage[]>(mask + 1))
+  {
+    for (std::size_t i = 0; i <= mask; i++) {
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] auto capacity() const -> std::size_t { return mask + 1; }
+
+  /// Claims a slot and fills it with `write`. Returns false, without
+  /// calling `write`, if the ring is full. Safe from any number of threads.
+  template<class Writer>
+  auto try_push(Writer&& write) -> bool
+  {
+    auto position = enqueue_position.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& slot = slots[position & mask];
+      const auto sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::ptrdiff_t>(sequence) -
+                              static_cast<std::ptrdiff_t>(position);
+      if (difference == 0) {
+        if (enqueue_position.compare_exchange_weak(
+              position, position + 1, std::memory_order_relaxed)) {
+          write(slot);
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = enqueue_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Hands the oldest published message to `read` and frees its slot.
+  /// Returns false if there is none. Only one thread may pop.
+  template<class Reader>
+  auto try_pop(Reader&& read) -> bool
+  {
+    auto& slot = slots[dequeue_position & mask];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeue_position + 1) {
+      return false;
+    }
+    read(static_cast<const LogMessage&>(slot));
+    slot.sequence.store(dequeue_position + mask + 1, std::memory_order_release);
+    dequeue_position++;
+    return true;
+  }
+
+private:
+  const std::size_t mask;
+  std::unique_ptr<LogMessage[]> slots;
+  alignas(64) std::atomic<std::size_t> enqueue_position{ 0 };
+  alignas(64) std::size_t dequeue_position{ 0 };
+};
+
+} // namespace ED::Logging
@@ -3,7 +3,9 @@
 #include "logging/Logger.hpp"
 #include "platform/Platform.hpp"
 
+#include <algorithm>
 #include <cctype>
+#include <cstdio>
 #include <cstdlib>
 #include <iostream>
 #include <string_view>
@@ -11,11 +13,48 @@
 
 namespace ED::Logging {
 
+namespace AnsiColor {
+using namespace std::string_view_literals;
+static constexpr auto Reset = "\033[0m"sv;
+static constexpr auto Red = "\033[31m"sv;     // Error
+static constexpr auto Green = "\033[32m"sv;   // Info
+static constexpr auto Yellow = "\033[33m"sv;  // Debug
+static constexpr auto Blue = "\033[34m"sv;    // Trace
+static constexpr auto Magenta = "\033[95m"sv; // Warn
+} // namespace AnsiColor
+
+namespace {
+// Lines are gathered into one buffer and written with a single call, rather
+// than one stream insertion per line.
+constexpr std::size_t batch_bytes = 64ULL * 1024ULL;
+}
+
 Logger::Logger()
-  : current_level(get_log_level_from_environment())
+  : Logger(Configuration{
+      .level = get_log_level_from_environment(),
+      .file_path = Platform::get_environment_variable("LOG_FILE"),
+    })
+{
+}
+
+Logger::Logger(const Configuration& configuration)
+  : current_level(configuration.level)
+  , overflow_policy(configuration.overflow_policy)
+  , ring(configuration.capacity)
+  , sink(stdout)
 {
-  worker = std::jthread(
-    [this](const std::stop_token& stop_token) { process_queue(stop_token); });
+  if (!configuration.file_path.empty()) {
+    if (auto* file = std::fopen(configuration.file_path.c_str(), "w");
+        file != nullptr) {
+      sink = file;
+      owns_sink = true;
+    } else {
+      std::cerr << "Could not open log file '" << configuration.file_path
+                << "', logging to the console.\n";
+    }
+  }
+
+  worker = std::jthread([this]() { process_queue(); });
 }
 
 Logger&
@@ -34,86 +73,172 @@ Logger::stop()
 Logger::~Logger()
 {
   stop_all();
+  if (owns_sink) {
+    std::fclose(sink);
+  }
 }
 
 void
 Logger::stop_all()
 {
   // If the worker thread is already stopped, return
-  if (exit_flag) {
+  if (exit_flag.exchange(true)) {
     return;
   }
 
-  exit_flag = true;
-  cv.notify_one();
+  publish();
   worker.join();
 }
 
 void
-Logger::log(std::string&& message, LogLevel level)
+Logger::log(std::string_view message, LogLevel level)
 {
-  std::lock_guard lock(queue_mutex);
-  log_queue.emplace(std::move(message), level);
-  cv.notify_one();
+  const auto write = [&](LogMessage& slot) {
+    const auto length = std::min(message.size(), LogMessage::text_capacity);
+    std::copy_n(message.data(), length, slot.text.data());
+    slot.level = level;
+    slot.length = static_cast<std::uint32_t>(length);
+    slot.truncated = length < message.size();
+  };
+  enqueue(write);
+}
+
+auto
+Logger::on_full(std::uint32_t freed) -> bool
+{
+  const auto policy = overflow_policy.load(std::memory_order_relaxed);
+  // Nothing frees slots once the writer thread has stopped.
+  if (policy == OverflowPolicy::Block && !exit_flag.load()) {
+    blocked_producers.fetch_add(1);
+    consumed.wait(freed);
+    blocked_producers.fetch_sub(1);
+    return true;
+  }
+
+  dropped.fetch_add(1, std::memory_order_relaxed);
+  if (policy == OverflowPolicy::Count) {
+    unreported_drops.fetch_add(1, std::memory_order_relaxed);
+    publish();
+  }
+  return false;
+}
+
+auto
+Logger::publish() -> void
+{
+  published.fetch_add(1);
+  // One wake-up per wait: the first producer to see the flag clears it.
+  if (writer_waiting.load() && writer_waiting.exchange(false)) {
+    published.notify_one();
+  }
 }
 
 void
-Logger::process_queue(const std::stop_token& stop_token)
+Logger::process_queue()
 {
-  while (!stop_token.stop_requested()) {
-    std::unique_lock lock(queue_mutex);
-    cv.wait(lock, [this] { return !log_queue.empty() || exit_flag; });
+  std::string batch;
+  batch.reserve(batch_bytes + LogMessage::text_capacity + 64);
 
-    if (exit_flag && log_queue.empty()) {
-      break;
+  const auto append_message = [this, &batch](const LogMessage& message) {
+    append(batch, message);
+  };
+
+  for (;;) {
+    // Read before draining, so a push made while draining ends the wait.
+    const auto seen = published.load(std::memory_order_acquire);
+    const auto exiting = exit_flag.load(std::memory_order_acquire);
+
+    bool freed_slots = false;
+    while (ring.try_pop(append_message)) {
+      freed_slots = true;
+      if (batch.size() >= batch_bytes) {
+        write(batch);
+      }
     }
+    if (freed_slots) {
+      consumed.fetch_add(1);
+      if (blocked_producers.load() > 0) {
+        consumed.notify_all();
+      }
+    }
+
+    if (const auto count = unreported_drops.exchange(0); count > 0) {
+      batch += std::format("{}[WARN] Dropped {} log messages, the queue was "
+                           "full{}\n",
+                           owns_sink ? "" : AnsiColor::Magenta,
+                           count,
+                           owns_sink ? "" : AnsiColor::Reset);
+    }
+    write(batch);
 
-    while (!log_queue.empty()) {
-      auto&& log_message = log_queue.front();
-      process_single(log_message);
-      log_queue.pop();
+    if (exiting) {
+      break;
+    }
+    // Either a producer sees the flag and notifies, or the load below sees
+    // its push, so no wake-up is lost.
+    writer_waiting.store(true);
+    if (published.load() == seen) {
+      published.wait(seen);
     }
+    writer_waiting.store(false);
   }
 }
 
-namespace AnsiColor {
-using namespace std::string_view_literals;
-static constexpr auto Reset = "\033[0m"sv;
-static constexpr auto Red = "\033[31m"sv;     // Error
-static constexpr auto Green = "\033[32m"sv;   // Info
-static constexpr auto Yellow = "\033[33m"sv;  // Debug
-static constexpr auto Blue = "\033[34m"sv;    // Trace
-static constexpr auto Magenta = "\033[95m"sv; // Warn
-} // namespace AnsiColor
-
 void
-Logger::process_single(const BackgroundLogMessage& message)
+Logger::append(std::string& batch, const LogMessage& message) const
 {
+  std::string_view colour;
+  std::string_view label;
   switch (message.level) {
     using enum ED::Logging::LogLevel;
     case Trace:
-      std::cout << AnsiColor::Blue << "[TRACE] " << message.message
-                << AnsiColor::Reset << "\n";
+      colour = AnsiColor::Blue;
+      label = "[TRACE] ";
       break;
     case Debug:
-      std::cout << AnsiColor::Yellow << "[DEBUG] " << message.message
-                << AnsiColor::Reset << "\n";
+      colour = AnsiColor::Yellow;
+      label = "[DEBUG] ";
       break;
     case Info:
-      std::cout << AnsiColor::Green << "[INFO] " << message.message
-                << AnsiColor::Reset << "\n";
+      colour = AnsiColor::Green;
+      label = "[INFO] ";
       break;
     case Warn:
-      std::cout << AnsiColor::Magenta << "[WARN] " << message.message
-                << AnsiColor::Reset << "\n";
+      colour = AnsiColor::Magenta;
+      label = "[WARN] ";
       break;
     case Error:
-      std::cout << AnsiColor::Red << "[ERROR] " << message.message
-                << AnsiColor::Reset << "\n";
+      colour = AnsiColor::Red;
+      label = "[ERROR] ";
       break;
     case None:
-      break;
+      return;
+  }
+
+  // Colours are for the console only.
+  if (!owns_sink) {
+    batch += colour;
+  }
+  batch += label;
+  batch.append(message.text.data(), message.length);
+  if (message.truncated) {
+    batch += "...";
+  }
+  if (!owns_sink) {
+    batch += AnsiColor::Reset;
+  }
+  batch += '\n';
+}
+
+auto
+Logger::write(std::string& batch) -> void
+{
+  if (batch.empty()) {
+    return;
   }
+  std::fwrite(batch.data(), 1, batch.size(), sink);
+  std::fflush(sink);
+  batch.clear();
 }
 
 void
@@ -122,6 +247,18 @@ Logger::set_level(LogLevel level)
   current_level = level;
 }
 
+auto
+Logger::set_overflow_policy(OverflowPolicy policy) -> void
+{
+  overflow_policy.store(policy, std::memory_order_relaxed);
+}
+
+auto
+Logger::get_dropped_count() const -> std::uint64_t
+{
+  return dropped.load(std::memory_order_relaxed);
+}
+
 auto
 Logger::get_level() const -> LogLevel
 {
@@ -169,4 +306,4 @@ Logger::get_log_level_from_environment() -> LogLevel
   return LogLevel::Info; // Default log level
 }
 
-} // namespace Core
+} // namespace ED::Logging
@@ -0,0 +1,42 @@
+#include "platform/Platform.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ED::Platform {
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+  const auto file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    return;
+  }
+
+  struct stat file_status = {};
+  if (fstat(file, &file_status) != 0 || file_status.st_size <= 0) {
+    close(file);
+    return;
+  }
+
+  const auto file_size = static_cast<std::size_t>(file_status.st_size);
+  void* view = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file, 0);
+  // The mapping keeps the file open.
+  close(file);
+  if (view == MAP_FAILED) {
+    return;
+  }
+
+  bytes = static_cast<const std::byte*>(view);
+  size = file_size;
+}
+
+MappedFile::~MappedFile()
+{
+  if (bytes != nullptr) {
+    munmap(const_cast<std::byte*>(bytes), size);
+  }
+}
+
+} // namespace ED::Platform
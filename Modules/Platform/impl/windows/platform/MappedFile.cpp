@@ -0,0 +1,55 @@
+#include "platform/Platform.hpp"
+
+#include <Windows.h>
+
+namespace ED::Platform {
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+  HANDLE file = CreateFileW(path.c_str(),
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return;
+  }
+
+  LARGE_INTEGER file_size{};
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+    CloseHandle(file);
+    return;
+  }
+
+  HANDLE mapping =
+    CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  // The mapping keeps the file open.
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    return;
+  }
+
+  const auto* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr) {
+    CloseHandle(mapping);
+    return;
+  }
+
+  bytes = static_cast<const std::byte*>(view);
+  size = static_cast<std::size_t>(file_size.QuadPart);
+  mapping_handle = mapping;
+}
+
+MappedFile::~MappedFile()
+{
+  if (bytes != nullptr) {
+    UnmapViewOfFile(bytes);
+  }
+  if (mapping_handle != nullptr) {
+    CloseHandle(mapping_handle);
+  }
+}
+
+} // namespace ED::Platform
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <filesystem>
+#include <span>
 #include <string>
 #include <string_view>
 
@@ -10,4 +13,28 @@ get_system_name() -> std::string;
 
 auto get_environment_variable(std::string_view) -> std::string;
 
+/// A read-only memory mapping of a whole file. Empty if the file could not be
+/// opened or mapped, or has no contents.
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::filesystem::path&);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+  [[nodiscard]] auto is_open() const -> bool { return bytes != nullptr; }
+  [[nodiscard]] auto data() const -> std::span<const std::byte>
+  {
+    return { bytes, size };
+  }
+
+private:
+  const std::byte* bytes{ nullptr };
+  std::size_t size{ 0 };
+  // The file mapping object on Windows, unused elsewhere.
+  void* mapping_handle{ nullptr };
+};
+
 }
@@ -0,0 +1,283 @@
+#include <compilation/SpirvCache.hpp>
+#include <reflection/ReflectionSerialisation.hpp>
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+#include <compilation/ShaderCompiler.hpp>
+#include <reflection/Reflector.hpp>
+#endif
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace Engine::Reflection;
+using Engine::Compilation::SpirvCache;
+using Engine::Core::u32;
+
+namespace {
+auto
+make_reflection_data() -> ReflectionData
+{
+  ReflectionData data;
+  data.shader_descriptor_sets.resize(2);
+  auto& renderer_set = data.shader_descriptor_sets[0];
+  renderer_set.uniform_buffers[0] = UniformBuffer{
+    .size = 256,
+    .binding_point = 0,
+    .name = "RendererUBO",
+    .shader_stage = VK_SHADER_STAGE_ALL,
+  };
+  renderer_set.storage_buffers[3] = StorageBuffer{
+    .size = 64,
+    .binding_point = 3,
+    .name = "Transforms",
+    .shader_stage = VK_SHADER_STAGE_ALL,
+  };
+  auto& material_set = data.shader_descriptor_sets[1];
+  material_set.separate_textures[6] = ImageSampler{
+    .binding_point = 6,
+    .descriptor_set = 1,
+    .array_size = 1,
+    .name = "albedo_map",
+    .shader_stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+  };
+  material_set.storage_images[2] = ImageSampler{
+    .binding_point = 2,
+    .descriptor_set = 1,
+    .array_size = 4,
+    .name = "output_image",
+    .shader_stage = VK_SHADER_STAGE_COMPUTE_BIT,
+  };
+
+  data.push_constant_ranges.push_back({
+    .offset = 0,
+    .size = 24,
+    .shader_stage = VK_SHADER_STAGE_ALL,
+  });
+  auto& material = data.constant_buffers["mat_pc"];
+  material.name = "mat_pc";
+  material.size = 24;
+  material.uniforms["mat_pc.roughness"] = ShaderUniform(
+    "mat_pc.roughness", ShaderUniformType::Float, 4, 16);
+  material.uniforms["mat_pc.albedo_colour"] = ShaderUniform(
+    "mat_pc.albedo_colour", ShaderUniformType::Vec3, 12, 0);
+
+  data.resources["albedo_map"] = ShaderResourceDeclaration("albedo_map", 6, 1);
+  data.resources["Transforms"] = ShaderResourceDeclaration("Transforms", 3, 1);
+
+  auto& constant = data.specialisation_constants["sample_count"];
+  constant.id = 1;
+  constant.type = ShaderUniformType::Int;
+  constant.value = Engine::Core::i32{ 8 };
+  return data;
+}
+
+auto
+expect_same_images(const std::unordered_map<u32, ImageSampler>& expected,
+                   const std::unordered_map<u32, ImageSampler>& actual) -> void
+{
+  ASSERT_EQ(actual.size(), expected.size());
+  for (const auto& [binding, image] : expected) {
+    ASSERT_TRUE(actual.contains(binding));
+    const auto& loaded = actual.at(binding);
+    EXPECT_EQ(loaded.binding_point, image.binding_point);
+    EXPECT_EQ(loaded.descriptor_set, image.descriptor_set);
+    EXPECT_EQ(loaded.array_size, image.array_size);
+    EXPECT_EQ(loaded.name, image.name);
+    EXPECT_EQ(loaded.shader_stage, image.shader_stage);
+  }
+}
+} // namespace
+
+TEST(ReflectionCacheTest, SerialisedDataRoundTrips)
+{
+  const auto data = make_reflection_data();
+  const auto loaded = deserialise(serialise(data));
+  ASSERT_TRUE(loaded.has_value());
+
+  ASSERT_EQ(loaded->shader_descriptor_sets.size(), 2U);
+  const auto& renderer_set = loaded->shader_descriptor_sets[0];
+  EXPECT_EQ(renderer_set.uniform_buffers.at(0).name, "RendererUBO");
+  EXPECT_EQ(renderer_set.uniform_buffers.at(0).size, 256U);
+  EXPECT_EQ(renderer_set.storage_buffers.at(3).name, "Transforms");
+  EXPECT_EQ(renderer_set.storage_buffers.at(3).shader_stage,
+            VK_SHADER_STAGE_ALL);
+  for (u32 set = 0; set < 2; set++) {
+    expect_same_images(data.shader_descriptor_sets[set].separate_textures,
+                       loaded->shader_descriptor_sets[set].separate_textures);
+    expect_same_images(data.shader_descriptor_sets[set].storage_images,
+                       loaded->shader_descriptor_sets[set].storage_images);
+  }
+
+  ASSERT_EQ(loaded->push_constant_ranges.size(), 1U);
+  EXPECT_EQ(loaded->push_constant_ranges[0].size, 24U);
+
+  const auto& roughness =
+    loaded->constant_buffers.at("mat_pc").uniforms.at("mat_pc.roughness");
+  EXPECT_EQ(roughness.get_name(), "mat_pc.roughness");
+  EXPECT_EQ(roughness.get_type(), ShaderUniformType::Float);
+  EXPECT_EQ(roughness.get_size(), 4U);
+  EXPECT_EQ(roughness.get_offset(), 16U);
+  EXPECT_EQ(loaded->constant_buffers.at("mat_pc").uniforms.size(), 2U);
+
+  EXPECT_EQ(loaded->resources.at("albedo_map").get_register(), 6U);
+  EXPECT_EQ(loaded->resources.at("Transforms").get_count(), 1U);
+
+  const auto& constant = loaded->specialisation_constants.at("sample_count");
+  EXPECT_EQ(constant.id, 1U);
+  EXPECT_EQ(constant.get_value<Engine::Core::i32>(), 8);
+}
+
+TEST(ReflectionCacheTest, RejectsDamagedBlobs)
+{
+  const auto blob = serialise(make_reflection_data());
+
+  // Every truncation fails, rather than reading past the end.
+  for (std::size_t size = 0; size < blob.size(); size++) {
+    EXPECT_FALSE(deserialise({ blob.data(), size }).has_value()) << size;
+  }
+
+  auto trailing = blob;
+  trailing.push_back(0);
+  EXPECT_FALSE(deserialise(trailing).has_value());
+
+  auto other_version = blob;
+  other_version[4] ^= 0xFF;
+  EXPECT_FALSE(deserialise(other_version).has_value());
+}
+
+TEST(ReflectionCacheTest, StoredNextToSpirv)
+{
+  const auto directory =
+    std::filesystem::temp_directory_path() / "reflection_cache_store";
+  std::filesystem::remove_all(directory);
+  SpirvCache cache{ directory };
+
+  const std::vector<u32> vertex{ 0x07230203, 1, 2 };
+  const std::vector<u32> fragment{ 0x07230203, 3, 4 };
+  const std::vector<std::span<const u32>> stages{ vertex, fragment };
+  const std::vector<std::span<const u32>> swapped{ fragment, vertex };
+  const auto key = SpirvCache::make_reflection_key(stages);
+  EXPECT_NE(SpirvCache::make_reflection_key(swapped), key);
+
+  EXPECT_FALSE(cache.load_reflection(key).has_value());
+  const auto blob = serialise(make_reflection_data());
+  ASSERT_TRUE(cache.store_reflection(key, blob));
+  EXPECT_EQ(cache.load_reflection(key), blob);
+  // Reflection entries never answer SPIR-V lookups, even with the same key.
+  EXPECT_FALSE(cache.load(key).has_value());
+
+  const auto statistics = cache.get_statistics();
+  EXPECT_EQ(statistics.reflection_hits, 1U);
+  EXPECT_EQ(statistics.reflection_misses, 1U);
+  std::filesystem::remove_all(directory);
+}
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+TEST(ReflectionCacheBenchmark, ReflectorAgainstCachedBlob)
+{
+  using namespace Engine::Compilation;
+  using Engine::Graphics::Shader;
+  static constexpr u32 iterations = 20;
+
+  // Shaders include relative to the repository root.
+  const auto previous_directory = std::filesystem::current_path();
+  std::filesystem::current_path(
+    std::filesystem::path{ __FILE__ }.parent_path() / "../../..");
+  const auto cache_directory =
+    std::filesystem::temp_directory_path() / "reflection_cache_benchmark";
+  std::filesystem::remove_all(cache_directory);
+
+  // One shader per vertex and fragment pair, and one per compute stage.
+  ShaderCompiler compiler{ { .optimisation_level = 2 } };
+  std::vector<std::unordered_map<Shader::Type, std::vector<u32>>> shaders;
+  for (const auto& file :
+       std::filesystem::directory_iterator("Assets/shaders")) {
+    const auto& path = file.path();
+    if (path.extension() == ".comp") {
+      shaders.push_back({ { Shader::Type::Compute,
+                            compiler.compile_stage(path,
+                                                   ShaderStage::Compute) } });
+    } else if (path.extension() == ".vert") {
+      auto fragment = path;
+      fragment.replace_extension(".frag");
+      if (!std::filesystem::exists(fragment)) {
+        fragment = "Assets/shaders/empty.frag";
+      }
+      shaders.push_back({
+        { Shader::Type::Vertex,
+          compiler.compile_stage(path, ShaderStage::Vertex) },
+        { Shader::Type::Fragment,
+          compiler.compile_stage(fragment, ShaderStage::Fragment) },
+      });
+    }
+  }
+
+  SpirvCache cache{ cache_directory };
+  const auto key_of = [](const auto& stages) {
+    std::vector<std::span<const u32>> spans;
+    for (const auto type : {
+           Shader::Type::Compute,
+           Shader::Type::Vertex,
+           Shader::Type::Fragment,
+         }) {
+      if (stages.contains(type)) {
+        spans.emplace_back(stages.at(type));
+      }
+    }
+    return SpirvCache::make_reflection_key(spans);
+  };
+
+  using clock = std::chrono::high_resolution_clock;
+  const auto reflect_start = clock::now();
+  for (u32 i = 0; i < iterations; i++) {
+    for (const auto& stages : shaders) {
+      std::vector<VkDescriptorSetLayout> unused;
+      ReflectionData data;
+      Reflector{ stages }.reflect(unused, data);
+      if (i == 0) {
+        EXPECT_TRUE(cache.store_reflection(key_of(stages), serialise(data)));
+      }
+    }
+  }
+  const auto reflect_ms =
+    std::chrono::duration<double, std::milli>(clock::now() - reflect_start)
+      .count();
+
+  const auto cached_start = clock::now();
+  for (u32 i = 0; i < iterations; i++) {
+    for (const auto& stages : shaders) {
+      const auto blob = cache.load_reflection(key_of(stages));
+      ASSERT_TRUE(blob.has_value());
+      EXPECT_TRUE(deserialise(*blob).has_value());
+    }
+  }
+  const auto cached_ms =
+    std::chrono::duration<double, std::milli>(clock::now() - cached_start)
+      .count();
+
+  const auto per_shader = [&](double total) {
+    return total / static_cast<double>(iterations * shaders.size());
+  };
+  std::stringstream csv_output;
+  csv_output << "Shaders,Reflector(ms/shader),Cached(ms/shader),Speedup\n";
+  csv_output << shaders.size() << "," << per_shader(reflect_ms) << ","
+             << per_shader(cached_ms) << "," << reflect_ms / cached_ms << "\n";
+  std::cout << csv_output.str();
+
+  std::filesystem::remove_all(cache_directory);
+  std::filesystem::current_path(previous_directory);
+
+  std::ofstream csv_file("reflection_cache_benchmark_results.csv");
+  if (csv_file.is_open()) {
+    csv_file << csv_output.str();
+    csv_file.close();
+  } else {
+    std::cerr << "Failed to open file for writing CSV results." << std::endl;
+  }
+}
+#endif
@@ -0,0 +1,170 @@
+#include <compilation/ShaderCompiler.hpp>
+
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace Engine::Compilation;
+using Engine::Core::u32;
+
+namespace {
+auto
+write_shader(const char* name, std::string_view source)
+  -> std::filesystem::path
+{
+  const auto path = std::filesystem::temp_directory_path() / name;
+  std::ofstream file{ path };
+  file << source;
+  return path;
+}
+
+constexpr std::string_view vertex_source = R"(
+layout(location = 0) in vec3 position;
+void main() { gl_Position = vec4(position * SCALE, 1.0); }
+)";
+constexpr std::string_view fragment_source = R"(
+layout(location = 0) out vec4 colour;
+void main() { colour = vec4(1.0, 0.0, 1.0, 1.0); }
+)";
+} // namespace
+
+TEST(ShaderBatchTest, MatchesSerialCompilationInJobOrder)
+{
+  const auto vertex = write_shader("batch_test.vert", vertex_source);
+  const auto fragment = write_shader("batch_test.frag", fragment_source);
+  const std::vector<ShaderCompileJob> jobs{
+    { fragment, ShaderStage::Fragment },
+    { vertex, ShaderStage::Vertex, { { "SCALE", "2.0" } } },
+    { vertex, ShaderStage::Vertex, { { "SCALE", "0.5" } } },
+    { "does_not_exist.vert", ShaderStage::Vertex },
+  };
+
+  ShaderCompiler batch_compiler{ {} };
+  const auto results = batch_compiler.compile_batch(jobs, 3);
+  ASSERT_EQ(results.size(), jobs.size());
+  EXPECT_FALSE(results[0].empty());
+  EXPECT_FALSE(results[1].empty());
+  EXPECT_FALSE(results[2].empty());
+  EXPECT_TRUE(results[3].empty());
+  // Each job's macros reach its own compilation.
+  EXPECT_NE(results[1], results[2]);
+
+  // The batch filled the shared cache under the plain path for the fragment
+  // stage; forcing compiles it again on the serial path for comparison.
+  ShaderCompiler serial_compiler{ {} };
+  EXPECT_EQ(serial_compiler.compile_stage(fragment, ShaderStage::Fragment),
+            results[0]);
+  EXPECT_EQ(
+    serial_compiler.compile_stage(fragment, ShaderStage::Fragment, true),
+    results[0]);
+
+  std::filesystem::remove(vertex);
+  std::filesystem::remove(fragment);
+}
+
+TEST(ShaderBatchTest, CompilersWithDifferentOptionsDoNotShareResults)
+{
+  const auto fragment =
+    write_shader("batch_options_test.frag", fragment_source);
+
+  ShaderCompiler plain{ {} };
+  ShaderCompiler debug{ { .debug_information_level =
+                            DebugInformationLevel::Full } };
+  const auto plain_result =
+    plain.compile_stage(fragment, ShaderStage::Fragment);
+  const auto debug_result =
+    debug.compile_stage(fragment, ShaderStage::Fragment);
+  ASSERT_FALSE(plain_result.empty());
+  ASSERT_FALSE(debug_result.empty());
+  // Debug information adds names and source to the module, so a shared entry
+  // would make the two equal.
+  EXPECT_NE(plain_result, debug_result);
+  EXPECT_EQ(debug_result,
+            debug.compile_stage(fragment, ShaderStage::Fragment, true));
+
+  std::filesystem::remove(fragment);
+}
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+TEST(ShaderBatchBenchmark, SerialAgainstBatchCompilation)
+{
+  static constexpr std::array<u32, 4> thread_counts{ 1, 2, 4, 8 };
+
+  // Shaders include relative to the repository root.
+  const auto previous_directory = std::filesystem::current_path();
+  std::filesystem::current_path(
+    std::filesystem::path{ __FILE__ }.parent_path() / "../../..");
+
+  std::vector<ShaderCompileJob> jobs;
+  for (const auto& file :
+       std::filesystem::directory_iterator("Assets/shaders")) {
+    const auto extension = file.path().extension();
+    if (extension == ".vert") {
+      jobs.push_back({ file.path(), ShaderStage::Vertex });
+    } else if (extension == ".frag") {
+      jobs.push_back({ file.path(), ShaderStage::Fragment });
+    } else if (extension == ".comp") {
+      jobs.push_back({ file.path(), ShaderStage::Compute });
+    }
+  }
+
+  // Every run defines a macro no other run uses, so nothing comes from the
+  // in-memory cache that all compilers share. There is no disk cache.
+  u32 run = 0;
+  const auto fresh_jobs = [&]() {
+    auto copy = jobs;
+    for (auto& job : copy) {
+      job.macro_definitions["ASTUTE_BENCHMARK_RUN"] = std::to_string(run);
+    }
+    run++;
+    return copy;
+  };
+
+  using clock = std::chrono::high_resolution_clock;
+  const auto millis = [](auto duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  };
+  ShaderCompiler compiler{ { .optimisation_level = 2 } };
+
+  const auto serial_jobs = fresh_jobs();
+  const auto serial_start = clock::now();
+  for (const auto& job : serial_jobs) {
+    ShaderCompiler serial{ {
+      .optimisation_level = 2,
+      .macro_definitions = job.macro_definitions,
+    } };
+    EXPECT_FALSE(serial.compile_stage(job.path, job.stage).empty()) << job.path;
+  }
+  const auto serial_ms = millis(clock::now() - serial_start);
+
+  std::stringstream csv_output;
+  csv_output << "Stages,Threads,Serial(ms),Batch(ms),Speedup\n";
+  for (const auto thread_count : thread_counts) {
+    const auto batch_jobs = fresh_jobs();
+    const auto batch_start = clock::now();
+    const auto results = compiler.compile_batch(batch_jobs, thread_count);
+    const auto batch_ms = millis(clock::now() - batch_start);
+    for (const auto& spirv : results) {
+      EXPECT_FALSE(spirv.empty());
+    }
+
+    csv_output << jobs.size() << "," << thread_count << "," << serial_ms << ","
+               << batch_ms << "," << serial_ms / batch_ms << "\n";
+  }
+  std::cout << csv_output.str();
+  std::filesystem::current_path(previous_directory);
+
+  std::ofstream csv_file("shader_batch_benchmark_results.csv");
+  if (csv_file.is_open()) {
+    csv_file << csv_output.str();
+    csv_file.close();
+  } else {
+    std::cerr << "Failed to open file for writing CSV results." << std::endl;
+  }
+}
+#endif
@@ -0,0 +1,71 @@
+#include <compilation/ShaderCompiler.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace Engine::Compilation;
+
+namespace {
+auto
+write_shader(const char* name, std::string_view source)
+  -> std::filesystem::path
+{
+  const auto path = std::filesystem::temp_directory_path() / name;
+  std::ofstream file{ path };
+  file << source;
+  return path;
+}
+
+constexpr std::string_view variant_source = R"(
+#pragma variant USE_TINT
+#pragma variant   USE_FOG
+#pragma optimize(on)
+// #pragma variant COMMENTED_OUT
+#pragma variant USE_TINT
+
+#ifndef USE_TINT
+#define USE_TINT 0
+#endif
+
+layout(location = 0) out vec4 colour;
+void main()
+{
+#if USE_TINT
+  colour = vec4(1.0, 0.5, 0.25, 1.0);
+#else
+  colour = vec4(1.0);
+#endif
+}
+)";
+} // namespace
+
+TEST(ShaderVariantTest, ReadsDeclaredKeysSortedAndUnique)
+{
+  const auto path = write_shader("variant_keys_test.frag", variant_source);
+  ShaderCompiler compiler{ {} };
+  EXPECT_EQ(compiler.get_variant_keys(path),
+            (std::vector<std::string>{ "USE_FOG", "USE_TINT" }));
+  std::filesystem::remove(path);
+}
+
+TEST(ShaderVariantTest, KeysSelectTheCompiledCode)
+{
+  const auto path = write_shader("variant_compile_test.frag", variant_source);
+  const std::vector<ShaderCompileJob> jobs{
+    { path, ShaderStage::Fragment, { { "USE_TINT", "0" } } },
+    { path, ShaderStage::Fragment, { { "USE_TINT", "1" } } },
+    { path, ShaderStage::Fragment },
+  };
+
+  ShaderCompiler compiler{ {} };
+  const auto results = compiler.compile_batch(jobs, 2);
+  ASSERT_FALSE(results[0].empty());
+  ASSERT_FALSE(results[1].empty());
+  EXPECT_NE(results[0], results[1]);
+  // Undeclared keys fall back to the shader's own default.
+  EXPECT_EQ(results[0], results[2]);
+  std::filesystem::remove(path);
+}
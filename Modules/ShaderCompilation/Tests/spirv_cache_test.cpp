@@ -0,0 +1,170 @@
+#include <compilation/ShaderCompiler.hpp>
+#include <compilation/SpirvCache.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace Engine::Compilation;
+using Engine::Core::u32;
+using Engine::Core::u64;
+
+namespace {
+auto
+fresh_directory(const char* name) -> std::filesystem::path
+{
+  const auto directory = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(directory);
+  return directory;
+}
+
+const std::vector<u32> fake_spirv{ 0x07230203, 0x00010600, 1, 2, 3, 4 };
+} // namespace
+
+TEST(SpirvCacheTest, StoresAndLoadsByKey)
+{
+  const auto directory = fresh_directory("spirv_cache_round_trip");
+  SpirvCache cache{ directory };
+
+  EXPECT_FALSE(cache.load(1).has_value());
+  ASSERT_TRUE(cache.store(1, fake_spirv));
+  EXPECT_EQ(cache.load(1), fake_spirv);
+  EXPECT_FALSE(cache.load(2).has_value());
+
+  // Entries outlive the cache object, as they do between runs.
+  SpirvCache reopened{ directory };
+  EXPECT_EQ(reopened.load(1), fake_spirv);
+
+  const auto statistics = cache.get_statistics();
+  EXPECT_EQ(statistics.hits, 1U);
+  EXPECT_EQ(statistics.misses, 2U);
+  EXPECT_EQ(statistics.failed_writes, 0U);
+  std::filesystem::remove_all(directory);
+}
+
+TEST(SpirvCacheTest, IgnoresDamagedEntries)
+{
+  const auto directory = fresh_directory("spirv_cache_damaged");
+  SpirvCache cache{ directory };
+  ASSERT_TRUE(cache.store(7, fake_spirv));
+
+  std::filesystem::path entry;
+  for (const auto& file : std::filesystem::directory_iterator(directory)) {
+    entry = file.path();
+  }
+  ASSERT_EQ(entry.extension(), ".spv");
+
+  {
+    std::fstream file{ entry, std::ios::binary | std::ios::in | std::ios::out };
+    file.seekp(-4, std::ios::end);
+    const u32 flipped = 0xFFFFFFFF;
+    file.write(reinterpret_cast<const char*>(&flipped), sizeof(flipped));
+  }
+  EXPECT_FALSE(cache.load(7).has_value());
+
+  ASSERT_TRUE(cache.store(7, fake_spirv));
+  std::filesystem::resize_file(entry, std::filesystem::file_size(entry) - 4);
+  EXPECT_FALSE(cache.load(7).has_value());
+  std::filesystem::remove_all(directory);
+}
+
+TEST(SpirvCacheTest, KeyCoversSourceStageAndConfiguration)
+{
+  const ShaderCompilerConfiguration base{ .optimisation_level = 2 };
+  const auto key = SpirvCache::make_key("void main() {}", 0, "a.vert", base);
+
+  EXPECT_EQ(SpirvCache::make_key("void main() {}", 0, "a.vert", base), key);
+  // The name only matters when it ends up in the binary.
+  EXPECT_EQ(SpirvCache::make_key("void main() {}", 0, "b.vert", base), key);
+
+  EXPECT_NE(SpirvCache::make_key("void main() { }", 0, "a.vert", base), key);
+  EXPECT_NE(SpirvCache::make_key("void main() {}", 1, "a.vert", base), key);
+  EXPECT_NE(SpirvCache::make_key("void main() {}",
+                                 0,
+                                 "a.vert",
+                                 { .optimisation_level = 0 }),
+            key);
+  EXPECT_NE(SpirvCache::make_key("void main() {}",
+                                 0,
+                                 "a.vert",
+                                 {
+                                   .optimisation_level = 2,
+                                   .macro_definitions = { { "SHADOWS", "1" } },
+                                 }),
+            key);
+
+  const ShaderCompilerConfiguration debug{
+    .optimisation_level = 2,
+    .debug_information_level = DebugInformationLevel::Full,
+  };
+  EXPECT_NE(SpirvCache::make_key("void main() {}", 0, "a.vert", debug),
+            SpirvCache::make_key("void main() {}", 0, "b.vert", debug));
+}
+
+#ifdef ASTUTE_TESTING_BENCHMARK
+TEST(SpirvCacheBenchmark, ColdAgainstWarmStart)
+{
+  // Shaders include relative to the repository root.
+  const auto previous_directory = std::filesystem::current_path();
+  std::filesystem::current_path(
+    std::filesystem::path{ __FILE__ }.parent_path() / "../../..");
+  const auto cache_directory = fresh_directory("spirv_cache_benchmark");
+
+  std::vector<std::pair<std::filesystem::path, ShaderStage>> stages;
+  for (const auto& file :
+       std::filesystem::directory_iterator("Assets/shaders")) {
+    const auto extension = file.path().extension();
+    if (extension == ".vert") {
+      stages.emplace_back(file.path(), ShaderStage::Vertex);
+    } else if (extension == ".frag") {
+      stages.emplace_back(file.path(), ShaderStage::Fragment);
+    } else if (extension == ".comp") {
+      stages.emplace_back(file.path(), ShaderStage::Compute);
+    }
+  }
+
+  using clock = std::chrono::high_resolution_clock;
+  const auto compile_all = [&]() {
+    // A new compiler per run, as in a new process. Forcing skips the
+    // in-memory cache, which is shared between compilers.
+    ShaderCompiler compiler{ {
+      .optimisation_level = 2,
+      .debug_information_level = DebugInformationLevel::Full,
+      .cache_directory = cache_directory,
+    } };
+    const auto start = clock::now();
+    for (const auto& [path, stage] : stages) {
+      EXPECT_FALSE(compiler.compile_stage(path, stage, true).empty()) << path;
+    }
+    const auto elapsed =
+      std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    return std::pair{ elapsed, compiler.get_cache_statistics() };
+  };
+
+  const auto [cold_ms, cold] = compile_all();
+  const auto [warm_ms, warm] = compile_all();
+  EXPECT_EQ(cold.hits, 0U);
+  EXPECT_EQ(warm.hits, stages.size());
+
+  std::stringstream csv_output;
+  csv_output << "Stages,Cold(ms),Warm(ms),ColdMisses,WarmHits\n";
+  csv_output << stages.size() << "," << cold_ms << "," << warm_ms << ","
+             << cold.misses << "," << warm.hits << "\n";
+  std::cout << csv_output.str();
+
+  std::filesystem::remove_all(cache_directory);
+  std::filesystem::current_path(previous_directory);
+
+  std::ofstream csv_file("spirv_cache_benchmark_results.csv");
+  if (csv_file.is_open()) {
+    csv_file << csv_output.str();
+    csv_file.close();
+  } else {
+    std::cerr << "Failed to open file for writing CSV results." << std::endl;
+  }
+}
+#endif
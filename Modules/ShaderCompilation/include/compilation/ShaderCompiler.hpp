@@ -1,10 +1,15 @@
 #pragma once
 
+#include "compilation/SpirvCache.hpp"
 #include "core/Types.hpp"
 
 #include "graphics/Forward.hpp"
 
+#include <algorithm>
 #include <filesystem>
+#include <mutex>
+#include <span>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -12,6 +17,11 @@ namespace Engine::Core {
 class Shader;
 }
 
+namespace shaderc {
+class Compiler;
+class CompileOptions;
+}
+
 namespace Engine::Compilation {
 
 enum class DebugInformationLevel : Core::u8
@@ -51,6 +61,25 @@ struct ShaderCompilerConfiguration
   // The macro definitions to use when compiling the shader.
   // The default value is an empty list.
   const std::unordered_map<std::string, std::string> macro_definitions = {};
+
+  // Where compiled SPIR-V is kept between runs.
+  // The default value is empty, which disables the disk cache.
+  const std::filesystem::path cache_directory = {};
+};
+
+enum class ShaderStage : Core::u8
+{
+  Vertex,
+  Fragment,
+  Compute,
+};
+
+struct ShaderCompileJob
+{
+  std::filesystem::path path;
+  ShaderStage stage;
+  // Added to the configuration's macro definitions for this job only.
+  std::unordered_map<std::string, std::string> macro_definitions{};
 };
 
 class ShaderCompiler
@@ -64,26 +93,70 @@ public:
                         bool force_recompile = false)
     -> Core::Ref<Graphics::Shader>;
 
-  auto compile_compute(const std::filesystem::path& compute_shader_path)
+  auto compile_compute(const std::filesystem::path& compute_shader_path,
+                       bool force_recompile = false)
     -> Core::Ref<Graphics::Shader>;
 
   auto compile_graphics_scoped(
     const std::filesystem::path& vertex_shader_path,
     const std::filesystem::path& fragment_shader_path,
     bool force_recompile = false) -> Core::Scope<Graphics::Shader>;
-  auto compile_compute_scoped(const std::filesystem::path& compute_shader_path)
+  auto compile_compute_scoped(const std::filesystem::path& compute_shader_path,
+                              bool force_recompile = false)
     -> Core::Scope<Graphics::Shader>;
 
+  /// Preprocesses and compiles one stage, going through the in-memory cache
+  /// (unless forced) and the disk cache. Empty if compilation failed.
+  auto compile_stage(const std::filesystem::path&,
+                     ShaderStage,
+                     bool force_recompile = false) -> std::vector<Core::u32>;
+
+  /// Compiles the jobs concurrently on up to thread_count threads, each with
+  /// its own shaderc compiler. Results are in job order, and empty for jobs
+  /// that failed. They also fill the in-memory cache, so later compile calls
+  /// for the same paths and macros return immediately.
+  auto compile_batch(std::span<const ShaderCompileJob>,
+                     Core::u32 thread_count = std::max(
+                       1U,
+                       std::thread::hardware_concurrency()))
+    -> std::vector<std::vector<Core::u32>>;
+
+  /// The feature keys a shader declares with `#pragma variant NAME` lines,
+  /// sorted and without duplicates. Variants define each key as 1 or 0.
+  auto get_variant_keys(const std::filesystem::path&)
+    -> std::vector<std::string>;
+
+  [[nodiscard]] auto get_cache_statistics() const -> SpirvCacheStatistics;
+  /// Null when no cache directory is configured.
+  [[nodiscard]] auto get_spirv_cache() -> SpirvCache*
+  {
+    return spirv_cache.get();
+  }
+
 private:
   const ShaderCompilerConfiguration configuration;
+  Core::Scope<SpirvCache> spirv_cache;
+
+  // Neither shaderc::Compiler nor the includer of shaderc::CompileOptions may
+  // be shared between threads, so callers pass in their own.
+  auto compile_stage(shaderc::Compiler&,
+                     shaderc::CompileOptions&,
+                     const ShaderCompilerConfiguration&,
+                     const std::filesystem::path&,
+                     ShaderStage,
+                     bool force_recompile) -> std::vector<Core::u32>;
 
   // Hide the implementation details of the shader compiler.
   struct Impl;
   Core::Scope<Impl> impl;
 
+  // Guards both caches, which are shared by every compiler and thread.
+  static inline std::mutex cache_mutex{};
   static inline std::unordered_map<std::string, std::string> file_cache{};
+  // Keyed by path, compile options, include directories and macro
+  // definitions.
   static inline std::unordered_map<std::string, std::vector<Core::u32>>
     compiled_cache{};
 };
 
-} // namespace Compilation
+} // namespace Engine::Compilation
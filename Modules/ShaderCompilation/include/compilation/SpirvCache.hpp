@@ -0,0 +1,86 @@
+#pragma once
+
+#include "core/Types.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Engine::Compilation {
+
+struct ShaderCompilerConfiguration;
+
+struct SpirvCacheStatistics
+{
+  Core::u32 hits{ 0 };
+  Core::u32 misses{ 0 };
+  Core::u32 failed_writes{ 0 };
+  Core::u32 reflection_hits{ 0 };
+  Core::u32 reflection_misses{ 0 };
+};
+
+/// Compiled SPIR-V on disk, one file per key, with the serialised reflection
+/// data of linked shaders next to it. Keys are hashes of everything the
+/// output depends on, so entries never go stale: an edited shader or include
+/// simply produces a new key. Safe to use from several threads.
+class SpirvCache
+{
+public:
+  /// Bump whenever the fixed compiler options in ShaderCompiler change, so
+  /// older entries are no longer found.
+  static constexpr Core::u32 format_version = 2;
+
+  explicit SpirvCache(std::filesystem::path);
+
+  /// The key of one stage: a hash of its preprocessed source (includes
+  /// resolved, macros expanded), its shaderc kind and the configuration. The
+  /// source name only counts when debug information is generated, as it is
+  /// then embedded in the binary.
+  static auto make_key(std::string_view preprocessed_source,
+                       Core::u32 shader_kind,
+                       std::string_view source_name,
+                       const ShaderCompilerConfiguration&) -> Core::u64;
+
+  /// The key of the reflection data of a shader made of these stages, in
+  /// the order the shader lists them.
+  static auto make_reflection_key(
+    std::span<const std::span<const Core::u32>> stages) -> Core::u64;
+
+  /// Returns nothing if there is no entry or it is damaged.
+  auto load(Core::u64 key) -> std::optional<std::vector<Core::u32>>;
+  /// Writes to a temporary file and renames it into place, so concurrent
+  /// writers and readers of a key never see a partial entry.
+  auto store(Core::u64 key, std::span<const Core::u32> spirv) -> bool;
+
+  /// As load and store, for a blob made by Reflection::serialise.
+  auto load_reflection(Core::u64 key) -> std::optional<std::vector<Core::u8>>;
+  auto store_reflection(Core::u64 key, std::span<const Core::u8>) -> bool;
+
+  [[nodiscard]] auto get_statistics() const -> SpirvCacheStatistics;
+  [[nodiscard]] auto get_directory() const -> const std::filesystem::path&
+  {
+    return directory;
+  }
+
+private:
+  auto get_entry_path(Core::u64 key, std::string_view extension) const
+    -> std::filesystem::path;
+  auto read_entry(Core::u64 key, Core::u32 magic, std::string_view extension)
+    -> std::optional<std::vector<Core::u8>>;
+  auto write_entry(Core::u64 key,
+                   Core::u32 magic,
+                   std::string_view extension,
+                   std::span<const Core::u8>) -> bool;
+
+  std::filesystem::path directory;
+  std::atomic<Core::u32> hits{ 0 };
+  std::atomic<Core::u32> misses{ 0 };
+  std::atomic<Core::u32> failed_writes{ 0 };
+  std::atomic<Core::u32> reflection_hits{ 0 };
+  std::atomic<Core::u32> reflection_misses{ 0 };
+};
+
+} // namespace Engine::Compilation
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "core/Types.hpp"
+#include "reflection/ReflectionData.hpp"
+
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Engine::Reflection {
+
+/// Bump whenever the blob layout changes; older blobs then fail to load.
+static constexpr Core::u32 serialisation_version = 1;
+
+/// A compact binary form of what the Reflector fills in. Write descriptor
+/// sets and buffer descriptors are left out, as shaders rebuild them when
+/// they create their descriptor set layouts.
+auto
+serialise(const ReflectionData&) -> std::vector<Core::u8>;
+
+/// Nothing if the blob is truncated, malformed or of another version.
+auto
+deserialise(std::span<const Core::u8>) -> std::optional<ReflectionData>;
+
+} // namespace Engine::Reflection
@@ -3,11 +3,12 @@
 #include "core/Types.hpp"
 #include "reflection/ReflectionData.hpp"
 
+#include <unordered_map>
 #include <vector>
 #include <vulkan/vulkan.h>
 
 #include "core/Forward.hpp"
-#include "graphics/Forward.hpp"
+#include "graphics/Shader.hpp"
 
 namespace Engine::Reflection {
 
@@ -17,12 +18,14 @@ class Reflector
 
 public:
   explicit Reflector(Graphics::Shader&);
+  /// Reflects SPIR-V before, or without, creating a shader from it.
+  explicit Reflector(
+    const std::unordered_map<Graphics::Shader::Type, std::vector<Core::u32>>&);
   ~Reflector();
   auto reflect(std::vector<VkDescriptorSetLayout>&,
                ReflectionData& output) const -> void;
 
 private:
-  Graphics::Shader& shader;
   Core::Scope<CompilerImpl> impl{ nullptr };
 };
 
@@ -7,6 +7,8 @@
 
 #include "logging/Logger.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <istream>
 #include <shaderc/shaderc.hpp>
@@ -26,7 +28,20 @@ struct std::formatter<std::filesystem::path>
 
 namespace Engine::Compilation {
 
-ShaderCompiler::~ShaderCompiler() = default;
+ShaderCompiler::~ShaderCompiler()
+{
+  if (spirv_cache) {
+    const auto statistics = spirv_cache->get_statistics();
+    info("SPIR-V cache in '{}': {} hits, {} misses, {} failed writes, {} "
+         "reflection hits, {} reflection misses",
+         spirv_cache->get_directory().string(),
+         statistics.hits,
+         statistics.misses,
+         statistics.failed_writes,
+         statistics.reflection_hits,
+         statistics.reflection_misses);
+  }
+}
 
 namespace {
 auto
@@ -139,64 +154,305 @@ struct ShaderIncluder : public shaderc::CompileOptions::IncluderInterface
   std::unordered_map<std::string, std::string> macro_definitions;
 };
 
+namespace {
+// Options are filled in place: moving a shaderc::CompileOptions leaves its
+// includer behind.
+auto
+configure_options(shaderc::CompileOptions& options,
+                  const ShaderCompilerConfiguration& configuration) -> void
+{
+  static constexpr auto to_shaderc_optimization_level = [](Core::u32 level) {
+    switch (level) {
+      case 0:
+        return shaderc_optimization_level_zero;
+      case 1:
+        return shaderc_optimization_level_size;
+      case 2:
+        return shaderc_optimization_level_performance;
+      default:
+        return shaderc_optimization_level_zero;
+    }
+  };
+
+  options.SetOptimizationLevel(
+    to_shaderc_optimization_level(configuration.optimisation_level));
+  if (configuration.debug_information_level == DebugInformationLevel::Full) {
+    options.SetGenerateDebugInfo();
+  }
+  options.SetTargetEnvironment(shaderc_target_env_vulkan,
+                               shaderc_env_version_vulkan_1_3);
+  if (configuration.warnings_as_errors) {
+    options.SetWarningsAsErrors();
+  }
+  // options.SetInvertY(true);
+  options.SetTargetSpirv(shaderc_spirv_version_1_6);
+  options.SetSourceLanguage(shaderc_source_language_glsl);
+  options.SetForcedVersionProfile(460, shaderc_profile_none);
+  options.SetPreserveBindings(true);
+  for (const auto& [name, value] : configuration.macro_definitions) {
+    options.AddMacroDefinition(name, value);
+  }
+
+  options.SetIncluder(std::make_unique<ShaderIncluder>(
+    configuration.include_directories, configuration.macro_definitions));
+}
+
+auto
+with_macros(const ShaderCompilerConfiguration& configuration,
+            const std::unordered_map<std::string, std::string>& macros)
+  -> ShaderCompilerConfiguration
+{
+  auto macro_definitions = configuration.macro_definitions;
+  for (const auto& [name, value] : macros) {
+    macro_definitions.insert_or_assign(name, value);
+  }
+  return {
+    .optimisation_level = configuration.optimisation_level,
+    .debug_information_level = configuration.debug_information_level,
+    .warnings_as_errors = configuration.warnings_as_errors,
+    .include_directories = configuration.include_directories,
+    .macro_definitions = std::move(macro_definitions),
+    .cache_directory = configuration.cache_directory,
+  };
+}
+
+auto
+make_memory_key(const std::filesystem::path& path,
+                const ShaderCompilerConfiguration& configuration)
+  -> std::string
+{
+  // Sorted, so the key does not depend on the map's iteration order.
+  std::vector<std::pair<std::string_view, std::string_view>> macros{
+    configuration.macro_definitions.begin(),
+    configuration.macro_definitions.end(),
+  };
+  std::ranges::sort(macros);
+
+  // Normalised, so "a/b.vert" and "a\\b.vert" share an entry. The cache is
+  // shared by every compiler, so the options that change the SPIR-V are part
+  // of the key too, as they are in SpirvCache::make_key.
+  auto key = path.lexically_normal().generic_string();
+  key += std::format(
+    ";O{};g{};W{}",
+    configuration.optimisation_level,
+    static_cast<Core::u32>(configuration.debug_information_level),
+    configuration.warnings_as_errors);
+  for (const auto& directory : configuration.include_directories) {
+    key += std::format(";I{}", directory.lexically_normal().generic_string());
+  }
+  for (const auto& [name, value] : macros) {
+    key += std::format(";{}={}", name, value);
+  }
+  return key;
+}
+} // namespace
+
 struct ShaderCompiler::Impl
 {
-  // Spirv cross GLSL compiler
+  // Spirv cross GLSL compiler, used by the single stage calls.
   shaderc::Compiler compiler;
   shaderc::CompileOptions options;
+  std::mutex mutex;
 };
 
 auto
-ShaderCompiler::compile_graphics(
-  const std::filesystem::path& vertex_shader_path,
-  const std::filesystem::path& fragment_shader_path,
-  bool force_recompile) -> Core::Ref<Graphics::Shader>
+ShaderCompiler::compile_stage(const std::filesystem::path& path,
+                              ShaderStage stage,
+                              bool force_recompile) -> std::vector<Core::u32>
 {
-  std::string vertex_path_key = vertex_shader_path.string();
-  std::string fragment_path_key = fragment_shader_path.string();
+  std::lock_guard lock(impl->mutex);
+  return compile_stage(impl->compiler,
+                       impl->options,
+                       configuration,
+                       path,
+                       stage,
+                       force_recompile);
+}
+
+auto
+ShaderCompiler::compile_stage(shaderc::Compiler& compiler,
+                              shaderc::CompileOptions& options,
+                              const ShaderCompilerConfiguration& job,
+                              const std::filesystem::path& path,
+                              ShaderStage stage,
+                              bool force_recompile) -> std::vector<Core::u32>
+{
+  const auto path_key = path.string();
+  const auto memory_key = make_memory_key(path, job);
+
+  std::string source;
+  {
+    std::lock_guard lock(cache_mutex);
+    if (!force_recompile) {
+      if (auto it = compiled_cache.find(memory_key);
+          it != compiled_cache.end() && !it->second.empty()) {
+        return it->second;
+      }
+      if (auto it = file_cache.find(path_key); it != file_cache.end()) {
+        source = it->second;
+      }
+    }
+  }
+  if (source.empty()) {
+    source = read_file(path);
+    std::lock_guard lock(cache_mutex);
+    file_cache[path_key] = source;
+  }
+
+  const auto kind = [stage]() {
+    switch (stage) {
+      case ShaderStage::Vertex:
+        return shaderc_vertex_shader;
+      case ShaderStage::Fragment:
+        return shaderc_fragment_shader;
+      case ShaderStage::Compute:
+        return shaderc_glsl_compute_shader;
+    }
+    return shaderc_glsl_infer_from_source;
+  }();
+
+  const auto remember = [&](std::vector<Core::u32> compiled) {
+    std::lock_guard lock(cache_mutex);
+    compiled_cache[memory_key] = compiled;
+    return compiled;
+  };
+
+  // Preprocessing is cheap next to compilation, and its output is what the
+  // compiled SPIR-V depends on, includes and all, so it keys the disk cache.
+  const auto preprocessed =
+    preprocess_shader(compiler, options, path_key, kind, source);
+  if (preprocessed.empty()) {
+    return remember({});
+  }
+
+  std::optional<Core::u64> key{};
+  if (spirv_cache) {
+    key = SpirvCache::make_key(
+      preprocessed, static_cast<Core::u32>(kind), path_key, job);
+    if (auto cached = spirv_cache->load(*key)) {
+      trace("Loaded cached SPIR-V for '{}'", path_key);
+      return remember(std::move(*cached));
+    }
+  }
+
+  auto compiled =
+    compile_shader(compiler, options, path_key, kind, preprocessed);
+  if (key.has_value() && !compiled.empty() &&
+      !spirv_cache->store(*key, compiled)) {
+    warn("Could not write cached SPIR-V for '{}'", path_key);
+  }
+  return remember(std::move(compiled));
+}
 
-  // Check and read vertex shader source file from cache
-  auto& vertex_file = file_cache[vertex_path_key];
-  if (force_recompile || vertex_file.empty()) {
-    vertex_file = read_file(vertex_shader_path);
+auto
+ShaderCompiler::compile_batch(std::span<const ShaderCompileJob> jobs,
+                              Core::u32 thread_count)
+  -> std::vector<std::vector<Core::u32>>
+{
+  std::vector<std::vector<Core::u32>> results(jobs.size());
+  if (jobs.empty()) {
+    return results;
   }
 
-  // Check and read fragment shader source file from cache
-  auto& fragment_file = file_cache[fragment_path_key];
-  if (force_recompile || fragment_file.empty()) {
-    fragment_file = read_file(fragment_shader_path);
+  const auto start = std::chrono::high_resolution_clock::now();
+  std::atomic<Core::usize> next_job{ 0 };
+  const auto worker = [&]() {
+    shaderc::Compiler compiler;
+    for (auto index = next_job.fetch_add(1); index < jobs.size();
+         index = next_job.fetch_add(1)) {
+      const auto& job = jobs[index];
+      // Options carry the job's macros, and an includer that is not safe to
+      // share, so every job gets its own.
+      const auto job_configuration =
+        with_macros(configuration, job.macro_definitions);
+      shaderc::CompileOptions options;
+      configure_options(options, job_configuration);
+      try {
+        results[index] = compile_stage(
+          compiler, options, job_configuration, job.path, job.stage, false);
+      } catch (const std::exception& exception) {
+        error(
+          "Could not compile '{}': {}", job.path.string(), exception.what());
+      }
+    }
+  };
+
+  const auto worker_count =
+    std::clamp<Core::usize>(thread_count, 1, jobs.size());
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(worker_count - 1);
+    for (Core::usize i = 1; i < worker_count; i++) {
+      workers.emplace_back(worker);
+    }
+    worker();
   }
 
-  // Check and compile vertex shader from cache
-  auto& compiled_vertex_shader = compiled_cache[vertex_path_key];
-  if (force_recompile || compiled_vertex_shader.empty()) {
-    auto preprocessed_vertex_shader = preprocess_shader(impl->compiler,
-                                                        impl->options,
-                                                        vertex_path_key,
-                                                        shaderc_vertex_shader,
-                                                        vertex_file);
-    compiled_vertex_shader = compile_shader(impl->compiler,
-                                            impl->options,
-                                            vertex_path_key,
-                                            shaderc_vertex_shader,
-                                            preprocessed_vertex_shader);
+  const auto elapsed = std::chrono::duration<double, std::milli>(
+                         std::chrono::high_resolution_clock::now() - start)
+                         .count();
+  info("Compiled {} shader stages on {} threads in {:.2f}ms",
+       jobs.size(),
+       worker_count,
+       elapsed);
+  return results;
+}
+
+auto
+ShaderCompiler::get_variant_keys(const std::filesystem::path& path)
+  -> std::vector<std::string>
+{
+  const auto path_key = path.string();
+  std::string source;
+  {
+    std::lock_guard lock(cache_mutex);
+    if (auto it = file_cache.find(path_key); it != file_cache.end()) {
+      source = it->second;
+    }
+  }
+  if (source.empty()) {
+    source = read_file(path);
+    std::lock_guard lock(cache_mutex);
+    file_cache[path_key] = source;
   }
 
-  // Check and compile fragment shader from cache
-  auto& compiled_fragment_shader = compiled_cache[fragment_path_key];
-  if (force_recompile || compiled_fragment_shader.empty()) {
-    auto preprocessed_fragment_shader =
-      preprocess_shader(impl->compiler,
-                        impl->options,
-                        fragment_path_key,
-                        shaderc_fragment_shader,
-                        fragment_file);
-    compiled_fragment_shader = compile_shader(impl->compiler,
-                                              impl->options,
-                                              fragment_path_key,
-                                              shaderc_fragment_shader,
-                                              preprocessed_fragment_shader);
+  // Unknown pragmas are ignored by the GLSL compiler, so the declarations
+  // need no special handling when compiling.
+  static constexpr std::string_view directive = "variant";
+  std::vector<std::string> keys;
+  std::istringstream lines{ source };
+  for (std::string line; std::getline(lines, line);) {
+    std::istringstream words{ line };
+    std::string hash_pragma;
+    std::string name;
+    std::string key;
+    if (words >> hash_pragma >> name >> key && hash_pragma == "#pragma" &&
+        name == directive) {
+      keys.push_back(std::move(key));
+    }
   }
+  std::ranges::sort(keys);
+  const auto [first, last] = std::ranges::unique(keys);
+  keys.erase(first, last);
+  return keys;
+}
+
+auto
+ShaderCompiler::get_cache_statistics() const -> SpirvCacheStatistics
+{
+  return spirv_cache ? spirv_cache->get_statistics() : SpirvCacheStatistics{};
+}
+
+auto
+ShaderCompiler::compile_graphics(
+  const std::filesystem::path& vertex_shader_path,
+  const std::filesystem::path& fragment_shader_path,
+  bool force_recompile) -> Core::Ref<Graphics::Shader>
+{
+  auto compiled_vertex_shader =
+    compile_stage(vertex_shader_path, ShaderStage::Vertex, force_recompile);
+  auto compiled_fragment_shader = compile_stage(
+    fragment_shader_path, ShaderStage::Fragment, force_recompile);
 
   // Check for compilation errors
   if (compiled_vertex_shader.empty() || compiled_fragment_shader.empty()) {
@@ -207,11 +463,11 @@ ShaderCompiler::compile_graphics(
     compiled_spirv_per_stage{
       {
         Graphics::Shader::Type::Vertex,
-        compiled_vertex_shader,
+        std::move(compiled_vertex_shader),
       },
       {
         Graphics::Shader::Type::Fragment,
-        compiled_fragment_shader,
+        std::move(compiled_fragment_shader),
       },
     };
   auto name = vertex_shader_path.filename().replace_extension().string();
@@ -222,27 +478,12 @@ ShaderCompiler::compile_graphics(
 
 auto
 ShaderCompiler::compile_compute(
-  const std::filesystem::path& compute_shader_path)
-  -> Core::Ref<Graphics::Shader>
+  const std::filesystem::path& compute_shader_path,
+  bool force_recompile) -> Core::Ref<Graphics::Shader>
 {
-
-  // Read shader source file
-  std::string compute_shader_source = read_file(compute_shader_path);
-
-  // Preprocess and compile compute shader
-  auto preprocessed_compute_shader =
-    preprocess_shader(impl->compiler,
-                      impl->options,
-                      compute_shader_path.string(),
-                      shaderc_glsl_compute_shader,
-                      compute_shader_source);
-  auto compiled_compute_shader = compile_shader(impl->compiler,
-                                                impl->options,
-                                                compute_shader_path.string(),
-                                                shaderc_glsl_compute_shader,
-                                                preprocessed_compute_shader);
-
-  if (compiled_compute_shader.empty() || preprocessed_compute_shader.empty()) {
+  auto compiled_compute_shader =
+    compile_stage(compute_shader_path, ShaderStage::Compute, force_recompile);
+  if (compiled_compute_shader.empty()) {
     return nullptr;
   }
 
@@ -250,7 +491,7 @@ ShaderCompiler::compile_compute(
     compiled_spirv_per_stage{
       {
         Graphics::Shader::Type::Compute,
-        compiled_compute_shader,
+        std::move(compiled_compute_shader),
       },
     };
 
@@ -266,51 +507,10 @@ ShaderCompiler::compile_graphics_scoped(
   const std::filesystem::path& fragment_shader_path,
   bool force_recompile) -> Core::Scope<Graphics::Shader>
 {
-  std::string vertex_path_key = vertex_shader_path.string();
-  std::string fragment_path_key = fragment_shader_path.string();
-
-  // Check and read vertex shader source file from cache
-  auto& vertex_file = file_cache[vertex_path_key];
-  if (force_recompile || vertex_file.empty()) {
-    vertex_file = read_file(vertex_shader_path);
-  }
-
-  // Check and read fragment shader source file from cache
-  auto& fragment_file = file_cache[fragment_path_key];
-  if (force_recompile || fragment_file.empty()) {
-    fragment_file = read_file(fragment_shader_path);
-  }
-
-  // Check and compile vertex shader from cache
-  auto& compiled_vertex_shader = compiled_cache[vertex_path_key];
-  if (force_recompile || compiled_vertex_shader.empty()) {
-    auto preprocessed_vertex_shader = preprocess_shader(impl->compiler,
-                                                        impl->options,
-                                                        vertex_path_key,
-                                                        shaderc_vertex_shader,
-                                                        vertex_file);
-    compiled_vertex_shader = compile_shader(impl->compiler,
-                                            impl->options,
-                                            vertex_path_key,
-                                            shaderc_vertex_shader,
-                                            preprocessed_vertex_shader);
-  }
-
-  // Check and compile fragment shader from cache
-  auto& compiled_fragment_shader = compiled_cache[fragment_path_key];
-  if (force_recompile || compiled_fragment_shader.empty()) {
-    auto preprocessed_fragment_shader =
-      preprocess_shader(impl->compiler,
-                        impl->options,
-                        fragment_path_key,
-                        shaderc_fragment_shader,
-                        fragment_file);
-    compiled_fragment_shader = compile_shader(impl->compiler,
-                                              impl->options,
-                                              fragment_path_key,
-                                              shaderc_fragment_shader,
-                                              preprocessed_fragment_shader);
-  }
+  auto compiled_vertex_shader =
+    compile_stage(vertex_shader_path, ShaderStage::Vertex, force_recompile);
+  auto compiled_fragment_shader = compile_stage(
+    fragment_shader_path, ShaderStage::Fragment, force_recompile);
 
   // Check for compilation errors
   if (compiled_vertex_shader.empty() || compiled_fragment_shader.empty()) {
@@ -321,11 +521,11 @@ ShaderCompiler::compile_graphics_scoped(
     compiled_spirv_per_stage{
       {
         Graphics::Shader::Type::Vertex,
-        compiled_vertex_shader,
+        std::move(compiled_vertex_shader),
       },
       {
         Graphics::Shader::Type::Fragment,
-        compiled_fragment_shader,
+        std::move(compiled_fragment_shader),
       },
     };
   auto name = vertex_shader_path.filename().replace_extension().string() + "_" +
@@ -337,27 +537,12 @@ ShaderCompiler::compile_graphics_scoped(
 
 auto
 ShaderCompiler::compile_compute_scoped(
-  const std::filesystem::path& compute_shader_path)
-  -> Core::Scope<Graphics::Shader>
+  const std::filesystem::path& compute_shader_path,
+  bool force_recompile) -> Core::Scope<Graphics::Shader>
 {
-
-  // Read shader source file
-  std::string compute_shader_source = read_file(compute_shader_path);
-
-  // Preprocess and compile compute shader
-  auto preprocessed_compute_shader =
-    preprocess_shader(impl->compiler,
-                      impl->options,
-                      compute_shader_path.string(),
-                      shaderc_glsl_compute_shader,
-                      compute_shader_source);
-  auto compiled_compute_shader = compile_shader(impl->compiler,
-                                                impl->options,
-                                                compute_shader_path.string(),
-                                                shaderc_glsl_compute_shader,
-                                                preprocessed_compute_shader);
-
-  if (compiled_compute_shader.empty() || preprocessed_compute_shader.empty()) {
+  auto compiled_compute_shader =
+    compile_stage(compute_shader_path, ShaderStage::Compute, force_recompile);
+  if (compiled_compute_shader.empty()) {
     return nullptr;
   }
 
@@ -365,7 +550,7 @@ ShaderCompiler::compile_compute_scoped(
     compiled_spirv_per_stage{
       {
         Graphics::Shader::Type::Compute,
-        compiled_compute_shader,
+        std::move(compiled_compute_shader),
       },
     };
   auto name = compute_shader_path.filename().replace_extension().string();
@@ -378,36 +563,11 @@ ShaderCompiler::ShaderCompiler(const ShaderCompilerConfiguration& conf)
   : configuration(conf)
 {
   impl = Core::make_scope<Impl>();
-  static constexpr auto to_shaderc_optimization_level = [](Core::u32 level) {
-    switch (level) {
-      case 0:
-        return shaderc_optimization_level_zero;
-      case 1:
-        return shaderc_optimization_level_size;
-      case 2:
-        return shaderc_optimization_level_performance;
-      default:
-        return shaderc_optimization_level_zero;
-    }
-  };
-  impl->options.SetOptimizationLevel(
-    to_shaderc_optimization_level(configuration.optimisation_level));
-  if (configuration.debug_information_level == DebugInformationLevel::Full) {
-    impl->options.SetGenerateDebugInfo();
-  }
-  impl->options.SetTargetEnvironment(shaderc_target_env_vulkan,
-                                     shaderc_env_version_vulkan_1_3);
-  if (configuration.warnings_as_errors) {
-    impl->options.SetWarningsAsErrors();
-  }
-  // impl->options.SetInvertY(true);
-  impl->options.SetTargetSpirv(shaderc_spirv_version_1_6);
-  impl->options.SetSourceLanguage(shaderc_source_language_glsl);
-  impl->options.SetForcedVersionProfile(460, shaderc_profile_none);
-  impl->options.SetPreserveBindings(true);
+  configure_options(impl->options, configuration);
 
-  impl->options.SetIncluder(std::make_unique<ShaderIncluder>(
-    configuration.include_directories, configuration.macro_definitions));
+  if (!configuration.cache_directory.empty()) {
+    spirv_cache = Core::make_scope<SpirvCache>(configuration.cache_directory);
+  }
 }
 
-} // namespace Compilation
+} // namespace Engine::Compilation
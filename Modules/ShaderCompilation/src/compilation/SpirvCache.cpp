@@ -0,0 +1,282 @@
+#include "pch/CorePCH.hpp"
+
+#include "compilation/SpirvCache.hpp"
+
+#include "compilation/ShaderCompiler.hpp"
+
+#include "logging/Logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace Engine::Compilation {
+
+namespace {
+constexpr Core::u32 spirv_entry_magic = 0x56505341;      // "ASPV"
+constexpr Core::u32 reflection_entry_magic = 0x4C465241; // "ARFL"
+constexpr Core::u32 spirv_magic = 0x07230203;
+
+struct EntryHeader
+{
+  Core::u32 magic;
+  Core::u32 format_version;
+  Core::u64 key;
+  Core::u64 byte_count;
+  Core::u64 checksum;
+};
+
+// FNV-1a, finished with the murmur3 mixer so that nearby inputs spread over
+// all 64 bits.
+class Hasher
+{
+public:
+  auto add(const void* data, Core::usize size) -> Hasher&
+  {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (Core::usize i = 0; i < size; i++) {
+      state = (state ^ bytes[i]) * 0x100000001B3ULL;
+    }
+    return *this;
+  }
+  auto add(std::string_view text) -> Hasher&
+  {
+    const auto size = static_cast<Core::u64>(text.size());
+    add(&size, sizeof(size));
+    return add(text.data(), text.size());
+  }
+  template<class T>
+    requires std::is_integral_v<T> || std::is_enum_v<T>
+  auto add(T value) -> Hasher&
+  {
+    return add(&value, sizeof(value));
+  }
+
+  [[nodiscard]] auto finish() const -> Core::u64
+  {
+    auto mixed = state;
+    mixed ^= mixed >> 33;
+    mixed *= 0xFF51AFD7ED558CCDULL;
+    mixed ^= mixed >> 33;
+    mixed *= 0xC4CEB9FE1A85EC53ULL;
+    mixed ^= mixed >> 33;
+    return mixed;
+  }
+
+private:
+  Core::u64 state{ 0xCBF29CE484222325ULL };
+};
+
+auto
+checksum(std::span<const Core::u8> bytes) -> Core::u64
+{
+  return Hasher{}.add(bytes.data(), bytes.size()).finish();
+}
+} // namespace
+
+SpirvCache::SpirvCache(std::filesystem::path cache_directory)
+  : directory(std::move(cache_directory))
+{
+  std::error_code error_code;
+  std::filesystem::create_directories(directory, error_code);
+  if (error_code) {
+    warn("Could not create the SPIR-V cache directory '{}': {}",
+         directory.string(),
+         error_code.message());
+  }
+}
+
+auto
+SpirvCache::make_key(std::string_view preprocessed_source,
+                     Core::u32 shader_kind,
+                     std::string_view source_name,
+                     const ShaderCompilerConfiguration& configuration)
+  -> Core::u64
+{
+  Hasher hasher;
+  hasher.add(format_version)
+    .add(shader_kind)
+    .add(preprocessed_source)
+    .add(configuration.optimisation_level)
+    .add(configuration.debug_information_level)
+    .add(configuration.warnings_as_errors);
+  if (configuration.debug_information_level != DebugInformationLevel::None) {
+    hasher.add(source_name);
+  }
+
+  // Sorted, so the key does not depend on the map's iteration order.
+  std::vector<std::pair<std::string_view, std::string_view>> macros{
+    configuration.macro_definitions.begin(),
+    configuration.macro_definitions.end(),
+  };
+  std::ranges::sort(macros);
+  for (const auto& [name, value] : macros) {
+    hasher.add(name).add(value);
+  }
+  return hasher.finish();
+}
+
+auto
+SpirvCache::make_reflection_key(
+  std::span<const std::span<const Core::u32>> stages) -> Core::u64
+{
+  Hasher hasher;
+  hasher.add(format_version).add(static_cast<Core::u64>(stages.size()));
+  for (const auto& stage : stages) {
+    hasher.add(static_cast<Core::u64>(stage.size()))
+      .add(stage.data(), stage.size_bytes());
+  }
+  return hasher.finish();
+}
+
+auto
+SpirvCache::get_entry_path(Core::u64 key, std::string_view extension) const
+  -> std::filesystem::path
+{
+  return directory / std::format("{:016x}{}", key, extension);
+}
+
+auto
+SpirvCache::read_entry(Core::u64 key,
+                       Core::u32 magic,
+                       std::string_view extension)
+  -> std::optional<std::vector<Core::u8>>
+{
+  const auto entry_path = get_entry_path(key, extension);
+  std::ifstream file(entry_path, std::ios::binary);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+
+  EntryHeader header{};
+  std::error_code error_code;
+  const auto file_size = std::filesystem::file_size(entry_path, error_code);
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      header.magic != magic || header.format_version != format_version ||
+      header.key != key || header.byte_count == 0 || error_code ||
+      file_size != sizeof(header) + header.byte_count) {
+    return std::nullopt;
+  }
+
+  std::vector<Core::u8> bytes(header.byte_count);
+  if (!file.read(reinterpret_cast<char*>(bytes.data()),
+                 static_cast<std::streamsize>(bytes.size())) ||
+      checksum(bytes) != header.checksum) {
+    warn("Ignoring damaged shader cache entry {:016x}{}", key, extension);
+    return std::nullopt;
+  }
+  return bytes;
+}
+
+auto
+SpirvCache::write_entry(Core::u64 key,
+                        Core::u32 magic,
+                        std::string_view extension,
+                        std::span<const Core::u8> bytes) -> bool
+{
+  const auto entry_path = get_entry_path(key, extension);
+  // Unique per thread, so two threads storing one key do not interleave.
+  auto temporary_path = entry_path;
+  temporary_path += std::format(
+    ".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+  const EntryHeader header{
+    .magic = magic,
+    .format_version = format_version,
+    .key = key,
+    .byte_count = bytes.size(),
+    .checksum = checksum(bytes),
+  };
+  {
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+  }
+  if (std::error_code error_code;
+      !std::filesystem::exists(temporary_path, error_code) ||
+      std::filesystem::file_size(temporary_path, error_code) !=
+        sizeof(header) + bytes.size()) {
+    std::filesystem::remove(temporary_path, error_code);
+    failed_writes.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  std::error_code error_code;
+  std::filesystem::rename(temporary_path, entry_path, error_code);
+  if (error_code) {
+    std::filesystem::remove(temporary_path, error_code);
+    failed_writes.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+auto
+SpirvCache::load(Core::u64 key) -> std::optional<std::vector<Core::u32>>
+{
+  auto bytes = read_entry(key, spirv_entry_magic, ".spv");
+  if (!bytes || bytes->size() % sizeof(Core::u32) != 0) {
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  std::vector<Core::u32> spirv(bytes->size() / sizeof(Core::u32));
+  std::memcpy(spirv.data(), bytes->data(), bytes->size());
+  if (spirv.front() != spirv_magic) {
+    warn("Ignoring SPIR-V cache entry {:016x} without the SPIR-V magic", key);
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  hits.fetch_add(1, std::memory_order_relaxed);
+  return spirv;
+}
+
+auto
+SpirvCache::store(Core::u64 key, std::span<const Core::u32> spirv) -> bool
+{
+  if (spirv.empty()) {
+    return false;
+  }
+  return write_entry(key,
+                     spirv_entry_magic,
+                     ".spv",
+                     { reinterpret_cast<const Core::u8*>(spirv.data()),
+                       spirv.size_bytes() });
+}
+
+auto
+SpirvCache::load_reflection(Core::u64 key)
+  -> std::optional<std::vector<Core::u8>>
+{
+  auto bytes = read_entry(key, reflection_entry_magic, ".refl");
+  (bytes ? reflection_hits : reflection_misses)
+    .fetch_add(1, std::memory_order_relaxed);
+  return bytes;
+}
+
+auto
+SpirvCache::store_reflection(Core::u64 key, std::span<const Core::u8> blob)
+  -> bool
+{
+  if (blob.empty()) {
+    return false;
+  }
+  return write_entry(key, reflection_entry_magic, ".refl", blob);
+}
+
+auto
+SpirvCache::get_statistics() const -> SpirvCacheStatistics
+{
+  return {
+    .hits = hits.load(std::memory_order_relaxed),
+    .misses = misses.load(std::memory_order_relaxed),
+    .failed_writes = failed_writes.load(std::memory_order_relaxed),
+    .reflection_hits = reflection_hits.load(std::memory_order_relaxed),
+    .reflection_misses = reflection_misses.load(std::memory_order_relaxed),
+  };
+}
+
+} // namespace Engine::Compilation
@@ -0,0 +1,301 @@
+#include "pch/CorePCH.hpp"
+
+#include "reflection/ReflectionSerialisation.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace Engine::Reflection {
+
+namespace {
+constexpr Core::u32 blob_magic = 0x4C464552; // "REFL"
+
+class Writer
+{
+public:
+  template<class T>
+    requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+  auto put(T value) -> Writer&
+  {
+    const auto offset = bytes.size();
+    bytes.resize(offset + sizeof(T));
+    std::memcpy(bytes.data() + offset, &value, sizeof(T));
+    return *this;
+  }
+  auto put(std::string_view text) -> Writer&
+  {
+    put(static_cast<Core::u32>(text.size()));
+    bytes.insert(bytes.end(), text.begin(), text.end());
+    return *this;
+  }
+  auto put_count(Core::usize count) -> Writer&
+  {
+    return put(static_cast<Core::u32>(count));
+  }
+
+  auto take() -> std::vector<Core::u8> { return std::move(bytes); }
+
+private:
+  std::vector<Core::u8> bytes;
+};
+
+// Reads fail softly: after the first short read every further read fails
+// too, and the caller checks once at the end.
+class Reader
+{
+public:
+  explicit Reader(std::span<const Core::u8> input)
+    : bytes(input)
+  {
+  }
+
+  template<class T>
+    requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+  auto get() -> T
+  {
+    T value{};
+    if (!take(sizeof(T))) {
+      return value;
+    }
+    std::memcpy(&value, bytes.data() + offset - sizeof(T), sizeof(T));
+    return value;
+  }
+  auto get_string() -> std::string
+  {
+    const auto size = get<Core::u32>();
+    if (!take(size)) {
+      return {};
+    }
+    return { reinterpret_cast<const char*>(bytes.data() + offset - size),
+             size };
+  }
+  // Every element takes at least a byte, which bounds counts read from a
+  // damaged blob.
+  auto get_count() -> Core::u32
+  {
+    const auto count = get<Core::u32>();
+    if (count > bytes.size() - offset) {
+      failed = true;
+      return 0;
+    }
+    return count;
+  }
+
+  [[nodiscard]] auto ok() const -> bool { return !failed; }
+  [[nodiscard]] auto at_end() const -> bool { return offset == bytes.size(); }
+
+private:
+  auto take(Core::usize size) -> bool
+  {
+    if (failed || size > bytes.size() - offset) {
+      failed = true;
+      return false;
+    }
+    offset += size;
+    return true;
+  }
+
+  std::span<const Core::u8> bytes;
+  Core::usize offset{ 0 };
+  bool failed{ false };
+};
+
+template<class Buffer>
+auto
+put_buffers(Writer& writer, const std::unordered_map<Core::u32, Buffer>& map)
+  -> void
+{
+  writer.put_count(map.size());
+  for (const auto& [key, buffer] : map) {
+    writer.put(key)
+      .put(buffer.size)
+      .put(buffer.binding_point)
+      .put(buffer.name)
+      .put(buffer.shader_stage);
+  }
+}
+
+template<class Buffer>
+auto
+get_buffers(Reader& reader, std::unordered_map<Core::u32, Buffer>& map)
+  -> void
+{
+  for (auto count = reader.get_count(); count > 0 && reader.ok(); count--) {
+    const auto key = reader.get<Core::u32>();
+    auto& buffer = map[key];
+    buffer.size = reader.get<Core::u32>();
+    buffer.binding_point = reader.get<Core::u32>();
+    buffer.name = reader.get_string();
+    buffer.shader_stage = reader.get<VkShaderStageFlagBits>();
+  }
+}
+
+auto
+put_images(Writer& writer,
+           const std::unordered_map<Core::u32, ImageSampler>& map) -> void
+{
+  writer.put_count(map.size());
+  for (const auto& [key, image] : map) {
+    writer.put(key)
+      .put(image.binding_point)
+      .put(image.descriptor_set)
+      .put(image.array_size)
+      .put(image.name)
+      .put(image.shader_stage);
+  }
+}
+
+auto
+get_images(Reader& reader, std::unordered_map<Core::u32, ImageSampler>& map)
+  -> void
+{
+  for (auto count = reader.get_count(); count > 0 && reader.ok(); count--) {
+    const auto key = reader.get<Core::u32>();
+    auto& image = map[key];
+    image.binding_point = reader.get<Core::u32>();
+    image.descriptor_set = reader.get<Core::u32>();
+    image.array_size = reader.get<Core::u32>();
+    image.name = reader.get_string();
+    image.shader_stage = reader.get<VkShaderStageFlagBits>();
+  }
+}
+} // namespace
+
+auto
+serialise(const ReflectionData& data) -> std::vector<Core::u8>
+{
+  Writer writer;
+  writer.put(blob_magic).put(serialisation_version);
+
+  writer.put_count(data.shader_descriptor_sets.size());
+  for (const auto& set : data.shader_descriptor_sets) {
+    put_buffers(writer, set.uniform_buffers);
+    put_buffers(writer, set.storage_buffers);
+    put_images(writer, set.sampled_images);
+    put_images(writer, set.storage_images);
+    put_images(writer, set.separate_textures);
+    put_images(writer, set.separate_samplers);
+  }
+
+  writer.put_count(data.push_constant_ranges.size());
+  for (const auto& range : data.push_constant_ranges) {
+    writer.put(range.offset).put(range.size).put(range.shader_stage);
+  }
+
+  writer.put_count(data.constant_buffers.size());
+  for (const auto& [key, buffer] : data.constant_buffers) {
+    writer.put(key).put(buffer.name).put(buffer.size);
+    writer.put_count(buffer.uniforms.size());
+    for (const auto& [uniform_key, uniform] : buffer.uniforms) {
+      writer.put(uniform_key)
+        .put(uniform.get_name())
+        .put(uniform.get_type())
+        .put(uniform.get_size())
+        .put(uniform.get_offset());
+    }
+  }
+
+  writer.put_count(data.resources.size());
+  for (const auto& [key, resource] : data.resources) {
+    writer.put(key)
+      .put(resource.get_name())
+      .put(resource.get_register())
+      .put(resource.get_count());
+  }
+
+  writer.put_count(data.specialisation_constants.size());
+  for (const auto& [key, constant] : data.specialisation_constants) {
+    writer.put(key)
+      .put(constant.id)
+      .put(constant.size)
+      .put(constant.offset)
+      .put(constant.type)
+      .put(static_cast<Core::u8>(constant.value.index()));
+    std::visit([&writer](auto value) { writer.put(value); }, constant.value);
+  }
+
+  return writer.take();
+}
+
+auto
+deserialise(std::span<const Core::u8> blob) -> std::optional<ReflectionData>
+{
+  Reader reader{ blob };
+  if (reader.get<Core::u32>() != blob_magic ||
+      reader.get<Core::u32>() != serialisation_version) {
+    return std::nullopt;
+  }
+
+  ReflectionData data;
+  data.shader_descriptor_sets.resize(reader.get_count());
+  for (auto& set : data.shader_descriptor_sets) {
+    get_buffers(reader, set.uniform_buffers);
+    get_buffers(reader, set.storage_buffers);
+    get_images(reader, set.sampled_images);
+    get_images(reader, set.storage_images);
+    get_images(reader, set.separate_textures);
+    get_images(reader, set.separate_samplers);
+  }
+
+  data.push_constant_ranges.resize(reader.get_count());
+  for (auto& range : data.push_constant_ranges) {
+    range.offset = reader.get<Core::u32>();
+    range.size = reader.get<Core::u32>();
+    range.shader_stage = reader.get<VkShaderStageFlags>();
+  }
+
+  for (auto count = reader.get_count(); count > 0 && reader.ok(); count--) {
+    auto& buffer = data.constant_buffers[reader.get_string()];
+    buffer.name = reader.get_string();
+    buffer.size = reader.get<Core::u32>();
+    for (auto uniforms = reader.get_count(); uniforms > 0 && reader.ok();
+         uniforms--) {
+      auto key = reader.get_string();
+      auto name = reader.get_string();
+      const auto type = reader.get<ShaderUniformType>();
+      const auto size = reader.get<Core::u32>();
+      const auto offset = reader.get<Core::u32>();
+      buffer.uniforms[std::move(key)] = ShaderUniform(name, type, size, offset);
+    }
+  }
+
+  for (auto count = reader.get_count(); count > 0 && reader.ok(); count--) {
+    auto key = reader.get_string();
+    auto name = reader.get_string();
+    const auto resource_register = reader.get<Core::u32>();
+    const auto resource_count = reader.get<Core::u32>();
+    data.resources[std::move(key)] =
+      ShaderResourceDeclaration(name, resource_register, resource_count);
+  }
+
+  for (auto count = reader.get_count(); count > 0 && reader.ok(); count--) {
+    auto& constant = data.specialisation_constants[reader.get_string()];
+    constant.id = reader.get<Core::u32>();
+    constant.size = reader.get<Core::u32>();
+    constant.offset = reader.get<Core::u32>();
+    constant.type = reader.get<ShaderUniformType>();
+    switch (reader.get<Core::u8>()) {
+      case 0:
+        constant.value = reader.get<Core::u8>() != 0;
+        break;
+      case 1:
+        constant.value = reader.get<Core::i32>();
+        break;
+      case 2:
+        constant.value = reader.get<Core::u64>();
+        break;
+      case 3:
+        constant.value = reader.get<float>();
+        break;
+      default:
+        return std::nullopt;
+    }
+  }
+
+  if (!reader.ok() || !reader.at_end()) {
+    return std::nullopt;
+  }
+  return data;
+}
+
+} // namespace Engine::Reflection
@@ -71,7 +71,6 @@ struct Reflector::CompilerImpl
 };
 
 Reflector::Reflector(Graphics::Shader& shader)
-  : shader(shader)
 {
   std::array potential_types = {
     Graphics::Shader::Type::Compute,
@@ -99,6 +98,30 @@ Reflector::Reflector(Graphics::Shader& shader)
   impl = Core::make_scope<CompilerImpl>(std::move(output));
 }
 
+Reflector::Reflector(
+  const std::unordered_map<Graphics::Shader::Type, std::vector<Core::u32>>&
+    stages)
+{
+  std::array potential_types = {
+    Graphics::Shader::Type::Compute,
+    Graphics::Shader::Type::Vertex,
+    Graphics::Shader::Type::Fragment,
+  };
+  std::unordered_map<Graphics::Shader::Type, Core::Scope<spirv_cross::Compiler>>
+    output;
+  for (const auto& type : potential_types) {
+    if (!stages.contains(type)) {
+      continue;
+    }
+    const auto& spirv = stages.at(type);
+    output.try_emplace(type,
+                       Core::make_scope<spirv_cross::Compiler>(spirv.data(),
+                                                               spirv.size()));
+  }
+
+  impl = Core::make_scope<CompilerImpl>(std::move(output));
+}
+
 Reflector::~Reflector() = default;
 
 static constexpr auto check_for_gaps = [](const auto& unordered_map) {
@@ -34,6 +34,11 @@ public:
   }
   ~ThreadPool();
 
+  [[nodiscard]] auto get_thread_count() const -> std::uint32_t
+  {
+    return static_cast<std::uint32_t>(thread_pool.get_thread_count());
+  }
+
   template<typename F>
   auto enqueue_task(F&& f) -> std::future<decltype(f())>
   {